@@ -0,0 +1,328 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "BenchmarkUtils.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace roboticslab::bench;
+
+//-- Count every heap allocation in this process.
+
+namespace
+{
+    std::atomic<long> counter(0);
+}
+
+#if defined(__GLIBC__)
+
+// Interpose the C allocator, which sits below operator new, Eigen's aligned_malloc and any
+// code loaded at runtime. Memory is released by the regular free().
+
+extern "C"
+{
+    void * __libc_malloc(std::size_t size);
+    void * __libc_calloc(std::size_t n, std::size_t size);
+    void * __libc_realloc(void * ptr, std::size_t size);
+    void * __libc_memalign(std::size_t alignment, std::size_t size);
+
+    void * malloc(std::size_t size)
+    {
+        counter++;
+        return __libc_malloc(size);
+    }
+
+    void * calloc(std::size_t n, std::size_t size)
+    {
+        counter++;
+        return __libc_calloc(n, size);
+    }
+
+    void * realloc(void * ptr, std::size_t size)
+    {
+        counter++;
+        return __libc_realloc(ptr, size);
+    }
+
+    void * memalign(std::size_t alignment, std::size_t size)
+    {
+        counter++;
+        return __libc_memalign(alignment, size);
+    }
+
+    void * aligned_alloc(std::size_t alignment, std::size_t size)
+    {
+        counter++;
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void ** ptr, std::size_t alignment, std::size_t size)
+    {
+        if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+        {
+            return EINVAL;
+        }
+
+        counter++;
+        void * p = __libc_memalign(alignment, size);
+
+        if (p == NULL)
+        {
+            return ENOMEM;
+        }
+
+        *ptr = p;
+        return 0;
+    }
+}
+
+const char * roboticslab::bench::allocationCounter()
+{
+    return "malloc";
+}
+
+#else
+
+void * operator new(std::size_t size)
+{
+    counter++;
+
+    if (void * ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+const char * roboticslab::bench::allocationCounter()
+{
+    return "operator new";
+}
+
+#endif
+
+// -----------------------------------------------------------------------------
+
+long roboticslab::bench::allocations()
+{
+    return counter;
+}
+
+// -----------------------------------------------------------------------------
+
+void Arguments::add(const std::string & option, int * value)
+{
+    options.push_back(std::make_pair("--" + option, value));
+}
+
+// -----------------------------------------------------------------------------
+
+bool Arguments::parse(int argc, char * argv[])
+{
+    std::string output;
+    bool ok = true;
+
+    for (int i = 1; i < argc && ok; i++)
+    {
+        std::string arg = argv[i];
+
+        if (i + 1 == argc)
+        {
+            ok = false;
+        }
+        else if (arg == "--output")
+        {
+            output = argv[++i];
+        }
+        else
+        {
+            ok = false;
+
+            for (const auto & option : options)
+            {
+                if (arg == option.first)
+                {
+                    *option.second = std::atoi(argv[++i]);
+                    ok = *option.second > 0;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Usage: " << argv[0];
+
+        for (const auto & option : options)
+        {
+            std::cerr << " [" << option.first << " N]";
+        }
+
+        std::cerr << " [--output file]" << std::endl;
+        std::cerr << "All values must be positive integers" << std::endl;
+        return false;
+    }
+
+    if (!output.empty())
+    {
+        file.open(output.c_str());
+
+        if (!file)
+        {
+            std::cerr << "Unable to open " << output << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+std::ostream & Arguments::output()
+{
+    return file.is_open() ? file : std::cout;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter::JsonWriter(std::ostream & _out)
+    : out(_out)
+{}
+
+// -----------------------------------------------------------------------------
+
+void JsonWriter::key(const char * key)
+{
+    if (!first.empty())
+    {
+        out << (first.back() ? "\n" : ",\n");
+        first.back() = false;
+    }
+
+    out << std::string(2 * first.size(), ' ');
+
+    if (key != 0 && !inArray.empty() && !inArray.back())
+    {
+        out << "\"" << key << "\": ";
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::beginObject(const char * _key)
+{
+    key(_key);
+    out << "{";
+    first.push_back(true);
+    inArray.push_back(false);
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::endObject()
+{
+    first.pop_back();
+    inArray.pop_back();
+    out << "\n" << std::string(2 * first.size(), ' ') << "}";
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::beginArray(const char * _key)
+{
+    key(_key);
+    out << "[";
+    first.push_back(true);
+    inArray.push_back(true);
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::endArray()
+{
+    first.pop_back();
+    inArray.pop_back();
+    out << "\n" << std::string(2 * first.size(), ' ') << "]";
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::value(const char * _key, double value)
+{
+    key(_key);
+    out << value;
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::value(const char * _key, int value)
+{
+    key(_key);
+    out << value;
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::value(const char * _key, bool value)
+{
+    key(_key);
+    out << (value ? "true" : "false");
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::value(const char * _key, const char * value)
+{
+    key(_key);
+    out << "\"" << value << "\"";
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::value(const char * _key, const Measure & m)
+{
+    key(_key);
+    out << "{\"ns\": " << m.ns << ", \"allocs\": " << m.allocs << "}";
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::beginBenchmark(const char * name)
+{
+    beginObject();
+    value("benchmark", name);
+    value("allocationCounter", allocationCounter());
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
+
+JsonWriter & JsonWriter::endBenchmark(bool ok)
+{
+    value("ok", ok);
+    endObject();
+    out << std::endl;
+    return *this;
+}
+
+// -----------------------------------------------------------------------------
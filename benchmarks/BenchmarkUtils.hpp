@@ -0,0 +1,147 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __BENCHMARK_UTILS_HPP__
+#define __BENCHMARK_UTILS_HPP__
+
+#include <chrono>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * @brief Helpers shared by all benchmarks: heap allocation counting, timing, command line
+ * parsing and JSON output.
+ *
+ * Results are printed as JSON so that they can be tracked across releases.
+ */
+namespace bench
+{
+
+/**
+ * @brief Number of heap allocations performed so far by this process.
+ *
+ * On glibc, malloc, calloc, realloc and the aligned variants are intercepted, hence
+ * allocations made by Eigen, KDL and plugins loaded at runtime are counted as well as
+ * those made through operator new. Elsewhere, only operator new is counted.
+ */
+long allocations();
+
+//! Name of the allocation functions being counted, either "malloc" or "operator new".
+const char * allocationCounter();
+
+typedef std::chrono::steady_clock Clock;
+
+//! Mean time and heap allocations per call.
+struct Measure
+{
+    double ns;
+    double allocs;
+};
+
+/**
+ * @brief Time a callable and count its heap allocations.
+ *
+ * @param iterations Number of calls, must be positive.
+ * @param call Invoked with the iteration index.
+ */
+template <typename Call>
+Measure measure(int iterations, Call call)
+{
+    long allocationsBefore = allocations();
+    Clock::time_point start = Clock::now();
+
+    for (int i = 0; i < iterations; i++)
+    {
+        call(i);
+    }
+
+    Clock::time_point end = Clock::now();
+    long allocationsAfter = allocations();
+
+    Measure m;
+    m.ns = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    m.allocs = static_cast<double>(allocationsAfter - allocationsBefore) / iterations;
+    return m;
+}
+
+/**
+ * @brief Command line parser for positive integer options plus `--output file`.
+ */
+class Arguments
+{
+public:
+
+    //! Register an option, the current value of the variable is its default.
+    void add(const std::string & option, int * value);
+
+    /**
+     * @brief Parse the command line, print usage on failure.
+     *
+     * @return False on unknown options or non-positive values, or if the output file
+     * cannot be opened.
+     */
+    bool parse(int argc, char * argv[]);
+
+    //! Either the requested output file or stdout.
+    std::ostream & output();
+
+private:
+
+    std::vector< std::pair<std::string, int *> > options;
+    std::ofstream file;
+};
+
+/**
+ * @brief Minimal streaming JSON writer, separators and indentation handled internally.
+ *
+ * Keys are ignored when writing array elements.
+ */
+class JsonWriter
+{
+public:
+
+    explicit JsonWriter(std::ostream & out);
+
+    JsonWriter & beginObject(const char * key = 0);
+    JsonWriter & endObject();
+
+    JsonWriter & beginArray(const char * key = 0);
+    JsonWriter & endArray();
+
+    JsonWriter & value(const char * key, double value);
+    JsonWriter & value(const char * key, int value);
+    JsonWriter & value(const char * key, bool value);
+    JsonWriter & value(const char * key, const char * value);
+
+    //! Write a @ref Measure as {"ns": ..., "allocs": ...}.
+    JsonWriter & value(const char * key, const Measure & m);
+
+    /**
+     * @brief Open the top-level object and write the common header.
+     *
+     * @param name Benchmark name.
+     */
+    JsonWriter & beginBenchmark(const char * name);
+
+    //! Write the final status and close the top-level object.
+    JsonWriter & endBenchmark(bool ok);
+
+private:
+
+    void key(const char * key);
+
+    std::ostream & out;
+    std::vector<bool> first;   // one entry per open scope
+    std::vector<bool> inArray; // one entry per open scope
+};
+
+} // namespace bench
+
+} // namespace roboticslab
+
+#endif // __BENCHMARK_UTILS_HPP__
@@ -0,0 +1,159 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchCartesianControlBatchInv benchCartesianControlBatchInv
+ *
+ * @brief Measures N sequential [inv] RPC round trips against one batched [inv] call
+ * through roboticslab::CartesianControlClient and roboticslab::CartesianControlServer.
+ *
+ * Both devices run in this process and talk over local YARP ports (local mode, no name
+ * server needed). The server wraps roboticslab::BasicCartesianControl on a simulated
+ * single-link mechanism, so that the solver cost is small next to the RPC overhead.
+ *
+ * Usage:
+ *
+\verbatim
+benchCartesianControlBatchInv [--iterations N] [--maxBatch N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per batch of poses, allocations are mean heap allocations
+ * per batch (client and server sides alike).
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
+#include <yarp/os/Value.h>
+#include <yarp/dev/PolyDriver.h>
+
+#include "BenchmarkUtils.hpp"
+#include "ICartesianControl.h"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const char * SERVER_PREFIX = "/benchCartesianControlBatchInv/server";
+    const char * CLIENT_PREFIX = "/benchCartesianControlBatchInv/client";
+
+    bool openServer(yarp::dev::PolyDriver & serverDevice)
+    {
+        yarp::os::Property serverOptions {
+            {"device", yarp::os::Value("CartesianControlServer")},
+            {"subdevice", yarp::os::Value("BasicCartesianControl")},
+            {"name", yarp::os::Value(SERVER_PREFIX)},
+            {"fkPeriod", yarp::os::Value(0)},
+            {"robot", yarp::os::Value("fakeMotionControl")},
+            {"solver", yarp::os::Value("KdlSolver")},
+            {"numLinks", yarp::os::Value(1)}
+        };
+
+        serverOptions.addGroup("link_0").put("A", yarp::os::Value(1));
+        serverOptions.put("mins", yarp::os::Value::makeList("-180.0"));
+        serverOptions.put("maxs", yarp::os::Value::makeList("180.0"));
+        serverOptions.put("maxvels", yarp::os::Value::makeList("100.0"));
+
+        return serverDevice.open(serverOptions);
+    }
+
+    bool openClient(yarp::dev::PolyDriver & clientDevice)
+    {
+        yarp::os::Property clientOptions {
+            {"device", yarp::os::Value("CartesianControlClient")},
+            {"cartesianLocal", yarp::os::Value(CLIENT_PREFIX)},
+            {"cartesianRemote", yarp::os::Value(SERVER_PREFIX)}
+        };
+
+        return clientDevice.open(clientOptions);
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 200;
+    int maxBatch = 256;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+    args.add("maxBatch", &maxBatch);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    yarp::os::Network::setLocalMode(true);
+    yarp::os::Network yarp;
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("CartesianControlBatchInv");
+    json.value("iterations", iterations);
+
+    yarp::dev::PolyDriver serverDevice, clientDevice;
+    ICartesianControl * iCartesianControl = NULL;
+
+    if (!openServer(serverDevice) || !openClient(clientDevice) || !clientDevice.view(iCartesianControl))
+    {
+        json.value("error", "unable to open CartesianControlServer and CartesianControlClient");
+        json.endBenchmark(false);
+        return 1;
+    }
+
+    json.beginArray("results");
+
+    bool ok = true;
+
+    for (int n = 1; n <= maxBatch; n *= 4)
+    {
+        //-- Reachable poses around the single revolute joint.
+        std::vector<std::vector<double>> xds(n, std::vector<double>(6, 0.0));
+
+        for (int k = 0; k < n; k++)
+        {
+            double theta = 0.5 * std::sin(0.37 * k);
+            xds[k][0] = std::cos(theta);
+            xds[k][1] = std::sin(theta);
+            xds[k][5] = theta;
+        }
+
+        std::vector<double> q;
+        std::vector<std::vector<double>> qs;
+        bool sequentialOk = true, batchedOk = true;
+
+        Measure sequential = measure(iterations, [&](int)
+        {
+            for (int k = 0; k < n; k++)
+            {
+                sequentialOk &= iCartesianControl->inv(xds[k], q);
+            }
+        });
+
+        Measure batched = measure(iterations, [&](int)
+        {
+            batchedOk &= iCartesianControl->inv(xds, qs);
+        });
+
+        json.beginObject();
+        json.value("poses", n);
+        json.value("sequential", sequential);
+        json.value("batched", batched);
+        json.value("speedup", sequential.ns / batched.ns);
+        json.value("ok", sequentialOk && batchedOk);
+        json.endObject();
+
+        ok &= sequentialOk && batchedOk;
+    }
+
+    json.endArray();
+    json.endBenchmark(ok);
+
+    clientDevice.close();
+    serverDevice.close();
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchChainIkSolverPos_ID benchChainIkSolverPos_ID
+ *
+ * @brief Compares the Jacobian transpose step of roboticslab::KdlSolver's "id" IK solver against
+ * its damped least-squares variant (idStep dls) on the chains used by testKdlSolver and
+ * testKdlSolverFromFile (one planar link and TEO's left arm).
+ *
+ * Each solver is called repeatedly on its own output, starting from a perturbed pose, until the
+ * pose error drops below a tolerance. Usage:
+ *
+\verbatim
+benchChainIkSolverPos_ID [--targets N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per iteration, allocations are mean heap allocations per iteration,
+ * converged is the fraction of targets reached within the iteration budget, iterations is the mean
+ * number of iterations of converged runs and rate is the geometric mean of the ratio between
+ * consecutive pose errors (lower is faster).
+ */
+
+#include <cmath>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
+#include "BenchmarkUtils.hpp"
+#include "ChainIkSolverPos_ID.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int MAX_ITERATIONS = 200;
+    const double TOLERANCE = 1e-6;
+
+    struct Convergence
+    {
+        Measure cost; // per iteration
+        double converged;
+        double iterations;
+        double rate;
+    };
+
+    double deg(double value)
+    {
+        return value * KDL::deg2rad;
+    }
+
+    //-- testKdlSolver
+    KDL::Chain makePlanar()
+    {
+        KDL::Chain chain;
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame()));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(1.0, 0.0, 0.0, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame()));
+        return chain;
+    }
+
+    //-- testKdlSolverFromFile
+    KDL::Chain makeTeoLeftArm()
+    {
+        KDL::Chain chain;
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Rotation(0, -1, 0, 0, 0, 1, -1, 0, 0), KDL::Vector(0, 0.34692, 0.4967))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.0, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.0, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.32901, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(-90), 0.0, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.202, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.187496, deg(90), 0.0, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame()));
+        return chain;
+    }
+
+    double poseError(KDL::ChainFkSolverPos & fkSolver, const KDL::JntArray & q, const KDL::Frame & target)
+    {
+        KDL::Frame H;
+        fkSolver.JntToCart(q, H);
+        KDL::Twist diff = KDL::diff(H, target);
+        return std::sqrt(KDL::dot(diff.vel, diff.vel) + KDL::dot(diff.rot, diff.rot));
+    }
+
+    //-- Iterate until convergence from perturbed poses; targets and seeds are deterministic.
+    Convergence converge(const KDL::Chain & chain, const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+                         int targets, double perturbation, bool damped, bool & ok)
+    {
+        const int n = chain.getNrOfJoints();
+
+        KDL::ChainFkSolverPos_recursive fkSolver(chain);
+        ChainIkSolverPos_ID ikSolver(chain, qMin, qMax, fkSolver);
+
+        if (damped)
+        {
+            ok &= ikSolver.setAdaptiveDamping(0.1, 0.001);
+        }
+
+        KDL::JntArray qTarget(n), q(n), qNext(n);
+        KDL::Frame target;
+
+        long totalIterations = 0, convergedIterations = 0, convergedCount = 0, rateCount = 0;
+        double ns = 0.0, allocs = 0.0, logRate = 0.0;
+
+        for (int k = 0; k < targets; k++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                double mid = 0.5 * (qMin(i) + qMax(i));
+                double half = 0.5 * (qMax(i) - qMin(i));
+                qTarget(i) = mid + 0.8 * half * std::sin(0.37 * k + 1.3 * i);
+                q(i) = qTarget(i) + perturbation * std::cos(0.71 * k + 0.9 * i);
+            }
+
+            fkSolver.JntToCart(qTarget, target);
+            double error = poseError(fkSolver, q, target);
+
+            for (int it = 0; it < MAX_ITERATIONS && error > TOLERANCE; it++)
+            {
+                Measure step = measure(1, [&](int)
+                {
+                    ok &= ikSolver.CartToJnt(q, target, qNext) >= 0;
+                });
+
+                ns += step.ns;
+                allocs += step.allocs;
+                totalIterations++;
+
+                q = qNext;
+                double nextError = poseError(fkSolver, q, target);
+
+                if (error > 0.0 && nextError > 0.0)
+                {
+                    logRate += std::log(nextError / error);
+                    rateCount++;
+                }
+
+                error = nextError;
+
+                if (error <= TOLERANCE)
+                {
+                    convergedIterations += it + 1;
+                    convergedCount++;
+                }
+            }
+        }
+
+        Convergence m;
+        m.cost.ns = totalIterations != 0 ? ns / totalIterations : 0.0;
+        m.cost.allocs = totalIterations != 0 ? allocs / totalIterations : 0.0;
+        m.converged = static_cast<double>(convergedCount) / targets;
+        m.iterations = convergedCount != 0 ? static_cast<double>(convergedIterations) / convergedCount : 0.0;
+        m.rate = rateCount != 0 ? std::exp(logRate / rateCount) : 0.0;
+        return m;
+    }
+
+    void writeConvergence(JsonWriter & json, const char * name, const Convergence & m)
+    {
+        json.beginObject(name);
+        json.value("ns", m.cost.ns);
+        json.value("allocs", m.cost.allocs);
+        json.value("converged", m.converged);
+        json.value("iterations", m.iterations);
+        json.value("rate", m.rate);
+        json.endObject();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int targets = 1000;
+
+    Arguments args;
+    args.add("targets", &targets);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    bool ok = true;
+
+    const KDL::Chain planar = makePlanar();
+    KDL::JntArray planarMin(1), planarMax(1);
+    planarMin(0) = deg(-180);
+    planarMax(0) = deg(180);
+
+    const KDL::Chain arm = makeTeoLeftArm();
+    KDL::JntArray armMin(6), armMax(6);
+    const double mins[] = {-98.1, -75.5, -80.1, -99.6, -80.4, -115.1};
+    const double maxs[] = {106.0, 22.4, 57.0, 98.4, 99.6, 44.7};
+
+    for (int i = 0; i < 6; i++)
+    {
+        armMin(i) = deg(mins[i]);
+        armMax(i) = deg(maxs[i]);
+    }
+
+    Convergence planarTranspose = converge(planar, planarMin, planarMax, targets, deg(10), false, ok);
+    Convergence planarDls = converge(planar, planarMin, planarMax, targets, deg(10), true, ok);
+    Convergence armTranspose = converge(arm, armMin, armMax, targets, deg(10), false, ok);
+    Convergence armDls = converge(arm, armMin, armMax, targets, deg(10), true, ok);
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("ChainIkSolverPos_ID");
+    json.value("targets", targets);
+    json.value("maxIterations", MAX_ITERATIONS);
+    json.value("tolerance", TOLERANCE);
+    json.beginObject("results");
+    writeConvergence(json, "planar_transpose", planarTranspose);
+    writeConvergence(json, "planar_dls", planarDls);
+    writeConvergence(json, "teo_arm_transpose", armTranspose);
+    writeConvergence(json, "teo_arm_dls", armDls);
+    json.endObject();
+    json.endBenchmark(ok);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,226 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchChainIkSolverPos_MultiStart benchChainIkSolverPos_MultiStart
+ *
+ * @brief Compares single-seed numerical IK as used by roboticslab::KdlSolver (ik nrjl, ik lma)
+ * against its multi-start mode (seeds, workers) on TEO's left arm, from initial guesses drawn
+ * at random within joint limits, i.e. often far from the solution.
+ *
+ * Usage:
+ *
+\verbatim
+benchChainIkSolverPos_MultiStart [--targets N] [--seeds N] [--workers N] [--output results.json]
+\endverbatim
+ *
+ * success is the fraction of targets solved within joint limits, times are the mean and 95th
+ * percentile latency per call in microseconds (successful or not), allocs is the mean number of
+ * heap allocations per call.
+ */
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainiksolverpos_lma.hpp>
+#include <kdl/chainiksolverpos_nr_jl.hpp>
+#include <kdl/chainiksolvervel_pinv.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
+#include <Eigen/Core>
+
+#include "BenchmarkUtils.hpp"
+#include "ChainIkSolverPos_MultiStart.hpp"
+#include "WorkerPool.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int MAX_ITERATIONS = 1000;
+    const double EPS = 1e-9;
+
+    struct Latency
+    {
+        double success;
+        double meanUs;
+        double p95Us;
+        double allocs;
+    };
+
+    double deg(double value)
+    {
+        return value * KDL::deg2rad;
+    }
+
+    //-- testKdlSolverFromFile
+    KDL::Chain makeTeoLeftArm()
+    {
+        KDL::Chain chain;
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Rotation(0, -1, 0, 0, 0, 1, -1, 0, 0), KDL::Vector(0, 0.34692, 0.4967))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.0, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.0, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.32901, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(-90), 0.0, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.0, deg(90), 0.202, 0.0)));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame::DH(0.187496, deg(90), 0.0, deg(90))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::None), KDL::Frame()));
+        return chain;
+    }
+
+    bool withinLimits(const KDL::JntArray & q, const KDL::JntArray & qMin, const KDL::JntArray & qMax)
+    {
+        for (int i = 0; i < q.rows(); i++)
+        {
+            if (q(i) < qMin(i) || q(i) > qMax(i))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    Latency solve(KDL::ChainIkSolverPos & solver, const std::vector<KDL::Frame> & targets, const std::vector<KDL::JntArray> & guesses,
+                  const KDL::JntArray & qMin, const KDL::JntArray & qMax)
+    {
+        std::vector<double> latencies;
+        KDL::JntArray q(qMin.rows());
+        int successes = 0;
+
+        Latency m;
+        m.meanUs = 0.0;
+        m.allocs = 0.0;
+
+        for (int k = 0; k < targets.size(); k++)
+        {
+            int ret = 0;
+
+            Measure call = measure(1, [&](int)
+            {
+                ret = solver.CartToJnt(guesses[k], targets[k], q);
+            });
+
+            latencies.push_back(call.ns / 1000.0);
+            m.meanUs += call.ns / 1000.0 / targets.size();
+            m.allocs += call.allocs / targets.size();
+
+            if (ret >= 0 && withinLimits(q, qMin, qMax))
+            {
+                successes++;
+            }
+        }
+
+        m.success = static_cast<double>(successes) / targets.size();
+
+        std::sort(latencies.begin(), latencies.end());
+        m.p95Us = latencies[static_cast<int>(0.95 * (latencies.size() - 1))];
+        return m;
+    }
+
+    void writeLatency(JsonWriter & json, const char * name, const Latency & m)
+    {
+        json.beginObject(name);
+        json.value("success", m.success);
+        json.value("meanUs", m.meanUs);
+        json.value("p95Us", m.p95Us);
+        json.value("allocs", m.allocs);
+        json.endObject();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int numTargets = 500;
+    int seeds = 4;
+    int workers = 3;
+
+    Arguments args;
+    args.add("targets", &numTargets);
+    args.add("seeds", &seeds);
+    args.add("workers", &workers);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    const KDL::Chain chain = makeTeoLeftArm();
+    const int n = chain.getNrOfJoints();
+
+    KDL::JntArray qMin(n), qMax(n);
+    const double mins[] = {-98.1, -75.5, -80.1, -99.6, -80.4, -115.1};
+    const double maxs[] = {106.0, 22.4, 57.0, 98.4, 99.6, 44.7};
+
+    for (int i = 0; i < n; i++)
+    {
+        qMin(i) = deg(mins[i]);
+        qMax(i) = deg(maxs[i]);
+    }
+
+    //-- Reachable targets and unrelated guesses, both deterministic.
+    KDL::ChainFkSolverPos_recursive fkSolver(chain);
+    std::mt19937 randomEngine(42);
+    std::vector<KDL::Frame> targets(numTargets);
+    std::vector<KDL::JntArray> guesses(numTargets, KDL::JntArray(n));
+    KDL::JntArray q(n);
+
+    for (int k = 0; k < numTargets; k++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            q(i) = std::uniform_real_distribution<double>(qMin(i), qMax(i))(randomEngine);
+            guesses[k](i) = std::uniform_real_distribution<double>(qMin(i), qMax(i))(randomEngine);
+        }
+
+        fkSolver.JntToCart(q, targets[k]);
+    }
+
+    Eigen::Matrix<double, 6, 1> L;
+    L << 1, 1, 1, 0.1, 0.1, 0.1;
+
+    KDL::ChainIkSolverVel_pinv ikVelSolver(chain);
+    KDL::ChainIkSolverPos_NR_JL nrjl(chain, qMin, qMax, fkSolver, ikVelSolver, MAX_ITERATIONS, EPS);
+    KDL::ChainIkSolverPos_LMA lma(chain, L);
+
+    WorkerPool serialPool(0);
+    WorkerPool parallelPool(std::min(workers, seeds - 1));
+
+    ChainIkSolverPos_MultiStart * nrjlSerial = ChainIkSolverPos_MultiStart::createNRJL(chain, qMin, qMax, seeds, MAX_ITERATIONS, EPS, serialPool, NULL);
+    ChainIkSolverPos_MultiStart * nrjlParallel = ChainIkSolverPos_MultiStart::createNRJL(chain, qMin, qMax, seeds, MAX_ITERATIONS, EPS, parallelPool, NULL);
+    ChainIkSolverPos_MultiStart * lmaParallel = ChainIkSolverPos_MultiStart::createLMA(chain, qMin, qMax, L, seeds, 500, 1e-5, parallelPool);
+
+    Latency nrjlSingle = solve(nrjl, targets, guesses, qMin, qMax);
+    Latency nrjlMultiSerial = solve(*nrjlSerial, targets, guesses, qMin, qMax);
+    Latency nrjlMultiParallel = solve(*nrjlParallel, targets, guesses, qMin, qMax);
+    Latency lmaSingle = solve(lma, targets, guesses, qMin, qMax);
+    Latency lmaMultiParallel = solve(*lmaParallel, targets, guesses, qMin, qMax);
+
+    delete nrjlSerial;
+    delete nrjlParallel;
+    delete lmaParallel;
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("ChainIkSolverPos_MultiStart");
+    json.value("targets", numTargets);
+    json.value("seeds", seeds);
+    json.value("workers", parallelPool.getNumWorkers());
+    json.beginObject("results");
+    writeLatency(json, "nrjl_single", nrjlSingle);
+    writeLatency(json, "nrjl_multi_serial", nrjlMultiSerial);
+    writeLatency(json, "nrjl_multi_parallel", nrjlMultiParallel);
+    writeLatency(json, "lma_single", lmaSingle);
+    writeLatency(json, "lma_multi_parallel", lmaMultiParallel);
+    json.endObject();
+    json.endBenchmark(true);
+
+    return 0;
+}
@@ -0,0 +1,191 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchDampedLeastSquares benchDampedLeastSquares
+ *
+ * @brief Compares the weighted damped least-squares differential IK used by roboticslab::KdlSolver
+ * (ikVel dls) against KDL's pseudoinverse and weighted solvers on a 7-DOF arm, half of the
+ * configurations sampled close to the stretched-elbow singularity.
+ *
+ * Usage:
+ *
+\verbatim
+benchDampedLeastSquares [--iterations N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call, allocations are mean heap allocations per call,
+ * maxJointVel is the largest joint velocity norm commanded for a unit Cartesian velocity
+ * and maxTaskError the largest norm of J * qdot - xdot, both across all configurations.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainiksolvervel_pinv.hpp>
+#include <kdl/chainiksolvervel_wdls.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
+#include <Eigen/Core>
+
+#include "BenchmarkUtils.hpp"
+#include "ChainIkSolverVel_DLS.hpp"
+#include "DampedLeastSquares.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int CONFIGURATIONS = 1000;
+
+    struct Quality
+    {
+        double maxJointVel;
+        double maxTaskError;
+    };
+
+    KDL::Chain makeArm()
+    {
+        KDL::Chain chain;
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame()));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotX), KDL::Frame()));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame(KDL::Vector(0.0, 0.0, -0.32))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame()));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotZ), KDL::Frame(KDL::Vector(0.0, 0.0, -0.28))));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotY), KDL::Frame()));
+        chain.addSegment(KDL::Segment(KDL::Joint(KDL::Joint::RotX), KDL::Frame(KDL::Vector(0.0, 0.0, -0.1))));
+        return chain;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    const KDL::Chain chain = makeArm();
+    const int n = chain.getNrOfJoints();
+
+    KDL::ChainIkSolverVel_pinv pinvSolver(chain);
+    KDL::ChainIkSolverVel_wdls wdlsSolver(chain);
+    wdlsSolver.setLambda(0.1);
+
+    DampedLeastSquares dls(1, n);
+    dls.setDamping(0.1, 0.05);
+    ChainIkSolverVel_DLS dlsSolver(chain, dls);
+
+    //-- Deterministic pseudo-random joint states and unit twists, odd ones with a stretched elbow.
+    std::vector<KDL::JntArray> qs(CONFIGURATIONS, KDL::JntArray(n));
+    std::vector<KDL::Twist> twists(CONFIGURATIONS);
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            qs[k](i) = std::sin(0.37 * k + 1.3 * i) * KDL::PI / 2;
+        }
+
+        if (k % 2 == 1)
+        {
+            qs[k](3) = 1e-4 * std::sin(0.11 * k);
+        }
+
+        for (int i = 0; i < 6; i++)
+        {
+            twists[k][i] = std::cos(0.53 * k + 0.9 * i);
+        }
+
+        double norm = std::sqrt(KDL::dot(twists[k].vel, twists[k].vel) + KDL::dot(twists[k].rot, twists[k].rot));
+        twists[k] = twists[k] / norm;
+    }
+
+    KDL::JntArray qdot(n);
+    bool ok = true;
+
+    Measure pinv = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= pinvSolver.CartToJnt(qs[k], twists[k], qdot) >= 0;
+    });
+
+    Measure wdls = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= wdlsSolver.CartToJnt(qs[k], twists[k], qdot) >= 0;
+    });
+
+    Measure damped = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= dlsSolver.CartToJnt(qs[k], twists[k], qdot) >= 0;
+    });
+
+    //-- Quality over all configurations, outside of timed sections.
+    KDL::ChainJntToJacSolver jacSolver(chain);
+    KDL::Jacobian jac(n);
+    Eigen::VectorXd xdot(6);
+
+    auto assess = [&](KDL::ChainIkSolverVel & solver)
+    {
+        Quality q = {0.0, 0.0};
+
+        for (int k = 0; k < CONFIGURATIONS; k++)
+        {
+            ok &= solver.CartToJnt(qs[k], twists[k], qdot) >= 0;
+            ok &= jacSolver.JntToJac(qs[k], jac) >= 0;
+
+            for (int i = 0; i < 6; i++)
+            {
+                xdot(i) = twists[k][i];
+            }
+
+            q.maxJointVel = std::max(q.maxJointVel, qdot.data.norm());
+            q.maxTaskError = std::max(q.maxTaskError, (jac.data * qdot.data - xdot).norm());
+        }
+
+        return q;
+    };
+
+    const Quality qualities[] = {assess(pinvSolver), assess(wdlsSolver), assess(dlsSolver)};
+    const char * names[] = {"kdl_pinv", "kdl_wdls", "dls"};
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("DampedLeastSquares");
+    json.value("iterations", iterations);
+    json.value("joints", n);
+    json.beginObject("results");
+    json.value(names[0], pinv);
+    json.value(names[1], wdls);
+    json.value(names[2], damped);
+    json.endObject();
+    json.beginObject("quality");
+
+    for (int i = 0; i < 3; i++)
+    {
+        json.beginObject(names[i]);
+        json.value("maxJointVel", qualities[i].maxJointVel);
+        json.value("maxTaskError", qualities[i].maxTaskError);
+        json.endObject();
+    }
+
+    json.endObject();
+    json.endBenchmark(ok);
+
+    return ok ? 0 : 1;
+}
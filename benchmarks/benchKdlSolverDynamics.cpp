@@ -0,0 +1,178 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchKdlSolverDynamics benchKdlSolverDynamics
+ *
+ * @brief Measures throughput and heap allocations of the dynamics queries exposed by
+ * roboticslab::KdlSolver (inverse dynamics, mass matrix, Coriolis torques, forward dynamics)
+ * on synthetic serial chains of increasing number of joints.
+ *
+ * Usage:
+ *
+\verbatim
+benchKdlSolverDynamics [--iterations N] [--maxJoints N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call, allocations are mean heap allocations per call.
+ * Output vectors are reused across calls, as in a control loop.
+ */
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <yarp/os/Property.h>
+#include <yarp/dev/PolyDriver.h>
+
+#include "BenchmarkUtils.hpp"
+#include "ICartesianSolver.h"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int CONFIGURATIONS = 1000;
+
+    //-- Spatial arm of alternating twists, links of decreasing mass.
+    std::string makeSolverOptions(int joints)
+    {
+        std::ostringstream ss;
+        ss << "(device KdlSolver) (gravity (0 0 -9.81)) (numLinks " << joints << ")";
+
+        for (int i = 0; i < joints; i++)
+        {
+            ss << " (link_" << i << " (A 0.2) (D " << (i % 3 == 0 ? 0.1 : 0.0) << ") (alpha " << (i % 2 == 0 ? 90 : -90) << ")";
+            ss << " (mass " << 2.0 - 1.5 * i / joints << ") (cog -0.1 0 0.01) (inertia 0.01 0.02 0.015))";
+        }
+
+        ss << " (mins (";
+
+        for (int i = 0; i < joints; i++)
+        {
+            ss << " -180";
+        }
+
+        ss << ")) (maxs (";
+
+        for (int i = 0; i < joints; i++)
+        {
+            ss << " 180";
+        }
+
+        ss << "))";
+        return ss.str();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+    int maxJoints = 12;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+    args.add("maxJoints", &maxJoints);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    JsonWriter json(args.output());
+    int failures = 0;
+
+    json.beginBenchmark("KdlSolverDynamics");
+    json.value("iterations", iterations);
+    json.beginArray("results");
+
+    for (int n = 2; n <= maxJoints; n += 2)
+    {
+        json.beginObject();
+        json.value("joints", n);
+
+        yarp::os::Property solverOptions;
+        solverOptions.fromString(makeSolverOptions(n));
+
+        yarp::dev::PolyDriver solverDevice;
+        ICartesianSolver * iCartesianSolver = NULL;
+
+        if (!solverDevice.open(solverOptions) || !solverDevice.view(iCartesianSolver))
+        {
+            json.value("error", "unable to open KdlSolver");
+            json.endObject();
+            failures++;
+            continue;
+        }
+
+        //-- Deterministic pseudo-random joint states (degrees and N·m).
+        std::vector<std::vector<double>> qs(CONFIGURATIONS, std::vector<double>(n));
+        std::vector<std::vector<double>> qdots(CONFIGURATIONS, std::vector<double>(n));
+        std::vector<std::vector<double>> qdotdots(CONFIGURATIONS, std::vector<double>(n));
+        std::vector<std::vector<double>> ts(CONFIGURATIONS, std::vector<double>(n));
+
+        for (int k = 0; k < CONFIGURATIONS; k++)
+        {
+            for (int i = 0; i < n; i++)
+            {
+                qs[k][i] = 180.0 * std::sin(0.37 * k + 1.3 * i);
+                qdots[k][i] = 60.0 * std::cos(0.11 * k + 0.7 * i);
+                qdotdots[k][i] = 60.0 * std::sin(0.05 * k - 0.9 * i);
+                ts[k][i] = std::cos(0.23 * k - 0.4 * i);
+            }
+        }
+
+        const std::vector<std::vector<double>> fexts;
+        std::vector<double> t(n), M(n * n), c(n), qdotdot(n);
+        bool ok = true;
+
+        Measure invDyn = measure(iterations, [&](int i)
+        {
+            const int k = i % CONFIGURATIONS;
+            ok &= iCartesianSolver->invDyn(qs[k], qdots[k], qdotdots[k], fexts, t);
+        });
+
+        Measure invDynGravity = measure(iterations, [&](int i)
+        {
+            const int k = i % CONFIGURATIONS;
+            ok &= iCartesianSolver->invDyn(qs[k].data(), NULL, NULL, NULL, 0, t.data());
+        });
+
+        Measure massMatrix = measure(iterations, [&](int i)
+        {
+            const int k = i % CONFIGURATIONS;
+            ok &= iCartesianSolver->massMatrix(qs[k], M);
+        });
+
+        Measure coriolisTorques = measure(iterations, [&](int i)
+        {
+            const int k = i % CONFIGURATIONS;
+            ok &= iCartesianSolver->coriolisTorques(qs[k], qdots[k], c);
+        });
+
+        Measure fwdDyn = measure(iterations, [&](int i)
+        {
+            const int k = i % CONFIGURATIONS;
+            ok &= iCartesianSolver->fwdDyn(qs[k], qdots[k], ts[k], qdotdot);
+        });
+
+        solverDevice.close();
+
+        json.value("invDyn", invDyn);
+        json.value("invDynGravity", invDynGravity);
+        json.value("massMatrix", massMatrix);
+        json.value("coriolisTorques", coriolisTorques);
+        json.value("fwdDyn", fwdDyn);
+        json.value("ok", ok);
+        json.endObject();
+
+        failures += !ok;
+    }
+
+    json.endArray();
+    json.endBenchmark(failures == 0);
+
+    return failures == 0 ? 0 : 1;
+}
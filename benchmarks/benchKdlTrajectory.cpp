@@ -0,0 +1,185 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchKdlTrajectory benchKdlTrajectory
+ *
+ * @brief Measures creation cost, evaluation throughput and heap allocations of
+ * roboticslab::KdlTrajectory for each path type and velocity profile.
+ *
+ * Usage:
+ *
+\verbatim
+benchKdlTrajectory [--iterations N] [--createIterations N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call, allocations are mean heap allocations per call.
+ */
+
+#include <vector>
+
+#include "BenchmarkUtils.hpp"
+#include "KdlTrajectory.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const double MAX_VEL = 0.2;
+    const double MAX_ACC = 0.05;
+    const double BLEND_RADIUS = 0.1;
+    const double SAMPLING_PERIOD = 0.01;
+    const int PATH_SAMPLES = 50;
+
+    struct Case
+    {
+        const char * pathName;
+        int path;
+        const char * profileName;
+        int profile;
+        bool sampled;
+    };
+
+    bool build(KdlTrajectory & trajectory, const Case & c)
+    {
+        std::vector<double> x1(6, 0.0), x2(6, 0.0), x3(6, 0.0);
+        x1[0] = 1.0;
+        x2[0] = 2.0;
+        x3[0] = 2.0;
+        x3[1] = 1.0;
+
+        if (c.sampled && !trajectory.setSamplingPeriod(SAMPLING_PERIOD))
+        {
+            return false;
+        }
+
+        if (!trajectory.setMaxVelocity(MAX_VEL) || !trajectory.setMaxAcceleration(MAX_ACC)
+                || !trajectory.addWaypoint(x1) || !trajectory.addWaypoint(x2))
+        {
+            return false;
+        }
+
+        if (c.path == ICartesianTrajectory::ROUNDED_COMPOSITE
+                && (!trajectory.setBlendRadius(BLEND_RADIUS) || !trajectory.addWaypoint(x3)))
+        {
+            return false;
+        }
+
+        if (!trajectory.configurePath(c.path))
+        {
+            return false;
+        }
+
+        if (c.profile == ICartesianTrajectory::TIME_OPTIMAL)
+        {
+            std::vector< std::vector<double> > positions, tangents;
+
+            if (!trajectory.getPathSamples(PATH_SAMPLES, positions, tangents)
+                    || !trajectory.setPathSpeedLimits(std::vector<double>(PATH_SAMPLES, MAX_VEL)))
+            {
+                return false;
+            }
+        }
+
+        return trajectory.configureVelocityProfile(c.profile) && trajectory.create();
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+    int createIterations = 1000;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+    args.add("createIterations", &createIterations);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    const Case cases[] = {
+        {"line", ICartesianTrajectory::LINE, "trapezoidal", ICartesianTrajectory::TRAPEZOIDAL, false},
+        {"line", ICartesianTrajectory::LINE, "trapezoidal", ICartesianTrajectory::TRAPEZOIDAL, true},
+        {"line", ICartesianTrajectory::LINE, "rectangular", ICartesianTrajectory::RECTANGULAR, false},
+        {"line", ICartesianTrajectory::LINE, "time_optimal", ICartesianTrajectory::TIME_OPTIMAL, false},
+        {"rounded_composite", ICartesianTrajectory::ROUNDED_COMPOSITE, "trapezoidal", ICartesianTrajectory::TRAPEZOIDAL, false},
+        {"rounded_composite", ICartesianTrajectory::ROUNDED_COMPOSITE, "rectangular", ICartesianTrajectory::RECTANGULAR, false},
+        {"rounded_composite", ICartesianTrajectory::ROUNDED_COMPOSITE, "time_optimal", ICartesianTrajectory::TIME_OPTIMAL, false}
+    };
+
+    JsonWriter json(args.output());
+    int failures = 0;
+
+    json.beginBenchmark("KdlTrajectory");
+    json.value("iterations", iterations);
+    json.value("createIterations", createIterations);
+    json.beginArray("results");
+
+    for (const Case & c : cases)
+    {
+        json.beginObject();
+        json.value("path", c.pathName);
+        json.value("profile", c.profileName);
+        json.value("sampled", c.sampled);
+
+        bool ok = true;
+
+        //-- Whole setup, from construction to create()
+        Measure create = measure(createIterations, [&c, &ok](int)
+        {
+            KdlTrajectory trajectory;
+            ok &= build(trajectory, c);
+        });
+
+        KdlTrajectory trajectory;
+        double duration = 0.0;
+
+        if (!ok || !build(trajectory, c) || !trajectory.getDuration(&duration))
+        {
+            json.value("error", "create failed");
+            json.endObject();
+            failures++;
+            continue;
+        }
+
+        //-- Query times spread over the whole trajectory, buffers reused as in a control loop
+        const int steps = 1000;
+        const double dt = duration / steps;
+
+        std::vector<double> position, velocity;
+        double state[ICartesianTrajectory::STATE_SIZE];
+
+        Measure getPosition = measure(iterations, [&](int i)
+        {
+            ok &= trajectory.getPosition((i % steps) * dt, position);
+        });
+
+        Measure getVelocity = measure(iterations, [&](int i)
+        {
+            ok &= trajectory.getVelocity((i % steps) * dt, velocity);
+        });
+
+        Measure getState = measure(iterations, [&](int i)
+        {
+            ok &= trajectory.getState((i % steps) * dt, state);
+        });
+
+        json.value("duration", duration);
+        json.value("create", create);
+        json.value("getPosition", getPosition);
+        json.value("getVelocity", getVelocity);
+        json.value("getState", getState);
+        json.value("ok", ok);
+        json.endObject();
+
+        failures += !ok;
+    }
+
+    json.endArray();
+    json.endBenchmark(failures == 0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,209 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchKdlTrajectorySampling benchKdlTrajectorySampling
+ *
+ * @brief Measures accuracy, memory and evaluation cost of pre-sampled
+ * roboticslab::KdlTrajectory instances against on-demand evaluation, for a range of
+ * sampling periods.
+ *
+ * Errors are the maximum deviation from the on-demand trajectory over a query grid
+ * that does not align with the samples: translation (meters), orientation (angle of
+ * the relative rotation, radians) and velocity (largest component). One of the paths
+ * rotates across pi, where scaled axis-angle vectors flip sign.
+ *
+ * Usage:
+ *
+\verbatim
+benchKdlTrajectorySampling [--iterations N] [--queries N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call, allocations are mean heap allocations per call,
+ * memory is the size of the pre-sampled table in bytes.
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+#include <kdl/frames.hpp>
+
+#include "BenchmarkUtils.hpp"
+#include "KdlTrajectory.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const double MAX_VEL = 0.2;
+    const double MAX_ACC = 0.05;
+    const double BLEND_RADIUS = 0.1;
+
+    struct Case
+    {
+        const char * name;
+        int path;
+        std::vector< std::vector<double> > waypoints;
+    };
+
+    bool build(KdlTrajectory & trajectory, const Case & c, double samplingPeriod)
+    {
+        if (!trajectory.setSamplingPeriod(samplingPeriod)
+                || !trajectory.setMaxVelocity(MAX_VEL) || !trajectory.setMaxAcceleration(MAX_ACC)
+                || !trajectory.setBlendRadius(BLEND_RADIUS))
+        {
+            return false;
+        }
+
+        for (const std::vector<double> & waypoint : c.waypoints)
+        {
+            if (!trajectory.addWaypoint(waypoint))
+            {
+                return false;
+            }
+        }
+
+        return trajectory.configurePath(c.path)
+                && trajectory.configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL)
+                && trajectory.create();
+    }
+
+    KDL::Rotation toRotation(const double * rotVector)
+    {
+        KDL::Vector axis(rotVector[0], rotVector[1], rotVector[2]);
+        return KDL::Rotation::Rot(axis, axis.Norm());
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+    int queries = 10000;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+    args.add("queries", &queries);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    std::vector<double> x1(6, 0.0), x2(6, 0.0), x3(6, 0.0);
+    x1[0] = 1.0;
+    x2[0] = 2.0;
+    x3[0] = 2.0;
+    x3[1] = 1.0;
+
+    std::vector<double> xPi1(x1), xPi2(x2);
+    xPi1[5] = 170 * M_PI / 180;
+    xPi2[5] = -170 * M_PI / 180;
+
+    const Case cases[] = {
+        {"line", ICartesianTrajectory::LINE, {x1, x2}},
+        {"line_across_pi", ICartesianTrajectory::LINE, {xPi1, xPi2}},
+        {"rounded_composite", ICartesianTrajectory::ROUNDED_COMPOSITE, {x1, x2, x3}}
+    };
+
+    const double periods[] = {0.001, 0.002, 0.005, 0.01, 0.02, 0.05};
+
+    JsonWriter json(args.output());
+    int failures = 0;
+
+    json.beginBenchmark("KdlTrajectorySampling");
+    json.value("iterations", iterations);
+    json.value("queries", queries);
+    json.beginArray("results");
+
+    for (const Case & c : cases)
+    {
+        KdlTrajectory reference;
+        double duration = 0.0;
+
+        if (!build(reference, c, 0.0) || !reference.getDuration(&duration))
+        {
+            json.beginObject();
+            json.value("path", c.name);
+            json.value("error", "create failed");
+            json.endObject();
+            failures++;
+            continue;
+        }
+
+        const int steps = 1000;
+        double state[ICartesianTrajectory::STATE_SIZE];
+        bool referenceOk = true;
+
+        Measure referenceGetState = measure(iterations, [&](int i)
+        {
+            referenceOk &= reference.getState((i % steps) * duration / steps, state);
+        });
+
+        for (double period : periods)
+        {
+            json.beginObject();
+            json.value("path", c.name);
+            json.value("samplingPeriod", period);
+
+            KdlTrajectory sampled;
+
+            if (!build(sampled, c, period))
+            {
+                json.value("error", "create failed");
+                json.endObject();
+                failures++;
+                continue;
+            }
+
+            bool ok = referenceOk;
+            double positionError = 0.0, orientationError = 0.0, velocityError = 0.0;
+            double expected[ICartesianTrajectory::STATE_SIZE], actual[ICartesianTrajectory::STATE_SIZE];
+
+            //-- Irrational stride, queries fall anywhere between samples
+            for (int i = 0; i <= queries; i++)
+            {
+                double t = std::fmod(i * duration * M_SQRT2 / queries, duration);
+
+                ok &= reference.getState(t, expected);
+                ok &= sampled.getState(t, actual);
+
+                for (int j = 0; j < 3; j++)
+                {
+                    positionError = std::max(positionError, std::abs(actual[j] - expected[j]));
+                }
+
+                KDL::Rotation relative = toRotation(expected + 3).Inverse() * toRotation(actual + 3);
+                orientationError = std::max(orientationError, relative.GetRot().Norm());
+
+                for (int j = 6; j < 12; j++)
+                {
+                    velocityError = std::max(velocityError, std::abs(actual[j] - expected[j]));
+                }
+            }
+
+            Measure getState = measure(iterations, [&](int i)
+            {
+                ok &= sampled.getState((i % steps) * duration / steps, state);
+            });
+
+            json.value("duration", duration);
+            json.value("memory", static_cast<int>(sampled.getSampleTableBytes()));
+            json.value("positionError", positionError);
+            json.value("orientationError", orientationError);
+            json.value("velocityError", velocityError);
+            json.value("getState", getState);
+            json.value("referenceGetState", referenceGetState);
+            json.value("ok", ok);
+            json.endObject();
+
+            failures += !ok;
+        }
+    }
+
+    json.endArray();
+    json.endBenchmark(failures == 0);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchScrewTheoryDynamics benchScrewTheoryDynamics
+ *
+ * @brief Compares roboticslab::ScrewTheoryDynamics against KDL's recursive Newton-Euler
+ * solver on TEO's (UC3M) right arm with synthetic link inertias.
+ *
+ * Usage:
+ *
+\verbatim
+benchScrewTheoryDynamics [--iterations N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call, allocations are mean heap allocations per call,
+ * maxError holds the largest torque deviation from KDL (N·m).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainidsolver_recursive_newton_euler.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/rigidbodyinertia.hpp>
+#include <kdl/rotationalinertia.hpp>
+#include <kdl/segment.hpp>
+
+#include "BenchmarkUtils.hpp"
+#include "ProductOfExponentials.hpp"
+#include "ScrewTheoryDynamics.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int CONFIGURATIONS = 1000;
+
+    KDL::Chain makeTeoRightArm()
+    {
+        const KDL::Joint rotZ(KDL::Joint::RotZ);
+        const double dh[][4] = {
+            {    0, -KDL::PI / 2,        0,            0},
+            {    0, -KDL::PI / 2,        0, -KDL::PI / 2},
+            {    0, -KDL::PI / 2, -0.32901, -KDL::PI / 2},
+            {    0,  KDL::PI / 2,        0,            0},
+            {    0, -KDL::PI / 2,   -0.215,            0},
+            {-0.09,            0,        0, -KDL::PI / 2}
+        };
+
+        KDL::Chain chain;
+
+        for (int i = 0; i < 6; i++)
+        {
+            KDL::RotationalInertia I_c(0.01 + 0.002 * i, 0.02, 0.015, 0.0, 0.001, 0.0);
+            KDL::RigidBodyInertia inertia(2.0 - 0.25 * i, KDL::Vector(0.01 * i, 0.0, 0.05), I_c);
+            chain.addSegment(KDL::Segment(rotZ, KDL::Frame::DH(dh[i][0], dh[i][1], dh[i][2], dh[i][3]), inertia));
+        }
+
+        return chain;
+    }
+
+    double maxDeviation(const KDL::JntArray & lhs, const KDL::JntArray & rhs)
+    {
+        double deviation = 0.0;
+
+        for (int i = 0; i < lhs.rows(); i++)
+        {
+            deviation = std::max(deviation, std::abs(lhs(i) - rhs(i)));
+        }
+
+        return deviation;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    const KDL::Vector gravity(0, 0, -9.81);
+    const KDL::Chain chain = makeTeoRightArm();
+    const int n = chain.getNrOfJoints();
+
+    KDL::ChainFkSolverPos_recursive fkSolver(chain);
+    KDL::ChainJntToJacSolver jacSolver(chain);
+    KDL::ChainIdSolver_RNE idSolver(chain, gravity);
+    ScrewTheoryDynamics dynamics(PoeExpression::fromChain(chain), gravity);
+
+    //-- Deterministic pseudo-random joint states.
+    std::vector<KDL::JntArray> qs(CONFIGURATIONS, KDL::JntArray(n));
+    std::vector<KDL::JntArray> qdots(CONFIGURATIONS, KDL::JntArray(n));
+    std::vector<KDL::JntArray> qdotdots(CONFIGURATIONS, KDL::JntArray(n));
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            qs[k](i) = std::sin(0.37 * k + 1.3 * i) * KDL::PI;
+            qdots[k](i) = std::cos(0.11 * k + 0.7 * i);
+            qdotdots[k](i) = std::sin(0.05 * k - 0.9 * i);
+        }
+    }
+
+    const KDL::JntArray zeros(n);
+    const KDL::Wrenches fextsKdl(chain.getNrOfSegments(), KDL::Wrench::Zero());
+    const std::vector<KDL::Wrench> fextsSt;
+
+    KDL::JntArray tKdl(n), tSt(n);
+    KDL::Frame H;
+    KDL::Jacobian J(n);
+    bool ok = true;
+
+    //-- Full inverse dynamics.
+    Measure kdlRne = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= idSolver.CartToJnt(qs[k], qdots[k], qdotdots[k], fextsKdl, tKdl) == KDL::SolverI::E_NOERROR;
+    });
+
+    Measure stRne = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= dynamics.inverseDynamics(qs[k], qdots[k], qdotdots[k], fextsSt, tSt);
+    });
+
+    //-- Gravity torques only.
+    Measure kdlGravity = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= idSolver.CartToJnt(qs[k], zeros, zeros, fextsKdl, tKdl) == KDL::SolverI::E_NOERROR;
+    });
+
+    Measure stGravity = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= dynamics.gravityTorques(qs[k], tSt);
+    });
+
+    //-- Pose, Jacobian and gravity torques, as needed by a torque controller.
+    Measure kdlCombined = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= fkSolver.JntToCart(qs[k], H) == KDL::SolverI::E_NOERROR
+                && jacSolver.JntToJac(qs[k], J) == KDL::SolverI::E_NOERROR
+                && idSolver.CartToJnt(qs[k], zeros, zeros, fextsKdl, tKdl) == KDL::SolverI::E_NOERROR;
+    });
+
+    Measure stCombined = measure(iterations, [&](int i)
+    {
+        const int k = i % CONFIGURATIONS;
+        ok &= dynamics.gravityTorques(qs[k], tSt, &H, &J);
+    });
+
+    //-- Accuracy over all configurations, outside of timed sections.
+    double rneError = 0.0, gravityError = 0.0;
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        ok &= idSolver.CartToJnt(qs[k], qdots[k], qdotdots[k], fextsKdl, tKdl) == KDL::SolverI::E_NOERROR;
+        ok &= dynamics.inverseDynamics(qs[k], qdots[k], qdotdots[k], fextsSt, tSt);
+        rneError = std::max(rneError, maxDeviation(tSt, tKdl));
+
+        ok &= idSolver.CartToJnt(qs[k], zeros, zeros, fextsKdl, tKdl) == KDL::SolverI::E_NOERROR;
+        ok &= dynamics.gravityTorques(qs[k], tSt);
+        gravityError = std::max(gravityError, maxDeviation(tSt, tKdl));
+    }
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("ScrewTheoryDynamics");
+    json.value("iterations", iterations);
+    json.value("joints", n);
+    json.beginObject("results");
+    json.value("kdl_rne", kdlRne);
+    json.value("st_rne", stRne);
+    json.value("kdl_gravity", kdlGravity);
+    json.value("st_gravity", stGravity);
+    json.value("kdl_fk_jac_gravity", kdlCombined);
+    json.value("st_fk_jac_gravity", stCombined);
+    json.endObject();
+    json.beginObject("maxError");
+    json.value("st_rne", rneError);
+    json.value("st_gravity", gravityError);
+    json.endObject();
+    json.endBenchmark(ok);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+/**
+ * @ingroup kinematics-dynamics-programs
+ * \defgroup benchTreeFkSolverPos benchTreeFkSolverPos
+ *
+ * @brief Compares the single-sweep endpoint FK used by roboticslab::KdlTreeSolver against
+ * KDL's recursive tree FK solver on a synthetic humanoid tree (two-joint waist, two-joint
+ * neck, 7-DOF arms, 6-DOF legs, fixed sensor frames; 30 joints, 5 endpoints).
+ *
+ * Usage:
+ *
+\verbatim
+benchTreeFkSolverPos [--iterations N] [--output results.json]
+\endverbatim
+ *
+ * Times are mean nanoseconds per call (all endpoints), allocations are mean heap allocations
+ * per call, maxError holds the largest deviation from KDL across translation and rotation
+ * components of KDL::diff (meters and radians).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+#include <kdl/tree.hpp>
+#include <kdl/treefksolverpos_recursive.hpp>
+
+#include "BenchmarkUtils.hpp"
+#include "TreeFkSolverPos_Endpoints.hpp"
+
+using namespace roboticslab;
+using namespace roboticslab::bench;
+
+namespace
+{
+    const int CONFIGURATIONS = 1000;
+
+    //-- Same layout as KdlTreeSolver: fixed H0, moving links, fixed HN named after the chain.
+    KDL::Chain makeChain(const std::string & name, const KDL::Frame & H0, const std::vector<KDL::Joint::JointType> & axes, double length)
+    {
+        KDL::Chain chain;
+        chain.addSegment(KDL::Segment(name + "_H0", KDL::Joint(KDL::Joint::None), H0));
+
+        for (int i = 0; i < axes.size(); i++)
+        {
+            KDL::Frame H(KDL::Vector(0.01 * (i % 2), 0.0, i % 3 == 2 ? -length : 0.0));
+            chain.addSegment(KDL::Segment(name + "_link_" + std::to_string(i), KDL::Joint(axes[i]), H));
+        }
+
+        chain.addSegment(KDL::Segment(name, KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.0, 0.0, -0.1))));
+        return chain;
+    }
+
+    KDL::Tree makeHumanoid(std::vector<std::string> & endpoints)
+    {
+        using T = KDL::Joint::JointType;
+
+        const std::vector<T> waist = {KDL::Joint::RotZ, KDL::Joint::RotY};
+        const std::vector<T> neck = {KDL::Joint::RotZ, KDL::Joint::RotY};
+        const std::vector<T> arm = {KDL::Joint::RotY, KDL::Joint::RotX, KDL::Joint::RotZ, KDL::Joint::RotY, KDL::Joint::RotZ, KDL::Joint::RotY, KDL::Joint::RotX};
+        const std::vector<T> leg = {KDL::Joint::RotZ, KDL::Joint::RotX, KDL::Joint::RotY, KDL::Joint::RotY, KDL::Joint::RotY, KDL::Joint::RotX};
+
+        KDL::Tree tree("root");
+
+        tree.addChain(makeChain("waist", KDL::Frame(KDL::Vector(0.0, 0.0, 0.2)), waist, 0.0), "root");
+        tree.addChain(makeChain("head", KDL::Frame(KDL::Vector(0.0, 0.0, 0.45)), neck, 0.0), "waist");
+        tree.addChain(makeChain("leftArm", KDL::Frame(KDL::Vector(0.0, 0.3, 0.35)), arm, 0.3), "waist");
+        tree.addChain(makeChain("rightArm", KDL::Frame(KDL::Vector(0.0, -0.3, 0.35)), arm, 0.3), "waist");
+        tree.addChain(makeChain("leftLeg", KDL::Frame(KDL::Vector(0.0, 0.15, 0.0)), leg, 0.4), "root");
+        tree.addChain(makeChain("rightLeg", KDL::Frame(KDL::Vector(0.0, -0.15, 0.0)), leg, 0.4), "root");
+
+        //-- Sensor frames that no endpoint depends on.
+        tree.addSegment(KDL::Segment("imu", KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.0, 0.0, 0.1))), "waist");
+        tree.addSegment(KDL::Segment("leftCamera", KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.1, 0.05, 0.0))), "head");
+        tree.addSegment(KDL::Segment("rightCamera", KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.1, -0.05, 0.0))), "head");
+        tree.addSegment(KDL::Segment("leftFoot_ft", KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.0, 0.0, -0.05))), "leftLeg");
+        tree.addSegment(KDL::Segment("rightFoot_ft", KDL::Joint(KDL::Joint::None), KDL::Frame(KDL::Vector(0.0, 0.0, -0.05))), "rightLeg");
+
+        endpoints = {"head", "leftArm", "rightArm", "leftLeg", "rightLeg"};
+        return tree;
+    }
+
+    double maxDeviation(const std::vector<KDL::Frame> & lhs, const std::vector<KDL::Frame> & rhs)
+    {
+        double deviation = 0.0;
+
+        for (int i = 0; i < lhs.size(); i++)
+        {
+            KDL::Twist diff = KDL::diff(lhs[i], rhs[i]);
+
+            for (int j = 0; j < 6; j++)
+            {
+                deviation = std::max(deviation, std::abs(diff[j]));
+            }
+        }
+
+        return deviation;
+    }
+}
+
+int main(int argc, char * argv[])
+{
+    int iterations = 100000;
+
+    Arguments args;
+    args.add("iterations", &iterations);
+
+    if (!args.parse(argc, argv))
+    {
+        return 1;
+    }
+
+    std::vector<std::string> endpoints;
+    const KDL::Tree tree = makeHumanoid(endpoints);
+    const int n = tree.getNrOfJoints();
+
+    KDL::TreeFkSolverPos_recursive recursiveSolver(tree);
+    TreeFkSolverPos_Endpoints sweepSolver(tree, endpoints);
+
+    //-- Deterministic pseudo-random joint states.
+    std::vector<KDL::JntArray> qs(CONFIGURATIONS, KDL::JntArray(n));
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            qs[k](i) = std::sin(0.37 * k + 1.3 * i) * KDL::PI;
+        }
+    }
+
+    std::vector<KDL::Frame> framesRecursive(endpoints.size()), framesSweep(endpoints.size());
+    bool ok = true;
+
+    //-- One root-to-tip traversal per endpoint, as KdlTreeSolver used to do.
+    Measure recursive = measure(iterations, [&](int j)
+    {
+        const int k = j % CONFIGURATIONS;
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ok &= recursiveSolver.JntToCart(qs[k], framesRecursive[i], endpoints[i]) >= 0;
+        }
+    });
+
+    //-- All endpoints in one sweep.
+    Measure sweep = measure(iterations, [&](int j)
+    {
+        const int k = j % CONFIGURATIONS;
+        ok &= sweepSolver.JntToCart(qs[k], framesSweep) >= 0;
+    });
+
+    //-- Per-endpoint queries on the same joint values, as issued by KDL's tree IK solvers.
+    Measure sweepPerEndpoint = measure(iterations, [&](int j)
+    {
+        const int k = j % CONFIGURATIONS;
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ok &= sweepSolver.JntToCart(qs[k], framesSweep[i], endpoints[i]) >= 0;
+        }
+    });
+
+    //-- Accuracy over all configurations, outside of timed sections.
+    double sweepError = 0.0, sweepPerEndpointError = 0.0;
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ok &= recursiveSolver.JntToCart(qs[k], framesRecursive[i], endpoints[i]) >= 0;
+        }
+
+        ok &= sweepSolver.JntToCart(qs[k], framesSweep) >= 0;
+        sweepError = std::max(sweepError, maxDeviation(framesSweep, framesRecursive));
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ok &= sweepSolver.JntToCart(qs[(k + 1) % CONFIGURATIONS], framesSweep[i], endpoints[i]) >= 0;
+            ok &= sweepSolver.JntToCart(qs[k], framesSweep[i], endpoints[i]) >= 0;
+        }
+
+        sweepPerEndpointError = std::max(sweepPerEndpointError, maxDeviation(framesSweep, framesRecursive));
+    }
+
+    JsonWriter json(args.output());
+
+    json.beginBenchmark("TreeFkSolverPos");
+    json.value("iterations", iterations);
+    json.value("joints", n);
+    json.value("segments", static_cast<int>(tree.getNrOfSegments()));
+    json.value("endpoints", static_cast<int>(endpoints.size()));
+    json.beginObject("results");
+    json.value("kdl_recursive", recursive);
+    json.value("sweep", sweep);
+    json.value("sweep_per_endpoint", sweepPerEndpoint);
+    json.endObject();
+    json.beginObject("maxError");
+    json.value("sweep", sweepError);
+    json.value("sweep_per_endpoint", sweepPerEndpointError);
+    json.endObject();
+    json.endBenchmark(ok);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,315 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "DampedLeastSquares.hpp"
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#include <yarp/os/Bottle.h>
+#include <yarp/os/LogStream.h>
+#include <yarp/os/Searchable.h>
+#include <yarp/os/Value.h>
+
+using namespace roboticslab;
+
+namespace
+{
+    bool parseVectorFromBottle(const yarp::os::Bottle & b, int size, Eigen::VectorXd & v)
+    {
+        if (b.size() != size)
+        {
+            yWarning("Wrong bottle size (expected: %d, was: %zu)", size, b.size());
+            return false;
+        }
+
+        v.resize(size);
+
+        for (int i = 0; i < b.size(); i++)
+        {
+            v(i) = b.get(i).asFloat64();
+        }
+
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+DampedLeastSquares::DampedLeastSquares(int _numTasks, int _numJoints)
+    : numTasks(_numTasks),
+      numJoints(_numJoints),
+      taskWeightsSqrt(Eigen::VectorXd::Ones(6 * _numTasks)),
+      jointWeightsInv(Eigen::VectorXd::Ones(_numJoints)),
+      numWeightedRows(6 * _numTasks),
+      lambdaMax(0.0),
+      epsilon(0.0),
+      lambda(0.0),
+      qMin(Eigen::VectorXd::Zero(_numJoints)),
+      qMax(Eigen::VectorXd::Zero(_numJoints)),
+      limitGain(0.0),
+      qRest(Eigen::VectorXd::Zero(_numJoints)),
+      postureGain(0.0),
+      Jw(6 * _numTasks, _numJoints),
+      JwWinv(6 * _numTasks, _numJoints),
+      G(6 * _numTasks, 6 * _numTasks),
+      eigenSolver(6 * _numTasks),
+      rowBuffer(6 * _numTasks),
+      rowBuffer2(6 * _numTasks),
+      rowBuffer3(6 * _numTasks),
+      jointBuffer(_numJoints),
+      jointBuffer2(_numJoints)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::setTaskWeights(const Eigen::VectorXd & weights)
+{
+    if (weights.size() != 6 && weights.size() != 6 * numTasks)
+    {
+        return false;
+    }
+
+    if ((weights.array() < 0.0).any())
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numTasks; i++)
+    {
+        taskWeightsSqrt.segment<6>(6 * i) = weights.segment<6>(weights.size() == 6 ? 0 : 6 * i).cwiseSqrt();
+    }
+
+    numWeightedRows = (taskWeightsSqrt.array() > 0.0).count();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::setJointWeights(const Eigen::VectorXd & weights)
+{
+    if (weights.size() != numJoints || (weights.array() <= 0.0).any())
+    {
+        return false;
+    }
+
+    jointWeightsInv = weights.cwiseInverse();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::setDamping(double _lambdaMax, double _epsilon)
+{
+    if (_lambdaMax < 0.0 || _epsilon < 0.0)
+    {
+        return false;
+    }
+
+    lambdaMax = _lambdaMax;
+    epsilon = _epsilon;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::setJointLimitAvoidance(const Eigen::VectorXd & _qMin, const Eigen::VectorXd & _qMax, double gain)
+{
+    if (_qMin.size() != numJoints || _qMax.size() != numJoints || gain < 0.0 || (_qMin.array() > _qMax.array()).any())
+    {
+        return false;
+    }
+
+    qMin = _qMin;
+    qMax = _qMax;
+    limitGain = gain;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::setPosture(const Eigen::VectorXd & _qRest, double gain)
+{
+    if (_qRest.size() != numJoints || gain < 0.0)
+    {
+        return false;
+    }
+
+    qRest = _qRest;
+    postureGain = gain;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void DampedLeastSquares::applyDampedInverse(const Eigen::VectorXd & in, Eigen::VectorXd & out)
+{
+    // out = Wq^-1 * Jw^T * (Jw * Wq^-1 * Jw^T + lambda^2 * I)^-1 * in
+    const Eigen::VectorXd & s = eigenSolver.eigenvalues(); // ascending
+    const Eigen::MatrixXd & V = eigenSolver.eigenvectors();
+
+    const double lambda2 = lambda * lambda;
+    const double tolerance = std::numeric_limits<double>::epsilon() * s.size() * std::max(1.0, s(s.size() - 1));
+
+    rowBuffer2.noalias() = V.transpose() * in;
+
+    for (int i = 0; i < s.size(); i++)
+    {
+        // truncate directions the Jacobian cannot span at all
+        double den = std::max(s(i), 0.0) + lambda2;
+        rowBuffer2(i) = den > tolerance ? rowBuffer2(i) / den : 0.0;
+    }
+
+    rowBuffer3.noalias() = V * rowBuffer2;
+    out.noalias() = JwWinv.transpose() * rowBuffer3;
+}
+
+// -----------------------------------------------------------------------------
+
+bool DampedLeastSquares::solve(const Eigen::Ref<const Eigen::MatrixXd> & J, const Eigen::VectorXd & xdot, const Eigen::VectorXd & q, Eigen::VectorXd & qdot)
+{
+    const int rows = 6 * numTasks;
+
+    if (J.rows() != rows || J.cols() != numJoints || xdot.size() != rows || q.size() != numJoints || qdot.size() != numJoints)
+    {
+        return false;
+    }
+
+    if (rows == 0)
+    {
+        qdot.setZero();
+        return true;
+    }
+
+    for (int i = 0; i < numTasks; i++)
+    {
+        Jw.middleRows<6>(6 * i) = taskWeightsSqrt.segment<6>(6 * i).asDiagonal() * J.middleRows<6>(6 * i);
+    }
+
+    JwWinv = Jw * jointWeightsInv.asDiagonal();
+    G.noalias() = JwWinv * Jw.transpose();
+
+    eigenSolver.compute(G);
+
+    if (eigenSolver.info() != Eigen::Success)
+    {
+        return false;
+    }
+
+    //-- Singular values beyond the rank of the weighted Jacobian are structurally zero, skip them.
+    const int rank = std::min(numWeightedRows, numJoints);
+    const double sigmaMin = rank != 0 ? std::sqrt(std::max(eigenSolver.eigenvalues()(rows - rank), 0.0)) : 0.0;
+
+    if (rank != 0 && sigmaMin < epsilon)
+    {
+        lambda = lambdaMax * std::sqrt(1.0 - (sigmaMin / epsilon) * (sigmaMin / epsilon));
+    }
+    else
+    {
+        lambda = 0.0;
+    }
+
+    //-- Primary task.
+    rowBuffer = taskWeightsSqrt.cwiseProduct(xdot);
+    applyDampedInverse(rowBuffer, qdot);
+
+    if (limitGain == 0.0 && postureGain == 0.0)
+    {
+        return true;
+    }
+
+    //-- Secondary objectives, in the weighted metric of the primary task.
+    for (int i = 0; i < numJoints; i++)
+    {
+        double z = postureGain * (qRest(i) - q(i));
+        double range = qMax(i) - qMin(i);
+
+        if (limitGain != 0.0 && range > 0.0)
+        {
+            z -= limitGain * 2.0 * (q(i) - 0.5 * (qMin(i) + qMax(i))) / (range * range);
+        }
+
+        jointBuffer(i) = jointWeightsInv(i) * z;
+    }
+
+    //-- Null-space projection: z - J# * J * z.
+    rowBuffer.noalias() = Jw * jointBuffer;
+    applyDampedInverse(rowBuffer, jointBuffer2);
+    qdot += jointBuffer - jointBuffer2;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::configureDampedLeastSquares(const yarp::os::Searchable & options, const Eigen::VectorXd & qMin,
+                                              const Eigen::VectorXd & qMax, DampedLeastSquares & dls)
+{
+    const int nrOfJoints = dls.getNumJoints();
+
+    double lambda = options.check("dlsLambda", yarp::os::Value(DEFAULT_DLS_LAMBDA), "DLS maximum damping factor").asFloat64();
+    double epsilon = options.check("dlsEpsilon", yarp::os::Value(DEFAULT_DLS_EPSILON), "DLS singular region width").asFloat64();
+
+    if (!dls.setDamping(lambda, epsilon))
+    {
+        yError("Illegal DLS damping (lambda: %f, epsilon: %f)", lambda, epsilon);
+        return false;
+    }
+
+    //-- Either 6 values shared by all tasks or 6 per task.
+    yarp::os::Bottle taskWeightsBottle(options.check("dlsTaskWeights", yarp::os::Value(DEFAULT_DLS_TASK_WEIGHTS),
+        "DLS task weights (bottle of 6 doubles, or 6 per task)").asString());
+
+    Eigen::VectorXd taskWeights;
+
+    if (!parseVectorFromBottle(taskWeightsBottle, taskWeightsBottle.size() == 6 ? 6 : 6 * dls.getNumTasks(), taskWeights)
+        || !dls.setTaskWeights(taskWeights))
+    {
+        yError() << "Unable to parse DLS task weights";
+        return false;
+    }
+
+    if (options.check("dlsJointWeights", "DLS joint weights (bottle of doubles, one per joint)"))
+    {
+        yarp::os::Bottle jointWeightsBottle(options.find("dlsJointWeights").asString());
+        Eigen::VectorXd jointWeights;
+
+        if (!parseVectorFromBottle(jointWeightsBottle, nrOfJoints, jointWeights) || !dls.setJointWeights(jointWeights))
+        {
+            yError() << "Unable to parse DLS joint weights";
+            return false;
+        }
+    }
+
+    double limitGain = options.check("dlsLimitGain", yarp::os::Value(DEFAULT_DLS_LIMIT_GAIN), "DLS joint limit avoidance gain").asFloat64();
+
+    if (limitGain != 0.0 && !dls.setJointLimitAvoidance(qMin, qMax, limitGain))
+    {
+        yError() << "Unable to configure DLS joint limit avoidance";
+        return false;
+    }
+
+    double postureGain = options.check("dlsPostureGain", yarp::os::Value(DEFAULT_DLS_POSTURE_GAIN), "DLS rest posture gain").asFloat64();
+
+    if (postureGain != 0.0)
+    {
+        yarp::os::Bottle postureBottle(options.check("dlsPosture", yarp::os::Value(""), "DLS rest posture (bottle of doubles, degrees)").asString());
+        Eigen::VectorXd posture;
+
+        if (!parseVectorFromBottle(postureBottle, nrOfJoints, posture))
+        {
+            yError() << "Unable to parse DLS rest posture";
+            return false;
+        }
+
+        if (!dls.setPosture(posture * M_PI / 180.0, postureGain))
+        {
+            yError() << "Unable to configure DLS rest posture";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,200 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __DAMPED_LEAST_SQUARES_HPP__
+#define __DAMPED_LEAST_SQUARES_HPP__
+
+#include <Eigen/Core>
+#include <Eigen/Eigenvalues>
+
+#define DEFAULT_DLS_LAMBDA 0.1
+#define DEFAULT_DLS_EPSILON 0.05
+#define DEFAULT_DLS_TASK_WEIGHTS "1 1 1 1 1 1"
+#define DEFAULT_DLS_LIMIT_GAIN 0.0
+#define DEFAULT_DLS_POSTURE_GAIN 0.0
+
+namespace yarp
+{
+    namespace os
+    {
+        class Searchable;
+    }
+}
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-libraries
+ * @defgroup DampedLeastSquaresLib
+ *
+ * @brief Contains roboticslab::DampedLeastSquares.
+ */
+
+/**
+ * @ingroup DampedLeastSquaresLib
+ * @brief Weighted, task-prioritized damped least-squares differential IK.
+ *
+ * The primary task is a stack of Cartesian velocities (six rows per task, in the
+ * same layout as KDL::Twist) solved in the weighted least-squares sense:
+ *
+ * @f[
+ * \dot{q}_1 = W_q^{-1} J_w^T \left( J_w W_q^{-1} J_w^T + \lambda^2 I \right)^{-1} W_x^{1/2} \dot{x}, \quad
+ * J_w = W_x^{1/2} J
+ * @f]
+ *
+ * where @f$ W_x @f$ and @f$ W_q @f$ are diagonal task and joint weights. The damping
+ * factor is zero away from singularities and grows up to @f$ \lambda_{max} @f$ as the
+ * smallest relevant singular value @f$ \sigma @f$ of the weighted Jacobian drops below
+ * @f$ \epsilon @f$, i.e. @f$ \lambda^2 = (1 - (\sigma / \epsilon)^2) \lambda_{max}^2 @f$.
+ *
+ * Secondary objectives (joint-limit avoidance and posture) are combined in a joint
+ * velocity @f$ z @f$ and projected onto the null space of the primary task, hence they
+ * only use the redundancy left by the latter:
+ *
+ * @f[
+ * \dot{q} = \dot{q}_1 + \left( I - J^{\#} J \right) z
+ * @f]
+ *
+ * All storage is allocated on construction, @ref solve does not allocate.
+ */
+class DampedLeastSquares
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param numTasks Number of Cartesian tasks, i.e. six rows each.
+     * @param numJoints Number of joints.
+     */
+    DampedLeastSquares(int numTasks, int numJoints);
+
+    //! Number of Cartesian tasks
+    int getNumTasks() const
+    { return numTasks; }
+
+    //! Number of joints
+    int getNumJoints() const
+    { return numJoints; }
+
+    /**
+     * @brief Set task weights
+     *
+     * @param weights Either six values applied to every task or one value per task row,
+     * all non-negative (default: ones). Rows weighted zero are ignored, also when looking
+     * for the smallest singular value.
+     *
+     * @return True on success, false on size mismatch or illegal values.
+     */
+    bool setTaskWeights(const Eigen::VectorXd & weights);
+
+    /**
+     * @brief Set joint weights, higher values mean less motion
+     *
+     * @param weights One positive value per joint (default: ones).
+     *
+     * @return True on success, false on size mismatch or illegal values.
+     */
+    bool setJointWeights(const Eigen::VectorXd & weights);
+
+    /**
+     * @brief Set singularity damping
+     *
+     * @param lambdaMax Damping factor at a singularity (default: 0, no damping).
+     * @param epsilon Width of the damped region, in terms of the smallest singular value.
+     *
+     * @return True on success, false on illegal values.
+     */
+    bool setDamping(double lambdaMax, double epsilon);
+
+    /**
+     * @brief Enable joint-limit avoidance as a secondary objective
+     *
+     * Descends the gradient of @f$ \sum_i ((q_i - \bar{q}_i) / (q_{max,i} - q_{min,i}))^2 @f$
+     * where @f$ \bar{q}_i @f$ is the middle of the joint range.
+     *
+     * @param qMin Minimum joint limits (radians or meters).
+     * @param qMax Maximum joint limits (radians or meters).
+     * @param gain Gain of the gradient, zero disables this objective.
+     *
+     * @return True on success, false on size mismatch or illegal values.
+     */
+    bool setJointLimitAvoidance(const Eigen::VectorXd & qMin, const Eigen::VectorXd & qMax, double gain);
+
+    /**
+     * @brief Enable a rest posture as a secondary objective
+     *
+     * @param qRest Rest posture (radians or meters).
+     * @param gain Proportional gain towards the rest posture, zero disables this objective.
+     *
+     * @return True on success, false on size mismatch or illegal values.
+     */
+    bool setPosture(const Eigen::VectorXd & qRest, double gain);
+
+    /**
+     * @brief Solve differential inverse kinematics
+     *
+     * @param J Stacked task Jacobians (6 * numTasks x numJoints), e.g. the data of a
+     * KDL::Jacobian, bound without a copy.
+     * @param xdot Stacked task velocities (6 * numTasks).
+     * @param q Current joint positions, needed by secondary objectives.
+     * @param qdot Output joint velocities (numJoints), must not alias inputs.
+     *
+     * @return True on success, false on size mismatch or numerical failure.
+     */
+    bool solve(const Eigen::Ref<const Eigen::MatrixXd> & J, const Eigen::VectorXd & xdot, const Eigen::VectorXd & q, Eigen::VectorXd & qdot);
+
+    //! Damping factor applied on the last call to @ref solve
+    double getDamping() const
+    { return lambda; }
+
+private:
+
+    void applyDampedInverse(const Eigen::VectorXd & in, Eigen::VectorXd & out);
+
+    int numTasks;
+    int numJoints;
+
+    Eigen::VectorXd taskWeightsSqrt;
+    Eigen::VectorXd jointWeightsInv;
+    int numWeightedRows;
+
+    double lambdaMax;
+    double epsilon;
+    double lambda;
+
+    Eigen::VectorXd qMin, qMax;
+    double limitGain;
+
+    Eigen::VectorXd qRest;
+    double postureGain;
+
+    // workspace
+    Eigen::MatrixXd Jw;      // weighted Jacobian
+    Eigen::MatrixXd JwWinv;  // weighted Jacobian times inverse joint weights
+    Eigen::MatrixXd G;       // JwWinv * Jw^T
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigenSolver;
+    Eigen::VectorXd rowBuffer, rowBuffer2, rowBuffer3;
+    Eigen::VectorXd jointBuffer, jointBuffer2;
+};
+
+/**
+ * @ingroup DampedLeastSquaresLib
+ * @brief Configure a @ref DampedLeastSquares solver from device options
+ *
+ * Parses dlsLambda, dlsEpsilon, dlsTaskWeights (six values, or six per task), dlsJointWeights
+ * (one per joint), dlsLimitGain, dlsPostureGain and dlsPosture (one per joint, degrees).
+ *
+ * @param options Device configuration.
+ * @param qMin Minimum joint limits (radians or meters), only read if dlsLimitGain is not zero.
+ * @param qMax Maximum joint limits (radians or meters), only read if dlsLimitGain is not zero.
+ * @param dls Solver to configure.
+ *
+ * @return True on success, false on malformed options or illegal values.
+ */
+bool configureDampedLeastSquares(const yarp::os::Searchable & options, const Eigen::VectorXd & qMin,
+                                 const Eigen::VectorXd & qMax, DampedLeastSquares & dls);
+
+} // namespace roboticslab
+
+#endif // __DAMPED_LEAST_SQUARES_HPP__
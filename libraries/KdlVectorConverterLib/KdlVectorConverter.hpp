@@ -68,6 +68,40 @@ KDL::Twist vectorToTwist(const std::vector<double> & xdot);
  */
 std::vector<double> twistToVector(const KDL::Twist & t);
 
+/**
+ * @brief Convert from a plain array to KDL::Frame
+ *
+ * @param x 6-element array with the same layout as in @ref vectorToFrame.
+ *
+ * @return Resulting KDL::Frame object.
+ */
+KDL::Frame arrayToFrame(const double * x);
+
+/**
+ * @brief Convert from KDL::Frame to a plain array
+ *
+ * @param f Input KDL::Frame object.
+ * @param x Output 6-element array with the same layout as in @ref frameToVector.
+ */
+void frameToArray(const KDL::Frame & f, double * x);
+
+/**
+ * @brief Convert from a plain array to KDL::Twist
+ *
+ * @param xdot 6-element array with the same layout as in @ref vectorToTwist.
+ *
+ * @return Resulting KDL::Twist object.
+ */
+KDL::Twist arrayToTwist(const double * xdot);
+
+/**
+ * @brief Convert from KDL::Twist to a plain array
+ *
+ * @param t Input KDL::Twist object.
+ * @param xdot Output 6-element array with the same layout as in @ref twistToVector.
+ */
+void twistToArray(const KDL::Twist & t, double * xdot);
+
 } // namespace KdlVectorConverter
 } // namespace roboticslab
 
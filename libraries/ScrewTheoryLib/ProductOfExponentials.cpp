@@ -58,6 +58,7 @@ void PoeExpression::append(const PoeExpression & poe, const KDL::Frame & H_new_o
     for (int i = 0; i < poe.size(); i++)
     {
         append(poe.exponentialAtJoint(i), H_new_old);
+        inertias.back() = H_new_old * poe.inertiaAtJoint(i);
     }
 
     H_S_T = H_new_old * poe.getTransform();
@@ -70,6 +71,7 @@ void PoeExpression::changeBaseFrame(const KDL::Frame & H_new_old)
     for (int i = 0; i < exps.size(); i++)
     {
         exps[i].changeBase(H_new_old);
+        inertias[i] = H_new_old * inertias[i];
     }
 
     H_S_T = H_new_old * H_S_T;
@@ -109,6 +111,7 @@ void PoeExpression::reverseSelf()
     }
 
     std::reverse(exps.begin(), exps.end());
+    inertias.assign(exps.size(), KDL::RigidBodyInertia::Zero());
 }
 
 // -----------------------------------------------------------------------------
@@ -118,6 +121,7 @@ PoeExpression PoeExpression::makeReverse() const
     PoeExpression poeReversed;
 
     poeReversed.exps.reserve(exps.size());
+    poeReversed.inertias.reserve(exps.size());
     poeReversed.H_S_T = H_S_T.Inverse();
 
     for (int i = 0; i < exps.size(); i++)
@@ -145,12 +149,14 @@ KDL::Chain PoeExpression::toChain() const
         KDL::Joint::JointType jointType = motionToJointType(exp.getMotionType());
         KDL::Joint joint(H_S_prev.Inverse() * exp.getOrigin(), exp.getAxis(), jointType);
 
+        // update position, keep orientation
+        KDL::Frame H_S_i(exp.getOrigin());
+
         // http://www.orocos.org/wiki/main-page/kdl-wiki/user-manual/kinematic-trees
-        KDL::Segment segment(joint, KDL::Frame(joint.JointOrigin()));
+        KDL::Segment segment(joint, KDL::Frame(joint.JointOrigin()), H_S_i.Inverse() * inertias[i]);
         chain.addSegment(segment);
 
-        // update position, keep orientation
-        H_S_prev = KDL::Frame(exp.getOrigin());
+        H_S_prev = H_S_i;
     }
 
     KDL::Frame H_N_T = H_S_prev.Inverse() * H_S_T;
@@ -168,6 +174,7 @@ PoeExpression PoeExpression::fromChain(const KDL::Chain & chain)
     KDL::Frame H_S_prev;
 
     poe.exps.reserve(chain.getNrOfJoints());
+    poe.inertias.reserve(chain.getNrOfJoints());
 
     for (int i = 0; i < chain.getNrOfSegments(); i++)
     {
@@ -183,6 +190,12 @@ PoeExpression PoeExpression::fromChain(const KDL::Chain & chain)
         }
 
         H_S_prev = H_S_prev * segment.pose(0);
+
+        // segment inertias are expressed in their tip frames, anything before the first joint is static
+        if (poe.size() != 0)
+        {
+            poe.inertias.back() = poe.inertias.back() + H_S_prev * segment.getInertia();
+        }
     }
 
     poe.H_S_T = H_S_prev;
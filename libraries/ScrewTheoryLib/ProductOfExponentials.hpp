@@ -8,6 +8,7 @@
 #include <kdl/chain.hpp>
 #include <kdl/frames.hpp>
 #include <kdl/jntarray.hpp>
+#include <kdl/rigidbodyinertia.hpp>
 
 #include "MatrixExponential.hpp"
 
@@ -20,7 +21,8 @@ namespace roboticslab
  * @brief Abstraction of a product of exponentials (POE) formula.
  *
  * This entity is comprised of a sequence of matrix exponentials and a transformation
- * between the base and the tool frame.
+ * between the base and the tool frame. Each term may carry the inertia of the link
+ * it moves (zero by default), which enables dynamics computations.
  *
  * @see MatrixExponential
  */
@@ -46,7 +48,7 @@ public:
      * base frame of the input POE term.
      */
     void append(const MatrixExponential & exp, const KDL::Frame & H_new_old = KDL::Frame::Identity())
-    { exps.push_back(exp.cloneWithBase(H_new_old)); }
+    { exps.push_back(exp.cloneWithBase(H_new_old)); inertias.push_back(KDL::RigidBodyInertia::Zero()); }
 
     /**
      * @brief Appends a POE to this formula
@@ -87,6 +89,27 @@ public:
     const MatrixExponential & exponentialAtJoint(int i) const
     { return exps.at(i); }
 
+    /**
+     * @brief Retrieves the inertia of the link moved by a term of the POE formula
+     *
+     * The link comprises all bodies rigidly attached between this term and the next one.
+     *
+     * @param i Zero-based index of the requested term.
+     *
+     * @return Spatial inertia expressed in the base frame, all joints at zero position.
+     */
+    const KDL::RigidBodyInertia & inertiaAtJoint(int i) const
+    { return inertias.at(i); }
+
+    /**
+     * @brief Assigns the inertia of the link moved by a term of the POE formula
+     *
+     * @param i Zero-based index of the target term.
+     * @param inertia Spatial inertia expressed in the base frame, all joints at zero position.
+     */
+    void setInertiaAtJoint(int i, const KDL::RigidBodyInertia & inertia)
+    { inertias.at(i) = inertia; }
+
     /**
      * @brief Refers the internal coordinates of this POE to a different base
      *
@@ -120,7 +143,8 @@ public:
      * @brief Inverts this POE formula
      *
      * The sequence of POE terms is reversed and the base and tool frames
-     * interchanged. Note that theta_i = -theta_(size-i)_reversed.
+     * interchanged. Note that theta_i = -theta_(size-i)_reversed. Link inertias
+     * are reset to zero.
      *
      * @see makeReverse
      */
@@ -130,7 +154,8 @@ public:
      * @brief Creates a new POE entity from the inverse of this POE formula
      *
      * The sequence of POE terms is reversed and the base and tool frames
-     * interchanged. Note that theta_i = -theta_(size-i)_reversed.
+     * interchanged. Note that theta_i = -theta_(size-i)_reversed. Link inertias
+     * are not copied.
      *
      * @return A reversed copy of this instance.
      *
@@ -161,6 +186,7 @@ public:
 private:
 
     std::vector<MatrixExponential> exps;
+    std::vector<KDL::RigidBodyInertia> inertias;
     KDL::Frame H_S_T;
 };
 
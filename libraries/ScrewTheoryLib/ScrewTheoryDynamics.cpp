@@ -0,0 +1,158 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ScrewTheoryDynamics.hpp"
+
+#include <kdl/rigidbodyinertia.hpp>
+
+#include <yarp/os/Log.h>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+namespace
+{
+    inline KDL::Twist screwAsTwist(const MatrixExponential & exp)
+    {
+        if (exp.getMotionType() == MatrixExponential::ROTATION)
+        {
+            // linear velocity of the point that coincides with the base origin
+            return KDL::Twist(exp.getOrigin() * exp.getAxis(), exp.getAxis());
+        }
+        else
+        {
+            return KDL::Twist(exp.getAxis(), KDL::Vector::Zero());
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ScrewTheoryDynamics::ScrewTheoryDynamics(const PoeExpression & _poe, const KDL::Vector & _gravity)
+    : poe(_poe),
+      gravity(_gravity),
+      screws(_poe.size()),
+      wrenches(_poe.size())
+{
+    homeScrews.reserve(poe.size());
+
+    for (int i = 0; i < poe.size(); i++)
+    {
+        homeScrews.push_back(screwAsTwist(poe.exponentialAtJoint(i)));
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryDynamics::checkSizes(const KDL::JntArray & q, const KDL::JntArray & torques, const KDL::Jacobian * J) const
+{
+    if (q.rows() != poe.size() || torques.rows() != poe.size())
+    {
+        yWarning("Size mismatch: %d (terms of PoE) != %d (joint array) or %d (torques)", poe.size(), q.rows(), torques.rows());
+        return false;
+    }
+
+    if (J != NULL && J->columns() != poe.size())
+    {
+        yWarning("Size mismatch: %d (terms of PoE) != %d (Jacobian columns)", poe.size(), J->columns());
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void ScrewTheoryDynamics::backwardPass(KDL::JntArray & torques, KDL::Jacobian * J) const
+{
+    KDL::Wrench W = KDL::Wrench::Zero();
+
+    for (int i = poe.size() - 1; i >= 0; i--)
+    {
+        W += wrenches[i];
+        torques(i) = KDL::dot(screws[i], W);
+
+        if (J != NULL)
+        {
+            J->setColumn(i, screws[i]);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryDynamics::inverseDynamics(const KDL::JntArray & q, const KDL::JntArray & qdot, const KDL::JntArray & qdotdot,
+        const std::vector<KDL::Wrench> & fexts, KDL::JntArray & torques, KDL::Frame * H, KDL::Jacobian * J)
+{
+    if (!checkSizes(q, torques, J) || qdot.rows() != poe.size() || qdotdot.rows() != poe.size()
+            || (!fexts.empty() && fexts.size() != poe.size()))
+    {
+        return false;
+    }
+
+    KDL::Frame H_S_i = KDL::Frame::Identity();
+    KDL::Twist v = KDL::Twist::Zero();
+    KDL::Twist a(-gravity, KDL::Vector::Zero());
+
+    //-- Forward pass: screws, spatial velocities and accelerations, link wrenches.
+    for (int i = 0; i < poe.size(); i++)
+    {
+        screws[i] = H_S_i * homeScrews[i];
+        H_S_i = H_S_i * poe.exponentialAtJoint(i).asFrame(q(i));
+
+        KDL::Twist vj = screws[i] * qdot(i);
+        v += vj;
+        a += screws[i] * qdotdot(i) + v * vj;
+
+        KDL::RigidBodyInertia I = H_S_i * poe.inertiaAtJoint(i);
+        wrenches[i] = I * a + v * (I * v);
+
+        if (!fexts.empty())
+        {
+            wrenches[i] -= H_S_i * fexts[i];
+        }
+    }
+
+    if (H != NULL)
+    {
+        *H = H_S_i * poe.getTransform();
+    }
+
+    backwardPass(torques, J);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ScrewTheoryDynamics::gravityTorques(const KDL::JntArray & q, KDL::JntArray & torques, KDL::Frame * H, KDL::Jacobian * J)
+{
+    if (!checkSizes(q, torques, J))
+    {
+        return false;
+    }
+
+    KDL::Frame H_S_i = KDL::Frame::Identity();
+
+    //-- Forward pass: screws and gravity wrenches, spatial velocities are null.
+    for (int i = 0; i < poe.size(); i++)
+    {
+        screws[i] = H_S_i * homeScrews[i];
+        H_S_i = H_S_i * poe.exponentialAtJoint(i).asFrame(q(i));
+
+        const KDL::RigidBodyInertia & I = poe.inertiaAtJoint(i);
+        KDL::Vector force = -I.getMass() * gravity;
+        wrenches[i] = KDL::Wrench(force, (H_S_i * I.getCOG()) * force);
+    }
+
+    if (H != NULL)
+    {
+        *H = H_S_i * poe.getTransform();
+    }
+
+    backwardPass(torques, J);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
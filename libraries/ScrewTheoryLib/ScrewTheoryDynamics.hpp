@@ -0,0 +1,102 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SCREW_THEORY_DYNAMICS_HPP__
+#define __SCREW_THEORY_DYNAMICS_HPP__
+
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+
+#include "ProductOfExponentials.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup ScrewTheoryLib
+ *
+ * @brief Recursive Newton-Euler inverse dynamics on a POE formula.
+ *
+ * All quantities are expressed in the base frame of the POE, hence joint screws are
+ * obtained from the very cumulative exponentials that forward kinematics need. The
+ * same pass may thus yield the tool pose and the spatial Jacobian at no extra cost.
+ * Link inertias are taken from @ref PoeExpression::inertiaAtJoint. Internal storage
+ * is allocated once on construction.
+ */
+class ScrewTheoryDynamics
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param poe Input POE formula with link inertias.
+     * @param gravity Gravity vector expressed in the base frame.
+     */
+    ScrewTheoryDynamics(const PoeExpression & poe, const KDL::Vector & gravity);
+
+    /**
+     * @brief Size of the underlying POE
+     *
+     * @return Number of joints.
+     */
+    int size() const
+    { return poe.size(); }
+
+    /**
+     * @brief Performs inverse dynamics
+     *
+     * @param q Input joint positions (radians or meters).
+     * @param qdot Input joint velocities.
+     * @param qdotdot Input joint accelerations.
+     * @param fexts External wrenches applied on each link, fixed to it and expressed in the
+     * base frame with all joints at zero position (same as link inertias). An empty vector
+     * stands for no external forces.
+     * @param torques Output joint torques or forces, sized by the caller.
+     * @param H If not NULL, output pose of the tool frame.
+     * @param J If not NULL, output spatial Jacobian (reference point at the base origin, see
+     * KDL::Jacobian::changeRefPoint), sized by the caller.
+     *
+     * @return False on size mismatch.
+     */
+    bool inverseDynamics(const KDL::JntArray & q, const KDL::JntArray & qdot, const KDL::JntArray & qdotdot,
+                         const std::vector<KDL::Wrench> & fexts, KDL::JntArray & torques,
+                         KDL::Frame * H = NULL, KDL::Jacobian * J = NULL);
+
+    /**
+     * @brief Computes gravity torques
+     *
+     * Equivalent to @ref inverseDynamics with null joint velocities and accelerations, and
+     * no external forces, but only link masses and centers of mass are involved.
+     *
+     * @param q Input joint positions (radians or meters).
+     * @param torques Output joint torques or forces, sized by the caller.
+     * @param H If not NULL, output pose of the tool frame.
+     * @param J If not NULL, output spatial Jacobian, sized by the caller.
+     *
+     * @return False on size mismatch.
+     */
+    bool gravityTorques(const KDL::JntArray & q, KDL::JntArray & torques,
+                        KDL::Frame * H = NULL, KDL::Jacobian * J = NULL);
+
+private:
+
+    bool checkSizes(const KDL::JntArray & q, const KDL::JntArray & torques, const KDL::Jacobian * J) const;
+    void backwardPass(KDL::JntArray & torques, KDL::Jacobian * J) const;
+
+    PoeExpression poe;
+    KDL::Vector gravity;
+
+    //! Joint screws with all joints at zero position.
+    std::vector<KDL::Twist> homeScrews;
+
+    //! Joint screws and link wrenches at the current configuration.
+    std::vector<KDL::Twist> screws;
+    std::vector<KDL::Wrench> wrenches;
+};
+
+}  // namespace roboticslab
+
+#endif  // __SCREW_THEORY_DYNAMICS_HPP__
@@ -20,15 +20,20 @@ public:
     //! Lists available Cartesian paths.
     enum cartesian_path
     {
-        LINE        ///< A straight line
+        LINE,               ///< A straight line
+        ROUNDED_COMPOSITE   ///< Straight segments through several waypoints, corners blended with circular arcs
     };
     //! Lists available Cartesian velocity profiles.
     enum cartesian_velocity_profile
     {
         TRAPEZOIDAL,        ///< A trapezoidal velocity profile
-        RECTANGULAR         ///< A rectangular velocity profile
+        RECTANGULAR,        ///< A rectangular velocity profile
+        TIME_OPTIMAL        ///< Fastest profile that honors per-point path speed limits
     };
 
+    //! Number of elements filled by @ref getState.
+    static const int STATE_SIZE = 18;
+
     /**
      * @brief Get trajectory total duration in seconds
      *
@@ -74,6 +79,21 @@ public:
      */
     virtual bool getAcceleration(double movementTime, std::vector<double>& acceleration) = 0;
 
+    /**
+     * @brief Cartesian position, velocity and acceleration at a specific instant in time
+     *
+     * Meant for control loops: computed at once, neither allocates nor throws.
+     *
+     * @param movementTime Time in seconds since start.
+     * @param state Caller-provided array of at least @ref STATE_SIZE elements, filled with
+     * position (0-5), velocity (6-11) and acceleration (12-17) as in @ref getPosition,
+     * @ref getVelocity and @ref getAcceleration. Velocity profiles that do not define
+     * acceleration are regarded as having null path acceleration.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getState(double movementTime, double * state) = 0;
+
     /**
      * @brief Set trajectory total duration in seconds
      *
@@ -101,6 +121,16 @@ public:
      */
     virtual bool setMaxAcceleration(double maxAcceleration) = 0;
 
+    /**
+     * @brief Set blend radius of corners between consecutive segments
+     *
+     * @param blendRadius Radius of the circular arc that joins two straight segments (meters),
+     * applies to \ref ROUNDED_COMPOSITE paths.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool setBlendRadius(double blendRadius) = 0;
+
     /**
      * @brief Add a waypoint to the trajectory
      *
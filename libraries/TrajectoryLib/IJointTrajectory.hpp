@@ -0,0 +1,126 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __I_JOINT_TRAJECTORY_HPP__
+#define __I_JOINT_TRAJECTORY_HPP__
+
+#include <vector>
+
+#include "ITrajectory.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup TrajectoryLib
+ * @brief Base class for a joint-space trajectory.
+ */
+class IJointTrajectory : public ITrajectory
+{
+public:
+    //! Lists available joint-space paths.
+    enum joint_path
+    {
+        CUBIC_SPLINE,       ///< Piecewise cubic polynomials, continuous velocity
+        QUINTIC_SPLINE      ///< Piecewise quintic polynomials, continuous acceleration
+    };
+    //! Lists available joint-space velocity profiles.
+    enum joint_velocity_profile
+    {
+        SYNCHRONIZED        ///< All joints share segment durations, dictated by the slowest one
+    };
+
+    /**
+     * @brief Joint position of the trajectory at a specific instant in time
+     *
+     * @param movementTime Time in seconds since start.
+     * @param position One element per joint (meters or degrees).
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getPosition(double movementTime, std::vector<double>& position) = 0;
+
+    /**
+     * @brief Joint velocity of the trajectory at a specific instant in time
+     *
+     * @param movementTime Time in seconds since start.
+     * @param velocity One element per joint (meters/second or degrees/second).
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getVelocity(double movementTime, std::vector<double>& velocity) = 0;
+
+    /**
+     * @brief Joint acceleration of the trajectory at a specific instant in time
+     *
+     * @param movementTime Time in seconds since start.
+     * @param acceleration One element per joint (meters/second^2 or degrees/second^2).
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getAcceleration(double movementTime, std::vector<double>& acceleration) = 0;
+
+    /**
+     * @brief Joint position, velocity and acceleration at a specific instant in time
+     *
+     * Meant for control loops: computed at once, neither allocates nor throws.
+     *
+     * @param movementTime Time in seconds since start.
+     * @param position Caller-provided array, one element per joint; may be NULL.
+     * @param velocity Caller-provided array, one element per joint; may be NULL.
+     * @param acceleration Caller-provided array, one element per joint; may be NULL.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getState(double movementTime, double * position, double * velocity, double * acceleration) = 0;
+
+    /**
+     * @brief Set maximum velocity of each joint
+     *
+     * Takes precedence over the value passed to @ref setMaxVelocity.
+     *
+     * @param maxVelocities One positive element per joint.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool setMaxJointVelocities(const std::vector<double>& maxVelocities) = 0;
+
+    /**
+     * @brief Add a waypoint to the trajectory
+     *
+     * @param waypoint Joint positions (meters or degrees).
+     * @param waypointVelocity Joint velocities at this waypoint; if empty, rest at first and
+     * last waypoints, otherwise chosen to keep moving in the same direction.
+     * @param waypointAcceleration Joint accelerations at this waypoint, only used by
+     * \ref QUINTIC_SPLINE; if empty, zero.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool addWaypoint(const std::vector<double>& waypoint,
+                             const std::vector<double>& waypointVelocity = std::vector<double>(),
+                             const std::vector<double>& waypointAcceleration = std::vector<double>()) = 0;
+
+    /**
+     * @brief Configure the type of joint-space path upon creation
+     *
+     * @param pathType Use a \ref joint_path to define the type of joint-space path
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool configurePath(int pathType) = 0;
+
+    /**
+     * @brief Configure the type of joint-space velocity profile upon creation
+     *
+     * @param velocityProfileType Use a \ref joint_velocity_profile to define the type of velocity profile
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool configureVelocityProfile(int velocityProfileType) = 0;
+
+    /** Destructor */
+    virtual ~IJointTrajectory() {}
+};
+
+}  // namespace roboticslab
+
+#endif  // __I_JOINT_TRAJECTORY_HPP__
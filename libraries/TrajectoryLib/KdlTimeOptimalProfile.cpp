@@ -0,0 +1,178 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "KdlTimeOptimalProfile.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+// -----------------------------------------------------------------------------
+
+roboticslab::KdlTimeOptimalProfile::KdlTimeOptimalProfile(const std::vector<double>& maxPathSpeeds,
+        double maxVelocity, double maxAcceleration)
+    : maxPathSpeeds(maxPathSpeeds),
+      maxVelocity(maxVelocity),
+      maxAcceleration(maxAcceleration)
+{}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTimeOptimalProfile::SetProfile(double pos1, double pos2)
+{
+    const int n = maxPathSpeeds.size();
+    const double ds = (pos2 - pos1) / (n - 1);
+    const double dx = 2 * maxAcceleration * std::abs(ds);
+    const double sign = ds < 0.0 ? -1.0 : 1.0;
+
+    // squared speed bounds, start and end at rest
+    std::vector<double> x(n);
+
+    for (int i = 0; i < n; i++)
+    {
+        double limit = std::min(maxPathSpeeds[i], maxVelocity);
+        x[i] = limit * limit;
+    }
+
+    x[0] = x[n - 1] = 0.0;
+
+    // backward pass: able to decelerate in time for every later bound
+    for (int i = n - 2; i >= 0; i--)
+    {
+        x[i] = std::min(x[i], x[i + 1] + dx);
+    }
+
+    // forward pass: reachable from the previous point
+    for (int i = 0; i < n - 1; i++)
+    {
+        x[i + 1] = std::min(x[i + 1], x[i] + dx);
+    }
+
+    s.resize(n);
+    sdot.resize(n);
+    t.resize(n);
+    sddot.resize(n);
+
+    t[0] = 0.0;
+
+    for (int i = 0; i < n; i++)
+    {
+        s[i] = pos1 + i * ds;
+        sdot[i] = sign * std::sqrt(x[i]);
+
+        if (i > 0)
+        {
+            double speedSum = std::abs(sdot[i - 1]) + std::abs(sdot[i]);
+            double dt = speedSum > 0.0 ? 2 * std::abs(ds) / speedSum : 0.0;
+            t[i] = t[i - 1] + dt;
+            sddot[i - 1] = dt > 0.0 ? (sdot[i] - sdot[i - 1]) / dt : 0.0;
+        }
+    }
+
+    sddot[n - 1] = 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTimeOptimalProfile::SetProfileDuration(double pos1, double pos2, double newDuration)
+{
+    SetProfile(pos1, pos2);
+
+    double optimal = Duration();
+
+    if (newDuration <= optimal || optimal <= 0.0)
+    {
+        return;
+    }
+
+    // uniform time scaling keeps the shape and lowers speed and acceleration
+    double k = newDuration / optimal;
+
+    for (size_t i = 0; i < t.size(); i++)
+    {
+        t[i] *= k;
+        sdot[i] /= k;
+        sddot[i] /= k * k;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+double roboticslab::KdlTimeOptimalProfile::Duration() const
+{
+    return t.empty() ? 0.0 : t.back();
+}
+
+// -----------------------------------------------------------------------------
+
+int roboticslab::KdlTimeOptimalProfile::findInterval(double time) const
+{
+    // last grid point whose start time is not after the given time
+    std::vector<double>::const_iterator it = std::upper_bound(t.begin(), t.end(), time);
+    return std::max(0, static_cast<int>(it - t.begin()) - 1);
+}
+
+// -----------------------------------------------------------------------------
+
+double roboticslab::KdlTimeOptimalProfile::Pos(double time) const
+{
+    if (time <= 0.0)
+    {
+        return s.front();
+    }
+
+    if (time >= Duration())
+    {
+        return s.back();
+    }
+
+    int i = findInterval(time);
+    double tau = time - t[i];
+    return s[i] + sdot[i] * tau + 0.5 * sddot[i] * tau * tau;
+}
+
+// -----------------------------------------------------------------------------
+
+double roboticslab::KdlTimeOptimalProfile::Vel(double time) const
+{
+    if (time <= 0.0 || time >= Duration())
+    {
+        return 0.0;
+    }
+
+    int i = findInterval(time);
+    return sdot[i] + sddot[i] * (time - t[i]);
+}
+
+// -----------------------------------------------------------------------------
+
+double roboticslab::KdlTimeOptimalProfile::Acc(double time) const
+{
+    if (time < 0.0 || time > Duration())
+    {
+        return 0.0;
+    }
+
+    return sddot[findInterval(time)];
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTimeOptimalProfile::Write(std::ostream& os) const
+{
+    os << "TIMEOPTIMAL[" << maxPathSpeeds.size() << "," << maxVelocity << "," << maxAcceleration << "]";
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::VelocityProfile* roboticslab::KdlTimeOptimalProfile::Clone() const
+{
+    KdlTimeOptimalProfile * profile = new KdlTimeOptimalProfile(maxPathSpeeds, maxVelocity, maxAcceleration);
+
+    if (!t.empty())
+    {
+        profile->SetProfileDuration(s.front(), s.back(), Duration());
+    }
+
+    return profile;
+}
+
+// -----------------------------------------------------------------------------
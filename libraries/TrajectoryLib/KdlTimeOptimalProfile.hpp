@@ -0,0 +1,65 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __KDL_TIME_OPTIMAL_PROFILE_HPP__
+#define __KDL_TIME_OPTIMAL_PROFILE_HPP__
+
+#include <iostream>
+#include <vector>
+
+#include <kdl/velocityprofile.hpp>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup TrajectoryLib
+ * @brief Fastest velocity profile along a path under position-dependent speed limits.
+ *
+ * Path speed limits are given on a uniform grid over [pos1, pos2]. The squared path speed
+ * is bounded at each grid point, then swept backwards and forwards so that path acceleration
+ * stays within a constant bound (reachability analysis, as in TOPP-RA for first-order
+ * constraints). Motion starts and ends at rest, acceleration is constant between grid points.
+ */
+class KdlTimeOptimalProfile : public KDL::VelocityProfile
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param maxPathSpeeds Path speed limit at each grid point (units/second), at least two.
+     * @param maxVelocity Path speed limit applied everywhere (units/second).
+     * @param maxAcceleration Path acceleration limit (units/second^2).
+     */
+    KdlTimeOptimalProfile(const std::vector<double>& maxPathSpeeds, double maxVelocity, double maxAcceleration);
+
+    virtual void SetProfile(double pos1, double pos2);
+
+    /**
+     * @brief Set profile, stretch in time if @p newDuration exceeds the optimal one
+     *
+     * A shorter duration is not feasible, the optimal profile is kept instead.
+     */
+    virtual void SetProfileDuration(double pos1, double pos2, double newDuration);
+
+    virtual double Duration() const;
+    virtual double Pos(double time) const;
+    virtual double Vel(double time) const;
+    virtual double Acc(double time) const;
+    virtual void Write(std::ostream& os) const;
+    virtual KDL::VelocityProfile* Clone() const;
+
+private:
+
+    int findInterval(double time) const;
+
+    std::vector<double> maxPathSpeeds;
+    double maxVelocity, maxAcceleration;
+
+    //! Grid point positions, speeds, start times; constant acceleration per interval
+    std::vector<double> s, sdot, t, sddot;
+};
+
+}  // namespace roboticslab
+
+#endif  // __KDL_TIME_OPTIMAL_PROFILE_HPP__
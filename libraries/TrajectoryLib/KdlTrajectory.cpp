@@ -2,8 +2,13 @@
 
 #include "KdlTrajectory.hpp"
 
+#include <cmath>
+#include <algorithm>
+
 #include <kdl/trajectory_segment.hpp>
 #include <kdl/path_line.hpp>
+#include <kdl/path_point.hpp>
+#include <kdl/path_roundedcomposite.hpp>
 #include <kdl/rotational_interpolation_sa.hpp>
 #include <kdl/velocityprofile_trap.hpp>
 #include <kdl/velocityprofile_rect.hpp>
@@ -11,21 +16,135 @@
 
 #include <yarp/os/LogStream.h>
 
+#include "KdlTimeOptimalProfile.hpp"
 #include "KdlVectorConverter.hpp"
 
+namespace
+{
+    // state layout, see getState()
+    const int POSITION_OFFSET = 0;
+    const int VELOCITY_OFFSET = 6;
+    const int ACCELERATION_OFFSET = 12;
+
+    // pre-sampled table layout: translation, unit quaternion (x, y, z, w), velocity, acceleration
+    const int SAMPLE_STRIDE = 19;
+    const int SAMPLE_TRANSLATION = 0;
+    const int SAMPLE_QUATERNION = 3;
+    const int SAMPLE_VELOCITY = 7;
+    const int SAMPLE_ACCELERATION = 13;
+
+    // same tolerance KDL::Path_RoundedComposite applies to segment lengths
+    const double WAYPOINT_EPS = 1e-7;
+
+    // quaternions this close (cosine of half the angle between them) are blended linearly,
+    // slerp weights lose precision as the angle vanishes
+    const double SLERP_DOT_THRESHOLD = 0.9995;
+
+    inline void frameToArray(const KDL::Frame & f, double * x)
+    {
+        KDL::Vector rotVector = f.M.GetRot();
+
+        x[0] = f.p.x();
+        x[1] = f.p.y();
+        x[2] = f.p.z();
+        x[3] = rotVector.x();
+        x[4] = rotVector.y();
+        x[5] = rotVector.z();
+    }
+
+    inline void twistToArray(const KDL::Twist & t, double * xdot)
+    {
+        xdot[0] = t.vel.x();
+        xdot[1] = t.vel.y();
+        xdot[2] = t.vel.z();
+        xdot[3] = t.rot.x();
+        xdot[4] = t.rot.y();
+        xdot[5] = t.rot.z();
+    }
+
+    inline void rotVectorToQuaternion(const double * r, double * q)
+    {
+        double angle = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+        double scale = angle > 1e-12 ? std::sin(angle / 2) / angle : 0.5;
+
+        q[0] = r[0] * scale;
+        q[1] = r[1] * scale;
+        q[2] = r[2] * scale;
+        q[3] = std::cos(angle / 2);
+    }
+
+    inline void quaternionToRotVector(const double * q, double * r)
+    {
+        // q and -q are the same rotation, pick the one with angle in [0, pi] like KDL does
+        double sign = q[3] < 0.0 ? -1.0 : 1.0;
+        double sinHalf = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2]);
+        double scale = sinHalf > 1e-12 ? 2 * std::atan2(sinHalf, sign * q[3]) / sinHalf : 2.0;
+
+        r[0] = sign * q[0] * scale;
+        r[1] = sign * q[1] * scale;
+        r[2] = sign * q[2] * scale;
+    }
+
+    inline void slerp(const double * q0, const double * q1, double frac, double * q)
+    {
+        // table quaternions share a hemisphere with their predecessor, see sample()
+        double dot = q0[0] * q1[0] + q0[1] * q1[1] + q0[2] * q1[2] + q0[3] * q1[3];
+        double w0, w1;
+
+        if (dot > SLERP_DOT_THRESHOLD)
+        {
+            w0 = 1.0 - frac;
+            w1 = frac;
+        }
+        else
+        {
+            double theta = std::acos(dot);
+            double sinTheta = std::sin(theta);
+            w0 = std::sin((1.0 - frac) * theta) / sinTheta;
+            w1 = std::sin(frac * theta) / sinTheta;
+        }
+
+        double norm = 0.0;
+
+        for (int i = 0; i < 4; i++)
+        {
+            q[i] = w0 * q0[i] + w1 * q1[i];
+            norm += q[i] * q[i];
+        }
+
+        norm = std::sqrt(norm);
+
+        for (int i = 0; i < 4; i++)
+        {
+            q[i] /= norm;
+        }
+    }
+
+    inline void lerp(const double * x0, const double * x1, double frac, int size, double * x)
+    {
+        for (int i = 0; i < size; i++)
+        {
+            x[i] = x0[i] + frac * (x1[i] - x0[i]);
+        }
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 roboticslab::KdlTrajectory::KdlTrajectory()
     : duration(DURATION_NOT_SET),
       maxVelocity(DEFAULT_CARTESIAN_MAX_VEL),
       maxAcceleration(DEFAULT_CARTESIAN_MAX_ACC),
+      blendRadius(DEFAULT_CARTESIAN_BLEND_RADIUS),
       configuredPath(false),
       configuredVelocityProfile(false),
       velocityDrivenPath(false),
+      profileAcceleration(false),
       created(false),
       currentTrajectory(0),
       path(0),
-      velocityProfile(0)
+      velocityProfile(0),
+      samplingPeriod(0.0)
 {}
 
 // -----------------------------------------------------------------------------
@@ -47,6 +166,12 @@ bool roboticslab::KdlTrajectory::getDuration(double* duration) const
 
 bool roboticslab::KdlTrajectory::getPosition(double movementTime, std::vector<double>& position)
 {
+    if (!samples.empty())
+    {
+        interpolate(movementTime, POSITION_OFFSET, position);
+        return true;
+    }
+
     try
     {
         const KDL::Frame & xFrame = currentTrajectory->Pos(movementTime);
@@ -64,6 +189,12 @@ bool roboticslab::KdlTrajectory::getPosition(double movementTime, std::vector<do
 
 bool roboticslab::KdlTrajectory::getVelocity(double movementTime, std::vector<double>& velocity)
 {
+    if (!samples.empty())
+    {
+        interpolate(movementTime, VELOCITY_OFFSET, velocity);
+        return true;
+    }
+
     try
     {
         const KDL::Twist & xdotFrame = currentTrajectory->Vel(movementTime);
@@ -81,6 +212,18 @@ bool roboticslab::KdlTrajectory::getVelocity(double movementTime, std::vector<do
 
 bool roboticslab::KdlTrajectory::getAcceleration(double movementTime, std::vector<double>& acceleration)
 {
+    if (!samples.empty())
+    {
+        if (!profileAcceleration)
+        {
+            yError() << "Unable to retrieve acceleration at" << movementTime;
+            return false;
+        }
+
+        interpolate(movementTime, ACCELERATION_OFFSET, acceleration);
+        return true;
+    }
+
     try
     {
         const KDL::Twist & xdotdotFrame = currentTrajectory->Acc(movementTime);
@@ -96,6 +239,28 @@ bool roboticslab::KdlTrajectory::getAcceleration(double movementTime, std::vecto
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::KdlTrajectory::getState(double movementTime, double * state)
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    if (!samples.empty())
+    {
+        interpolate(movementTime, POSITION_OFFSET, ICartesianTrajectory::STATE_SIZE, state);
+    }
+    else
+    {
+        evaluate(movementTime, state);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::KdlTrajectory::setDuration(double duration)
 {
     this->duration = duration;
@@ -120,6 +285,89 @@ bool roboticslab::KdlTrajectory::setMaxAcceleration(double maxAcceleration)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::KdlTrajectory::setBlendRadius(double blendRadius)
+{
+    if (blendRadius <= 0.0)
+    {
+        yError() << "Blend radius must be positive";
+        return false;
+    }
+
+    this->blendRadius = blendRadius;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlTrajectory::setSamplingPeriod(double samplingPeriod)
+{
+    if (samplingPeriod < 0.0)
+    {
+        yError() << "Sampling period cannot be negative";
+        return false;
+    }
+
+    this->samplingPeriod = samplingPeriod;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlTrajectory::getPathSamples(int samples, std::vector< std::vector<double> >& positions,
+                                                std::vector< std::vector<double> >& tangents) const
+{
+    if ( ! configuredPath || velocityDrivenPath )
+    {
+        yError() << "Path not configured or not bounded by waypoints!";
+        return false;
+    }
+
+    if ( samples < 2 )
+    {
+        yError() << "Need at least 2 samples, got" << samples;
+        return false;
+    }
+
+    double length = path->PathLength();
+
+    positions.resize(samples);
+    tangents.resize(samples);
+
+    for ( int i = 0; i < samples; i++ )
+    {
+        double s = length * i / (samples - 1);
+        positions[i] = KdlVectorConverter::frameToVector(path->Pos(s));
+        tangents[i] = KdlVectorConverter::twistToVector(path->Vel(s, 1.0));
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlTrajectory::setPathSpeedLimits(const std::vector<double>& maxPathSpeeds)
+{
+    if ( maxPathSpeeds.size() < 3 )
+    {
+        yError() << "Need at least 3 path speed limits, got" << maxPathSpeeds.size();
+        return false;
+    }
+
+    for ( size_t i = 0; i < maxPathSpeeds.size(); i++ )
+    {
+        if ( maxPathSpeeds[i] <= 0.0 )
+        {
+            yError("Path speed limit must be positive (sample %zu: %f)", i, maxPathSpeeds[i]);
+            return false;
+        }
+    }
+
+    this->maxPathSpeeds = maxPathSpeeds;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::KdlTrajectory::addWaypoint(const std::vector<double>& waypoint,
                          const std::vector<double>& waypointVelocity,
                          const std::vector<double>& waypointAcceleration)
@@ -175,8 +423,87 @@ bool roboticslab::KdlTrajectory::configurePath(int pathType)
 
         break;
     }
+    case ICartesianTrajectory::ROUNDED_COMPOSITE:
+    {
+        if ( frames.size() < 2 )
+        {
+            yError("Need at least 2 waypoints for Cartesian rounded composite (have %zu)!", frames.size());
+            return false;
+        }
+
+        // KDL throws on zero-length segments, a repeated waypoint is a hold: drop it
+        std::vector<KDL::Frame> points;
+        std::vector<size_t> indices;
+
+        for ( size_t i = 0; i < frames.size(); i++ )
+        {
+            if ( points.empty() || !KDL::Equal(frames[i], points.back(), WAYPOINT_EPS) )
+            {
+                points.push_back(frames[i]);
+                indices.push_back(i);
+            }
+        }
+
+        // a single velocity profile cannot stop at a via point, which both of these need
+        for ( size_t i = 1; i + 1 < points.size(); i++ )
+        {
+            KDL::Vector ab = points[i].p - points[i - 1].p;
+            KDL::Vector bc = points[i + 1].p - points[i].p;
+            double abdist = ab.Norm();
+            double bcdist = bc.Norm();
+
+            if ( abdist < WAYPOINT_EPS || bcdist < WAYPOINT_EPS )
+            {
+                size_t first = abdist < WAYPOINT_EPS ? i - 1 : i;
+                yError("Waypoints %zu and %zu only differ in orientation, unable to reorient at a via point "
+                       "(split the motion into separate commands)", indices[first], indices[first + 1]);
+                return false;
+            }
+
+            if ( KDL::PI - std::acos(std::max(-1.0, std::min(KDL::dot(ab, bc) / (abdist * bcdist), 1.0))) < WAYPOINT_EPS )
+            {
+                yError("Path reverses its direction at waypoint %zu, unable to blend "
+                       "(split the motion into separate commands)", indices[i]);
+                return false;
+            }
+        }
+
+        if ( points.size() == 1 )
+        {
+            velocityDrivenPath = false;
+            path = new KDL::Path_Point(points[0]);
+            break;
+        }
+
+        KDL::RotationalInterpolation * orient = new KDL::RotationalInterpolation_SingleAxis();
+        double eqradius = 1.0;
+
+        // takes ownership of orient, deletes it on failure as well
+        KDL::Path_RoundedComposite * composite = new KDL::Path_RoundedComposite(blendRadius, eqradius, orient);
+
+        try
+        {
+            for ( size_t i = 0; i < points.size(); i++ )
+            {
+                composite->Add(points[i]);
+            }
+
+            composite->Finish();
+        }
+        catch (const KDL::Error_MotionPlanning &e)
+        {
+            yError() << "Unable to blend waypoints:" << e.Description() << "(try a smaller blend radius)";
+            delete composite;
+            return false;
+        }
+
+        velocityDrivenPath = false;
+        path = composite;
+
+        break;
+    }
     default:
-        yError() << "Only LINE cartesian path implemented for now!";
+        yError() << "Only LINE and ROUNDED_COMPOSITE cartesian paths implemented for now!";
         return false;
     }
 
@@ -200,15 +527,35 @@ bool roboticslab::KdlTrajectory::configureVelocityProfile(int velocityProfileTyp
     case ICartesianTrajectory::TRAPEZOIDAL:
     {
         velocityProfile = new KDL::VelocityProfile_Trap(maxVelocity, maxAcceleration);
+        profileAcceleration = true;
         break;
     }
     case ICartesianTrajectory::RECTANGULAR:
     {
         velocityProfile = new KDL::VelocityProfile_Rectangular(maxVelocity);
+        profileAcceleration = false; // KDL throws on Acc()
+        break;
+    }
+    case ICartesianTrajectory::TIME_OPTIMAL:
+    {
+        if ( maxPathSpeeds.empty() )
+        {
+            yError() << "Path speed limits not set!";
+            return false;
+        }
+
+        if ( velocityDrivenPath )
+        {
+            yError() << "TIME_OPTIMAL velocity profile needs a path bounded by waypoints!";
+            return false;
+        }
+
+        velocityProfile = new KdlTimeOptimalProfile(maxPathSpeeds, maxVelocity, maxAcceleration);
+        profileAcceleration = true;
         break;
     }
     default:
-        yError() << "Only TRAPEZOIDAL and RECTANGULAR cartesian velocity profiles implemented for now!";
+        yError() << "Only TRAPEZOIDAL, RECTANGULAR and TIME_OPTIMAL cartesian velocity profiles implemented for now!";
         return false;
     }
 
@@ -281,11 +628,157 @@ bool roboticslab::KdlTrajectory::create()
 
     created = true;
 
+    if (samplingPeriod > 0.0 && !sample())
+    {
+        yWarning() << "Unable to pre-sample trajectory, evaluating on demand";
+        samples.clear();
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlTrajectory::sample()
+{
+    double total = currentTrajectory->Duration();
+    double n = std::ceil(total / samplingPeriod) + 1;
+
+    if (n > MAX_TRAJECTORY_SAMPLES)
+    {
+        yWarning() << "Too many samples requested:" << n;
+        return false;
+    }
+
+    int numSamples = n;
+    samples.resize(numSamples * SAMPLE_STRIDE);
+
+    double state[ICartesianTrajectory::STATE_SIZE];
+
+    for (int k = 0; k < numSamples; k++)
+    {
+        evaluate(std::min(k * samplingPeriod, total), state);
+
+        double * entry = samples.data() + k * SAMPLE_STRIDE;
+        std::copy(state + POSITION_OFFSET, state + POSITION_OFFSET + 3, entry + SAMPLE_TRANSLATION);
+        std::copy(state + VELOCITY_OFFSET, state + VELOCITY_OFFSET + 6, entry + SAMPLE_VELOCITY);
+        std::copy(state + ACCELERATION_OFFSET, state + ACCELERATION_OFFSET + 6, entry + SAMPLE_ACCELERATION);
+
+        double * q = entry + SAMPLE_QUATERNION;
+        rotVectorToQuaternion(state + POSITION_OFFSET + 3, q);
+
+        // scaled axis-angle flips its axis past pi, keep the shortest arc between samples
+        if (k > 0)
+        {
+            const double * prev = q - SAMPLE_STRIDE;
+
+            if (prev[0] * q[0] + prev[1] * q[1] + prev[2] * q[2] + prev[3] * q[3] < 0.0)
+            {
+                for (int i = 0; i < 4; i++)
+                {
+                    q[i] = -q[i];
+                }
+            }
+        }
+    }
+
     return true;
 }
 
 // -----------------------------------------------------------------------------
 
+std::size_t roboticslab::KdlTrajectory::getSampleTableBytes() const
+{
+    return samples.size() * sizeof(double);
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTrajectory::evaluate(double movementTime, double * state) const
+{
+    // same as KDL::Trajectory_Segment, but path parameter is computed once and the
+    // velocity profile's acceleration is only queried if defined (rectangular throws)
+    double s = velocityProfile->Pos(movementTime);
+    double sd = velocityProfile->Vel(movementTime);
+    double sdd = profileAcceleration ? velocityProfile->Acc(movementTime) : 0.0;
+
+    // guard against rounding, composite paths throw outside their bounds
+    if (!velocityDrivenPath)
+    {
+        s = std::max(0.0, std::min(s, path->PathLength()));
+    }
+
+    frameToArray(path->Pos(s), state + POSITION_OFFSET);
+    twistToArray(path->Vel(s, sd), state + VELOCITY_OFFSET);
+    twistToArray(path->Acc(s, sd, sdd), state + ACCELERATION_OFFSET);
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTrajectory::interpolate(double movementTime, int offset, int size, double * out) const
+{
+    int numSamples = samples.size() / SAMPLE_STRIDE;
+    double total = currentTrajectory->Duration();
+
+    int k;
+    double frac;
+
+    if (movementTime <= 0.0 || numSamples == 1)
+    {
+        k = 0;
+        frac = 0.0;
+    }
+    else if (movementTime >= total)
+    {
+        k = numSamples - 1;
+        frac = 0.0;
+    }
+    else
+    {
+        // last interval may be shorter than the sampling period
+        k = std::min(static_cast<int>(movementTime / samplingPeriod), numSamples - 2);
+        double t0 = k * samplingPeriod;
+        double t1 = std::min(t0 + samplingPeriod, total);
+        frac = t1 > t0 ? (movementTime - t0) / (t1 - t0) : 0.0;
+    }
+
+    const double * s0 = samples.data() + k * SAMPLE_STRIDE;
+    const double * s1 = k < numSamples - 1 ? s0 + SAMPLE_STRIDE : s0;
+
+    for (int section = offset; section < offset + size; section += 6)
+    {
+        double * x = out + section - offset;
+
+        switch (section)
+        {
+        case POSITION_OFFSET:
+        {
+            double q[4];
+            lerp(s0 + SAMPLE_TRANSLATION, s1 + SAMPLE_TRANSLATION, frac, 3, x);
+            slerp(s0 + SAMPLE_QUATERNION, s1 + SAMPLE_QUATERNION, frac, q);
+            quaternionToRotVector(q, x + 3);
+            break;
+        }
+        case VELOCITY_OFFSET:
+            lerp(s0 + SAMPLE_VELOCITY, s1 + SAMPLE_VELOCITY, frac, 6, x);
+            break;
+        case ACCELERATION_OFFSET:
+            lerp(s0 + SAMPLE_ACCELERATION, s1 + SAMPLE_ACCELERATION, frac, 6, x);
+            break;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::KdlTrajectory::interpolate(double movementTime, int offset, std::vector<double>& out) const
+{
+    out.resize(6);
+    interpolate(movementTime, offset, 6, out.data());
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::KdlTrajectory::destroy()
 {
     if ( currentTrajectory )
@@ -314,14 +807,21 @@ bool roboticslab::KdlTrajectory::destroy()
     duration = DURATION_NOT_SET;
     maxVelocity = DEFAULT_CARTESIAN_MAX_VEL;
     maxAcceleration = DEFAULT_CARTESIAN_MAX_ACC;
+    blendRadius = DEFAULT_CARTESIAN_BLEND_RADIUS;
 
     configuredPath = configuredVelocityProfile = false;
     velocityDrivenPath = false;
+    profileAcceleration = false;
     created = false;
 
     frames.clear();
     twists.clear();
 
+    maxPathSpeeds.clear();
+
+    samplingPeriod = 0.0;
+    samples.clear();
+
     return true;
 }
 
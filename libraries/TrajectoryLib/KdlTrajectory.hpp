@@ -3,6 +3,7 @@
 #ifndef __KDL_TRAJECTORY_HPP__
 #define __KDL_TRAJECTORY_HPP__
 
+#include <cstddef>
 #include <vector>
 
 #include <kdl/frames.hpp>
@@ -16,6 +17,9 @@
 
 #define DEFAULT_CARTESIAN_MAX_VEL 7.5      // unit/s, enforces a min duration of KDL::Trajectory_Segment
 #define DEFAULT_CARTESIAN_MAX_ACC 0.2      // unit/s^2
+#define DEFAULT_CARTESIAN_BLEND_RADIUS 0.01 // unit
+
+#define MAX_TRAJECTORY_SAMPLES 1000000     // upper bound on pre-sampled table length
 
 namespace roboticslab
 {
@@ -83,6 +87,17 @@ public:
      */
     virtual bool getAcceleration(double movementTime, std::vector<double>& acceleration);
 
+    /**
+     * @brief Cartesian position, velocity and acceleration at a specific instant in time
+     *
+     * @param movementTime Time in seconds since start.
+     * @param state Caller-provided array of at least @ref STATE_SIZE elements: position,
+     * velocity and acceleration, 6 elements each.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool getState(double movementTime, double * state);
+
     /**
      * @brief Set trajectory total duration in seconds
      *
@@ -110,6 +125,69 @@ public:
      */
     virtual bool setMaxAcceleration(double maxAcceleration);
 
+    /**
+     * @brief Set blend radius of corners between consecutive segments
+     *
+     * @param blendRadius Radius of the circular arc that joins two straight segments (meters),
+     * applies to \ref ROUNDED_COMPOSITE paths.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool setBlendRadius(double blendRadius);
+
+    /**
+     * @brief Pre-sample the trajectory upon creation
+     *
+     * Position, velocity and acceleration are stored in a contiguous table every
+     * @p samplingPeriod seconds, later queries are answered by linear interpolation
+     * between the two nearest samples instead of evaluating the KDL trajectory. Values
+     * are exact at sample instants; in between, position error is bounded by
+     * acc*period^2/8. Orientation is stored as a unit quaternion and interpolated along
+     * the shortest arc (slerp), so rotations crossing the pi boundary of the scaled
+     * axis-angle representation are handled. Memory cost is 19 doubles per sample,
+     * choose the control period or a fraction of it.
+     *
+     * @param samplingPeriod Time between samples (seconds), zero disables sampling.
+     *
+     * @return true on success, false otherwise
+     */
+    bool setSamplingPeriod(double samplingPeriod);
+
+    /**
+     * @brief Memory held by the pre-sampled table
+     *
+     * @return Size in bytes, zero if the trajectory is evaluated on demand.
+     */
+    std::size_t getSampleTableBytes() const;
+
+    /**
+     * @brief Sample the configured path on a uniform grid
+     *
+     * Meant for computing path speed limits from joint-space constraints, see
+     * @ref setPathSpeedLimits. The path must be configured beforehand.
+     *
+     * @param samples Number of grid points, including both ends (at least two).
+     * @param positions 6-element vectors describing each grid point in Cartesian space.
+     * @param tangents 6-element vectors describing the Cartesian velocity at each grid
+     * point when moving along the path at unit speed.
+     *
+     * @return true on success, false otherwise
+     */
+    bool getPathSamples(int samples, std::vector< std::vector<double> >& positions,
+                        std::vector< std::vector<double> >& tangents) const;
+
+    /**
+     * @brief Set path speed limits for a \ref TIME_OPTIMAL velocity profile
+     *
+     * @param maxPathSpeeds One positive limit per grid point of @ref getPathSamples
+     * (path units/second). Path acceleration is bounded by the maximum acceleration,
+     * path speed by the maximum velocity. At least three, since the profile starts and
+     * ends at rest and would have no room to move along a two-point grid.
+     *
+     * @return true on success, false otherwise
+     */
+    bool setPathSpeedLimits(const std::vector<double>& maxPathSpeeds);
+
     /**
      * @brief Add a waypoint to the trajectory
      *
@@ -165,11 +243,18 @@ private:
     KdlTrajectory(const KdlTrajectory &);
     KdlTrajectory operator=(const KdlTrajectory &);
 
+    bool sample();
+    void evaluate(double movementTime, double * state) const;
+    void interpolate(double movementTime, int offset, int size, double * out) const;
+    void interpolate(double movementTime, int offset, std::vector<double>& out) const;
+
     double duration;
     double maxVelocity, maxAcceleration;
+    double blendRadius;
 
     bool configuredPath, configuredVelocityProfile;
     bool velocityDrivenPath;
+    bool profileAcceleration;
     bool created;
 
     KDL::Trajectory* currentTrajectory;
@@ -178,6 +263,11 @@ private:
 
     std::vector<KDL::Frame> frames;
     std::vector<KDL::Twist> twists;
+
+    std::vector<double> maxPathSpeeds;
+
+    double samplingPeriod;
+    std::vector<double> samples; // [translation(3) quaternion(4) vel(6) acc(6)] per sample
 };
 
 }  // namespace roboticslab
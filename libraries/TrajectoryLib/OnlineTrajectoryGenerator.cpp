@@ -0,0 +1,170 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "OnlineTrajectoryGenerator.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <yarp/os/LogStream.h>
+
+// -----------------------------------------------------------------------------
+
+roboticslab::OnlineTrajectoryGenerator::OnlineTrajectoryGenerator()
+    : period(0.0),
+      maxAcceleration(0.0),
+      maxJerk(0.0),
+      windowSize(1),
+      windowIndex(0)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::OnlineTrajectoryGenerator::configure(double period, const std::vector<double>& maxVelocity,
+        double maxAcceleration, double maxJerk)
+{
+    if (maxAcceleration <= 0.0 || maxJerk <= 0.0)
+    {
+        yError() << "Acceleration and jerk limits must be positive";
+        return false;
+    }
+
+    for (size_t i = 0; i < maxVelocity.size(); i++)
+    {
+        if (maxVelocity[i] <= 0.0)
+        {
+            yError() << "Velocity limit must be positive at axis" << i;
+            return false;
+        }
+    }
+
+    this->maxVelocity = maxVelocity;
+    this->maxAcceleration = maxAcceleration;
+    this->maxJerk = maxJerk;
+
+    return setPeriod(period);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::OnlineTrajectoryGenerator::setPeriod(double period)
+{
+    if (period <= 0.0)
+    {
+        yError() << "Period must be positive";
+        return false;
+    }
+
+    this->period = period;
+
+    // averaging a profile whose velocity changes at most a*T per cycle over N cycles
+    // keeps jerk below 2*a/(N*T), pick N accordingly
+    windowSize = std::max(1, static_cast<int>(std::ceil(2 * maxAcceleration / (maxJerk * period))));
+
+    reset(position);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::OnlineTrajectoryGenerator::reset(const std::vector<double>& position)
+{
+    this->position = position;
+    rawPosition = position;
+    target = position;
+    velocity.assign(position.size(), 0.0);
+    rawVelocity.assign(position.size(), 0.0);
+    resetWindow();
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::OnlineTrajectoryGenerator::resetWindow()
+{
+    window.assign(windowSize * position.size(), 0.0);
+    windowSums.assign(position.size(), 0.0);
+    windowIndex = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::OnlineTrajectoryGenerator::setTarget(const std::vector<double>& target)
+{
+    if (target.size() != position.size() || target.size() > maxVelocity.size())
+    {
+        yError() << "Target size mismatch:" << target.size();
+        return false;
+    }
+
+    this->target = target;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::OnlineTrajectoryGenerator::step(std::vector<double>& position, std::vector<double>& velocity)
+{
+    const double a = maxAcceleration;
+    const double dv = a * period;
+    const int axes = this->position.size();
+
+    bool resting = true;
+
+    for (int i = 0; i < axes; i++)
+    {
+        double error = target[i] - rawPosition[i];
+        double distance = std::abs(error);
+
+        // fastest speed v = (n + f) * dv such that moving one cycle at v and then braking
+        // by dv per cycle covers at most the remaining distance: (n(n+1)/2 + f(n+1))*dv*T
+        double steps = distance / (dv * period);
+        double n = std::floor((std::sqrt(1 + 8 * steps) - 1) / 2);
+        double f = std::min(1.0, (steps - n * (n + 1) / 2) / (n + 1));
+        double vDesired = std::min(maxVelocity[i], (n + f) * dv);
+
+        if (error < 0.0)
+        {
+            vDesired = -vDesired;
+        }
+
+        rawVelocity[i] = std::max(rawVelocity[i] - dv, std::min(rawVelocity[i] + dv, vDesired));
+        rawPosition[i] += rawVelocity[i] * period;
+
+        if (std::abs(target[i] - rawPosition[i]) <= 1e-9)
+        {
+            rawPosition[i] = target[i];
+        }
+
+        double & slot = window[windowIndex * axes + i];
+        windowSums[i] += rawVelocity[i] - slot;
+        slot = rawVelocity[i];
+
+        this->velocity[i] = windowSums[i] / windowSize;
+        this->position[i] += this->velocity[i] * period;
+
+        resting &= rawPosition[i] == target[i] && rawVelocity[i] == 0.0;
+    }
+
+    windowIndex = (windowIndex + 1) % windowSize;
+
+    if (resting && std::all_of(window.begin(), window.end(), [](double v) { return v == 0.0; }))
+    {
+        // remove accumulated round-off
+        rawPosition = target;
+        this->position = target;
+        std::fill(this->velocity.begin(), this->velocity.end(), 0.0);
+        std::fill(windowSums.begin(), windowSums.end(), 0.0);
+    }
+
+    position = this->position;
+    velocity = this->velocity;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::OnlineTrajectoryGenerator::isDone() const
+{
+    return position == target && std::all_of(velocity.begin(), velocity.end(), [](double v) { return v == 0.0; });
+}
+
+// -----------------------------------------------------------------------------
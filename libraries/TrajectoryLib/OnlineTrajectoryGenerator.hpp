@@ -0,0 +1,106 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __ONLINE_TRAJECTORY_GENERATOR_HPP__
+#define __ONLINE_TRAJECTORY_GENERATOR_HPP__
+
+#include <vector>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup TrajectoryLib
+ * @brief Online, per-axis jerk-limited setpoint generator.
+ *
+ * Tracks a target that may change at any cycle. Each call to @ref step advances the
+ * internal state by one period. An acceleration-limited profile brakes early enough to
+ * land exactly on the target; its velocity is then smoothed by a moving average spanning
+ * 2*maxAcceleration/maxJerk seconds, which bounds jerk without changing the final position
+ * (the target is reached that much later). Axes are handled independently (no phase
+ * synchronization), units are up to the caller.
+ */
+class OnlineTrajectoryGenerator
+{
+public:
+
+    /**
+     * @brief Constructor
+     */
+    OnlineTrajectoryGenerator();
+
+    /**
+     * @brief Configure limits and cycle period
+     *
+     * @param period Time between consecutive calls to @ref step (seconds).
+     * @param maxVelocity Maximum velocity per axis.
+     * @param maxAcceleration Maximum acceleration, same for all axes.
+     * @param maxJerk Maximum jerk, same for all axes.
+     *
+     * @return true on success, false otherwise
+     */
+    bool configure(double period, const std::vector<double>& maxVelocity, double maxAcceleration, double maxJerk);
+
+    /**
+     * @brief Set cycle period
+     *
+     * Smoothing state is cleared, call while at rest.
+     *
+     * @param period Time between consecutive calls to @ref step (seconds).
+     *
+     * @return true on success, false otherwise
+     */
+    bool setPeriod(double period);
+
+    /**
+     * @brief Start from a resting state
+     *
+     * @param position Current position, also taken as initial target.
+     */
+    void reset(const std::vector<double>& position);
+
+    /**
+     * @brief Set a new target, can be called at any cycle
+     *
+     * @param target Desired position, must match the size passed to @ref reset.
+     *
+     * @return true on success, false otherwise
+     */
+    bool setTarget(const std::vector<double>& target);
+
+    /**
+     * @brief Advance one period
+     *
+     * @param position Next position setpoint.
+     * @param velocity Next velocity setpoint.
+     */
+    void step(std::vector<double>& position, std::vector<double>& velocity);
+
+    /**
+     * @brief Check whether all axes rest on target
+     *
+     * @return true if target reached and velocity is zero, false otherwise
+     */
+    bool isDone() const;
+
+private:
+
+    void resetWindow();
+
+    double period;
+    double maxAcceleration, maxJerk;
+    std::vector<double> maxVelocity;
+
+    //! Acceleration-limited profile
+    std::vector<double> target, rawPosition, rawVelocity;
+
+    //! Smoothed output
+    std::vector<double> position, velocity;
+
+    //! Last raw velocities per axis (windowSize x axes), running sums, current slot
+    std::vector<double> window, windowSums;
+    int windowSize, windowIndex;
+};
+
+}  // namespace roboticslab
+
+#endif  // __ONLINE_TRAJECTORY_GENERATOR_HPP__
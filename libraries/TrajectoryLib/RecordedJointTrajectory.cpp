@@ -0,0 +1,409 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "RecordedJointTrajectory.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+
+#include <yarp/os/LogStream.h>
+
+namespace
+{
+    const char MAGIC[4] = {'R', 'L', 'J', 'T'};
+    const std::uint32_t VERSION = 3;
+
+    template <typename T>
+    inline void writeValue(std::ofstream & out, T value)
+    {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template <typename T>
+    inline bool readValue(std::ifstream & in, T & value)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    void writeVector(std::ofstream & out, const std::vector<double> & v)
+    {
+        writeValue<std::uint32_t>(out, v.size());
+        out.write(reinterpret_cast<const char *>(v.data()), v.size() * sizeof(double));
+    }
+
+    bool readVector(std::ifstream & in, std::vector<double> & v)
+    {
+        std::uint32_t size;
+
+        if (!readValue(in, size))
+        {
+            return false;
+        }
+
+        v.resize(size);
+        return static_cast<bool>(in.read(reinterpret_cast<char *>(v.data()), size * sizeof(double)));
+    }
+
+    bool withinTolerance(const std::vector<double> & a, const std::vector<double> & b, double tolerance)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            if (std::abs(a[i] - b[i]) > tolerance)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::RecordedJointTrajectory::RecordedJointTrajectory()
+    : period(0.0),
+      created(false),
+      numJoints(0),
+      numSamples(0),
+      command(0),
+      frame(0)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::getDuration(double* duration) const
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    *duration = (numSamples - 1) * period;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::getPosition(double movementTime, std::vector<double>& position)
+{
+    position.resize(numJoints);
+    return getState(movementTime, position.data(), NULL, NULL);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::getVelocity(double movementTime, std::vector<double>& velocity)
+{
+    velocity.resize(numJoints);
+    return getState(movementTime, NULL, velocity.data(), NULL);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::getAcceleration(double movementTime, std::vector<double>& acceleration)
+{
+    acceleration.resize(numJoints);
+    return getState(movementTime, NULL, NULL, acceleration.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::getState(double movementTime, double * position, double * velocity,
+        double * acceleration)
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    // hold the last sample after the end, the first one before the start
+    double t = std::min(std::max(0.0, movementTime / period), numSamples - 1.0);
+    int sample = std::min(static_cast<int>(t), std::max(0, numSamples - 2));
+    bool moving = numSamples > 1 && movementTime >= 0.0 && movementTime < (numSamples - 1) * period;
+
+    const double * p0 = samples.data() + sample * numJoints;
+    const double * p1 = numSamples > 1 ? p0 + numJoints : p0;
+    double frac = t - sample;
+
+    for (int joint = 0; joint < numJoints; joint++)
+    {
+        if (position)
+        {
+            position[joint] = p0[joint] + frac * (p1[joint] - p0[joint]);
+        }
+
+        if (velocity)
+        {
+            velocity[joint] = moving ? (p1[joint] - p0[joint]) / period : 0.0;
+        }
+
+        if (acceleration)
+        {
+            acceleration[joint] = 0.0;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::setDuration(double duration)
+{
+    yError() << "Duration is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::setMaxVelocity(double maxVelocity)
+{
+    yError() << "Velocity is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::setMaxAcceleration(double maxAcceleration)
+{
+    yError() << "Acceleration is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::setMaxJointVelocities(const std::vector<double>& maxVelocities)
+{
+    yError() << "Velocity is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::addWaypoint(const std::vector<double>& waypoint,
+                         const std::vector<double>& waypointVelocity,
+                         const std::vector<double>& waypointAcceleration)
+{
+    if (created)
+    {
+        yWarning() << "Trajectory already created";
+        return false;
+    }
+
+    if (numSamples == 0)
+    {
+        numJoints = waypoint.size();
+    }
+
+    if (static_cast<int>(waypoint.size()) != numJoints)
+    {
+        yError() << "Waypoint size mismatch, expected" << numJoints << "joints";
+        return false;
+    }
+
+    samples.insert(samples.end(), waypoint.begin(), waypoint.end());
+    numSamples++;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::configurePath(int pathType)
+{
+    yError() << "Path is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::configureVelocityProfile(int velocityProfileType)
+{
+    yError() << "Velocity profile is fixed by the recording";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::create()
+{
+    if (created)
+    {
+        yWarning() << "Trajectory already created";
+        return false;
+    }
+
+    if (period <= 0.0)
+    {
+        yError() << "Sampling period not set";
+        return false;
+    }
+
+    if (numSamples == 0)
+    {
+        yError() << "No samples recorded";
+        return false;
+    }
+
+    created = true;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::destroy()
+{
+    samples.clear();
+    numSamples = 0;
+    numJoints = 0;
+    created = false;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::setPeriod(double period)
+{
+    if (period <= 0.0)
+    {
+        yError() << "Illegal sampling period:" << period;
+        return false;
+    }
+
+    this->period = period;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::RecordedJointTrajectory::setKey(int command, int frame, const std::vector<double>& start,
+        const std::vector<double>& goal, const std::vector<double>& tool)
+{
+    this->command = command;
+    this->frame = frame;
+    this->start = start;
+    this->goal = goal;
+    this->tool = tool;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::matches(int command, int frame, const std::vector<double>& start,
+        const std::vector<double>& goal, const std::vector<double>& tool, double startTolerance, double goalTolerance) const
+{
+    return created
+            && command == this->command
+            && frame == this->frame
+            && withinTolerance(start, this->start, startTolerance)
+            && withinTolerance(goal, this->goal, goalTolerance)
+            && withinTolerance(tool, this->tool, goalTolerance);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::save(const std::string& filename) const
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+
+    if (!out)
+    {
+        yError() << "Unable to open" << filename << "for writing";
+        return false;
+    }
+
+    out.write(MAGIC, sizeof(MAGIC));
+    writeValue<std::uint32_t>(out, VERSION);
+    writeValue<std::int32_t>(out, command);
+    writeValue<std::int32_t>(out, frame);
+    writeValue<std::uint32_t>(out, numJoints);
+    writeValue<std::uint32_t>(out, numSamples);
+    writeValue<double>(out, period);
+    writeVector(out, start);
+    writeVector(out, goal);
+    writeVector(out, tool);
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        writeValue<float>(out, static_cast<float>(samples[i]));
+    }
+
+    if (!out)
+    {
+        yError() << "Unable to write" << filename;
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RecordedJointTrajectory::load(const std::string& filename)
+{
+    std::ifstream in(filename.c_str(), std::ios::binary);
+
+    if (!in)
+    {
+        yError() << "Unable to open" << filename << "for reading";
+        return false;
+    }
+
+    char magic[sizeof(MAGIC)];
+    std::uint32_t version, fileJoints, fileSamples;
+    std::int32_t fileCommand, fileFrame;
+    double filePeriod;
+    std::vector<double> fileStart, fileGoal, fileTool;
+
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0
+            || !readValue(in, version) || version != VERSION)
+    {
+        yError() << "Not a recorded trajectory or unsupported version:" << filename;
+        return false;
+    }
+
+    if (!readValue(in, fileCommand) || !readValue(in, fileFrame) || !readValue(in, fileJoints) || !readValue(in, fileSamples)
+            || !readValue(in, filePeriod) || !readVector(in, fileStart) || !readVector(in, fileGoal)
+            || !readVector(in, fileTool))
+    {
+        yError() << "Truncated header:" << filename;
+        return false;
+    }
+
+    std::vector<float> buffer(static_cast<size_t>(fileJoints) * fileSamples);
+
+    if (!in.read(reinterpret_cast<char *>(buffer.data()), buffer.size() * sizeof(float)))
+    {
+        yError() << "Truncated samples:" << filename;
+        return false;
+    }
+
+    destroy();
+
+    if (!setPeriod(filePeriod))
+    {
+        return false;
+    }
+
+    numJoints = fileJoints;
+    numSamples = fileSamples;
+    samples.assign(buffer.begin(), buffer.end());
+    setKey(fileCommand, fileFrame, fileStart, fileGoal, fileTool);
+
+    return create();
+}
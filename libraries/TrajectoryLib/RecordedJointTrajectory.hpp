@@ -0,0 +1,148 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __RECORDED_JOINT_TRAJECTORY_HPP__
+#define __RECORDED_JOINT_TRAJECTORY_HPP__
+
+#include <string>
+#include <vector>
+
+#include "IJointTrajectory.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup TrajectoryLib
+ * @brief Replays joint-space setpoints recorded at a fixed period.
+ *
+ * Waypoints are consecutive samples, positions are linearly interpolated between them.
+ * The recording carries a key (command, reference frame, start, goal and tool) so that it can be looked up and
+ * replayed instead of re-planning the same motion. Recordings are stored in a compact
+ * binary file: a small header with the key, then samples in single precision and in
+ * native byte order.
+ */
+class RecordedJointTrajectory : public IJointTrajectory
+{
+public:
+
+    /**
+     * @brief Constructor
+     */
+    RecordedJointTrajectory();
+
+    virtual bool getDuration(double* duration) const;
+    virtual bool getPosition(double movementTime, std::vector<double>& position);
+    virtual bool getVelocity(double movementTime, std::vector<double>& velocity);
+    virtual bool getAcceleration(double movementTime, std::vector<double>& acceleration);
+
+    /**
+     * @brief Joint position, velocity and acceleration at a specific instant in time
+     *
+     * Velocity is the finite difference of the enclosing samples, acceleration is always zero.
+     */
+    virtual bool getState(double movementTime, double * position, double * velocity, double * acceleration);
+
+    /** @brief Not supported, duration is fixed by the recording */
+    virtual bool setDuration(double duration);
+    /** @brief Not supported, velocity is fixed by the recording */
+    virtual bool setMaxVelocity(double maxVelocity);
+    /** @brief Not supported, acceleration is fixed by the recording */
+    virtual bool setMaxAcceleration(double maxAcceleration);
+    /** @brief Not supported, velocity is fixed by the recording */
+    virtual bool setMaxJointVelocities(const std::vector<double>& maxVelocities);
+
+    /**
+     * @brief Append a sample to the recording
+     *
+     * @param waypoint Joint positions (meters or degrees).
+     * @param waypointVelocity Ignored.
+     * @param waypointAcceleration Ignored.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool addWaypoint(const std::vector<double>& waypoint,
+                             const std::vector<double>& waypointVelocity = std::vector<double>(),
+                             const std::vector<double>& waypointAcceleration = std::vector<double>());
+
+    /** @brief Not supported, path is fixed by the recording */
+    virtual bool configurePath(int pathType);
+    /** @brief Not supported, velocity profile is fixed by the recording */
+    virtual bool configureVelocityProfile(int velocityProfileType);
+
+    virtual bool create();
+    virtual bool destroy();
+
+    /**
+     * @brief Set time between consecutive samples
+     *
+     * @param period Sampling period in seconds.
+     *
+     * @return true on success, false otherwise
+     */
+    bool setPeriod(double period);
+
+    /**
+     * @brief Identify the recorded motion
+     *
+     * @param command Command vocab, e.g. VOCAB_CC_MOVL.
+     * @param frame Reference frame the goal is expressed in, e.g. ICartesianSolver::BASE_FRAME.
+     * @param start Joint positions at the start of the motion.
+     * @param goal Flattened command targets.
+     * @param tool Tool appended to the kinematic chain, empty if none.
+     */
+    void setKey(int command, int frame, const std::vector<double>& start, const std::vector<double>& goal,
+                const std::vector<double>& tool);
+
+    /**
+     * @brief Check whether this recording may replace a new motion
+     *
+     * @param command Command vocab, must be the same.
+     * @param frame Reference frame of the goal, must be the same.
+     * @param start Joint positions, each within startTolerance of the recorded ones.
+     * @param goal Flattened command targets, each within goalTolerance of the recorded ones.
+     * @param tool Tool appended to the kinematic chain, each value within goalTolerance of the recorded ones.
+     * @param startTolerance Maximum joint position deviation.
+     * @param goalTolerance Maximum target and tool deviation.
+     *
+     * @return true if this recording matches the motion
+     */
+    bool matches(int command, int frame, const std::vector<double>& start, const std::vector<double>& goal,
+                 const std::vector<double>& tool, double startTolerance, double goalTolerance) const;
+
+    /**
+     * @brief Store a created trajectory along with its key
+     *
+     * @param filename Path to the output file, overwritten if it exists.
+     *
+     * @return true on success, false otherwise
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Load and create a trajectory stored with @ref save
+     *
+     * @param filename Path to the input file.
+     *
+     * @return true on success, false otherwise
+     */
+    bool load(const std::string& filename);
+
+private:
+
+    double period;
+    bool created;
+
+    int numJoints;
+    int numSamples;
+
+    int command;
+    int frame;
+    std::vector<double> start, goal, tool;
+
+    //! Joint positions, one row per sample
+    std::vector<double> samples;
+};
+
+}  // namespace roboticslab
+
+#endif  // __RECORDED_JOINT_TRAJECTORY_HPP__
@@ -0,0 +1,548 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "SplineJointTrajectory.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include <yarp/os/LogStream.h>
+
+#define DURATION_NOT_SET -1
+
+namespace
+{
+    const int NUM_COEFFS = 6;
+
+    // peak speed and acceleration of a rest-to-rest segment, in units of d/T and d/T^2
+    const double CUBIC_PEAK_VEL = 1.5;
+    const double CUBIC_PEAK_ACC = 6.0;
+    const double QUINTIC_PEAK_VEL = 1.875;
+    const double QUINTIC_PEAK_ACC = 5.773502691896258; // 10/sqrt(3)
+
+    // relative slack on the acceleration limit, and bounds on the segment stretching loop
+    const double ACC_TOLERANCE = 1e-9;
+    const double MIN_STRETCH = 1.01;
+    const int MAX_STRETCH_ITERATIONS = 1000;
+
+    inline double sign(double val)
+    {
+        return (0.0 < val) - (val < 0.0);
+    }
+
+    inline double accelerationAt(const double * a, double t)
+    {
+        return 2 * a[2] + t * (6 * a[3] + t * (12 * a[4] + t * 20 * a[5]));
+    }
+
+    // acceleration is at most cubic in t, its extrema lie at the ends or where jerk vanishes
+    double peakAcceleration(const double * a, double T)
+    {
+        double peak = std::max(std::abs(accelerationAt(a, 0.0)), std::abs(accelerationAt(a, T)));
+
+        // jerk: 6 a3 + 24 a4 t + 60 a5 t^2
+        double c2 = 60 * a[5], c1 = 24 * a[4], c0 = 6 * a[3];
+        double roots[2];
+        int numRoots = 0;
+
+        if (c2 != 0.0)
+        {
+            double disc = c1 * c1 - 4 * c2 * c0;
+
+            if (disc >= 0.0)
+            {
+                roots[numRoots++] = (-c1 + std::sqrt(disc)) / (2 * c2);
+                roots[numRoots++] = (-c1 - std::sqrt(disc)) / (2 * c2);
+            }
+        }
+        else if (c1 != 0.0)
+        {
+            roots[numRoots++] = -c0 / c1;
+        }
+
+        for (int i = 0; i < numRoots; i++)
+        {
+            if (roots[i] > 0.0 && roots[i] < T)
+            {
+                peak = std::max(peak, std::abs(accelerationAt(a, roots[i])));
+            }
+        }
+
+        return peak;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::SplineJointTrajectory::SplineJointTrajectory()
+    : duration(DURATION_NOT_SET),
+      maxVelocity(DEFAULT_JOINT_MAX_VEL),
+      maxAcceleration(DEFAULT_JOINT_MAX_ACC),
+      pathType(CUBIC_SPLINE),
+      configuredPath(false),
+      configuredVelocityProfile(false),
+      created(false),
+      numJoints(0)
+{}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::getDuration(double* duration) const
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    *duration = times.back();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::getPosition(double movementTime, std::vector<double>& position)
+{
+    position.resize(numJoints);
+    return getState(movementTime, position.data(), NULL, NULL);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::getVelocity(double movementTime, std::vector<double>& velocity)
+{
+    velocity.resize(numJoints);
+    return getState(movementTime, NULL, velocity.data(), NULL);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::getAcceleration(double movementTime, std::vector<double>& acceleration)
+{
+    acceleration.resize(numJoints);
+    return getState(movementTime, NULL, NULL, acceleration.data());
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::getState(double movementTime, double * position, double * velocity,
+        double * acceleration)
+{
+    if (!created)
+    {
+        yError() << "Trajectory not created";
+        return false;
+    }
+
+    int numSegments = times.size() - 1;
+
+    // last segment whose start time is not after the given time
+    std::vector<double>::const_iterator it = std::upper_bound(times.begin(), times.end(), movementTime);
+    int segment = std::min(std::max(0, static_cast<int>(it - times.begin()) - 1), numSegments - 1);
+
+    double T = times[segment + 1] - times[segment];
+    double t = std::min(std::max(0.0, movementTime - times[segment]), T);
+
+    for (int joint = 0; joint < numJoints; joint++)
+    {
+        const double * a = coeffs.data() + (segment * numJoints + joint) * NUM_COEFFS;
+
+        if (position)
+        {
+            position[joint] = a[0] + t * (a[1] + t * (a[2] + t * (a[3] + t * (a[4] + t * a[5]))));
+        }
+
+        if (velocity)
+        {
+            velocity[joint] = a[1] + t * (2 * a[2] + t * (3 * a[3] + t * (4 * a[4] + t * 5 * a[5])));
+        }
+
+        if (acceleration)
+        {
+            acceleration[joint] = 2 * a[2] + t * (6 * a[3] + t * (12 * a[4] + t * 20 * a[5]));
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::setDuration(double duration)
+{
+    this->duration = duration;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::setMaxVelocity(double maxVelocity)
+{
+    if (maxVelocity <= 0.0)
+    {
+        yError() << "Illegal max velocity:" << maxVelocity;
+        return false;
+    }
+
+    this->maxVelocity = maxVelocity;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::setMaxAcceleration(double maxAcceleration)
+{
+    if (maxAcceleration <= 0.0)
+    {
+        yError() << "Illegal max acceleration:" << maxAcceleration;
+        return false;
+    }
+
+    this->maxAcceleration = maxAcceleration;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::setMaxJointVelocities(const std::vector<double>& maxVelocities)
+{
+    for (size_t joint = 0; joint < maxVelocities.size(); joint++)
+    {
+        if (maxVelocities[joint] <= 0.0)
+        {
+            yError("Illegal max velocity at joint %zu: %f", joint, maxVelocities[joint]);
+            return false;
+        }
+    }
+
+    maxJointVelocities = maxVelocities;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::addWaypoint(const std::vector<double>& waypoint,
+                         const std::vector<double>& waypointVelocity,
+                         const std::vector<double>& waypointAcceleration)
+{
+    if (created)
+    {
+        yWarning() << "Trajectory already created";
+        return false;
+    }
+
+    if (positions.empty())
+    {
+        numJoints = waypoint.size();
+    }
+
+    if (static_cast<int>(waypoint.size()) != numJoints
+            || (!waypointVelocity.empty() && static_cast<int>(waypointVelocity.size()) != numJoints)
+            || (!waypointAcceleration.empty() && static_cast<int>(waypointAcceleration.size()) != numJoints))
+    {
+        yError() << "Waypoint size mismatch, expected" << numJoints << "joints";
+        return false;
+    }
+
+    positions.push_back(waypoint);
+    velocities.push_back(waypointVelocity);
+    accelerations.push_back(waypointAcceleration);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::configurePath(int pathType)
+{
+    if (configuredPath)
+    {
+        yWarning() << "Path already configured";
+        return false;
+    }
+
+    switch (pathType)
+    {
+    case IJointTrajectory::CUBIC_SPLINE:
+    case IJointTrajectory::QUINTIC_SPLINE:
+        this->pathType = pathType;
+        break;
+    default:
+        yError() << "Only CUBIC_SPLINE and QUINTIC_SPLINE joint-space paths implemented for now!";
+        return false;
+    }
+
+    configuredPath = true;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::configureVelocityProfile(int velocityProfileType)
+{
+    if (configuredVelocityProfile)
+    {
+        yWarning() << "Velocity profile already configured";
+        return false;
+    }
+
+    if (velocityProfileType != IJointTrajectory::SYNCHRONIZED)
+    {
+        yError() << "Only SYNCHRONIZED joint-space velocity profile implemented for now!";
+        return false;
+    }
+
+    configuredVelocityProfile = true;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+double roboticslab::SplineJointTrajectory::getMaxVelocity(int joint) const
+{
+    return joint < static_cast<int>(maxJointVelocities.size()) ? maxJointVelocities[joint] : maxVelocity;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::create()
+{
+    if (created)
+    {
+        yWarning() << "Trajectory already created";
+        return false;
+    }
+
+    if (!configuredPath)
+    {
+        yError() << "Path not configured!";
+        return false;
+    }
+
+    if (!configuredVelocityProfile)
+    {
+        yError() << "Velocity profile not configured!";
+        return false;
+    }
+
+    if (positions.size() < 2)
+    {
+        yError() << "At least two waypoints needed, got" << positions.size();
+        return false;
+    }
+
+    if (!maxJointVelocities.empty() && static_cast<int>(maxJointVelocities.size()) != numJoints)
+    {
+        yError() << "Joint velocity limits size mismatch, expected" << numJoints << "joints";
+        return false;
+    }
+
+    const double peakVel = pathType == QUINTIC_SPLINE ? QUINTIC_PEAK_VEL : CUBIC_PEAK_VEL;
+    const double peakAcc = pathType == QUINTIC_SPLINE ? QUINTIC_PEAK_ACC : CUBIC_PEAK_ACC;
+
+    int numSegments = positions.size() - 1;
+
+    //-- Synchronize joints: the slowest one dictates each segment duration
+    times.assign(numSegments + 1, 0.0);
+
+    for (int k = 0; k < numSegments; k++)
+    {
+        double T = 0.0;
+
+        for (int joint = 0; joint < numJoints; joint++)
+        {
+            double distance = std::abs(positions[k + 1][joint] - positions[k][joint]);
+            T = std::max(T, peakVel * distance / getMaxVelocity(joint));
+            T = std::max(T, std::sqrt(peakAcc * distance / maxAcceleration));
+        }
+
+        times[k + 1] = times[k] + T;
+    }
+
+    //-- Stretch in time if requested
+    if (duration != DURATION_NOT_SET && duration > times.back() && times.back() > 0.0)
+    {
+        double factor = duration / times.back();
+
+        for (int k = 0; k <= numSegments; k++)
+        {
+            times[k] *= factor;
+        }
+    }
+
+    //-- Fill in unspecified boundary conditions, via point velocities depend on segment durations
+    std::vector<bool> viaVelocities(numSegments + 1);
+
+    for (int k = 0; k <= numSegments; k++)
+    {
+        viaVelocities[k] = velocities[k].empty();
+
+        if (accelerations[k].empty() || pathType == CUBIC_SPLINE)
+        {
+            accelerations[k].assign(numJoints, 0.0);
+        }
+    }
+
+    coeffs.assign(numSegments * numJoints * NUM_COEFFS, 0.0);
+
+    //-- Segment durations above assume rest-to-rest motion. Through via points, a segment starts
+    //-- or ends moving, and its acceleration peaks higher: stretch it until the real peak fits.
+    for (int iteration = 0; ; iteration++)
+    {
+        for (int k = 0; k <= numSegments; k++)
+        {
+            if (viaVelocities[k])
+            {
+                computeViaVelocity(k);
+            }
+        }
+
+        bool fits = true;
+
+        for (int k = 0; k < numSegments; k++)
+        {
+            computeSegment(k);
+
+            double T = times[k + 1] - times[k];
+            double peak = 0.0;
+
+            for (int joint = 0; T > 0.0 && joint < numJoints; joint++)
+            {
+                peak = std::max(peak, peakAcceleration(coeffs.data() + (k * numJoints + joint) * NUM_COEFFS, T));
+            }
+
+            if (peak > maxAcceleration * (1.0 + ACC_TOLERANCE))
+            {
+                // exact for the rest-to-rest part, which scales with 1/T^2; boundary velocity terms
+                // scale with 1/T and need more passes, the lower bound keeps those finite
+                double delta = T * (std::max(std::sqrt(peak / maxAcceleration), MIN_STRETCH) - 1.0);
+
+                for (int next = k + 1; next <= numSegments; next++)
+                {
+                    times[next] += delta;
+                }
+
+                fits = false;
+            }
+        }
+
+        if (fits)
+        {
+            break;
+        }
+
+        if (iteration == MAX_STRETCH_ITERATIONS)
+        {
+            yError() << "Unable to meet the acceleration limit, check waypoint velocities and accelerations";
+            return false;
+        }
+    }
+
+    created = true;
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::SplineJointTrajectory::computeViaVelocity(int waypoint)
+{
+    int numSegments = times.size() - 1;
+    velocities[waypoint].assign(numJoints, 0.0);
+
+    if (waypoint == 0 || waypoint == numSegments)
+    {
+        return;
+    }
+
+    double T1 = times[waypoint] - times[waypoint - 1];
+    double T2 = times[waypoint + 1] - times[waypoint];
+
+    if (T1 <= 0.0 || T2 <= 0.0)
+    {
+        return;
+    }
+
+    // keep moving through via points unless a joint reverses its direction
+    for (int joint = 0; joint < numJoints; joint++)
+    {
+        double slope1 = (positions[waypoint][joint] - positions[waypoint - 1][joint]) / T1;
+        double slope2 = (positions[waypoint + 1][joint] - positions[waypoint][joint]) / T2;
+
+        if (sign(slope1) == sign(slope2))
+        {
+            velocities[waypoint][joint] = (slope1 + slope2) / 2;
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::SplineJointTrajectory::computeSegment(int segment)
+{
+    double T = times[segment + 1] - times[segment];
+
+    for (int joint = 0; joint < numJoints; joint++)
+    {
+        double * a = coeffs.data() + (segment * numJoints + joint) * NUM_COEFFS;
+
+        double p0 = positions[segment][joint];
+        double p1 = positions[segment + 1][joint];
+        double v0 = velocities[segment][joint];
+        double v1 = velocities[segment + 1][joint];
+        double a0 = accelerations[segment][joint];
+        double a1 = accelerations[segment + 1][joint];
+
+        a[0] = p0;
+
+        if (T <= 0.0)
+        {
+            continue; // repeated waypoint, hold position
+        }
+
+        double h = p1 - p0;
+
+        if (pathType == QUINTIC_SPLINE)
+        {
+            a[1] = v0;
+            a[2] = a0 / 2;
+            a[3] = (20 * h - (8 * v1 + 12 * v0) * T - (3 * a0 - a1) * T * T) / (2 * T * T * T);
+            a[4] = (-30 * h + (14 * v1 + 16 * v0) * T + (3 * a0 - 2 * a1) * T * T) / (2 * T * T * T * T);
+            a[5] = (12 * h - 6 * (v1 + v0) * T + (a1 - a0) * T * T) / (2 * T * T * T * T * T);
+        }
+        else
+        {
+            a[1] = v0;
+            a[2] = (3 * h - (2 * v0 + v1) * T) / (T * T);
+            a[3] = (-2 * h + (v0 + v1) * T) / (T * T * T);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::SplineJointTrajectory::destroy()
+{
+    duration = DURATION_NOT_SET;
+    maxVelocity = DEFAULT_JOINT_MAX_VEL;
+    maxAcceleration = DEFAULT_JOINT_MAX_ACC;
+    maxJointVelocities.clear();
+
+    pathType = CUBIC_SPLINE;
+    configuredPath = configuredVelocityProfile = false;
+    created = false;
+
+    numJoints = 0;
+
+    positions.clear();
+    velocities.clear();
+    accelerations.clear();
+
+    times.clear();
+    coeffs.clear();
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,96 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __SPLINE_JOINT_TRAJECTORY_HPP__
+#define __SPLINE_JOINT_TRAJECTORY_HPP__
+
+#include <vector>
+
+#include "IJointTrajectory.hpp"
+
+#define DEFAULT_JOINT_MAX_VEL 10.0  // unit/s
+#define DEFAULT_JOINT_MAX_ACC 10.0  // unit/s^2
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup TrajectoryLib
+ * @brief Implements joint-space trajectories through waypoints using polynomial splines.
+ *
+ * Each segment between consecutive waypoints is a cubic or quintic polynomial per joint.
+ * Segment durations are shared by all joints and chosen so that the slowest joint stays
+ * within its velocity and acceleration limits. The velocity bound is exact for segments
+ * that start and end at rest, approximate otherwise. Segments through via points are
+ * stretched until their peak acceleration, with the actual boundary velocities, fits the
+ * limit as well. A longer total duration may be requested, in which case the trajectory
+ * is uniformly stretched in time before that check.
+ */
+class SplineJointTrajectory : public IJointTrajectory
+{
+public:
+
+    /**
+     * @brief Constructor
+     */
+    SplineJointTrajectory();
+
+    virtual bool getDuration(double* duration) const;
+    virtual bool getPosition(double movementTime, std::vector<double>& position);
+    virtual bool getVelocity(double movementTime, std::vector<double>& velocity);
+    virtual bool getAcceleration(double movementTime, std::vector<double>& acceleration);
+    virtual bool getState(double movementTime, double * position, double * velocity, double * acceleration);
+
+    /**
+     * @brief Set minimum trajectory duration in seconds
+     *
+     * Shorter durations than allowed by joint limits are ignored.
+     *
+     * @param duration Trajectory total duration in seconds.
+     *
+     * @return true on success, false otherwise
+     */
+    virtual bool setDuration(double duration);
+
+    virtual bool setMaxVelocity(double maxVelocity);
+    virtual bool setMaxAcceleration(double maxAcceleration);
+    virtual bool setMaxJointVelocities(const std::vector<double>& maxVelocities);
+
+    virtual bool addWaypoint(const std::vector<double>& waypoint,
+                             const std::vector<double>& waypointVelocity = std::vector<double>(),
+                             const std::vector<double>& waypointAcceleration = std::vector<double>());
+
+    virtual bool configurePath(int pathType);
+    virtual bool configureVelocityProfile(int velocityProfileType);
+
+    virtual bool create();
+    virtual bool destroy();
+
+private:
+
+    double getMaxVelocity(int joint) const;
+    void computeViaVelocity(int waypoint);
+    void computeSegment(int segment);
+
+    double duration;
+    double maxVelocity, maxAcceleration;
+    std::vector<double> maxJointVelocities;
+
+    int pathType;
+    bool configuredPath, configuredVelocityProfile;
+    bool created;
+
+    int numJoints;
+
+    //! Waypoint data, velocities and accelerations are empty if not specified by user
+    std::vector< std::vector<double> > positions, velocities, accelerations;
+
+    //! Segment start times plus total duration
+    std::vector<double> times;
+
+    //! Polynomial coefficients per segment and joint, lowest order first
+    std::vector<double> coeffs;
+};
+
+}  // namespace roboticslab
+
+#endif  // __SPLINE_JOINT_TRAJECTORY_HPP__
@@ -0,0 +1,148 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "WorkerPool.hpp"
+
+#ifdef __linux__
+# include <pthread.h>
+# include <sched.h>
+#endif
+
+// -----------------------------------------------------------------------------
+
+roboticslab::WorkerPool::WorkerPool(int numWorkers)
+    : generation(0),
+      busyWorkers(0),
+      stopping(false),
+      invoker(nullptr),
+      task(nullptr),
+      numTasks(0),
+      nextTask(0)
+{
+    for (int i = 0; i < numWorkers; i++)
+    {
+        workers.emplace_back(&WorkerPool::loop, this);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+roboticslab::WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wakeup.notify_all();
+
+    for (auto & worker : workers)
+    {
+        worker.join();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::WorkerPool::setAffinity(const std::vector<int> & cpus)
+{
+    if (cpus.empty())
+    {
+        return false;
+    }
+
+#ifdef __linux__
+    bool ok = true;
+
+    for (int i = 0; i < static_cast<int>(workers.size()); i++)
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        CPU_SET(cpus[i % cpus.size()], &cpuset);
+        ok &= pthread_setaffinity_np(workers[i].native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+    }
+
+    return ok;
+#else
+    return false;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::WorkerPool::dispatch(int numTasks, Invoker invoker, void * task)
+{
+    if (workers.empty() || numTasks <= 1)
+    {
+        for (int i = 0; i < numTasks; i++)
+        {
+            invoker(task, i);
+        }
+
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->invoker = invoker;
+        this->task = task;
+        this->numTasks = numTasks;
+        nextTask = 0;
+        busyWorkers = workers.size();
+        generation++;
+    }
+
+    wakeup.notify_all();
+
+    //-- The caller takes its share, then waits for the stragglers
+    execute();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return busyWorkers == 0; });
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::WorkerPool::execute()
+{
+    int i;
+
+    while ((i = nextTask++) < numTasks)
+    {
+        invoker(task, i);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::WorkerPool::loop()
+{
+    unsigned long seen = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeup.wait(lock, [this, seen] { return stopping || generation != seen; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seen = generation;
+        }
+
+        execute();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (--busyWorkers == 0)
+            {
+                done.notify_one();
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,104 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __WORKER_POOL_HPP__
+#define __WORKER_POOL_HPP__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-libraries
+ * @defgroup WorkerPoolLib
+ *
+ * @brief Contains roboticslab::WorkerPool.
+ */
+
+/**
+ * @ingroup WorkerPoolLib
+ * @brief Fixed set of threads that split indexed tasks of a control cycle.
+ *
+ * Each call to @ref run hands out task indices to the workers and the calling
+ * thread, and returns once all of them are done, thus acting as a per-cycle
+ * barrier. Workers sleep in between. Dispatching does not allocate. Tasks must
+ * not throw.
+ */
+class WorkerPool
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param numWorkers Number of threads besides the caller's, none means @ref run is serial.
+     */
+    explicit WorkerPool(int numWorkers = 0);
+
+    /** Destructor, joins all workers */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool & operator=(const WorkerPool &) = delete;
+
+    /** @brief Number of threads besides the caller's */
+    int getNumWorkers() const
+    { return workers.size(); }
+
+    /**
+     * @brief Pin each worker to a CPU
+     *
+     * @param cpus CPU indices, worker i is pinned to cpus[i % cpus.size()].
+     *
+     * @return true on success, false otherwise or if not supported on this platform
+     */
+    bool setAffinity(const std::vector<int> & cpus);
+
+    /**
+     * @brief Run task(i) for i in [0, numTasks), return when all are done
+     *
+     * @param numTasks Number of task indices.
+     * @param task Callable with signature void(int), must outlive the call.
+     */
+    template <typename Task>
+    void run(int numTasks, Task & task)
+    {
+        dispatch(numTasks, &invoke<Task>, &task);
+    }
+
+private:
+
+    typedef void (*Invoker)(void *, int);
+
+    template <typename Task>
+    static void invoke(void * task, int index)
+    {
+        (*static_cast<Task *>(task))(index);
+    }
+
+    void dispatch(int numTasks, Invoker invoker, void * task);
+    void execute();
+    void loop();
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wakeup, done;
+
+    unsigned long generation;
+    int busyWorkers;
+    bool stopping;
+
+    Invoker invoker;
+    void * task;
+    int numTasks;
+    std::atomic<int> nextTask;
+};
+
+}  // namespace roboticslab
+
+#endif  // __WORKER_POOL_HPP__
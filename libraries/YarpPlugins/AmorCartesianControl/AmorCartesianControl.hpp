@@ -56,18 +56,29 @@ public:
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
+    virtual bool movj(const std::vector< std::vector<double> > &xds);
+
     virtual bool relj(const std::vector<double> &xd);
 
     virtual bool movl(const std::vector<double> &xd);
 
+    virtual bool movl(const std::vector< std::vector<double> > &xds);
+
+    virtual bool preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+                         double * failTime = 0, int * failReason = 0);
+
     virtual bool movv(const std::vector<double> &xdotd);
 
     virtual bool gcmp();
 
     virtual bool forc(const std::vector<double> &td);
 
+    virtual bool impd(const std::vector<double> &xd);
+
     virtual bool stopControl();
 
     virtual bool wait(double timeout);
@@ -90,6 +101,8 @@ public:
 
     virtual bool getParameters(std::map<int, double> & params);
 
+    virtual bool setStateObserver(ICartesianStateObserver * observer);
+
     // -------- DeviceDriver declarations. Implementation in DeviceDriverImpl.cpp --------
 
     /**
@@ -77,6 +77,42 @@ bool roboticslab::AmorCartesianControl::inv(const std::vector<double> &xd, std::
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::AmorCartesianControl::inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs)
+{
+    AMOR_VECTOR7 positions;
+
+    if (amor_get_actual_positions(handle, &positions) != AMOR_SUCCESS)
+    {
+        yError() << "amor_get_actual_positions() failed:" << amor_error();
+        return false;
+    }
+
+    std::vector<double> currentQ(AMOR_NUM_JOINTS);
+
+    for (int i = 0; i < AMOR_NUM_JOINTS; i++)
+    {
+        currentQ[i] = KinRepresentation::radToDeg(positions[i]);
+    }
+
+    qs.assign(xds.size(), std::vector<double>());
+
+    bool ok = true;
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        if (!iCartesianSolver->invKin(xds[i], currentQ, qs[i], referenceFrame))
+        {
+            yWarning("invKin() failed for pose %zu", i);
+            qs[i].clear();
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::AmorCartesianControl::movj(const std::vector<double> &xd)
 {
     std::vector<double> qd;
@@ -107,6 +143,19 @@ bool roboticslab::AmorCartesianControl::movj(const std::vector<double> &xd)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::AmorCartesianControl::movj(const std::vector< std::vector<double> > &xds)
+{
+    if (xds.size() == 1)
+    {
+        return movj(xds[0]);
+    }
+
+    yError() << "Multi-waypoint MOVJ is not supported on AMOR";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::AmorCartesianControl::relj(const std::vector<double> &xd)
 {
     if (referenceFrame == ICartesianSolver::TCP_FRAME)
@@ -199,6 +248,28 @@ bool roboticslab::AmorCartesianControl::movl(const std::vector<double> &xd)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::AmorCartesianControl::movl(const std::vector< std::vector<double> > &xds)
+{
+    if (xds.size() == 1)
+    {
+        return movl(xds[0]);
+    }
+
+    yError() << "Blended multi-waypoint MOVL is not supported on AMOR";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::AmorCartesianControl::preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+        double * failTime, int * failReason)
+{
+    yError() << "preview() not supported on AMOR";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::AmorCartesianControl::movv(const std::vector<double> &xdotd)
 {
     if (referenceFrame == ICartesianSolver::TCP_FRAME)
@@ -259,6 +330,14 @@ bool roboticslab::AmorCartesianControl::forc(const std::vector<double> &td)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::AmorCartesianControl::impd(const std::vector<double> &xd)
+{
+    yWarning() << "impd() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::AmorCartesianControl::stopControl()
 {
     currentState = VOCAB_CC_NOT_CONTROLLING;
@@ -588,3 +667,11 @@ bool roboticslab::AmorCartesianControl::getParameters(std::map<int, double> & pa
 }
 
 // -----------------------------------------------------------------------------
+
+bool roboticslab::AmorCartesianControl::setStateObserver(ICartesianStateObserver * observer)
+{
+    yWarning() << "setStateObserver() not supported";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
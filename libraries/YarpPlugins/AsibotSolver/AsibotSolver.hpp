@@ -81,6 +81,21 @@ public:
     // Perform inverse dynamics.
     virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t);
 
+    // Perform inverse dynamics on caller-owned storage.
+    virtual bool invDyn(const double *q, const double *qdot, const double *qdotdot, const double *fexts, int numFexts, double *t);
+
+    // Compute the joint-space inertia matrix.
+    virtual bool massMatrix(const std::vector<double> &q, std::vector<double> &M);
+
+    // Compute pose and geometric Jacobian on caller-owned storage.
+    virtual bool jacobian(const double *q, double *x, double *J);
+
+    // Compute Coriolis and centrifugal joint torques.
+    virtual bool coriolisTorques(const std::vector<double> &q, const std::vector<double> &qdot, std::vector<double> &c);
+
+    // Perform forward dynamics.
+    virtual bool fwdDyn(const std::vector<double> &q, const std::vector<double> &qdot, const std::vector<double> &t, std::vector<double> &qdotdot);
+
 // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
     /**
@@ -495,3 +495,43 @@ bool AsibotSolver::invDyn(const std::vector<double> &q,const std::vector<double>
 }
 
 // -----------------------------------------------------------------------------
+
+bool AsibotSolver::invDyn(const double *q, const double *qdot, const double *qdotdot, const double *fexts, int numFexts, double *t)
+{
+    yWarning() << "invDyn() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::massMatrix(const std::vector<double> &q, std::vector<double> &M)
+{
+    yWarning() << "massMatrix() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::jacobian(const double *q, double *x, double *J)
+{
+    yWarning() << "jacobian() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::coriolisTorques(const std::vector<double> &q, const std::vector<double> &qdot, std::vector<double> &c)
+{
+    yWarning() << "coriolisTorques() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool AsibotSolver::fwdDyn(const std::vector<double> &q, const std::vector<double> &qdot, const std::vector<double> &t, std::vector<double> &qdotdot)
+{
+    yWarning() << "fwdDyn() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
@@ -4,12 +4,22 @@
 
 #include <cmath>
 
+#include <cstdint>
+
 #include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Time.h>
 #include <yarp/os/Vocab.h>
 
+#include "KdlTrajectory.hpp"
+
 using namespace roboticslab;
 
 // -----------------------------------------------------------------------------
@@ -18,6 +28,10 @@ namespace
 {
     double epsilon = 1e-5;
 
+    // keep time-optimal joint speeds slightly below their limits, since these are only
+    // enforced at path samples
+    double pathSpeedMargin = 0.9;
+
     // return -1 for negative numbers, +1 for positive numbers, 0 for zero
     // https://stackoverflow.com/a/4609795
     template <typename T>
@@ -25,6 +39,39 @@ namespace
     {
         return (T(0) < val) - (val < T(0));
     }
+
+    // short tag identifying a tool in cached motion filenames (FNV-1a of its values, rounded)
+    std::string toolTag(const std::vector<double> & tool)
+    {
+        if (tool.empty())
+        {
+            return "none";
+        }
+
+        std::uint32_t hash = 2166136261u;
+
+        for (double value : tool)
+        {
+            std::int64_t rounded = std::llround(value * 1e6);
+
+            for (int i = 0; i < 8; i++)
+            {
+                hash ^= static_cast<std::uint8_t>(rounded >> (8 * i));
+                hash *= 16777619u;
+            }
+        }
+
+        std::ostringstream oss;
+        oss << std::hex << std::setw(8) << std::setfill('0') << hash;
+        return oss.str();
+    }
+
+    std::string cacheFileName(const std::string & dir, const std::string & tag, int index)
+    {
+        std::ostringstream oss;
+        oss << dir << "/motion-" << tag << "-" << index << ".traj";
+        return oss.str();
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -46,6 +93,13 @@ void BasicCartesianControl::setCurrentState(int value)
 
 // -----------------------------------------------------------------------------
 
+double BasicCartesianControl::getTimestamp() const
+{
+    return iPreciselyTimed != NULL ? iPreciselyTimed->getLastInputStamp().getTime() : yarp::os::Time::now();
+}
+
+// -----------------------------------------------------------------------------
+
 bool BasicCartesianControl::checkJointLimits(const std::vector<double> &q)
 {
     for (unsigned int joint = 0; joint < numSolverJoints; joint++)
@@ -113,15 +167,16 @@ bool BasicCartesianControl::checkJointVelocities(const std::vector<double> &qdot
 
 bool BasicCartesianControl::checkControlModes(int mode)
 {
-    std::vector<int> modes(numRobotJoints);
+    //-- Called every control cycle and by streaming commands, reuse the buffer sized in open().
+    std::lock_guard<std::mutex> lock(controlModesMutex);
 
-    if (!iControlMode->getControlModes(modes.data()))
+    if (!iControlMode->getControlModes(controlModes.data()))
     {
         yWarning() << "getControlModes() failed";
         return false;
     }
 
-    return std::all_of(modes.begin(), modes.end(), [mode](int retrievedMode) { return retrievedMode == mode; });
+    return std::all_of(controlModes.begin(), controlModes.end(), [mode](int retrievedMode) { return retrievedMode == mode; });
 }
 
 // -----------------------------------------------------------------------------
@@ -162,9 +217,44 @@ bool BasicCartesianControl::setControlModes(int mode)
 
 // -----------------------------------------------------------------------------
 
+bool BasicCartesianControl::enterJointStreaming()
+{
+    if (!iControlMode->getControlModes(jointStreamingModes.data()))
+    {
+        yWarning() << "getControlModes() failed";
+        return false;
+    }
+
+    return setControlModes(VOCAB_CM_POSITION_DIRECT);
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::leaveJointStreaming()
+{
+    jointTrajectory.reset();
+
+    //-- Torque-like references are stale once the CMC thread is done, hold position instead
+    for (auto & mode : jointStreamingModes)
+    {
+        if (mode == VOCAB_CM_TORQUE || mode == VOCAB_CM_CURRENT || mode == VOCAB_CM_PWM)
+        {
+            mode = VOCAB_CM_POSITION;
+        }
+    }
+
+    if (!iControlMode->setControlModes(jointStreamingModes.data()))
+    {
+        yWarning() << "setControlModes() (to restore) failed";
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 bool BasicCartesianControl::presetStreamingCommand(int command)
 {
     setCurrentState(VOCAB_CC_NOT_CONTROLLING);
+    stopStreamingGenerator();
 
     switch (command)
     {
@@ -182,6 +272,343 @@ bool BasicCartesianControl::presetStreamingCommand(int command)
 
 // -----------------------------------------------------------------------------
 
+bool BasicCartesianControl::isStreamingGeneratorActive() const
+{
+    std::lock_guard<std::mutex> lock(streamingMutex);
+    return streamingGeneratorActive;
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::stopStreamingGenerator()
+{
+    std::lock_guard<std::mutex> lock(streamingMutex);
+    streamingGeneratorActive = false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::lookupGravityTorques(const std::vector<double> &q, double tolerance)
+{
+    //-- A refresh might have raced with a tolerance change, its Jacobian step would be stale
+    if (!gcmpCacheValid || gcmpCacheToolVersion != toolVersion || gcmpCachedTolerance != tolerance)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numRobotJoints; i++)
+    {
+        if (std::abs(q[i] - gcmpCachedQ[i]) >= tolerance)
+        {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < numRobotJoints; i++)
+    {
+        torques[i] = gcmpCachedTorques[i];
+
+        //-- Extrapolate only once every column is in place
+        if (gcmpCacheTaylor && gcmpJacobianColumns == numRobotJoints)
+        {
+            for (int j = 0; j < numRobotJoints; j++)
+            {
+                torques[i] += gcmpTorqueJacobian[i * numRobotJoints + j] * (q[j] - gcmpCachedQ[j]);
+            }
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::refreshGravityTorques(const std::vector<double> &q, double tolerance)
+{
+    gcmpCacheValid = false;
+
+    if (!iCartesianSolver->invDyn(q.data(), NULL, NULL, NULL, 0, gcmpCachedTorques.data()))
+    {
+        return false;
+    }
+
+    std::copy(q.begin(), q.end(), gcmpCachedQ.begin());
+    std::copy(gcmpCachedTorques.begin(), gcmpCachedTorques.end(), torques.begin());
+    gcmpCachedTolerance = tolerance;
+    gcmpJacobianColumns = 0;
+    gcmpCacheToolVersion = toolVersion;
+    gcmpCacheValid = true;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::refineGravityTorqueJacobian()
+{
+    if (!gcmpCacheValid || gcmpJacobianColumns >= numRobotJoints)
+    {
+        return true;
+    }
+
+    //-- Forward difference, one step the size of the cache tolerance. The cached
+    //-- posture doubles as scratch input.
+    const int j = gcmpJacobianColumns;
+    const double qj = gcmpCachedQ[j];
+
+    gcmpCachedQ[j] += gcmpCachedTolerance;
+    bool ok = iCartesianSolver->invDyn(gcmpCachedQ.data(), NULL, NULL, NULL, 0, gcmpScratchTorques.data());
+    gcmpCachedQ[j] = qj;
+
+    if (!ok)
+    {
+        return false;
+    }
+
+    for (int i = 0; i < numRobotJoints; i++)
+    {
+        gcmpTorqueJacobian[i * numRobotJoints + j] = (gcmpScratchTorques[i] - gcmpCachedTorques[i]) / gcmpCachedTolerance;
+    }
+
+    gcmpJacobianColumns++;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+double BasicCartesianControl::getGcmpCacheHitRate() const
+{
+    unsigned int queries = gcmpCacheQueries;
+    return queries != 0 ? static_cast<double>(gcmpCacheHits) / queries : 0.0;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::planMovl(const std::vector< std::vector<double> > &xds, const std::vector<double> &currentQ,
+        std::vector<std::unique_ptr<ICartesianTrajectory>> &plan)
+{
+    std::vector<double> x_base_tcp;
+
+    if (!iCartesianSolver->fwdKin(currentQ, x_base_tcp))
+    {
+        yError() << "fwdKin() failed";
+        return false;
+    }
+
+    std::vector< std::vector<double> > xds_obj(xds.size());
+
+    for (unsigned int k = 0; k < xds.size(); k++)
+    {
+        if (xds[k].size() != x_base_tcp.size())
+        {
+            yError("Waypoint %d size mismatch (got %zu, expected %zu)", k, xds[k].size(), x_base_tcp.size());
+            return false;
+        }
+
+        if (referenceFrame == ICartesianSolver::TCP_FRAME)
+        {
+            if (!iCartesianSolver->changeOrigin(xds[k], x_base_tcp, xds_obj[k]))
+            {
+                yError() << "changeOrigin() failed";
+                return false;
+            }
+        }
+        else
+        {
+            xds_obj[k] = xds[k];
+        }
+    }
+
+    //-- Blend corners if there are intermediate waypoints, otherwise follow a single line
+    int pathType = xds.size() > 1 ? ICartesianTrajectory::ROUNDED_COMPOSITE : ICartesianTrajectory::LINE;
+
+    //-- Path speed limits are derived from the only kinematic chain, if any
+    bool timeOptimal = timeOptimalMovl && x_base_tcp.size() == 6 && !qdotMax.empty();
+
+    if (timeOptimalMovl && !timeOptimal)
+    {
+        yWarning() << "Time-optimal MOVL not available (kinematic tree or unknown joint limits), using trapezoidal profile";
+    }
+
+    plan.clear();
+
+    //-- Create trajectories (one per endpoint if robot is a kin-tree)
+    for (unsigned int i = 0; i < x_base_tcp.size() / 6; i++)
+    {
+        std::vector<double> xd_base_tcp_sub(x_base_tcp.cbegin() + i * 6, x_base_tcp.cbegin() + (i + 1) * 6);
+
+        auto iCartesianTrajectory = std::make_unique<KdlTrajectory>();
+
+        if (!timeOptimal && !iCartesianTrajectory->setDuration(duration))
+        {
+            yError() << "setDuration() failed";
+            return false;
+        }
+
+        if (!iCartesianTrajectory->setBlendRadius(blendRadius))
+        {
+            yError() << "setBlendRadius() failed";
+            return false;
+        }
+
+        if (presampleTrajectories && !iCartesianTrajectory->setSamplingPeriod(cmcPeriodMs * 0.001))
+        {
+            yError() << "setSamplingPeriod() failed";
+            return false;
+        }
+
+        if (!iCartesianTrajectory->addWaypoint(xd_base_tcp_sub))
+        {
+            yError() << "First addWaypoint() failed";
+            return false;
+        }
+
+        for (unsigned int k = 0; k < xds_obj.size(); k++)
+        {
+            std::vector<double> xd_obj_sub(xds_obj[k].cbegin() + i * 6, xds_obj[k].cbegin() + (i + 1) * 6);
+
+            if (!iCartesianTrajectory->addWaypoint(xd_obj_sub))
+            {
+                yError() << "addWaypoint() failed at waypoint" << k;
+                return false;
+            }
+        }
+
+        if (!iCartesianTrajectory->configurePath(pathType))
+        {
+            yError() << "configurePath() failed";
+            return false;
+        }
+
+        int velocityProfileType = ICartesianTrajectory::TRAPEZOIDAL;
+
+        if (timeOptimal)
+        {
+            std::vector< std::vector<double> > positions, tangents;
+            std::vector<double> maxPathSpeeds;
+
+            if (!iCartesianTrajectory->getPathSamples(timeOptimalSamples, positions, tangents))
+            {
+                yError() << "getPathSamples() failed";
+                return false;
+            }
+
+            if (!computePathSpeedLimits(currentQ, positions, tangents, maxPathSpeeds))
+            {
+                yError() << "computePathSpeedLimits() failed";
+                return false;
+            }
+
+            if (!iCartesianTrajectory->setPathSpeedLimits(maxPathSpeeds))
+            {
+                yError() << "setPathSpeedLimits() failed";
+                return false;
+            }
+
+            velocityProfileType = ICartesianTrajectory::TIME_OPTIMAL;
+        }
+
+        if (!iCartesianTrajectory->configureVelocityProfile(velocityProfileType))
+        {
+            yError() << "configureVelocityProfile() failed";
+            return false;
+        }
+
+        if (!iCartesianTrajectory->create())
+        {
+            yError() << "create() failed";
+            return false;
+        }
+
+        plan.push_back(std::move(iCartesianTrajectory));
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::computePathSpeedLimits(const std::vector<double> & q,
+        const std::vector< std::vector<double> > & positions, const std::vector< std::vector<double> > & tangents,
+        std::vector<double> & maxPathSpeeds)
+{
+    std::vector<double> qGuess(q), qSample, dqds;
+
+    maxPathSpeeds.resize(positions.size());
+
+    for (unsigned int i = 0; i < positions.size(); i++)
+    {
+        //-- Follow the path in joint space, each solution seeds the next one
+        if (!iCartesianSolver->invKin(positions[i], qGuess, qSample, ICartesianSolver::BASE_FRAME))
+        {
+            yError() << "invKin() failed at path sample" << i;
+            return false;
+        }
+
+        if (!iCartesianSolver->diffInvKin(qSample, tangents[i], dqds, ICartesianSolver::BASE_FRAME))
+        {
+            yError() << "diffInvKin() failed at path sample" << i;
+            return false;
+        }
+
+        //-- Joint speed scales linearly with path speed
+        double limit = std::numeric_limits<double>::infinity();
+
+        for (int joint = 0; joint < numSolverJoints; joint++)
+        {
+            double rate = std::abs(dqds[joint]);
+
+            if (rate > 0.0)
+            {
+                double qdotLimit = std::min(std::abs(qdotMin[joint]), std::abs(qdotMax[joint]));
+                limit = std::min(limit, pathSpeedMargin * qdotLimit / rate);
+            }
+        }
+
+        if (limit <= 0.0)
+        {
+            yError() << "Null path speed limit at path sample" << i;
+            return false;
+        }
+
+        maxPathSpeeds[i] = limit;
+        qGuess = qSample;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::evaluateTrajectories(double movementTime)
+{
+    // no reallocation unless the number of trajectories grows
+    desiredX.resize(trajectories.size() * 6);
+    desiredXdot.resize(trajectories.size() * 6);
+
+    std::atomic<bool> ok(true);
+
+    //-- Trajectories write to disjoint slices of the output buffers
+    auto evaluate = [this, movementTime, &ok](int i)
+    {
+        double state[ICartesianTrajectory::STATE_SIZE];
+
+        if (!trajectories[i]->getState(movementTime, state))
+        {
+            ok = false;
+            return;
+        }
+
+        std::copy(state, state + 6, desiredX.begin() + i * 6);
+        std::copy(state + 6, state + 12, desiredXdot.begin() + i * 6);
+    };
+
+    trajectoryWorkers->run(trajectories.size(), evaluate);
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
 void BasicCartesianControl::computeIsocronousSpeeds(const std::vector<double> & q, const std::vector<double> & qd,
         std::vector<double> & qdot)
 {
@@ -227,3 +654,255 @@ void BasicCartesianControl::computeIsocronousSpeeds(const std::vector<double> &
 }
 
 // -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::loadTrajectoryCache(const std::vector<double> &tool)
+{
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    trajectoryCache.clear();
+    cacheTool = tool;
+
+    const std::string tag = toolTag(tool);
+
+    //-- Files are numbered consecutively per tool, stop at the first gap
+    for (int i = 0; ; i++)
+    {
+        std::string file = cacheFileName(trajectoryCacheDir, tag, i);
+
+        if (!std::ifstream(file.c_str()))
+        {
+            break;
+        }
+
+        RecordedJointTrajectory & cached = trajectoryCache[file];
+
+        if (!cached.load(file))
+        {
+            yError() << "Unable to load cached motion:" << file;
+            trajectoryCache.clear();
+            return false;
+        }
+    }
+
+    yInfo() << "Loaded" << trajectoryCache.size() << "cached motions of tool" << tag << "from" << trajectoryCacheDir;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool BasicCartesianControl::replayCachedMotion(int command, const std::vector<double> &currentQ, const std::vector<double> &goal)
+{
+    if (!replayMotions)
+    {
+        return false;
+    }
+
+    std::unique_ptr<RecordedJointTrajectory> replay;
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        for (const auto & entry : trajectoryCache)
+        {
+            if (entry.second.matches(command, referenceFrame, currentQ, goal, cacheTool, cacheStartTolerance, cacheGoalTolerance))
+            {
+                replay.reset(new RecordedJointTrajectory(entry.second));
+                yInfo() << "Replaying cached motion:" << entry.first;
+                break;
+            }
+        }
+    }
+
+    if (!replay)
+    {
+        return false;
+    }
+
+    desiredQ = currentQ;
+    desiredQdot.assign(numRobotJoints, 0.0);
+
+    jointTrajectory = std::move(replay);
+
+    if (!enterJointStreaming())
+    {
+        yWarning() << "Unable to set position direct mode, planning motion instead";
+        jointTrajectory.reset();
+        return false;
+    }
+
+    //-- Set state, enable CMC thread and wait for movement to be done
+    movementStartTime = yarp::os::Time::now();
+    cmcSuccess = true;
+
+    setCurrentState(command == VOCAB_CC_MOVL ? VOCAB_CC_MOVL_CONTROLLING : VOCAB_CC_MOVJ_CONTROLLING);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::startRecording(int command, const std::vector<double> &currentQ, const std::vector<double> &goal)
+{
+    if (!recordMotions)
+    {
+        return;
+    }
+
+    std::unique_ptr<RecordedJointTrajectory> recording;
+    std::string file, tag;
+
+    //-- Firmware MOVJ setpoints are unknown, only the target is
+    if (command == VOCAB_CC_MOVJ && !jointTrajectory)
+    {
+        yWarning() << "MOVJ not streamed (see --movjInterpolation), not recording";
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+
+        //-- Overwrite the previous recording of the same motion, if any
+        for (const auto & entry : trajectoryCache)
+        {
+            if (entry.second.matches(command, referenceFrame, currentQ, goal, cacheTool, cacheStartTolerance, cacheGoalTolerance))
+            {
+                file = entry.first;
+                break;
+            }
+        }
+
+        tag = toolTag(cacheTool);
+
+        recording.reset(new RecordedJointTrajectory);
+        recording->setPeriod(cmcPeriodMs * 0.001);
+        recording->setKey(command, referenceFrame, currentQ, goal, cacheTool);
+        recording->addWaypoint(currentQ);
+    }
+
+    //-- Replaces an aborted recording, if any
+    std::lock_guard<std::mutex> lock(recordingMutex);
+    this->recording = std::move(recording);
+    recordingFile = file;
+    recordingTag = tag;
+    recordedQ = currentQ;
+    recordingComplete = false;
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::recordPositions(const std::vector<double> &qd)
+{
+    std::lock_guard<std::mutex> lock(recordingMutex);
+
+    if (recording)
+    {
+        recording->addWaypoint(qd);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::recordVelocities(const std::vector<double> &qdot)
+{
+    std::lock_guard<std::mutex> lock(recordingMutex);
+
+    if (recording)
+    {
+        //-- Joints beyond the solver's are not commanded
+        for (unsigned int i = 0; i < qdot.size(); i++)
+        {
+            recordedQ[i] += qdot[i] * cmcPeriodMs * 0.001;
+        }
+
+        recording->addWaypoint(recordedQ);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::finishRecording()
+{
+    std::lock_guard<std::mutex> lock(recordingMutex);
+    recordingComplete = false;
+
+    if (!recording)
+    {
+        return;
+    }
+
+    if (pendingRecording)
+    {
+        yWarning() << "Previous recording not stored yet, dropping the last one";
+        recording.reset();
+        return;
+    }
+
+    //-- No allocations here, file I/O is left to the recording thread
+    pendingRecording = std::move(recording);
+    pendingRecordingFile.swap(recordingFile);
+    pendingRecordingTag.swap(recordingTag);
+    recordingCondition.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::saveRecordings()
+{
+    std::unique_lock<std::mutex> lock(recordingMutex);
+
+    while (true)
+    {
+        recordingCondition.wait(lock, [this] { return pendingRecording || stopRecordingThread; });
+
+        //-- Pending recordings are stored before leaving
+        if (!pendingRecording)
+        {
+            return;
+        }
+
+        std::unique_ptr<RecordedJointTrajectory> recorded = std::move(pendingRecording);
+        std::string file = pendingRecordingFile;
+        std::string tag = pendingRecordingTag;
+
+        lock.unlock();
+        storeRecording(*recorded, file, tag);
+        lock.lock();
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void BasicCartesianControl::storeRecording(RecordedJointTrajectory &recorded, std::string file, const std::string &tag)
+{
+    if (!recorded.create())
+    {
+        yWarning() << "Unable to create recorded trajectory";
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    //-- New motion, first free slot of its tool
+    for (int i = 0; file.empty(); i++)
+    {
+        std::string candidate = cacheFileName(trajectoryCacheDir, tag, i);
+
+        if (trajectoryCache.find(candidate) == trajectoryCache.end() && !std::ifstream(candidate.c_str()))
+        {
+            file = candidate;
+        }
+    }
+
+    if (!recorded.save(file))
+    {
+        yWarning() << "Unable to store recorded motion, keeping it in memory only";
+    }
+
+    yInfo() << "Recorded motion:" << file;
+
+    //-- The tool might have changed meanwhile, its file is kept for later anyway
+    if (tag == toolTag(cacheTool))
+    {
+        trajectoryCache[file] = std::move(recorded);
+    }
+}
+
+// -----------------------------------------------------------------------------
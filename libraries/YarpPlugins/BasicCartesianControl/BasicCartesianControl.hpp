@@ -3,8 +3,13 @@
 #ifndef __BASIC_CARTESIAN_CONTROL_HPP__
 #define __BASIC_CARTESIAN_CONTROL_HPP__
 
+#include <atomic>
+#include <condition_variable>
+#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <yarp/os/all.h>
@@ -17,14 +22,31 @@
 #include "ICartesianControl.h"
 
 #include "ICartesianTrajectory.hpp"
+#include "IJointTrajectory.hpp"
+#include "OnlineTrajectoryGenerator.hpp"
+#include "RecordedJointTrajectory.hpp"
+#include "WorkerPool.hpp"
 
 #define DEFAULT_SOLVER "KdlSolver"
 #define DEFAULT_ROBOT "remote_controlboard"
 #define DEFAULT_GAIN 0.05
 #define DEFAULT_DURATION 10.0
+#define DEFAULT_BLEND_RADIUS 0.01
+#define DEFAULT_TIME_OPTIMAL_SAMPLES 50
+#define DEFAULT_MOVJ_INTERPOLATION "firmware"
+#define DEFAULT_MOVJ_MAX_ACC 50.0 // [deg/s^2]
+#define DEFAULT_TRAJECTORY_CACHE "off"
+#define DEFAULT_CACHE_START_TOLERANCE 0.1 // [deg]
+#define DEFAULT_CACHE_GOAL_TOLERANCE 1e-3
+#define DEFAULT_GCMP_CACHE_TOLERANCE 0.0 // [deg]
+#define DEFAULT_IMPD_STIFFNESS "500 500 500 20 20 20" // [N/m, Nm/rad]
+#define DEFAULT_IMPD_DAMPING "50 50 50 2 2 2" // [Ns/m, Nms/rad]
+#define DEFAULT_TRAJECTORY_WORKERS 0
 #define DEFAULT_CMC_PERIOD_MS 50
 #define DEFAULT_WAIT_PERIOD_MS 30
 #define DEFAULT_REFERENCE_FRAME "base"
+#define DEFAULT_STREAMING_MAX_ACC 100.0 // [deg/s^2]
+#define DEFAULT_STREAMING_MAX_JERK 1000.0 // [deg/s^3]
 
 namespace roboticslab
 {
@@ -59,7 +81,7 @@ We connect, can ask for help, etc. Here's an example interaction:
 \verbatim
 [on terminal 3] yarp rpc /CartesianControl/rpc_transform:s
 [>>] help
-Response: [stat] [inv] [movj] [movl] [movv] [gcmp] [forc] [stop]
+Response: [stat] [inv] [movj] [movl] [movv] [gcmp] [forc] [impd] [stop]
 [>>] stat
 Response: [ccnc] 1.0 0.0 0.0 0.0 0.0 1.0 0.0
 \endverbatim
@@ -126,14 +148,39 @@ public:
                               referenceFrame(ICartesianSolver::BASE_FRAME),
                               gain(DEFAULT_GAIN),
                               duration(DEFAULT_DURATION),
+                              blendRadius(DEFAULT_BLEND_RADIUS),
+                              presampleTrajectories(false),
+                              timeOptimalMovl(false),
+                              timeOptimalSamples(DEFAULT_TIME_OPTIMAL_SAMPLES),
+                              streamMovj(false),
+                              movjPathType(IJointTrajectory::QUINTIC_SPLINE),
+                              movjMaxAcc(DEFAULT_MOVJ_MAX_ACC),
+                              recordMotions(false),
+                              replayMotions(false),
+                              cacheStartTolerance(DEFAULT_CACHE_START_TOLERANCE),
+                              cacheGoalTolerance(DEFAULT_CACHE_GOAL_TOLERANCE),
+                              recordingComplete(false),
+                              stopRecordingThread(false),
+                              gcmpCacheTolerance(DEFAULT_GCMP_CACHE_TOLERANCE),
+                              gcmpCacheTaylor(false),
+                              gcmpCacheValid(false),
+                              gcmpCacheToolVersion(0),
+                              gcmpCachedTolerance(0.0),
+                              gcmpJacobianColumns(0),
+                              gcmpCacheHits(0),
+                              gcmpCacheQueries(0),
+                              onlineStreaming(false),
+                              streamingGeneratorActive(false),
                               cmcPeriodMs(DEFAULT_CMC_PERIOD_MS),
                               waitPeriodMs(DEFAULT_WAIT_PERIOD_MS),
                               numRobotJoints(0),
                               numSolverJoints(0),
                               currentState(VOCAB_CC_NOT_CONTROLLING),
                               streamingCommand(VOCAB_CC_NOT_SET),
+                              toolVersion(0),
                               movementStartTime(0),
-                              cmcSuccess(true)
+                              cmcSuccess(true),
+                              stateObserver(NULL)
     {}
 
     // -- ICartesianControl declarations. Implementation in ICartesianControlImpl.cpp--
@@ -142,18 +189,29 @@ public:
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
+    virtual bool movj(const std::vector< std::vector<double> > &xds);
+
     virtual bool relj(const std::vector<double> &xd);
 
     virtual bool movl(const std::vector<double> &xd);
 
+    virtual bool movl(const std::vector< std::vector<double> > &xds);
+
+    virtual bool preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+                         double * failTime = 0, int * failReason = 0);
+
     virtual bool movv(const std::vector<double> &xdotd);
 
     virtual bool gcmp();
 
     virtual bool forc(const std::vector<double> &td);
 
+    virtual bool impd(const std::vector<double> &xd);
+
     virtual bool stopControl();
 
     virtual bool wait(double timeout);
@@ -176,6 +234,8 @@ public:
 
     virtual bool getParameters(std::map<int, double> & params);
 
+    virtual bool setStateObserver(ICartesianStateObserver * observer);
+
     // -------- PeriodicThread declarations. Implementation in PeriodicThreadImpl.cpp --------
 
     /** Loop function. This is the thread itself. */
@@ -208,6 +268,7 @@ protected:
 
     int getCurrentState() const;
     void setCurrentState(int value);
+    double getTimestamp() const;
 
     bool checkJointLimits(const std::vector<double> &q);
     bool checkJointLimits(const std::vector<double> &q, const std::vector<double> &qdot);
@@ -215,14 +276,41 @@ protected:
 
     bool checkControlModes(int mode);
     bool setControlModes(int mode);
+    bool enterJointStreaming();
+    void leaveJointStreaming();
     bool presetStreamingCommand(int command);
     void computeIsocronousSpeeds(const std::vector<double> & q, const std::vector<double> & qd, std::vector<double> & qdot);
+    bool planMovl(const std::vector< std::vector<double> > &xds, const std::vector<double> &currentQ,
+                  std::vector<std::unique_ptr<ICartesianTrajectory>> &plan);
+    bool computePathSpeedLimits(const std::vector<double> & q, const std::vector< std::vector<double> > & positions,
+                                const std::vector< std::vector<double> > & tangents, std::vector<double> & maxPathSpeeds);
+
+    bool evaluateTrajectories(double movementTime);
+
+    bool loadTrajectoryCache(const std::vector<double> &tool);
+    bool replayCachedMotion(int command, const std::vector<double> &currentQ, const std::vector<double> &goal);
+    void startRecording(int command, const std::vector<double> &currentQ, const std::vector<double> &goal);
+    void recordPositions(const std::vector<double> &qd);
+    void recordVelocities(const std::vector<double> &qdot);
+    void finishRecording();
+    void saveRecordings();
+    void storeRecording(RecordedJointTrajectory &recorded, std::string file, const std::string &tag);
 
     void handleMovj(const std::vector<double> &q);
-    void handleMovl(const std::vector<double> &q);
-    void handleMovv(const std::vector<double> &q);
+    void handleJointStreaming(const std::vector<double> &q);
+    void handleMovl(const std::vector<double> &q, const std::vector<double> &currentX);
+    void handleMovv(const std::vector<double> &q, const std::vector<double> &currentX);
     void handleGcmp(const std::vector<double> &q);
+    bool lookupGravityTorques(const std::vector<double> &q, double tolerance);
+    bool refreshGravityTorques(const std::vector<double> &q, double tolerance);
+    bool refineGravityTorqueJacobian();
+    double getGcmpCacheHitRate() const;
     void handleForc(const std::vector<double> &q);
+    void handleImpd(const std::vector<double> &q);
+    void handleMovi(const std::vector<double> &q);
+
+    bool isStreamingGeneratorActive() const;
+    void stopStreamingGenerator();
 
     yarp::dev::PolyDriver solverDevice;
     ICartesianSolver *iCartesianSolver;
@@ -240,6 +328,63 @@ protected:
 
     double gain;
     double duration; // [s]
+    double blendRadius; // [m]
+
+    /** MOVL evaluate trajectories from tables sampled at CMC rate */
+    bool presampleTrajectories;
+
+    /** MOVL time-optimal parameterization under joint velocity limits, sampled along the path */
+    bool timeOptimalMovl;
+    int timeOptimalSamples;
+
+    /** MOVJ stream spline setpoints through position direct mode at CMC rate instead of relying on firmware */
+    bool streamMovj;
+    int movjPathType;
+    double movjMaxAcc; // [deg/s^2]
+
+    /** MOVJ/MOVL record commanded joint positions at CMC rate, replay them through position direct mode
+     *  instead of planning when start, goal and tool match */
+    bool recordMotions;
+    bool replayMotions;
+    std::string trajectoryCacheDir;
+    double cacheStartTolerance; // [deg]
+    double cacheGoalTolerance;
+    std::map<std::string, RecordedJointTrajectory> trajectoryCache; // motions of cacheTool, by file
+    std::vector<double> cacheTool; // empty if no tool
+    std::mutex cacheMutex;
+
+    /** Motion being recorded by the CMC thread, file is empty unless it replaces a cached one */
+    std::unique_ptr<RecordedJointTrajectory> recording;
+    std::string recordingFile, recordingTag;
+    std::vector<double> recordedQ; // MOVL integrated velocity commands
+    std::atomic<bool> recordingComplete;
+
+    /** Completed recording handed over to recordingThread, which stores it off the CMC thread */
+    std::unique_ptr<RecordedJointTrajectory> pendingRecording;
+    std::string pendingRecordingFile, pendingRecordingTag;
+    bool stopRecordingThread;
+    std::mutex recordingMutex;
+    std::condition_variable recordingCondition;
+    std::thread recordingThread;
+
+    /** GCMP reuse gravity torques while joints stay within tolerance of the cached posture,
+     *  optionally extrapolated to first order through the gravity torque Jacobian, which is
+     *  refined one column per cycle after each refresh */
+    std::atomic<double> gcmpCacheTolerance; // [deg]
+    bool gcmpCacheTaylor;
+    std::atomic<bool> gcmpCacheValid;
+    int gcmpCacheToolVersion;
+    double gcmpCachedTolerance; // Jacobian step [deg]
+    int gcmpJacobianColumns;
+    std::vector<double> gcmpCachedQ, gcmpCachedTorques, gcmpScratchTorques;
+    std::vector<double> gcmpTorqueJacobian; // row-major, [Nm/deg]
+    std::atomic<unsigned int> gcmpCacheHits, gcmpCacheQueries;
+
+    /** MOVI smooth sparse targets into jerk-limited joint setpoints at CMC rate */
+    bool onlineStreaming;
+    bool streamingGeneratorActive;
+    OnlineTrajectoryGenerator streamingGenerator;
+    mutable std::mutex streamingMutex;
 
     int cmcPeriodMs;
     int waitPeriodMs;
@@ -247,25 +392,61 @@ protected:
     int currentState;
     int streamingCommand;
 
+    /** Incremented on each successful tool change, lets clients keep local solvers in sync */
+    int toolVersion;
+
     mutable std::mutex stateMutex;
 
     /** MOVJ store previous reference speeds */
     std::vector<double> vmoStored;
 
+    /** MOVJ store joint trajectory and setpoint buffers (streaming mode), also MOVL replay */
+    std::unique_ptr<IJointTrajectory> jointTrajectory;
+    std::vector<double> desiredQ, desiredQdot;
+    std::vector<int> jointStreamingModes; // restored once the last setpoint is sent
+
     /** MOVL keep track of movement start time to know at what time of trajectory movement we are */
     double movementStartTime;
 
     /** MOVL store Cartesian trajectory */
     std::vector<std::unique_ptr<ICartesianTrajectory>> trajectories;
 
-    /** FORC desired Cartesian force */
-    std::vector<double> td;
+    /** MOVL/MOVV desired Cartesian position and velocity, stacked per trajectory and reused each cycle */
+    std::vector<double> desiredX, desiredXdot;
+
+    /** MOVL/MOVV evaluate one trajectory per endpoint concurrently */
+    std::unique_ptr<WorkerPool> trajectoryWorkers;
+
+    /** FORC desired Cartesian force, flattened as zero wrenches followed by the force applied on the last segment */
+    std::vector<double> forceFexts;
+    std::mutex forceMutex;
+
+    /** Control modes retrieved by checkControlModes(), shared by the CMC and command threads */
+    std::vector<int> controlModes;
+    std::mutex controlModesMutex;
+
+    /** Joint positions and GCMP/FORC/IMPD torques, sized once and reused each cycle */
+    std::vector<double> qMeasured, torques;
+
+    /** MOVI joint setpoints and velocities drawn from the streaming generator, sized once and reused each cycle */
+    std::vector<double> moviQRef, moviQdotRef;
+
+    /** IMPD equilibrium pose, diagonal task-space stiffness [N/m, Nm/rad] and damping [Ns/m, Nms/rad] */
+    std::vector<double> impdXd, impdStiffness, impdDamping;
+    std::mutex impdMutex; // guards impdXd
+
+    /** IMPD joint velocities, TCP pose, Jacobian (row-major) and task-space wrench, sized once and reused each cycle */
+    std::vector<double> qdotMeasured, impdX, impdJ, impdWrench;
 
     bool cmcSuccess;
 
     std::vector<double> qMin, qMax;
     std::vector<double> qdotMin, qdotMax;
     std::vector<double> qRefSpeeds;
+
+    /** Receives FK computed each control cycle */
+    ICartesianStateObserver * stateObserver;
+    mutable std::mutex observerMutex;
 };
 
 }  // namespace roboticslab
@@ -2,6 +2,9 @@
 
 #include "BasicCartesianControl.hpp"
 
+#include <cmath>
+#include <algorithm>
+
 #include <yarp/os/LogStream.h>
 
 // ------------------- DeviceDriver Related ------------------------------------
@@ -16,6 +19,152 @@ bool roboticslab::BasicCartesianControl::open(yarp::os::Searchable& config)
     duration = config.check("trajectoryDuration", yarp::os::Value(DEFAULT_DURATION),
             "trajectory duration (seconds)").asFloat64();
 
+    blendRadius = config.check("blendRadius", yarp::os::Value(DEFAULT_BLEND_RADIUS),
+            "corner blend radius of multi-waypoint linear moves (meters)").asFloat64();
+
+    presampleTrajectories = config.check("presampleTrajectories",
+            "pre-sample MOVL trajectories at CMC rate, interpolate in control loop");
+
+    timeOptimalMovl = config.check("timeOptimalMovl",
+            "MOVL as fast as joint velocity limits allow, ignores trajectory duration");
+
+    timeOptimalSamples = config.check("timeOptimalSamples", yarp::os::Value(DEFAULT_TIME_OPTIMAL_SAMPLES),
+            "number of path samples for time-optimal MOVL").asInt32();
+
+    //-- Both ends are at rest, at least one interior sample is needed to move
+    if (timeOptimalMovl && timeOptimalSamples < 3)
+    {
+        yError() << "Illegal number of time-optimal MOVL samples:" << timeOptimalSamples;
+        return false;
+    }
+
+    std::string movjInterpolationStr = config.check("movjInterpolation", yarp::os::Value(DEFAULT_MOVJ_INTERPOLATION),
+            "MOVJ interpolation (firmware|cubic|quintic), splines are streamed at CMC rate").asString();
+
+    if (movjInterpolationStr == "firmware")
+    {
+        streamMovj = false;
+    }
+    else if (movjInterpolationStr == "cubic")
+    {
+        streamMovj = true;
+        movjPathType = IJointTrajectory::CUBIC_SPLINE;
+    }
+    else if (movjInterpolationStr == "quintic")
+    {
+        streamMovj = true;
+        movjPathType = IJointTrajectory::QUINTIC_SPLINE;
+    }
+    else
+    {
+        yError() << "Unsupported MOVJ interpolation:" << movjInterpolationStr;
+        return false;
+    }
+
+    movjMaxAcc = config.check("movjMaxAcc", yarp::os::Value(DEFAULT_MOVJ_MAX_ACC),
+            "streamed MOVJ max joint acceleration (meters/second^2 or degrees/second^2)").asFloat64();
+
+    std::string trajectoryCacheStr = config.check("trajectoryCache", yarp::os::Value(DEFAULT_TRAJECTORY_CACHE),
+            "MOVJ (streamed only)/MOVL cache of commanded joint positions per tool (off|record|replay)").asString();
+
+    if (trajectoryCacheStr == "record")
+    {
+        recordMotions = true;
+    }
+    else if (trajectoryCacheStr == "replay")
+    {
+        replayMotions = true;
+    }
+    else if (trajectoryCacheStr != "off")
+    {
+        yError() << "Unsupported trajectory cache mode:" << trajectoryCacheStr;
+        return false;
+    }
+
+    trajectoryCacheDir = config.check("trajectoryCacheDir", yarp::os::Value("."),
+            "directory of cached motion files").asString();
+
+    cacheStartTolerance = config.check("cacheStartTolerance", yarp::os::Value(DEFAULT_CACHE_START_TOLERANCE),
+            "max joint deviation from a cached motion start (meters or degrees)").asFloat64();
+
+    cacheGoalTolerance = config.check("cacheGoalTolerance", yarp::os::Value(DEFAULT_CACHE_GOAL_TOLERANCE),
+            "max deviation from cached motion targets (Cartesian coordinates)").asFloat64();
+
+    if ((recordMotions || replayMotions) && !loadTrajectoryCache(std::vector<double>()))
+    {
+        yError() << "Unable to load trajectory cache from:" << trajectoryCacheDir;
+        return false;
+    }
+
+    gcmpCacheTolerance = config.check("gcmpCacheTolerance", yarp::os::Value(DEFAULT_GCMP_CACHE_TOLERANCE),
+            "GCMP max joint deviation from the posture of cached gravity torques (meters or degrees, 0: no cache)").asFloat64();
+
+    if (gcmpCacheTolerance < 0.0)
+    {
+        yError() << "Illegal GCMP cache tolerance:" << gcmpCacheTolerance.load();
+        return false;
+    }
+
+    gcmpCacheTaylor = config.check("gcmpCacheTaylor",
+            "GCMP extrapolate cached gravity torques through their Jacobian (finite differences)");
+
+    yarp::os::Bottle impdStiffnessBottle(config.check("impdStiffness", yarp::os::Value(DEFAULT_IMPD_STIFFNESS),
+            "IMPD task-space stiffness (bottle of 6 doubles, N/m and Nm/rad)").asString());
+
+    yarp::os::Bottle impdDampingBottle(config.check("impdDamping", yarp::os::Value(DEFAULT_IMPD_DAMPING),
+            "IMPD task-space damping (bottle of 6 doubles, Ns/m and Nms/rad)").asString());
+
+    if (impdStiffnessBottle.size() != 6 || impdDampingBottle.size() != 6)
+    {
+        yError() << "Expected 6-element IMPD stiffness and damping, got" << impdStiffnessBottle.size() << "and" << impdDampingBottle.size();
+        return false;
+    }
+
+    impdStiffness.resize(6);
+    impdDamping.resize(6);
+
+    for (int i = 0; i < 6; i++)
+    {
+        impdStiffness[i] = impdStiffnessBottle.get(i).asFloat64();
+        impdDamping[i] = impdDampingBottle.get(i).asFloat64();
+    }
+
+    onlineStreaming = config.check("onlineStreaming",
+            "track MOVI targets with a jerk-limited setpoint generator running at CMC rate");
+
+    double streamingMaxAcc = config.check("streamingMaxAcc", yarp::os::Value(DEFAULT_STREAMING_MAX_ACC),
+            "MOVI setpoint generator max joint acceleration (meters/second^2 or degrees/second^2)").asFloat64();
+
+    double streamingMaxJerk = config.check("streamingMaxJerk", yarp::os::Value(DEFAULT_STREAMING_MAX_JERK),
+            "MOVI setpoint generator max joint jerk (meters/second^3 or degrees/second^3)").asFloat64();
+
+    int numTrajectoryWorkers = config.check("trajectoryWorkers", yarp::os::Value(DEFAULT_TRAJECTORY_WORKERS),
+            "threads evaluating per-endpoint MOVL/MOVV trajectories besides the CMC one (0: serial)").asInt32();
+
+    if (numTrajectoryWorkers < 0)
+    {
+        yError() << "Illegal number of trajectory workers:" << numTrajectoryWorkers;
+        return false;
+    }
+
+    trajectoryWorkers = std::make_unique<WorkerPool>(numTrajectoryWorkers);
+
+    if (config.check("trajectoryWorkerCpus", "list of CPUs to pin trajectory workers to"))
+    {
+        yarp::os::Bottle * trajectoryWorkerCpus = config.find("trajectoryWorkerCpus").asList();
+        std::vector<int> cpus;
+
+        for (int i = 0; trajectoryWorkerCpus && i < trajectoryWorkerCpus->size(); i++)
+        {
+            cpus.push_back(trajectoryWorkerCpus->get(i).asInt32());
+        }
+
+        if (!trajectoryWorkers->setAffinity(cpus))
+        {
+            yWarning() << "Unable to pin trajectory workers to CPUs:" << cpus;
+        }
+    }
+
     cmcPeriodMs = config.check("cmcPeriodMs", yarp::os::Value(DEFAULT_CMC_PERIOD_MS),
             "CMC rate (milliseconds)").asInt32();
 
@@ -102,7 +251,22 @@ bool roboticslab::BasicCartesianControl::open(yarp::os::Searchable& config)
     iEncoders->getAxes(&numRobotJoints);
     yInfo() << "numRobotJoints:" << numRobotJoints;
 
+    qMeasured.resize(numRobotJoints);
+    torques.resize(numRobotJoints);
+    qdotMeasured.resize(numRobotJoints);
+    impdXd.resize(6);
+    impdX.resize(6);
+    impdWrench.resize(6);
+    gcmpCachedQ.resize(numRobotJoints);
+    gcmpCachedTorques.resize(numRobotJoints);
+    gcmpScratchTorques.resize(numRobotJoints);
+    gcmpTorqueJacobian.resize(numRobotJoints * numRobotJoints);
     qRefSpeeds.resize(numRobotJoints);
+    forceFexts.resize(6 * numRobotJoints);
+    controlModes.resize(numRobotJoints);
+    jointStreamingModes.resize(numRobotJoints);
+    moviQRef.resize(numRobotJoints);
+    moviQdotRef.resize(numRobotJoints);
 
     if (!iPositionControl->getRefSpeeds(qRefSpeeds.data()))
     {
@@ -196,12 +360,45 @@ bool roboticslab::BasicCartesianControl::open(yarp::os::Searchable& config)
         yWarning("numRobotJoints(%d) != numSolverJoints(%d)", numRobotJoints, numSolverJoints);
     }
 
+    impdJ.resize(6 * numSolverJoints);
+
+    if (onlineStreaming)
+    {
+        std::vector<double> streamingMaxVel(qRefSpeeds);
+
+        if (!qdotMax.empty())
+        {
+            for (int joint = 0; joint < numRobotJoints; joint++)
+            {
+                streamingMaxVel[joint] = std::min(std::abs(qdotMin[joint]), std::abs(qdotMax[joint]));
+            }
+        }
+
+        if (!streamingGenerator.configure(cmcPeriodMs * 0.001, streamingMaxVel, streamingMaxAcc, streamingMaxJerk))
+        {
+            yError() << "Unable to configure MOVI setpoint generator";
+            return false;
+        }
+    }
+
     if (cmcPeriodMs != DEFAULT_CMC_PERIOD_MS)
     {
         yarp::os::PeriodicThread::setPeriod(cmcPeriodMs * 0.001);
     }
 
-    return yarp::os::PeriodicThread::start();
+    if (!yarp::os::PeriodicThread::start())
+    {
+        yError() << "Unable to start CMC thread";
+        return false;
+    }
+
+    //-- Started last, a joinable std::thread must not outlive a device that failed to open
+    if (recordMotions)
+    {
+        recordingThread = std::thread(&BasicCartesianControl::saveRecordings, this);
+    }
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -210,6 +407,18 @@ bool roboticslab::BasicCartesianControl::close()
 {
     stopControl();
     yarp::os::PeriodicThread::stop();
+
+    if (recordingThread.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(recordingMutex);
+            stopRecordingThread = true;
+        }
+
+        recordingCondition.notify_one();
+        recordingThread.join();
+    }
+
     robotDevice.close();
     solverDevice.close();
     return true;
@@ -12,14 +12,20 @@
 #include <yarp/os/Vocab.h>
 
 #include "KdlTrajectory.hpp"
-
-// -----------------------------------------------------------------------------
+#include "SplineJointTrajectory.hpp"
 
 namespace
 {
-    inline double getTimestamp(yarp::dev::IPreciselyTimed * iPreciselyTimed)
+    std::vector<double> flatten(const std::vector< std::vector<double> > &xds)
     {
-        return iPreciselyTimed != NULL ? iPreciselyTimed->getLastInputStamp().getTime() : yarp::os::Time::now();
+        std::vector<double> flat;
+
+        for (const auto & xd : xds)
+        {
+            flat.insert(flat.end(), xd.begin(), xd.end());
+        }
+
+        return flat;
     }
 }
 
@@ -37,7 +43,7 @@ bool roboticslab::BasicCartesianControl::stat(std::vector<double> &x, int * stat
 
     if (timestamp != NULL)
     {
-        *timestamp = getTimestamp(iPreciselyTimed);
+        *timestamp = getTimestamp();
     }
 
     if (!iCartesianSolver->fwdKin(currentQ, x))
@@ -77,8 +83,42 @@ bool roboticslab::BasicCartesianControl::inv(const std::vector<double> &xd, std:
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::BasicCartesianControl::inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs)
+{
+    std::vector<double> currentQ(numRobotJoints);
+
+    if (!iEncoders->getEncoders(currentQ.data()))
+    {
+        yError() << "getEncoders() failed";
+        return false;
+    }
+
+    qs.assign(xds.size(), std::vector<double>());
+
+    bool ok = true;
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        if (!iCartesianSolver->invKin(xds[i], currentQ, qs[i], referenceFrame))
+        {
+            yWarning("invKin() failed for pose %zu", i);
+            qs[i].clear();
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::BasicCartesianControl::movj(const std::vector<double> &xd)
 {
+    if (streamMovj)
+    {
+        return movj(std::vector< std::vector<double> >(1, xd));
+    }
+
     std::vector<double> currentQ(numRobotJoints), qd;
 
     if (!iEncoders->getEncoders(currentQ.data()))
@@ -87,12 +127,20 @@ bool roboticslab::BasicCartesianControl::movj(const std::vector<double> &xd)
         return false;
     }
 
+    if (replayCachedMotion(VOCAB_CC_MOVJ, currentQ, xd))
+    {
+        yInfo() << "Performing MOVJ (cached)";
+        return true;
+    }
+
     if (!iCartesianSolver->invKin(xd, currentQ, qd, referenceFrame))
     {
         yError() << "invKin() failed";
         return false;
     }
 
+    jointTrajectory.reset();
+
     std::vector<double> vmo(numRobotJoints);
 
     computeIsocronousSpeeds(currentQ, qd, vmo);
@@ -127,6 +175,156 @@ bool roboticslab::BasicCartesianControl::movj(const std::vector<double> &xd)
     cmcSuccess = true;
     yInfo() << "Performing MOVJ";
 
+    startRecording(VOCAB_CC_MOVJ, currentQ, xd);
+
+    setCurrentState(VOCAB_CC_MOVJ_CONTROLLING);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::movj(const std::vector< std::vector<double> > &xds)
+{
+    if (xds.empty())
+    {
+        yError() << "No waypoints given";
+        return false;
+    }
+
+    if (!streamMovj)
+    {
+        if (xds.size() == 1)
+        {
+            return movj(xds[0]);
+        }
+
+        yError() << "Multi-waypoint MOVJ requires a streamed interpolation mode (see --movjInterpolation)";
+        return false;
+    }
+
+    std::vector<double> currentQ(numRobotJoints);
+
+    if (!iEncoders->getEncoders(currentQ.data()))
+    {
+        yError() << "getEncoders() failed";
+        return false;
+    }
+
+    if (replayCachedMotion(VOCAB_CC_MOVJ, currentQ, flatten(xds)))
+    {
+        yInfo() << "Performing MOVJ (cached)";
+        return true;
+    }
+
+    std::vector<double> x_base_tcp;
+
+    if (!iCartesianSolver->fwdKin(currentQ, x_base_tcp))
+    {
+        yError() << "fwdKin() failed";
+        return false;
+    }
+
+    //-- Waypoints are given with respect to the initial pose in TCP frame, solve all of them in base frame
+    auto jointTrajectory = std::make_unique<SplineJointTrajectory>();
+    std::vector<double> qGuess(currentQ.cbegin(), currentQ.cbegin() + numSolverJoints);
+
+    if (!jointTrajectory->addWaypoint(qGuess))
+    {
+        yError() << "First addWaypoint() failed";
+        return false;
+    }
+
+    for (unsigned int k = 0; k < xds.size(); k++)
+    {
+        std::vector<double> xd_obj, qd;
+
+        if (referenceFrame == ICartesianSolver::TCP_FRAME)
+        {
+            if (!iCartesianSolver->changeOrigin(xds[k], x_base_tcp, xd_obj))
+            {
+                yError() << "changeOrigin() failed";
+                return false;
+            }
+        }
+        else
+        {
+            xd_obj = xds[k];
+        }
+
+        if (!iCartesianSolver->invKin(xd_obj, qGuess, qd, ICartesianSolver::BASE_FRAME))
+        {
+            yError() << "invKin() failed at waypoint" << k;
+            return false;
+        }
+
+        if (!jointTrajectory->addWaypoint(qd))
+        {
+            yError() << "addWaypoint() failed at waypoint" << k;
+            return false;
+        }
+
+        qGuess = qd;
+    }
+
+    //-- Same joint speeds as firmware-driven MOVJ, capped by hardware limits
+    std::vector<double> maxVelocities(qRefSpeeds.cbegin(), qRefSpeeds.cbegin() + numSolverJoints);
+
+    for (int joint = 0; joint < numSolverJoints && !qdotMax.empty(); joint++)
+    {
+        maxVelocities[joint] = std::min(maxVelocities[joint], std::min(std::abs(qdotMin[joint]), std::abs(qdotMax[joint])));
+    }
+
+    if (!jointTrajectory->setMaxJointVelocities(maxVelocities))
+    {
+        yError() << "setMaxJointVelocities() failed";
+        return false;
+    }
+
+    if (!jointTrajectory->setMaxAcceleration(movjMaxAcc))
+    {
+        yError() << "setMaxAcceleration() failed";
+        return false;
+    }
+
+    if (!jointTrajectory->configurePath(movjPathType))
+    {
+        yError() << "configurePath() failed";
+        return false;
+    }
+
+    if (!jointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED))
+    {
+        yError() << "configureVelocityProfile() failed";
+        return false;
+    }
+
+    if (!jointTrajectory->create())
+    {
+        yError() << "create() failed";
+        return false;
+    }
+
+    //-- Joints not handled by the solver stay where they are
+    desiredQ = currentQ;
+    desiredQdot.assign(numRobotJoints, 0.0);
+
+    this->jointTrajectory = std::move(jointTrajectory);
+
+    //-- Enter position direct mode and stream setpoints from the CMC thread
+    if (!enterJointStreaming())
+    {
+        yError() << "Unable to set position direct mode";
+        return false;
+    }
+
+    //-- Set state, enable CMC thread and wait for movement to be done
+    movementStartTime = yarp::os::Time::now();
+    cmcSuccess = true;
+    yInfo() << "Performing MOVJ (streamed)";
+
+    startRecording(VOCAB_CC_MOVJ, currentQ, flatten(xds));
+
     setCurrentState(VOCAB_CC_MOVJ_CONTROLLING);
 
     return true;
@@ -160,9 +358,22 @@ bool roboticslab::BasicCartesianControl::relj(const std::vector<double> &xd)
 // -----------------------------------------------------------------------------
 
 bool roboticslab::BasicCartesianControl::movl(const std::vector<double> &xd)
+{
+    return movl(std::vector< std::vector<double> >(1, xd));
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::movl(const std::vector< std::vector<double> > &xds)
 {
     yWarning() << "MOVL mode still experimental";
 
+    if (xds.empty())
+    {
+        yError() << "No waypoints given";
+        return false;
+    }
+
     std::vector<double> currentQ(numRobotJoints);
 
     if (!iEncoders->getEncoders(currentQ.data()))
@@ -171,91 +382,164 @@ bool roboticslab::BasicCartesianControl::movl(const std::vector<double> &xd)
         return false;
     }
 
-    std::vector<double> x_base_tcp;
+    if (replayCachedMotion(VOCAB_CC_MOVL, currentQ, flatten(xds)))
+    {
+        yInfo() << "Performing MOVL (cached)";
+        return true;
+    }
 
-    if (!iCartesianSolver->fwdKin(currentQ, x_base_tcp))
+    std::vector<std::unique_ptr<ICartesianTrajectory>> plan;
+
+    if (!planMovl(xds, currentQ, plan))
     {
-        yError() << "fwdKin() failed";
+        yError() << "planMovl() failed";
         return false;
     }
 
-    std::vector<double> xd_obj;
+    trajectories = std::move(plan);
+    jointTrajectory.reset();
 
-    if (referenceFrame == ICartesianSolver::TCP_FRAME)
+    //-- Set velocity mode and set state which makes periodic thread implement control.
+    if (!setControlModes(VOCAB_CM_VELOCITY))
     {
-        if (!iCartesianSolver->changeOrigin(xd, x_base_tcp, xd_obj))
-        {
-            yError() << "changeOrigin() failed";
-            return false;
-        }
+        yError() << "Unable to set velocity mode";
+        return false;
     }
-    else
+
+    //-- Set state, enable CMC thread and wait for movement to be done
+    movementStartTime = yarp::os::Time::now();
+    cmcSuccess = true;
+    yInfo() << "Performing MOVL";
+
+    startRecording(VOCAB_CC_MOVL, currentQ, flatten(xds));
+
+    setCurrentState(VOCAB_CC_MOVL_CONTROLLING);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+        double * failTime, int * failReason)
+{
+    qdotPeaks.assign(numSolverJoints, 0.0);
+
+    if (failTime != NULL)
     {
-        xd_obj = xd;
+        *failTime = -1.0;
     }
 
-    trajectories.clear();
+    if (failReason != NULL)
+    {
+        *failReason = VOCAB_CC_NOT_SET;
+    }
 
-    //-- Create line trajectories (one per endpoint if robot is a kin-tree)
-    for (unsigned int i = 0; i < xd.size() / 6; i++)
+    if (xds.empty())
     {
-        std::vector<double> xd_base_tcp_sub(x_base_tcp.cbegin() + i * 6, x_base_tcp.cbegin() + (i + 1) * 6);
-        std::vector<double> xd_obj_sub(xd_obj.cbegin() + i * 6, xd_obj.cbegin() + (i + 1) * 6);
+        yError() << "No waypoints given";
+        return false;
+    }
 
-        auto iCartesianTrajectory = std::make_unique<KdlTrajectory>();
+    std::vector<double> currentQ(numRobotJoints);
 
-        if (!iCartesianTrajectory->setDuration(duration))
-        {
-            yError() << "setDuration() failed";
-            return false;
-        }
+    if (!iEncoders->getEncoders(currentQ.data()))
+    {
+        yError() << "getEncoders() failed";
+        return false;
+    }
+
+    std::vector<std::unique_ptr<ICartesianTrajectory>> plan;
+
+    if (!planMovl(xds, currentQ, plan))
+    {
+        yError() << "planMovl() failed";
+        return false;
+    }
 
-        if (!iCartesianTrajectory->addWaypoint(xd_base_tcp_sub))
+    //-- MOVL ends as soon as any trajectory does
+    double totalDuration = 0.0;
+
+    for (unsigned int i = 0; i < plan.size(); i++)
+    {
+        double trajectoryDuration;
+        plan[i]->getDuration(&trajectoryDuration);
+        totalDuration = i == 0 ? trajectoryDuration : std::min(totalDuration, trajectoryDuration);
+    }
+
+    //-- Follow the plan at CMC rate, assume perfect tracking. Not parallelized: each IK call is
+    //-- seeded with the previous solution so that the same branch as in movl() is followed,
+    //-- and solver devices serialize their calls anyway.
+    const double period = cmcPeriodMs * 0.001;
+    const int numSamples = std::ceil(totalDuration / period) + 1;
+
+    std::vector<double> x(plan.size() * 6), xdot(plan.size() * 6), q, qdot;
+    std::vector<double> qGuess(currentQ);
+    double state[ICartesianTrajectory::STATE_SIZE];
+
+    for (int k = 0; k < numSamples; k++)
+    {
+        double t = std::min(k * period, totalDuration);
+        int violation = VOCAB_CC_NOT_SET;
+        bool evaluated = true;
+
+        for (unsigned int i = 0; i < plan.size(); i++)
         {
-            yError() << "First addWaypoint() failed";
-            return false;
+            if (!plan[i]->getState(t, state))
+            {
+                evaluated = false;
+                break;
+            }
+
+            std::copy(state, state + 6, x.begin() + i * 6);
+            std::copy(state + 6, state + 12, xdot.begin() + i * 6);
         }
 
-        if (!iCartesianTrajectory->addWaypoint(xd_obj_sub))
+        if (!evaluated)
         {
-            yError() << "Second addWaypoint() failed";
-            return false;
+            violation = VOCAB_CC_PREVIEW_TRAJECTORY;
         }
-
-        if (!iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE))
+        else if (!iCartesianSolver->invKin(x, qGuess, q, ICartesianSolver::BASE_FRAME)
+                || !iCartesianSolver->diffInvKin(q, xdot, qdot, ICartesianSolver::BASE_FRAME))
         {
-            yError() << "configurePath() failed";
-            return false;
+            violation = VOCAB_CC_PREVIEW_UNREACHABLE;
         }
-
-        if (!iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL))
+        else
         {
-            yError() << "configureVelocityProfile() failed";
-            return false;
+            for (int joint = 0; joint < numSolverJoints; joint++)
+            {
+                qdotPeaks[joint] = std::max(qdotPeaks[joint], std::abs(qdot[joint]));
+            }
+
+            if (!qMin.empty() && !checkJointLimits(q))
+            {
+                violation = VOCAB_CC_PREVIEW_JOINT_LIMIT;
+            }
+            else if (!qdotMin.empty() && !checkJointVelocities(qdot))
+            {
+                violation = VOCAB_CC_PREVIEW_VELOCITY_LIMIT;
+            }
         }
 
-        if (!iCartesianTrajectory->create())
+        if (violation != VOCAB_CC_NOT_SET)
         {
-            yError() << "create() failed";
-            return false;
-        }
+            yWarning("MOVL preview: violation %s at %f [s]", yarp::os::Vocab::decode(violation).c_str(), t);
 
-        trajectories.push_back(std::move(iCartesianTrajectory));
-    }
+            if (failTime != NULL)
+            {
+                *failTime = t;
+            }
 
-    //-- Set velocity mode and set state which makes periodic thread implement control.
-    if (!setControlModes(VOCAB_CM_VELOCITY))
-    {
-        yError() << "Unable to set velocity mode";
-        return false;
-    }
+            if (failReason != NULL)
+            {
+                *failReason = violation;
+            }
 
-    //-- Set state, enable CMC thread and wait for movement to be done
-    movementStartTime = yarp::os::Time::now();
-    cmcSuccess = true;
-    yInfo() << "Performing MOVL";
+            return false;
+        }
 
-    setCurrentState(VOCAB_CC_MOVL_CONTROLLING);
+        qGuess = q;
+    }
 
     return true;
 }
@@ -344,6 +628,11 @@ bool roboticslab::BasicCartesianControl::gcmp()
         return false;
     }
 
+    //-- Cached torques are keyed by posture, tool and tolerance, thus still valid from
+    //-- a previous run. Only the hit rate starts over.
+    gcmpCacheHits = 0;
+    gcmpCacheQueries = 0;
+
     setCurrentState(VOCAB_CC_GCMP_CONTROLLING);
     return true;
 }
@@ -360,8 +649,19 @@ bool roboticslab::BasicCartesianControl::forc(const std::vector<double> &td)
         return false;
     }
 
+    if (td.size() != 6)
+    {
+        yError() << "Expected 6-element force, got" << td.size();
+        return false;
+    }
+
     //-- Set torque mode and set state which makes periodic thread implement control.
-    this->td = td;
+    //-- Zero wrenches on the first numRobotJoints-1 segments, td on the last one.
+    {
+        std::lock_guard<std::mutex> lock(forceMutex);
+        std::fill(forceFexts.begin(), forceFexts.end(), 0.0);
+        std::copy(td.begin(), td.end(), forceFexts.begin() + 6 * (numRobotJoints - 1));
+    }
 
     if (!setControlModes(VOCAB_CM_TORQUE))
     {
@@ -375,9 +675,64 @@ bool roboticslab::BasicCartesianControl::forc(const std::vector<double> &td)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::BasicCartesianControl::impd(const std::vector<double> &xd)
+{
+    if (referenceFrame == ICartesianSolver::TCP_FRAME)
+    {
+        yWarning() << "TCP frame not supported yet in impd command";
+        return false;
+    }
+
+    if (xd.size() != 6)
+    {
+        yError() << "Expected 6-element pose, got" << xd.size();
+        return false;
+    }
+
+    //-- Solver reads and writes numSolverJoints values per row, robot encoders must cover them.
+    if (numSolverJoints > numRobotJoints)
+    {
+        yError("Impedance control needs numSolverJoints(%d) <= numRobotJoints(%d)", numSolverJoints, numRobotJoints);
+        return false;
+    }
+
+    std::vector<double> currentQ(numRobotJoints), J(6 * numSolverJoints);
+
+    if (!iEncoders->getEncoders(currentQ.data()))
+    {
+        yError() << "getEncoders() failed";
+        return false;
+    }
+
+    //-- Probe the solver, it must provide Jacobians in order to map task-space wrenches.
+    if (!iCartesianSolver->jacobian(currentQ.data(), NULL, J.data()))
+    {
+        yError() << "jacobian() failed, unable to enable impedance control";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(impdMutex);
+        std::copy(xd.begin(), xd.end(), impdXd.begin());
+    }
+
+    //-- Set torque mode and set state which makes periodic thread implement control.
+    if (!setControlModes(VOCAB_CM_TORQUE))
+    {
+        yError() << "Unable to set torque mode";
+        return false;
+    }
+
+    setCurrentState(VOCAB_CC_IMPD_CONTROLLING);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::BasicCartesianControl::stopControl()
 {
     setCurrentState(VOCAB_CC_NOT_CONTROLLING);
+    stopStreamingGenerator();
 
     // first switch control so that manipulators don't fall due to e.g. gravity
     if (!setControlModes(VOCAB_CM_POSITION))
@@ -392,6 +747,7 @@ bool roboticslab::BasicCartesianControl::stopControl()
     }
 
     trajectories.clear();
+    jointTrajectory.reset();
 
     return true;
 }
@@ -441,6 +797,14 @@ bool roboticslab::BasicCartesianControl::tool(const std::vector<double> &x)
         return false;
     }
 
+    toolVersion++;
+
+    //-- Cached motions are stored per tool, switch to the ones of the new tool
+    if ((recordMotions || replayMotions) && !loadTrajectoryCache(x))
+    {
+        yWarning() << "Unable to load cached motions of the new tool";
+    }
+
     return true;
 }
 
@@ -605,6 +969,21 @@ void roboticslab::BasicCartesianControl::movi(const std::vector<double> &x)
         return;
     }
 
+    if (onlineStreaming)
+    {
+        std::lock_guard<std::mutex> lock(streamingMutex);
+
+        if (!streamingGeneratorActive)
+        {
+            streamingGenerator.reset(currentQ);
+            streamingGeneratorActive = true;
+        }
+
+        // setpoints are sent from the CMC thread, see handleMovi()
+        streamingGenerator.setTarget(q);
+        return;
+    }
+
     if (!iPositionDirect->setPositions(q.data()))
     {
         yError() << "setPositions() failed";
@@ -646,6 +1025,12 @@ bool roboticslab::BasicCartesianControl::setParameter(int vocab, double value)
             return false;
         }
         cmcPeriodMs = value;
+        if (onlineStreaming)
+        {
+            std::lock_guard<std::mutex> lock(streamingMutex);
+            streamingGeneratorActive = false;
+            streamingGenerator.setPeriod(value * 0.001);
+        }
         break;
     case VOCAB_CC_CONFIG_WAIT_PERIOD:
         if (value <= 0.0)
@@ -671,6 +1056,29 @@ bool roboticslab::BasicCartesianControl::setParameter(int vocab, double value)
         }
         streamingCommand = value;
         break;
+    case VOCAB_CC_CONFIG_TOOL_VERSION:
+        yError() << "Tool version is a read-only parameter";
+        return false;
+    case VOCAB_CC_CONFIG_BLEND_RADIUS:
+        if (value <= 0.0)
+        {
+            yError() << "Blend radius cannot be negative nor zero";
+            return false;
+        }
+        blendRadius = value;
+        break;
+    case VOCAB_CC_CONFIG_GCMP_TOLERANCE:
+        if (value < 0.0)
+        {
+            yError() << "GCMP cache tolerance cannot be negative";
+            return false;
+        }
+        gcmpCacheTolerance = value;
+        gcmpCacheValid = false; // cached torques and Jacobian step depend on it
+        break;
+    case VOCAB_CC_CONFIG_GCMP_HIT_RATE:
+        yError() << "GCMP cache hit rate is a read-only parameter";
+        return false;
     default:
         yError() << "Unrecognized or unsupported config parameter key:" << yarp::os::Vocab::decode(vocab);
         return false;
@@ -703,6 +1111,18 @@ bool roboticslab::BasicCartesianControl::getParameter(int vocab, double * value)
     case VOCAB_CC_CONFIG_STREAMING_CMD:
         *value = streamingCommand;
         break;
+    case VOCAB_CC_CONFIG_TOOL_VERSION:
+        *value = toolVersion;
+        break;
+    case VOCAB_CC_CONFIG_BLEND_RADIUS:
+        *value = blendRadius;
+        break;
+    case VOCAB_CC_CONFIG_GCMP_TOLERANCE:
+        *value = gcmpCacheTolerance;
+        break;
+    case VOCAB_CC_CONFIG_GCMP_HIT_RATE:
+        *value = getGcmpCacheHitRate();
+        break;
     default:
         yError() << "Unrecognized or unsupported config parameter key:" << yarp::os::Vocab::decode(vocab);
         return false;
@@ -741,6 +1161,19 @@ bool roboticslab::BasicCartesianControl::getParameters(std::map<int, double> & p
     params.insert(std::make_pair(VOCAB_CC_CONFIG_WAIT_PERIOD, waitPeriodMs));
     params.insert(std::make_pair(VOCAB_CC_CONFIG_FRAME, referenceFrame));
     params.insert(std::make_pair(VOCAB_CC_CONFIG_STREAMING_CMD, streamingCommand));
+    params.insert(std::make_pair(VOCAB_CC_CONFIG_TOOL_VERSION, toolVersion));
+    params.insert(std::make_pair(VOCAB_CC_CONFIG_BLEND_RADIUS, blendRadius));
+    params.insert(std::make_pair(VOCAB_CC_CONFIG_GCMP_TOLERANCE, gcmpCacheTolerance.load()));
+    params.insert(std::make_pair(VOCAB_CC_CONFIG_GCMP_HIT_RATE, getGcmpCacheHitRate()));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::BasicCartesianControl::setStateObserver(ICartesianStateObserver * observer)
+{
+    std::lock_guard<std::mutex> lock(observerMutex);
+    stateObserver = observer;
     return true;
 }
 
@@ -2,21 +2,111 @@
 
 #include "BasicCartesianControl.hpp"
 
+#include <cmath>
+
+#include <algorithm>
+
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Time.h>
 
+namespace
+{
+    //-- Rotation matrix (row-major) from a scaled axis-angle vector (Rodrigues' formula).
+    void axisAngleToMatrix(const double * r, double * R)
+    {
+        const double theta = std::sqrt(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+
+        if (theta < 1e-12)
+        {
+            std::fill(R, R + 9, 0.0);
+            R[0] = R[4] = R[8] = 1.0;
+            return;
+        }
+
+        const double k[3] = {r[0] / theta, r[1] / theta, r[2] / theta};
+        const double c = std::cos(theta);
+        const double s = std::sin(theta);
+
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                R[3 * i + j] = (1.0 - c) * k[i] * k[j] + (i == j ? c : 0.0);
+            }
+        }
+
+        R[1] -= s * k[2];
+        R[2] += s * k[1];
+        R[3] += s * k[2];
+        R[5] -= s * k[0];
+        R[6] -= s * k[1];
+        R[7] += s * k[0];
+    }
+
+    //-- Scaled axis-angle vector from a rotation matrix (row-major), inverse of the above.
+    void matrixToAxisAngle(const double * R, double * r)
+    {
+        const double c = std::max(-1.0, std::min(1.0, (R[0] + R[4] + R[8] - 1.0) / 2.0));
+        const double theta = std::acos(c);
+        const double v[3] = {R[7] - R[5], R[2] - R[6], R[3] - R[1]};
+
+        if (theta < 1e-6)
+        {
+            // first-order approximation, sin(theta) ~ theta
+            r[0] = v[0] / 2.0;
+            r[1] = v[1] / 2.0;
+            r[2] = v[2] / 2.0;
+        }
+        else if (theta < M_PI - 1e-6)
+        {
+            const double scale = theta / (2.0 * std::sin(theta));
+            r[0] = v[0] * scale;
+            r[1] = v[1] * scale;
+            r[2] = v[2] * scale;
+        }
+        else
+        {
+            // half-turn: R = 2*k*k^T - I, pick the best conditioned axis component
+            int i = R[0] >= R[4] && R[0] >= R[8] ? 0 : (R[4] >= R[8] ? 1 : 2);
+            double k[3];
+            k[i] = std::sqrt((R[4 * i] + 1.0) / 2.0);
+
+            for (int j = 0; j < 3; j++)
+            {
+                if (j != i)
+                {
+                    k[j] = R[3 * i + j] / (2.0 * k[i]);
+                }
+            }
+
+            r[0] = k[0] * theta;
+            r[1] = k[1] * theta;
+            r[2] = k[2] * theta;
+        }
+    }
+}
+
 // ------------------- PeriodicThread Related ------------------------------------
 
 void roboticslab::BasicCartesianControl::run()
 {
     const int currentState = getCurrentState();
+    bool observed;
+
+    {
+        std::lock_guard<std::mutex> lock(observerMutex);
+        observed = stateObserver != NULL && stateObserver->isObserving();
+    }
+
+    const bool streaming = currentState == VOCAB_CC_NOT_CONTROLLING && isStreamingGeneratorActive();
 
-    if (currentState == VOCAB_CC_NOT_CONTROLLING)
+    if (currentState == VOCAB_CC_NOT_CONTROLLING && !observed && !streaming)
     {
         return;
     }
 
-    std::vector<double> q(numRobotJoints);
+    //-- Reused across cycles, torque control must not allocate.
+    std::vector<double> & q = qMeasured;
 
     if (!iEncoders->getEncoders(q.data()))
     {
@@ -24,7 +114,9 @@ void roboticslab::BasicCartesianControl::run()
         return;
     }
 
-    if (!checkJointLimits(q))
+    const double timestamp = getTimestamp();
+
+    if (currentState != VOCAB_CC_NOT_CONTROLLING && !checkJointLimits(q))
     {
         yError() << "checkJointLimits() failed, stopping control";
         cmcSuccess = false;
@@ -32,16 +124,39 @@ void roboticslab::BasicCartesianControl::run()
         return;
     }
 
+    //-- Compute FK only once per cycle, share it with the state observer. Not needed by replayed MOVL.
+    std::vector<double> x;
+
+    if (observed || (currentState == VOCAB_CC_MOVL_CONTROLLING && !jointTrajectory)
+            || currentState == VOCAB_CC_MOVV_CONTROLLING)
+    {
+        if (!iCartesianSolver->fwdKin(q, x))
+        {
+            yWarning() << "fwdKin() failed, not updating control this iteration";
+            return;
+        }
+    }
+
+    if (observed)
+    {
+        std::lock_guard<std::mutex> lock(observerMutex);
+
+        if (stateObserver != NULL)
+        {
+            stateObserver->onStat(x, currentState, timestamp);
+        }
+    }
+
     switch (currentState)
     {
     case VOCAB_CC_MOVJ_CONTROLLING:
         handleMovj(q);
         break;
     case VOCAB_CC_MOVL_CONTROLLING:
-        handleMovl(q);
+        handleMovl(q, x);
         break;
     case VOCAB_CC_MOVV_CONTROLLING:
-        handleMovv(q);
+        handleMovv(q, x);
         break;
     case VOCAB_CC_GCMP_CONTROLLING:
         handleGcmp(q);
@@ -49,15 +164,36 @@ void roboticslab::BasicCartesianControl::run()
     case VOCAB_CC_FORC_CONTROLLING:
         handleForc(q);
         break;
+    case VOCAB_CC_IMPD_CONTROLLING:
+        handleImpd(q);
+        break;
+    case VOCAB_CC_NOT_CONTROLLING:
+        if (streaming)
+        {
+            handleMovi(q);
+        }
+        break;
     default:
         break;
     }
+
+    //-- Aborted motions never complete, their recordings are replaced by the next one.
+    if (recordingComplete)
+    {
+        finishRecording();
+    }
 }
 
 // -----------------------------------------------------------------------------
 
 void roboticslab::BasicCartesianControl::handleMovj(const std::vector<double> &q)
 {
+    if (jointTrajectory)
+    {
+        handleJointStreaming(q);
+        return;
+    }
+
     if (!checkControlModes(VOCAB_CM_POSITION))
     {
         yError() << "Not in position control mode";
@@ -78,6 +214,7 @@ void roboticslab::BasicCartesianControl::handleMovj(const std::vector<double> &q
 
     if (done)
     {
+        recordingComplete = true;
         setCurrentState(VOCAB_CC_NOT_CONTROLLING);
 
         if (!iPositionControl->setRefSpeeds(vmoStored.data()))
@@ -89,8 +226,63 @@ void roboticslab::BasicCartesianControl::handleMovj(const std::vector<double> &q
 
 // -----------------------------------------------------------------------------
 
-void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q)
+void roboticslab::BasicCartesianControl::handleJointStreaming(const std::vector<double> &q)
+{
+    if (!checkControlModes(VOCAB_CM_POSITION_DIRECT))
+    {
+        yError() << "Not in position direct mode";
+        cmcSuccess = false;
+        stopControl();
+        return;
+    }
+
+    double movementTime = yarp::os::Time::now() - movementStartTime;
+
+    double duration;
+    jointTrajectory->getDuration(&duration);
+
+    //-- Joints beyond the solver's keep their initial setpoints
+    if (!jointTrajectory->getState(movementTime, desiredQ.data(), desiredQdot.data(), NULL))
+    {
+        yWarning() << "getState() failed, not updating control this iteration";
+        return;
+    }
+
+    if (!checkJointLimits(q, desiredQdot))
+    {
+        yError() << "Joint position or velocity limits exceeded, stopping";
+        cmcSuccess = false;
+        stopControl();
+        return;
+    }
+
+    if (!iPositionDirect->setPositions(desiredQ.data()))
+    {
+        yWarning() << "setPositions() failed, not updating control this iteration";
+    }
+
+    recordPositions(desiredQ);
+
+    //-- Last setpoint sent, the target has been reached
+    if (movementTime > duration)
+    {
+        recordingComplete = true;
+        leaveJointStreaming();
+        setCurrentState(VOCAB_CC_NOT_CONTROLLING);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q, const std::vector<double> &currentX)
 {
+    //-- Replaying a cached motion
+    if (jointTrajectory)
+    {
+        handleJointStreaming(q);
+        return;
+    }
+
     if (!checkControlModes(VOCAB_CM_VELOCITY))
     {
         yError() << "Not in velocity control mode";
@@ -101,8 +293,6 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
 
     double movementTime = yarp::os::Time::now() - movementStartTime;
 
-    std::vector<double> desiredX, desiredXdot;
-
     for (const auto & trajectory : trajectories)
     {
         double currentTrajectoryDuration;
@@ -110,24 +300,16 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
 
         if (movementTime > currentTrajectoryDuration)
         {
+            recordingComplete = true;
             stopControl();
             return;
         }
-
-        //-- Obtain desired Cartesian position and velocity.
-        std::vector<double> desiredX_sub, desiredXdot_sub;
-        trajectory->getPosition(movementTime, desiredX_sub);
-        trajectory->getVelocity(movementTime, desiredXdot_sub);
-
-        desiredX.insert(desiredX.end(), desiredX_sub.cbegin(), desiredX_sub.cend());
-        desiredXdot.insert(desiredXdot.end(), desiredXdot_sub.cbegin(), desiredXdot_sub.cend());
     }
 
-    std::vector<double> currentX;
-
-    if (!iCartesianSolver->fwdKin(q, currentX))
+    //-- Obtain desired Cartesian position and velocity.
+    if (!evaluateTrajectories(movementTime))
     {
-        yWarning() << "fwdKin() failed, not updating control this iteration";
+        yWarning() << "evaluateTrajectories() failed, not updating control this iteration";
         return;
     }
 
@@ -164,11 +346,13 @@ void roboticslab::BasicCartesianControl::handleMovl(const std::vector<double> &q
     {
         yWarning() << "velocityMove() failed, not updating control this iteration";
     }
+
+    recordVelocities(commandQdot);
 }
 
 // -----------------------------------------------------------------------------
 
-void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q)
+void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q, const std::vector<double> &currentX)
 {
     if (!checkControlModes(VOCAB_CM_VELOCITY))
     {
@@ -180,26 +364,11 @@ void roboticslab::BasicCartesianControl::handleMovv(const std::vector<double> &q
 
     double movementTime = yarp::os::Time::now() - movementStartTime;
 
-    std::vector<double> currentX;
-
-    if (!iCartesianSolver->fwdKin(q, currentX))
-    {
-        yWarning() << "fwdKin() failed, not updating control this iteration";
-        return;
-    }
-
     //-- Obtain desired Cartesian position and velocity.
-    std::vector<double> desiredX, desiredXdot;
-
-    for (const auto & trajectory : trajectories)
+    if (!evaluateTrajectories(movementTime))
     {
-        //-- Obtain desired Cartesian position and velocity.
-        std::vector<double> desiredX_sub, desiredXdot_sub;
-        trajectory->getPosition(movementTime, desiredX_sub);
-        trajectory->getVelocity(movementTime, desiredXdot_sub);
-
-        desiredX.insert(desiredX.end(), desiredX_sub.cbegin(), desiredX_sub.cend());
-        desiredXdot.insert(desiredXdot.end(), desiredXdot_sub.cbegin(), desiredXdot_sub.cend());
+        yWarning() << "evaluateTrajectories() failed, not updating control this iteration";
+        return;
     }
 
     //-- Apply control law to compute robot Cartesian velocity commands.
@@ -248,15 +417,70 @@ void roboticslab::BasicCartesianControl::handleGcmp(const std::vector<double> &q
         return;
     }
 
-    std::vector<double> t(numRobotJoints);
+    //-- Read once, might be changed meanwhile through setParameter()
+    const double tolerance = gcmpCacheTolerance;
+
+    if (tolerance <= 0.0)
+    {
+        if (!iCartesianSolver->invDyn(q.data(), NULL, NULL, NULL, 0, torques.data()))
+        {
+            yWarning() << "invDyn() failed, not updating control this iteration";
+            return;
+        }
+    }
+    else
+    {
+        gcmpCacheQueries++;
+
+        if (lookupGravityTorques(q, tolerance))
+        {
+            gcmpCacheHits++;
+
+            //-- One column per cycle, a cycle never costs more than one invDyn() call
+            if (gcmpCacheTaylor && !refineGravityTorqueJacobian())
+            {
+                yWarning() << "invDyn() failed, gravity torque Jacobian not refined this iteration";
+            }
+        }
+        else if (!refreshGravityTorques(q, tolerance))
+        {
+            yWarning() << "invDyn() failed, not updating control this iteration";
+            return;
+        }
+    }
+
+    if (!iTorqueControl->setRefTorques(torques.data()))
+    {
+        yWarning() << "setRefTorques() failed, not updating control this iteration";
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::BasicCartesianControl::handleForc(const std::vector<double> &q)
+{
+    if (!checkControlModes(VOCAB_CM_TORQUE))
+    {
+        yError() << "Not in torque control mode";
+        stopControl();
+        return;
+    }
+
+    //-- Null joint velocities and accelerations, external forces prepared by forc().
+    bool ok;
+
+    {
+        std::lock_guard<std::mutex> lock(forceMutex);
+        ok = iCartesianSolver->invDyn(q.data(), NULL, NULL, forceFexts.data(), numRobotJoints, torques.data());
+    }
 
-    if (!iCartesianSolver->invDyn(q, t))
+    if (!ok)
     {
         yWarning() << "invDyn() failed, not updating control this iteration";
         return;
     }
 
-    if (!iTorqueControl->setRefTorques(t.data()))
+    if (!iTorqueControl->setRefTorques(torques.data()))
     {
         yWarning() << "setRefTorques() failed, not updating control this iteration";
     }
@@ -264,7 +488,7 @@ void roboticslab::BasicCartesianControl::handleGcmp(const std::vector<double> &q
 
 // -----------------------------------------------------------------------------
 
-void roboticslab::BasicCartesianControl::handleForc(const std::vector<double> &q)
+void roboticslab::BasicCartesianControl::handleImpd(const std::vector<double> &q)
 {
     if (!checkControlModes(VOCAB_CM_TORQUE))
     {
@@ -273,29 +497,116 @@ void roboticslab::BasicCartesianControl::handleForc(const std::vector<double> &q
         return;
     }
 
-    std::vector<double> qdot(numRobotJoints, 0), qdotdot(numRobotJoints, 0);
-    std::vector< std::vector<double> > fexts;
+    if (!iEncoders->getEncoderSpeeds(qdotMeasured.data()))
+    {
+        yWarning() << "getEncoderSpeeds() failed, not updating control this iteration";
+        return;
+    }
+
+    if (!iCartesianSolver->jacobian(q.data(), impdX.data(), impdJ.data()))
+    {
+        yWarning() << "jacobian() failed, not updating control this iteration";
+        return;
+    }
+
+    //-- Equilibrium pose might be replaced meanwhile by a new impd command.
+    double xd[6];
+
+    {
+        std::lock_guard<std::mutex> lock(impdMutex);
+        std::copy(impdXd.begin(), impdXd.end(), xd);
+    }
+
+    //-- Pose error, rotation of the equilibrium frame relative to the current one expressed in the base frame.
+    double Rd[9], R[9], Re[9];
+    axisAngleToMatrix(xd + 3, Rd);
+    axisAngleToMatrix(impdX.data() + 3, R);
 
-    for (int i = 0; i < numRobotJoints - 1; i++)  //-- "numRobotJoints-1" is important
+    for (int i = 0; i < 3; i++)
     {
-        std::vector<double> fext(6, 0);
-        fexts.push_back(fext);
+        for (int j = 0; j < 3; j++)
+        {
+            Re[3 * i + j] = Rd[3 * i] * R[3 * j] + Rd[3 * i + 1] * R[3 * j + 1] + Rd[3 * i + 2] * R[3 * j + 2];
+        }
+
+        impdWrench[i] = xd[i] - impdX[i];
     }
 
-    fexts.push_back(td);
+    matrixToAxisAngle(Re, impdWrench.data() + 3);
+
+    //-- Spring-damper wrench, TCP twist obtained from measured joint velocities.
+    for (int i = 0; i < 6; i++)
+    {
+        double xdot = 0.0;
+
+        for (int j = 0; j < numSolverJoints; j++)
+        {
+            xdot += impdJ[i * numSolverJoints + j] * qdotMeasured[j] * M_PI / 180.0;
+        }
 
-    std::vector<double> t(numRobotJoints);
+        impdWrench[i] = impdStiffness[i] * impdWrench[i] - impdDamping[i] * xdot;
+    }
 
-    if (!iCartesianSolver->invDyn(q, qdot, qdotdot, fexts, t))
+    //-- Gravity, Coriolis and centrifugal compensation at measured velocities.
+    if (!iCartesianSolver->invDyn(q.data(), qdotMeasured.data(), NULL, NULL, 0, torques.data()))
     {
         yWarning() << "invDyn() failed, not updating control this iteration";
         return;
     }
 
-    if (!iTorqueControl->setRefTorques(t.data()))
+    //-- Map the wrench to joint space through the Jacobian transpose, only solver joints are affected.
+    for (int j = 0; j < numSolverJoints; j++)
+    {
+        for (int i = 0; i < 6; i++)
+        {
+            torques[j] += impdJ[i * numSolverJoints + j] * impdWrench[i];
+        }
+    }
+
+    if (!iTorqueControl->setRefTorques(torques.data()))
     {
         yWarning() << "setRefTorques() failed, not updating control this iteration";
     }
 }
 
 // -----------------------------------------------------------------------------
+
+void roboticslab::BasicCartesianControl::handleMovi(const std::vector<double> &q)
+{
+    if (streamingCommand != VOCAB_CC_MOVI || !checkControlModes(VOCAB_CM_POSITION_DIRECT))
+    {
+        yError() << "Not in position direct mode, dropping MOVI target";
+        stopStreamingGenerator();
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(streamingMutex);
+
+        if (!streamingGeneratorActive)
+        {
+            return;
+        }
+
+        streamingGenerator.step(moviQRef, moviQdotRef);
+
+        if (streamingGenerator.isDone())
+        {
+            streamingGeneratorActive = false;
+        }
+    }
+
+    if (!checkJointLimits(q, moviQdotRef))
+    {
+        yError() << "Joint position or velocity limits exceeded, dropping MOVI target";
+        stopStreamingGenerator();
+        return;
+    }
+
+    if (!iPositionDirect->setPositions(moviQRef.data()))
+    {
+        yWarning() << "setPositions() failed, not updating control this iteration";
+    }
+}
+
+// -----------------------------------------------------------------------------
@@ -3,23 +3,31 @@
 #ifndef __CARTESIAN_CONTROL_CLIENT_HPP__
 #define __CARTESIAN_CONTROL_CLIENT_HPP__
 
+#include <atomic>
 #include <mutex>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/PortReaderBuffer.h>
 #include <yarp/os/RpcClient.h>
+#include <yarp/os/Stamp.h>
 
 #include <yarp/dev/Drivers.h>
+#include <yarp/dev/IEncoders.h>
+#include <yarp/dev/PolyDriver.h>
 
+#include <string>
 #include <vector>
 
 #include "ICartesianControl.h"
+#include "ICartesianSolver.h"
 
 #define DEFAULT_CARTESIAN_LOCAL "/CartesianControl"
 #define DEFAULT_CARTESIAN_REMOTE "/CartesianControl"
 
 #define DEFAULT_FK_STREAM_TIMEOUT_SECS 0.5
+#define DEFAULT_FK_STREAM_POSE_SIZE 6
+#define DEFAULT_LOCAL_SOLVER_SYNC_PERIOD 1.0
 
 namespace roboticslab
 {
@@ -34,22 +42,28 @@ namespace roboticslab
 /**
  * @ingroup CartesianControlClient
  * @brief Responds to streaming FK messages.
+ *
+ * Latest data is kept in a seqlock over preallocated storage: the port callback (single
+ * writer) never waits for readers, readers retry until they get a consistent snapshot.
+ * Storage is sized once to the remote pose size, larger messages are discarded.
  */
 class FkStreamResponder : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
 {
 public:
 
     FkStreamResponder();
+    void setPoseSize(int n); // not thread-safe, call before the first onRead()
     void onRead(yarp::os::Bottle& b);
     bool getLastStatData(std::vector<double> &x, int *state, double * timestamp, double timeout);
 
 protected:
 
-    double localArrivalTime;
-    int state;
-    double timestamp;
-    std::vector<double> x;
-    mutable std::mutex mtx;
+    std::atomic<unsigned int> seq;
+    std::atomic<double> localArrivalTime;
+    std::atomic<int> state;
+    std::atomic<double> timestamp;
+    std::atomic<int> size;
+    std::vector< std::atomic<double> > x;
 };
 
 /**
@@ -60,24 +74,45 @@ class CartesianControlClient : public yarp::dev::DeviceDriver, public ICartesian
 {
 public:
 
+    CartesianControlClient() : fkStreamTimeoutSecs(DEFAULT_FK_STREAM_TIMEOUT_SECS),
+                               iCartesianSolver(NULL),
+                               iEncoders(NULL),
+                               localSolverSyncPeriod(DEFAULT_LOCAL_SOLVER_SYNC_PERIOD),
+                               localReferenceFrame(ICartesianSolver::BASE_FRAME),
+                               localToolVersion(0),
+                               localSolverSynced(false),
+                               lastLocalSolverSync(0.0)
+    {}
+
     // -- ICartesianControl declarations. Implementation in ICartesianControlImpl.cpp--
 
     virtual bool stat(std::vector<double> &x, int * state = 0, double * timestamp = 0);
 
     virtual bool inv(const std::vector<double> &xd, std::vector<double> &q);
 
+    virtual bool inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs);
+
     virtual bool movj(const std::vector<double> &xd);
 
+    virtual bool movj(const std::vector< std::vector<double> > &xds);
+
     virtual bool relj(const std::vector<double> &xd);
 
     virtual bool movl(const std::vector<double> &xd);
 
+    virtual bool movl(const std::vector< std::vector<double> > &xds);
+
+    virtual bool preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+                         double * failTime = 0, int * failReason = 0);
+
     virtual bool movv(const std::vector<double> &xdotd);
 
     virtual bool gcmp();
 
     virtual bool forc(const std::vector<double> &td);
 
+    virtual bool impd(const std::vector<double> &xd);
+
     virtual bool stopControl();
 
     virtual bool wait(double timeout);
@@ -100,6 +135,8 @@ public:
 
     virtual bool getParameters(std::map<int, double> & params);
 
+    virtual bool setStateObserver(ICartesianStateObserver * observer);
+
     // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
     /**
@@ -132,11 +169,33 @@ protected:
     void handleStreamingConsumerCmd(int vocab, const std::vector<double>& in);
     void handleStreamingBiConsumerCmd(int vocab, const std::vector<double>& in1, double in2);
 
+    bool openLocalSolver(yarp::os::Searchable& config, const std::string& local);
+    bool syncLocalSolver(bool force = false);
+    bool fetchLocalSolverSync();
+    bool getLocalSolverGuess(std::vector<double>& qGuess, ICartesianSolver::reference_frame& frame);
+
     yarp::os::RpcClient rpcClient;
     yarp::os::BufferedPort<yarp::os::Bottle> fkInPort, commandPort;
 
+    /** Sequence number and send time of last streaming command */
+    yarp::os::Stamp commandStamp;
+
     FkStreamResponder fkStreamResponder;
     double fkStreamTimeoutSecs;
+
+    /** Local mirror of the remote kinematic solver, answers IK queries without RPC */
+    yarp::dev::PolyDriver solverDevice, robotDevice;
+    ICartesianSolver * iCartesianSolver;
+    yarp::dev::IEncoders * iEncoders;
+
+    double localSolverSyncPeriod;
+
+    /** Remote state mirrored by the local solver, shared by all calling threads */
+    ICartesianSolver::reference_frame localReferenceFrame;
+    int localToolVersion;
+    bool localSolverSynced;
+    double lastLocalSolverSync;
+    std::mutex localSolverMutex;
 };
 
 }  // namespace roboticslab
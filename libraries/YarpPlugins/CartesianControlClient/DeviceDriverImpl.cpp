@@ -3,9 +3,11 @@
 #include "CartesianControlClient.hpp"
 
 #include <string>
+#include <vector>
 
 #include <yarp/os/LogStream.h>
 #include <yarp/os/Network.h>
+#include <yarp/os/Property.h>
 #include <yarp/os/Time.h>
 
 // ------------------- DeviceDriver Related ------------------------------------
@@ -53,6 +55,17 @@ bool roboticslab::CartesianControlClient::open(yarp::os::Searchable& config)
 
         if (yarp::os::Network::exists(statePort))
         {
+            std::vector<double> x;
+
+            // stream port still closed, thus queried via RPC; trees may stream several poses
+            if (!stat(x))
+            {
+                yError() << "Unable to query remote pose size";
+                return false;
+            }
+
+            fkStreamResponder.setPoseSize(x.size());
+
             if (!fkInPort.open(local + "/state:i"))
             {
                 yError() << "Unable to open local stream port";
@@ -74,6 +87,18 @@ bool roboticslab::CartesianControlClient::open(yarp::os::Searchable& config)
         }
     }
 
+    if (config.check("localSolver", "cartesian solver device to be mirrored locally"))
+    {
+        if (transformEnabled)
+        {
+            yWarning() << "Local solver not supported in --transform mode, using RPC instead";
+        }
+        else if (!openLocalSolver(config, local))
+        {
+            return false;
+        }
+    }
+
     yInfo() << "Connected to remote";
 
     return true;
@@ -81,6 +106,71 @@ bool roboticslab::CartesianControlClient::open(yarp::os::Searchable& config)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::openLocalSolver(yarp::os::Searchable& config, const std::string& local)
+{
+    std::string solverStr = config.find("localSolver").asString();
+
+    if (!config.check("localRobotRemote", "remote port prefix of the robot control board (encoder reads)"))
+    {
+        yError() << "Missing --localRobotRemote parameter, needed by --localSolver";
+        return false;
+    }
+
+    localSolverSyncPeriod = config.check("localSolverSyncPeriod", yarp::os::Value(DEFAULT_LOCAL_SOLVER_SYNC_PERIOD),
+            "period of remote tool/frame consistency checks (seconds)").asFloat64();
+
+    yarp::os::Property robotOptions;
+    robotOptions.put("device", "remote_controlboard");
+    robotOptions.put("remote", config.find("localRobotRemote"));
+    robotOptions.put("local", local + "/robot");
+
+    if (!robotDevice.open(robotOptions))
+    {
+        yError() << "Unable to connect to remote robot device";
+        return false;
+    }
+
+    if (!robotDevice.view(iEncoders))
+    {
+        yError() << "Could not view iEncoders in remote robot device";
+        return false;
+    }
+
+    yarp::os::Property solverOptions;
+    solverOptions.fromString(config.toString());
+    solverOptions.put("device", solverStr);
+
+    if (!solverDevice.open(solverOptions))
+    {
+        yError() << "Solver device not valid:" << solverStr;
+        return false;
+    }
+
+    if (!solverDevice.view(iCartesianSolver))
+    {
+        yError() << "Could not view iCartesianSolver in:" << solverStr;
+        return false;
+    }
+
+    int numRobotJoints, numSolverJoints;
+
+    if (!iEncoders->getAxes(&numRobotJoints) || !iCartesianSolver->getNumJoints(&numSolverJoints)
+            || numRobotJoints != numSolverJoints)
+    {
+        yError() << "Local solver and remote robot joint count mismatch";
+        return false;
+    }
+
+    if (!syncLocalSolver(true))
+    {
+        yWarning() << "Local solver not in sync with remote, using RPC until next tool change";
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::close()
 {
     rpcClient.close();
@@ -91,6 +181,12 @@ bool roboticslab::CartesianControlClient::close()
         fkInPort.close();
     }
 
+    iCartesianSolver = NULL;
+    iEncoders = NULL;
+
+    solverDevice.close();
+    robotDevice.close();
+
     return true;
 }
 
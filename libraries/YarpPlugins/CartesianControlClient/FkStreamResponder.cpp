@@ -9,48 +9,104 @@ using namespace roboticslab;
 // -----------------------------------------------------------------------------
 
 FkStreamResponder::FkStreamResponder()
-    : localArrivalTime(0.0),
+    : seq(0),
+      localArrivalTime(0.0),
       state(0),
-      timestamp(0.0)
-{}
+      timestamp(0.0),
+      size(0)
+{
+    setPoseSize(DEFAULT_FK_STREAM_POSE_SIZE);
+}
+
+// -----------------------------------------------------------------------------
+
+void FkStreamResponder::setPoseSize(int n)
+{
+    std::vector< std::atomic<double> >(n).swap(x);
+
+    for (int i = 0; i < n; i++)
+    {
+        x[i].store(0.0, std::memory_order_relaxed);
+    }
+
+    size.store(0, std::memory_order_relaxed);
+}
 
 // -----------------------------------------------------------------------------
 
 void FkStreamResponder::onRead(yarp::os::Bottle & b)
 {
-    std::lock_guard<std::mutex> lock(mtx);
+    int n = b.size() - 2;
 
-    localArrivalTime = yarp::os::Time::now();
-    state = b.get(0).asVocab();
-    x.resize(b.size() - 2);
+    if (n < 0 || n > static_cast<int>(x.size()))
+    {
+        return; // not a standard pose, stat() will resort to RPC on timeout
+    }
 
-    for (size_t i = 0; i < x.size(); i++)
+    double now = yarp::os::Time::now();
+
+    // odd sequence number while writing, readers discard anything read meanwhile
+    unsigned int s = seq.load(std::memory_order_relaxed);
+    seq.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    localArrivalTime.store(now, std::memory_order_relaxed);
+    state.store(b.get(0).asVocab(), std::memory_order_relaxed);
+    size.store(n, std::memory_order_relaxed);
+
+    for (int i = 0; i < n; i++)
     {
-        x[i] = b.get(i + 1).asFloat64();
+        x[i].store(b.get(i + 1).asFloat64(), std::memory_order_relaxed);
     }
 
-    timestamp = b.get(b.size() - 1).asFloat64();
+    timestamp.store(b.get(b.size() - 1).asFloat64(), std::memory_order_relaxed);
+
+    seq.store(s + 2, std::memory_order_release);
 }
 
 // -----------------------------------------------------------------------------
 
 bool FkStreamResponder::getLastStatData(std::vector<double> &x, int *state, double *timestamp, const double timeout)
 {
-    std::lock_guard<std::mutex> lock(mtx);
+    double _localArrivalTime, _timestamp;
+    int _state, _size;
+    unsigned int s0, s1;
+
+    x.resize(this->x.size()); // no-op after the first call, keeps the retry loop allocation-free
+
+    do
+    {
+        s0 = seq.load(std::memory_order_acquire);
+
+        _localArrivalTime = localArrivalTime.load(std::memory_order_relaxed);
+        _state = this->state.load(std::memory_order_relaxed);
+        _size = size.load(std::memory_order_relaxed);
+
+        for (int i = 0; i < _size; i++)
+        {
+            x[i] = this->x[i].load(std::memory_order_relaxed);
+        }
+
+        _timestamp = this->timestamp.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        s1 = seq.load(std::memory_order_relaxed);
+    }
+    while ((s0 & 1) != 0 || s0 != s1);
 
-    x = this->x;
+    x.resize(_size);
 
     if (state != 0)
     {
-        *state = this->state;
+        *state = _state;
     }
 
     if (timestamp != 0)
     {
-        *timestamp = this->timestamp;
+        *timestamp = _timestamp;
     }
 
-    return yarp::os::Time::now() - localArrivalTime <= timeout;
+    return yarp::os::Time::now() - _localArrivalTime <= timeout;
 }
 
 // -----------------------------------------------------------------------------
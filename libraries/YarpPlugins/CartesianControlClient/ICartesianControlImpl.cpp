@@ -112,6 +112,8 @@ void roboticslab::CartesianControlClient::handleStreamingConsumerCmd(int vocab,
         cmd.addFloat64(in[i]);
     }
 
+    commandStamp.update();
+    commandPort.setEnvelope(commandStamp);
     commandPort.write();
 }
 
@@ -130,11 +132,96 @@ void roboticslab::CartesianControlClient::handleStreamingBiConsumerCmd(int vocab
         cmd.addFloat64(in1[i]);
     }
 
+    commandStamp.update();
+    commandPort.setEnvelope(commandStamp);
     commandPort.write();
 }
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::syncLocalSolver(bool force)
+{
+    if (iCartesianSolver == NULL)
+    {
+        return false;
+    }
+
+    // concurrent callers wait for a single request instead of issuing their own
+    std::lock_guard<std::mutex> lock(localSolverMutex);
+
+    double now = yarp::os::Time::now();
+
+    if (!force && now - lastLocalSolverSync < localSolverSyncPeriod)
+    {
+        return localSolverSynced;
+    }
+
+    lastLocalSolverSync = now;
+    return fetchLocalSolverSync();
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlClient::fetchLocalSolverSync()
+{
+    // localSolverMutex must be held by the caller
+    std::map<int, double> params;
+
+    if (!getParameters(params))
+    {
+        localSolverSynced = false;
+        return false;
+    }
+
+    std::map<int, double>::const_iterator it = params.find(VOCAB_CC_CONFIG_FRAME);
+
+    if (it != params.end())
+    {
+        localReferenceFrame = static_cast<ICartesianSolver::reference_frame>(it->second);
+    }
+
+    it = params.find(VOCAB_CC_CONFIG_TOOL_VERSION);
+
+    // remote tool is unknown if the server does not track tool changes or has applied one we did not request
+    localSolverSynced = it != params.end() && it->second == localToolVersion;
+
+    return localSolverSynced;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlClient::getLocalSolverGuess(std::vector<double>& qGuess, ICartesianSolver::reference_frame& frame)
+{
+    if (!syncLocalSolver())
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(localSolverMutex);
+        frame = localReferenceFrame;
+    }
+
+    int numJoints;
+
+    if (!iEncoders->getAxes(&numJoints))
+    {
+        return false;
+    }
+
+    qGuess.resize(numJoints);
+
+    if (!iEncoders->getEncoders(qGuess.data()))
+    {
+        yWarning() << "getEncoders() failed, falling back to RPC request";
+        return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::stat(std::vector<double> &x, int * state, double * timestamp)
 {
     if (!fkInPort.isClosed())
@@ -184,11 +271,90 @@ bool roboticslab::CartesianControlClient::stat(std::vector<double> &x, int * sta
 
 bool roboticslab::CartesianControlClient::inv(const std::vector<double> &xd, std::vector<double> &q)
 {
+    std::vector<double> currentQ;
+    ICartesianSolver::reference_frame frame;
+
+    if (getLocalSolverGuess(currentQ, frame))
+    {
+        return iCartesianSolver->invKin(xd, currentQ, q, frame);
+    }
+
     return handleRpcFunctionCmd(VOCAB_CC_INV, xd, q);
 }
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs)
+{
+    std::vector<double> currentQ;
+    ICartesianSolver::reference_frame frame;
+
+    if (getLocalSolverGuess(currentQ, frame))
+    {
+        qs.assign(xds.size(), std::vector<double>());
+
+        bool ok = true;
+
+        for (size_t i = 0; i < xds.size(); i++)
+        {
+            if (!iCartesianSolver->invKin(xds[i], currentQ, qs[i], frame))
+            {
+                qs[i].clear();
+                ok = false;
+            }
+        }
+
+        return ok;
+    }
+
+    yarp::os::Bottle cmd, response;
+
+    cmd.addVocab(VOCAB_CC_INV);
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        yarp::os::Bottle & b = cmd.addList();
+
+        for (size_t j = 0; j < xds[i].size(); j++)
+        {
+            b.addFloat64(xds[i][j]);
+        }
+    }
+
+    rpcClient.write(cmd, response);
+
+    if (!checkSuccess(response) || response.size() != xds.size())
+    {
+        return false;
+    }
+
+    qs.assign(xds.size(), std::vector<double>());
+
+    bool ok = true;
+
+    for (size_t i = 0; i < response.size(); i++)
+    {
+        yarp::os::Bottle * b = response.get(i).asList();
+
+        if (b == NULL || b->size() == 0)
+        {
+            ok = false;
+            continue;
+        }
+
+        qs[i].resize(b->size());
+
+        for (size_t j = 0; j < b->size(); j++)
+        {
+            qs[i][j] = b->get(j).asFloat64();
+        }
+    }
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::movj(const std::vector<double> &xd)
 {
     return handleRpcConsumerCmd(VOCAB_CC_MOVJ, xd);
@@ -196,6 +362,29 @@ bool roboticslab::CartesianControlClient::movj(const std::vector<double> &xd)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::movj(const std::vector< std::vector<double> > &xds)
+{
+    yarp::os::Bottle cmd, response;
+
+    cmd.addVocab(VOCAB_CC_MOVJ);
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        yarp::os::Bottle & b = cmd.addList();
+
+        for (size_t j = 0; j < xds[i].size(); j++)
+        {
+            b.addFloat64(xds[i][j]);
+        }
+    }
+
+    rpcClient.write(cmd, response);
+
+    return checkSuccess(response);
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::relj(const std::vector<double> &xd)
 {
     return handleRpcConsumerCmd(VOCAB_CC_RELJ, xd);
@@ -210,6 +399,89 @@ bool roboticslab::CartesianControlClient::movl(const std::vector<double> &xd)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::movl(const std::vector< std::vector<double> > &xds)
+{
+    yarp::os::Bottle cmd, response;
+
+    cmd.addVocab(VOCAB_CC_MOVL);
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        yarp::os::Bottle & b = cmd.addList();
+
+        for (size_t j = 0; j < xds[i].size(); j++)
+        {
+            b.addFloat64(xds[i][j]);
+        }
+    }
+
+    rpcClient.write(cmd, response);
+
+    return checkSuccess(response);
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlClient::preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+        double * failTime, int * failReason)
+{
+    yarp::os::Bottle cmd, response;
+
+    cmd.addVocab(VOCAB_CC_PREVIEW);
+
+    for (size_t i = 0; i < xds.size(); i++)
+    {
+        yarp::os::Bottle & b = cmd.addList();
+
+        for (size_t j = 0; j < xds[i].size(); j++)
+        {
+            b.addFloat64(xds[i][j]);
+        }
+    }
+
+    rpcClient.write(cmd, response);
+
+    if (failTime != NULL)
+    {
+        *failTime = -1.0;
+    }
+
+    if (failReason != NULL)
+    {
+        *failReason = VOCAB_CC_NOT_SET;
+    }
+
+    qdotPeaks.clear();
+
+    // [ok] (peaks) | [fail] [reason] time (peaks) | [fail]
+    bool ok = checkSuccess(response);
+    size_t offset = ok ? 1 : 3;
+
+    if (!ok && response.size() > 2)
+    {
+        if (failReason != NULL)
+        {
+            *failReason = response.get(1).asVocab();
+        }
+
+        if (failTime != NULL)
+        {
+            *failTime = response.get(2).asFloat64();
+        }
+    }
+
+    yarp::os::Bottle * b = response.size() > offset ? response.get(offset).asList() : NULL;
+
+    for (size_t i = 0; b != NULL && i < b->size(); i++)
+    {
+        qdotPeaks.push_back(b->get(i).asFloat64());
+    }
+
+    return ok;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::movv(const std::vector<double> &xdotd)
 {
     return handleRpcConsumerCmd(VOCAB_CC_MOVV, xdotd);
@@ -231,6 +503,13 @@ bool roboticslab::CartesianControlClient::forc(const std::vector<double> &td)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::CartesianControlClient::impd(const std::vector<double> &xd)
+{
+    return handleRpcConsumerCmd(VOCAB_CC_IMPD, xd);
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::CartesianControlClient::stopControl()
 {
     return handleRpcRunnableCmd(VOCAB_CC_STOP);
@@ -254,7 +533,42 @@ bool roboticslab::CartesianControlClient::wait(double timeout)
 
 bool roboticslab::CartesianControlClient::tool(const std::vector<double> &x)
 {
-    return handleRpcConsumerCmd(VOCAB_CC_TOOL, x);
+    if (iCartesianSolver == NULL)
+    {
+        return handleRpcConsumerCmd(VOCAB_CC_TOOL, x);
+    }
+
+    std::lock_guard<std::mutex> lock(localSolverMutex);
+
+    double previousVersion, version;
+    bool versioned = getParameter(VOCAB_CC_CONFIG_TOOL_VERSION, &previousVersion);
+
+    if (!handleRpcConsumerCmd(VOCAB_CC_TOOL, x))
+    {
+        localSolverSynced = false; // remote chain might have been restored before failing
+        return false;
+    }
+
+    if (!versioned || !iCartesianSolver->restoreOriginalChain() || !iCartesianSolver->appendLink(x)
+            || !getParameter(VOCAB_CC_CONFIG_TOOL_VERSION, &version))
+    {
+        yWarning() << "Unable to mirror tool change in local solver, using RPC instead";
+        localSolverSynced = false;
+    }
+    else if (version != previousVersion + 1)
+    {
+        // another client changed the tool meanwhile, its tool or ours is now in place
+        yWarning() << "Concurrent remote tool change, using RPC until next tool change";
+        localSolverSynced = false;
+    }
+    else
+    {
+        localToolVersion = version;
+        lastLocalSolverSync = yarp::os::Time::now();
+        fetchLocalSolverSync();
+    }
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -304,7 +618,18 @@ bool roboticslab::CartesianControlClient::setParameter(int vocab, double value)
 
     rpcClient.write(cmd, response);
 
-    return checkSuccess(response);
+    if (!checkSuccess(response))
+    {
+        return false;
+    }
+
+    if (vocab == VOCAB_CC_CONFIG_FRAME)
+    {
+        std::lock_guard<std::mutex> lock(localSolverMutex);
+        localReferenceFrame = static_cast<ICartesianSolver::reference_frame>(value);
+    }
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -346,7 +671,20 @@ bool roboticslab::CartesianControlClient::setParameters(const std::map<int, doub
 
     rpcClient.write(cmd, response);
 
-    return checkSuccess(response);
+    if (!checkSuccess(response))
+    {
+        return false;
+    }
+
+    std::map<int, double>::const_iterator it = params.find(VOCAB_CC_CONFIG_FRAME);
+
+    if (it != params.end())
+    {
+        std::lock_guard<std::mutex> lock(localSolverMutex);
+        localReferenceFrame = static_cast<ICartesianSolver::reference_frame>(it->second);
+    }
+
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -378,3 +716,11 @@ bool roboticslab::CartesianControlClient::getParameters(std::map<int, double> &
 }
 
 // -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlClient::setStateObserver(ICartesianStateObserver * observer)
+{
+    yWarning() << "setStateObserver() not supported in remote clients";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
@@ -7,10 +7,12 @@
 #include <yarp/os/BufferedPort.h>
 #include <yarp/os/PeriodicThread.h>
 #include <yarp/os/RpcServer.h>
+#include <yarp/os/Stamp.h>
 
 #include <yarp/dev/Drivers.h>
 #include <yarp/dev/PolyDriver.h>
 
+#include <mutex>
 #include <vector>
 
 #include "ICartesianControl.h"
@@ -18,6 +20,11 @@
 
 #define DEFAULT_PREFIX "/CartesianServer"
 #define DEFAULT_MS 20
+#define DEFAULT_FK_CHANGE_THRESHOLD 0.0
+#define DEFAULT_FK_HEARTBEAT 0.25
+#define DEFAULT_STREAM_MAX_AGE 0.0
+
+#define VOCAB_CC_STREAMING_STATS ROBOTICSLAB_VOCAB('c','m','d','s') ///< Streaming command statistics
 
 namespace roboticslab
 {
@@ -36,9 +43,14 @@ class StreamResponder;
 /**
  * @ingroup CartesianControlServer
  * @brief The CartesianControlServer class implements ICartesianControl server side.
+ *
+ * The FK stream is either polled at a fixed period or, if requested and supported by
+ * the wrapped device, pushed by the controller on each control cycle.
  */
 
-class CartesianControlServer : public yarp::dev::DeviceDriver, public yarp::os::PeriodicThread
+class CartesianControlServer : public yarp::dev::DeviceDriver,
+                               public yarp::os::PeriodicThread,
+                               public ICartesianStateObserver
 {
 public:
 
@@ -47,7 +59,12 @@ public:
           iCartesianControl(NULL),
           rpcResponder(NULL), rpcTransformResponder(NULL),
           streamResponder(NULL),
-          fkStreamEnabled(true)
+          fkStreamEnabled(true),
+          fkPushEnabled(false),
+          fkChangeThreshold(DEFAULT_FK_CHANGE_THRESHOLD),
+          fkHeartbeat(DEFAULT_FK_HEARTBEAT),
+          lastState(VOCAB_CC_NOT_SET),
+          lastPublishTime(0.0)
     {}
 
     // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
@@ -78,8 +95,16 @@ public:
      */
     virtual void run();
 
+    // -------- ICartesianStateObserver declarations. Implementation in PeriodicThreadImpl.cpp --------
+
+    virtual void onStat(const std::vector<double> &x, int state, double timestamp);
+
+    virtual bool isObserving();
+
 protected:
 
+    void publishState(const std::vector<double> &x, int state, double timestamp);
+
     yarp::dev::PolyDriver cartesianControlDevice;
 
     yarp::os::RpcServer rpcServer, rpcTransformServer;
@@ -91,19 +116,33 @@ protected:
     StreamResponder *streamResponder;
 
     bool fkStreamEnabled;
+    bool fkPushEnabled;
+
+    double fkChangeThreshold;
+    double fkHeartbeat;
+
+    std::vector<double> lastX;
+    int lastState;
+    double lastPublishTime;
 };
 
 /**
  * @ingroup CartesianControlServer
  * @brief Responds to RPC command messages.
+ *
+ * A command either fails as a whole, in which case the reply is [fail] and respond()
+ * returns false, or it succeeds and the reply carries its results. Outcomes of
+ * individual items (poses of a batched [inv], violations found by [prvw]) are part
+ * of a successful reply.
  */
 class RpcResponder : public yarp::dev::DeviceResponder
 {
 public:
 
-    RpcResponder(roboticslab::ICartesianControl *iCartesianControl)
+    RpcResponder(roboticslab::ICartesianControl *iCartesianControl, StreamResponder *streamResponder = NULL)
     {
         this->iCartesianControl = iCartesianControl;
+        this->streamResponder = streamResponder;
 
         // shadows DeviceResponder::makeUsage(), which was already called by the base constructor
         makeUsage();
@@ -127,14 +166,20 @@ protected:
     typedef bool (ICartesianControl::*RunnableFun)();
     typedef bool (ICartesianControl::*ConsumerFun)(const std::vector<double>&);
     typedef bool (ICartesianControl::*FunctionFun)(const std::vector<double>&, std::vector<double>&);
+    typedef bool (ICartesianControl::*BatchConsumerFun)(const std::vector< std::vector<double> >&);
+    typedef bool (ICartesianControl::*BatchFunctionFun)(const std::vector< std::vector<double> >&, std::vector< std::vector<double> >&);
 
     bool handleStatMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool handleWaitMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool handleActMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
+    bool handleStreamingStatsMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
+    bool handlePreviewMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out);
 
     bool handleRunnableCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, RunnableFun cmd);
     bool handleConsumerCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, ConsumerFun cmd);
     bool handleFunctionCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, FunctionFun cmd);
+    bool handleBatchConsumerCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, BatchConsumerFun cmd);
+    bool handleBatchFunctionCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, BatchFunctionFun cmd);
 
     bool handleParameterSetter(const yarp::os::Bottle& in, yarp::os::Bottle& out);
     bool handleParameterGetter(const yarp::os::Bottle& in, yarp::os::Bottle& out);
@@ -153,6 +198,7 @@ protected:
     }
 
     roboticslab::ICartesianControl *iCartesianControl;
+    StreamResponder *streamResponder;
 };
 
 /**
@@ -163,9 +209,10 @@ class RpcTransformResponder : public RpcResponder
 {
 public:
 
-    RpcTransformResponder(roboticslab::ICartesianControl * iCartesianControl, KinRepresentation::coordinate_system coord,
-            KinRepresentation::orientation_system orient, KinRepresentation::angular_units units)
-        : RpcResponder(iCartesianControl),
+    RpcTransformResponder(roboticslab::ICartesianControl * iCartesianControl, StreamResponder * streamResponder,
+            KinRepresentation::coordinate_system coord, KinRepresentation::orientation_system orient,
+            KinRepresentation::angular_units units)
+        : RpcResponder(iCartesianControl, streamResponder),
           coord(coord),
           orient(orient),
           units(units)
@@ -184,18 +231,60 @@ protected:
 /**
  * @ingroup CartesianControlServer
  * @brief Responds to streaming command messages.
+ *
+ * Incoming commands may carry a YARP envelope (sequence number and send timestamp).
+ * If so, superseded commands can be dropped (latest-only policy) and so can commands
+ * delayed by more than a given age (bounded age policy). Commands that lack an envelope
+ * are always forwarded to the controller.
+ *
+ * Sender and receiver clocks are not assumed to be synchronized. The delay of each
+ * command is measured as its local receive time minus its send timestamp, which
+ * includes the (unknown) clock offset; the smallest delay seen so far is taken as the
+ * baseline, and the age of a command is its delay in excess of that baseline.
  */
 class StreamResponder : public yarp::os::TypedReaderCallback<yarp::os::Bottle>
 {
 public:
 
-    StreamResponder(roboticslab::ICartesianControl *iCartesianControl)
-    {
-        this->iCartesianControl = iCartesianControl;
-    }
+    StreamResponder(roboticslab::ICartesianControl *iCartesianControl, yarp::os::BufferedPort<yarp::os::Bottle> *commandPort = NULL)
+        : iCartesianControl(iCartesianControl),
+          commandPort(commandPort),
+          latestOnly(false),
+          maxAge(DEFAULT_STREAM_MAX_AGE),
+          lastSeq(-1),
+          lastStamp(0.0),
+          minDelay(0.0),
+          lastReceiveTime(0.0),
+          received(0),
+          applied(0),
+          dropped(0),
+          late(0)
+    {}
 
     void onRead(yarp::os::Bottle& b);
 
+    //! Drop commands superseded by newer (pending or already applied) ones.
+    void setLatestOnly(bool latestOnly)
+    { this->latestOnly = latestOnly; }
+
+    //! Drop commands delayed by more than given age [s], zero disables this check.
+    void setMaxAge(double maxAge)
+    { this->maxAge = maxAge; }
+
+    //! Retrieve number of received, applied, dropped (superseded) and late commands.
+    void getStats(unsigned int * received, unsigned int * applied, unsigned int * dropped, unsigned int * late) const;
+
+    /**
+     * @brief Apply drop policies to an incoming command.
+     *
+     * @param stamp Envelope of the command, invalid if the sender did not provide one.
+     * @param receiveTime Local time at which the command was received [s].
+     * @param pendingReads Number of commands still queued after this one.
+     *
+     * @return True if the command should be forwarded to the controller.
+     */
+    bool acceptCommand(const yarp::os::Stamp & stamp, double receiveTime, int pendingReads);
+
 protected:
 
     typedef void (ICartesianControl::*ConsumerFun)(const std::vector<double>&);
@@ -205,6 +294,19 @@ protected:
     void handleBiConsumerCmdMsg(const yarp::os::Bottle& in, BiConsumerFun cmd);
 
     roboticslab::ICartesianControl *iCartesianControl;
+    yarp::os::BufferedPort<yarp::os::Bottle> *commandPort;
+
+    bool latestOnly;
+    double maxAge;
+
+    int lastSeq;
+    double lastStamp;
+
+    double minDelay; // baseline delay, includes the offset between sender and local clocks
+    double lastReceiveTime;
+
+    unsigned int received, applied, dropped, late;
+    mutable std::mutex statsMutex;
 };
 
 }  // namespace roboticslab
@@ -55,8 +55,21 @@ bool roboticslab::CartesianControlServer::open(yarp::os::Searchable& config)
         return false;
     }
 
-    rpcResponder = new RpcResponder(iCartesianControl);
-    streamResponder = new StreamResponder(iCartesianControl);
+    streamResponder = new StreamResponder(iCartesianControl, &commandPort);
+    rpcResponder = new RpcResponder(iCartesianControl, streamResponder);
+
+    streamResponder->setLatestOnly(config.check("streamLatestOnly", "drop superseded streaming commands"));
+
+    double streamMaxAge = config.check("streamMaxAge", yarp::os::Value(DEFAULT_STREAM_MAX_AGE),
+            "drop streaming commands delayed by more than this (seconds), 0 to disable").asFloat64();
+
+    if (streamMaxAge < 0.0)
+    {
+        yError() << "Illegal streamMaxAge:" << streamMaxAge;
+        return false;
+    }
+
+    streamResponder->setMaxAge(streamMaxAge);
 
     std::string prefix = config.check("name", yarp::os::Value(DEFAULT_PREFIX), "local port prefix").asString();
 
@@ -70,12 +83,34 @@ bool roboticslab::CartesianControlServer::open(yarp::os::Searchable& config)
 
     int periodInMs = config.check("fkPeriod", yarp::os::Value(DEFAULT_MS), "FK stream period (milliseconds)").asInt32();
 
+    fkChangeThreshold = config.check("fkChangeThreshold", yarp::os::Value(DEFAULT_FK_CHANGE_THRESHOLD),
+            "publish FK only if any coordinate changes beyond this value, 0 to disable").asFloat64();
+
+    fkHeartbeat = config.check("fkHeartbeat", yarp::os::Value(DEFAULT_FK_HEARTBEAT),
+            "publish unchanged FK anyway after this time has elapsed (seconds)").asFloat64();
+
     if (periodInMs > 0)
     {
         ok &= fkOutPort.open(prefix + "/state:o");
 
-        yarp::os::PeriodicThread::setPeriod(periodInMs * 0.001);
-        yarp::os::PeriodicThread::start();
+        if (config.check("fkPush", "publish FK as computed by the controller on each control cycle"))
+        {
+            if (iCartesianControl->setStateObserver(this))
+            {
+                yInfo() << "FK stream driven by the controller";
+                fkPushEnabled = true;
+            }
+            else
+            {
+                yWarning() << "Controller cannot push FK data, polling instead";
+            }
+        }
+
+        if (!fkPushEnabled)
+        {
+            yarp::os::PeriodicThread::setPeriod(periodInMs * 0.001);
+            yarp::os::PeriodicThread::start();
+        }
     }
     else
     {
@@ -136,7 +171,7 @@ bool roboticslab::CartesianControlServer::open(yarp::os::Searchable& config)
 
     if (openTransformPort)
     {
-        rpcTransformResponder = new RpcTransformResponder(iCartesianControl, coord, orient, units);
+        rpcTransformResponder = new RpcTransformResponder(iCartesianControl, streamResponder, coord, orient, units);
         ok &= rpcTransformServer.open(prefix + "/rpc_transform:s");
         rpcTransformServer.setReader(*rpcTransformResponder);
     }
@@ -150,7 +185,14 @@ bool roboticslab::CartesianControlServer::close()
 {
     if (fkStreamEnabled)
     {
-        yarp::os::PeriodicThread::stop();
+        if (fkPushEnabled)
+        {
+            iCartesianControl->setStateObserver(NULL);
+        }
+        else
+        {
+            yarp::os::PeriodicThread::stop();
+        }
 
         fkOutPort.interrupt();
         fkOutPort.close();
@@ -2,12 +2,20 @@
 
 #include "CartesianControlServer.hpp"
 
+#include <cmath>
 #include <vector>
 
+#include <yarp/os/Time.h>
+
 // ------------------- PeriodicThread related ------------------------------------
 
 void roboticslab::CartesianControlServer::run()
 {
+    if (fkOutPort.getOutputCount() == 0)
+    {
+        return; // nobody is listening, skip FK
+    }
+
     std::vector<double> x;
     int state;
     double timestamp;
@@ -17,6 +25,51 @@ void roboticslab::CartesianControlServer::run()
         return;
     }
 
+    publishState(x, state, timestamp);
+}
+
+// ------------------- ICartesianStateObserver related ------------------------------------
+
+void roboticslab::CartesianControlServer::onStat(const std::vector<double> &x, int state, double timestamp)
+{
+    if (fkOutPort.getOutputCount() != 0)
+    {
+        publishState(x, state, timestamp);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::CartesianControlServer::isObserving()
+{
+    return fkOutPort.getOutputCount() != 0; // nobody is listening, let the controller skip FK
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::CartesianControlServer::publishState(const std::vector<double> &x, int state, double timestamp)
+{
+    double now = yarp::os::Time::now();
+
+    if (fkChangeThreshold > 0.0 && state == lastState && x.size() == lastX.size() && now - lastPublishTime < fkHeartbeat)
+    {
+        bool changed = false;
+
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            if (std::abs(x[i] - lastX[i]) > fkChangeThreshold)
+            {
+                changed = true;
+                break;
+            }
+        }
+
+        if (!changed)
+        {
+            return;
+        }
+    }
+
     yarp::os::Bottle &out = fkOutPort.prepare();
     out.clear();
     out.addVocab(state);
@@ -30,7 +83,9 @@ void roboticslab::CartesianControlServer::run()
 
     fkOutPort.write();
 
-    return;
+    lastX = x;
+    lastState = state;
+    lastPublishTime = now;
 }
 
 // -----------------------------------------------------------------------------
@@ -51,19 +51,35 @@ bool roboticslab::RpcResponder::respond(const yarp::os::Bottle& in, yarp::os::Bo
     case VOCAB_CC_STAT:
         return handleStatMsg(in, out);
     case VOCAB_CC_INV:
+        if (in.size() > 1 && in.get(1).isList())
+        {
+            return handleBatchFunctionCmdMsg(in, out, &ICartesianControl::inv);
+        }
         return handleFunctionCmdMsg(in, out, &ICartesianControl::inv);
     case VOCAB_CC_MOVJ:
+        if (in.size() > 1 && in.get(1).isList())
+        {
+            return handleBatchConsumerCmdMsg(in, out, &ICartesianControl::movj);
+        }
         return handleConsumerCmdMsg(in, out, &ICartesianControl::movj);
     case VOCAB_CC_RELJ:
         return handleConsumerCmdMsg(in, out, &ICartesianControl::relj);
     case VOCAB_CC_MOVL:
+        if (in.size() > 1 && in.get(1).isList())
+        {
+            return handleBatchConsumerCmdMsg(in, out, &ICartesianControl::movl);
+        }
         return handleConsumerCmdMsg(in, out, &ICartesianControl::movl);
+    case VOCAB_CC_PREVIEW:
+        return handlePreviewMsg(in, out);
     case VOCAB_CC_MOVV:
         return handleConsumerCmdMsg(in, out, &ICartesianControl::movv);
     case VOCAB_CC_GCMP:
         return handleRunnableCmdMsg(in, out, &ICartesianControl::gcmp);
     case VOCAB_CC_FORC:
         return handleConsumerCmdMsg(in, out, &ICartesianControl::forc);
+    case VOCAB_CC_IMPD:
+        return handleConsumerCmdMsg(in, out, &ICartesianControl::impd);
     case VOCAB_CC_STOP:
         return handleRunnableCmdMsg(in, out, &ICartesianControl::stopControl);
     case VOCAB_CC_WAIT:
@@ -72,6 +88,8 @@ bool roboticslab::RpcResponder::respond(const yarp::os::Bottle& in, yarp::os::Bo
         return handleConsumerCmdMsg(in, out, &ICartesianControl::tool);
     case VOCAB_CC_ACT:
         return handleActMsg(in, out);
+    case VOCAB_CC_STREAMING_STATS:
+        return handleStreamingStatsMsg(in, out);
     case VOCAB_CC_SET:
         return isGroupParam(in) ? handleParameterSetterGroup(in, out) : handleParameterSetter(in, out);
     case VOCAB_CC_GET:
@@ -95,10 +113,18 @@ void roboticslab::RpcResponder::makeUsage()
     addUsage(ss.str().c_str(), "accept desired position in cartesian space, return result in joint space");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_INV) << "] (coord1 coord2 ...) (coord1 coord2 ...) ...";
+    addUsage(ss.str().c_str(), "accept several desired positions in cartesian space, return one list per result in joint space (empty on failure)");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_MOVJ) << "] coord1 coord2 ...";
     addUsage(ss.str().c_str(), "joint move to desired position (absolute coordinates in cartesian space)");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_MOVJ) << "] (coord1 coord2 ...) (coord1 coord2 ...) ...";
+    addUsage(ss.str().c_str(), "joint move through several waypoints (absolute coordinates in cartesian space)");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_RELJ) << "] coord1 coord2 ...";
     addUsage(ss.str().c_str(), "joint move to desired position (relative coordinates in cartesian space)");
     ss.str("");
@@ -107,6 +133,14 @@ void roboticslab::RpcResponder::makeUsage()
     addUsage(ss.str().c_str(), "linear move to desired position (absolute coordinates in cartesian space)");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_MOVL) << "] (coord1 coord2 ...) (coord1 coord2 ...) ...";
+    addUsage(ss.str().c_str(), "linear move through several waypoints with blended corners (absolute coordinates in cartesian space)");
+    ss.str("");
+
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_PREVIEW) << "] (coord1 coord2 ...) (coord1 coord2 ...) ...";
+    addUsage(ss.str().c_str(), "check linear move without executing it, return [ok] or [fail] violation time, then peak joint velocities");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_MOVV) << "] coord1 coord2 ...";
     addUsage(ss.str().c_str(), "velocity move using supplied vector (cartesian space)");
     ss.str("");
@@ -119,6 +153,10 @@ void roboticslab::RpcResponder::makeUsage()
     addUsage(ss.str().c_str(), "enable torque control, apply input forces (cartesian space)");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_IMPD) << "] coord1 coord2 ...";
+    addUsage(ss.str().c_str(), "enable torque control, hold input pose through a spring-damper (cartesian space)");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_STOP) << "]";
     addUsage(ss.str().c_str(), "stop control");
     ss.str("");
@@ -135,6 +173,10 @@ void roboticslab::RpcResponder::makeUsage()
     addUsage(ss.str().c_str(), "actuate tool using selected command vocab");
     ss.str("");
 
+    ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_STREAMING_STATS) << "]";
+    addUsage(ss.str().c_str(), "get streaming command statistics: received, applied, dropped (superseded) and late");
+    ss.str("");
+
     ss << "[" << yarp::os::Vocab::decode(VOCAB_CC_SET) << "] vocab value";
     addUsage(ss.str().c_str(), "set configuration parameter");
     ss.str("");
@@ -188,6 +230,22 @@ void roboticslab::RpcResponder::makeUsage()
     ss << "... [" << yarp::os::Vocab::decode(VOCAB_CC_CONFIG_STREAMING_CMD) << "] vocab";
     addUsage(ss.str().c_str(), ss_cmd.str().c_str());
     ss.str("");
+
+    ss << "... [" << yarp::os::Vocab::decode(VOCAB_CC_CONFIG_BLEND_RADIUS) << "] value";
+    addUsage(ss.str().c_str(), "(config param) corner blend radius of multi-waypoint linear moves [m]");
+    ss.str("");
+
+    ss << "... [" << yarp::os::Vocab::decode(VOCAB_CC_CONFIG_TOOL_VERSION) << "] value";
+    addUsage(ss.str().c_str(), "(config param) tool change counter (read-only)");
+    ss.str("");
+
+    ss << "... [" << yarp::os::Vocab::decode(VOCAB_CC_CONFIG_GCMP_TOLERANCE) << "] value";
+    addUsage(ss.str().c_str(), "(config param) joint deviation that invalidates cached gravity torques [deg], 0 disables");
+    ss.str("");
+
+    ss << "... [" << yarp::os::Vocab::decode(VOCAB_CC_CONFIG_GCMP_HIT_RATE) << "] value";
+    addUsage(ss.str().c_str(), "(config param) ratio of gravity compensation cycles served from cache (read-only)");
+    ss.str("");
 }
 
 // -----------------------------------------------------------------------------
@@ -279,6 +337,99 @@ bool roboticslab::RpcResponder::handleActMsg(const yarp::os::Bottle& in, yarp::o
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::RpcResponder::handlePreviewMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out)
+{
+    if (in.size() < 2)
+    {
+        yError() << "Size error:" << in.size();
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+
+    std::vector< std::vector<double> > xds(in.size() - 1);
+
+    for (size_t i = 1; i < in.size(); i++)
+    {
+        yarp::os::Bottle * b = in.get(i).asList();
+
+        if (b == NULL)
+        {
+            yError() << "Expected list at position" << i;
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+
+        std::vector<double> & xd = xds[i - 1];
+
+        for (size_t j = 0; j < b->size(); j++)
+        {
+            xd.push_back(b->get(j).asFloat64());
+        }
+
+        if (!transformIncomingData(xd))
+        {
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+    }
+
+    std::vector<double> qdotPeaks;
+    double failTime = -1.0;
+    int failReason = VOCAB_CC_NOT_SET;
+
+    bool ok = iCartesianControl->preview(xds, qdotPeaks, &failTime, &failReason);
+
+    if (ok)
+    {
+        out.addVocab(VOCAB_CC_OK);
+    }
+    else if (failReason != VOCAB_CC_NOT_SET)
+    {
+        out.addVocab(VOCAB_CC_FAILED);
+        out.addVocab(failReason);
+        out.addFloat64(failTime);
+    }
+    else
+    {
+        // could not plan the move
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+
+    yarp::os::Bottle & b = out.addList();
+
+    for (size_t i = 0; i < qdotPeaks.size(); i++)
+    {
+        b.addFloat64(qdotPeaks[i]);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RpcResponder::handleStreamingStatsMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out)
+{
+    if (streamResponder == NULL)
+    {
+        yError() << "Streaming command statistics not available";
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+
+    unsigned int received, applied, dropped, late;
+    streamResponder->getStats(&received, &applied, &dropped, &late);
+
+    out.addInt32(received);
+    out.addInt32(applied);
+    out.addInt32(dropped);
+    out.addInt32(late);
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::RpcResponder::handleRunnableCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, RunnableFun cmd)
 {
     if ((iCartesianControl->*cmd)())
@@ -359,6 +510,119 @@ bool roboticslab::RpcResponder::handleFunctionCmdMsg(const yarp::os::Bottle& in,
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::RpcResponder::handleBatchConsumerCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, BatchConsumerFun cmd)
+{
+    if (in.size() > 1)
+    {
+        std::vector< std::vector<double> > vins(in.size() - 1);
+
+        for (size_t i = 1; i < in.size(); i++)
+        {
+            yarp::os::Bottle * b = in.get(i).asList();
+
+            if (b == NULL)
+            {
+                yError() << "Expected list at position" << i;
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+
+            std::vector<double> & vin = vins[i - 1];
+
+            for (size_t j = 0; j < b->size(); j++)
+            {
+                vin.push_back(b->get(j).asFloat64());
+            }
+
+            if (!transformIncomingData(vin))
+            {
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+        }
+
+        if (!(iCartesianControl->*cmd)(vins))
+        {
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+
+        out.addVocab(VOCAB_CC_OK);
+        return true;
+    }
+    else
+    {
+        yError() << "Size error:" << in.size();
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::RpcResponder::handleBatchFunctionCmdMsg(const yarp::os::Bottle& in, yarp::os::Bottle& out, BatchFunctionFun cmd)
+{
+    if (in.size() > 1)
+    {
+        std::vector< std::vector<double> > vins(in.size() - 1), vouts;
+
+        for (size_t i = 1; i < in.size(); i++)
+        {
+            yarp::os::Bottle * b = in.get(i).asList();
+
+            if (b == NULL)
+            {
+                yError() << "Expected list at position" << i;
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+
+            std::vector<double> & vin = vins[i - 1];
+
+            for (size_t j = 0; j < b->size(); j++)
+            {
+                vin.push_back(b->get(j).asFloat64());
+            }
+
+            if (!transformIncomingData(vin))
+            {
+                out.addVocab(VOCAB_CC_FAILED);
+                return false;
+            }
+        }
+
+        //-- Per-pose failures are reported as empty lists, only a batch that could not
+        //-- be processed at all is a failed command
+        (iCartesianControl->*cmd)(vins, vouts);
+
+        if (vouts.size() != vins.size())
+        {
+            out.addVocab(VOCAB_CC_FAILED);
+            return false;
+        }
+
+        for (size_t i = 0; i < vouts.size(); i++)
+        {
+            yarp::os::Bottle & b = out.addList();
+
+            for (size_t j = 0; j < vouts[i].size(); j++)
+            {
+                b.addFloat64(vouts[i][j]);
+            }
+        }
+
+        return true;
+    }
+    else
+    {
+        yError() << "Size error:" << in.size();
+        out.addVocab(VOCAB_CC_FAILED);
+        return false;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
 bool roboticslab::RpcResponder::handleParameterSetter(const yarp::os::Bottle& in, yarp::os::Bottle& out)
 {
     if (in.size() > 2)
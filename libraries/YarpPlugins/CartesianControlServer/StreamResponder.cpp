@@ -2,9 +2,18 @@
 
 #include "CartesianControlServer.hpp"
 
+#include <algorithm>
 #include <vector>
 
 #include <yarp/os/LogStream.h>
+#include <yarp/os/Stamp.h>
+#include <yarp/os/Time.h>
+
+namespace
+{
+    // tolerated relative drift between sender and local clocks
+    const double CLOCK_DRIFT = 1e-4;
+}
 
 // ------------------- StreamResponder Related ------------------------------------
 
@@ -12,6 +21,21 @@ void roboticslab::StreamResponder::onRead(yarp::os::Bottle& b)
 {
     yDebug("Got: %s", b.toString().c_str());
 
+    double receiveTime = yarp::os::Time::now();
+    yarp::os::Stamp stamp;
+    int pendingReads = 0;
+
+    if (commandPort != NULL)
+    {
+        commandPort->getEnvelope(stamp);
+        pendingReads = commandPort->getPendingReads();
+    }
+
+    if (!acceptCommand(stamp, receiveTime, pendingReads))
+    {
+        return;
+    }
+
     switch (b.get(0).asVocab())
     {
     case VOCAB_CC_TWIST:
@@ -31,6 +55,87 @@ void roboticslab::StreamResponder::onRead(yarp::os::Bottle& b)
 
 // -----------------------------------------------------------------------------
 
+bool roboticslab::StreamResponder::acceptCommand(const yarp::os::Stamp & stamp, double receiveTime, int pendingReads)
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    received++;
+
+    if (!stamp.isValid())
+    {
+        // no sequence number nor timestamp, assume legacy sender
+        applied++;
+        return true;
+    }
+
+    // a lower sequence number with a newer timestamp means that the sender has been restarted
+    bool restarted = stamp.getCount() <= lastSeq && stamp.getTime() > lastStamp;
+    bool outOfOrder = stamp.getCount() <= lastSeq && !restarted;
+
+    // send timestamps belong to the sender clock, only differences between delays are meaningful
+    double delay = receiveTime - stamp.getTime();
+
+    if (lastSeq < 0 || restarted)
+    {
+        minDelay = delay;
+    }
+    else
+    {
+        // let the baseline follow slow drifts between both clocks
+        minDelay = std::min(delay, minDelay + CLOCK_DRIFT * (receiveTime - lastReceiveTime));
+    }
+
+    lastReceiveTime = receiveTime;
+
+    if (!outOfOrder)
+    {
+        lastSeq = stamp.getCount();
+        lastStamp = stamp.getTime();
+    }
+
+    if (maxAge > 0.0 && delay - minDelay > maxAge)
+    {
+        yDebug("Late command dropped (seq %d, age %f)", stamp.getCount(), delay - minDelay);
+        late++;
+        return false;
+    }
+
+    if (latestOnly)
+    {
+        if (outOfOrder)
+        {
+            yDebug("Out-of-order command dropped (seq %d, last %d)", stamp.getCount(), lastSeq);
+            dropped++;
+            return false;
+        }
+
+        if (pendingReads > 0)
+        {
+            yDebug("Superseded command dropped (seq %d)", stamp.getCount());
+            dropped++;
+            return false;
+        }
+    }
+
+    applied++;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void roboticslab::StreamResponder::getStats(unsigned int * received, unsigned int * applied, unsigned int * dropped,
+        unsigned int * late) const
+{
+    std::lock_guard<std::mutex> lock(statsMutex);
+
+    *received = this->received;
+    *applied = this->applied;
+    *dropped = this->dropped;
+    *late = this->late;
+}
+
+// -----------------------------------------------------------------------------
+
 void roboticslab::StreamResponder::handleConsumerCmdMsg(const yarp::os::Bottle& in, ConsumerFun cmd)
 {
     if (in.size() > 1)
@@ -58,10 +58,28 @@
 #define VOCAB_CC_MOVV ROBOTICSLAB_VOCAB('m','o','v','v') ///< Linear move with given velocity
 #define VOCAB_CC_GCMP ROBOTICSLAB_VOCAB('g','c','m','p') ///< Gravity compensation
 #define VOCAB_CC_FORC ROBOTICSLAB_VOCAB('f','o','r','c') ///< Force control
+#define VOCAB_CC_IMPD ROBOTICSLAB_VOCAB('i','m','p','d') ///< Cartesian impedance control
 #define VOCAB_CC_STOP ROBOTICSLAB_VOCAB('s','t','o','p') ///< Stop control
 #define VOCAB_CC_WAIT ROBOTICSLAB_VOCAB('w','a','i','t') ///< Wait motion done
 #define VOCAB_CC_TOOL ROBOTICSLAB_VOCAB('t','o','o','l') ///< Change tool
 #define VOCAB_CC_ACT ROBOTICSLAB_VOCAB('a','c','t',0)    ///< Actuate tool
+#define VOCAB_CC_PREVIEW ROBOTICSLAB_VOCAB('p','r','v','w') ///< Check linear move without executing it
+
+/** @} */
+
+/**
+ * @name Preview violation vocabs
+ *
+ * Used by roboticslab::ICartesianControl::preview to report the first violation found.
+ *
+ * @{
+ */
+
+// Preview violations
+#define VOCAB_CC_PREVIEW_UNREACHABLE ROBOTICSLAB_VOCAB('p','v','u','r')    ///< Inverse kinematics failed
+#define VOCAB_CC_PREVIEW_JOINT_LIMIT ROBOTICSLAB_VOCAB('p','v','j','l')    ///< Joint position out of limits
+#define VOCAB_CC_PREVIEW_VELOCITY_LIMIT ROBOTICSLAB_VOCAB('p','v','v','l') ///< Joint velocity out of limits
+#define VOCAB_CC_PREVIEW_TRAJECTORY ROBOTICSLAB_VOCAB('p','v','t','r')     ///< Cartesian trajectory evaluation failed
 
 /** @} */
 
@@ -95,6 +113,7 @@
 #define VOCAB_CC_MOVV_CONTROLLING ROBOTICSLAB_VOCAB('c','c','v','c') ///< Controlling MOVV commands
 #define VOCAB_CC_GCMP_CONTROLLING ROBOTICSLAB_VOCAB('c','c','g','c') ///< Controlling GCMP commands
 #define VOCAB_CC_FORC_CONTROLLING ROBOTICSLAB_VOCAB('c','c','f','c') ///< Controlling FORC commands
+#define VOCAB_CC_IMPD_CONTROLLING ROBOTICSLAB_VOCAB('c','c','i','c') ///< Controlling IMPD commands
 
 /** @} */
 
@@ -130,12 +149,53 @@
 #define VOCAB_CC_CONFIG_WAIT_PERIOD ROBOTICSLAB_VOCAB('c','p','w','p')      ///< Check period of 'wait' command [ms]
 #define VOCAB_CC_CONFIG_FRAME ROBOTICSLAB_VOCAB('c','p','f',0)              ///< Reference frame
 #define VOCAB_CC_CONFIG_STREAMING_CMD ROBOTICSLAB_VOCAB('c','p','s','c')    ///< Preset streaming command
+#define VOCAB_CC_CONFIG_TOOL_VERSION ROBOTICSLAB_VOCAB('c','p','t','v')     ///< Tool change counter (read-only)
+#define VOCAB_CC_CONFIG_BLEND_RADIUS ROBOTICSLAB_VOCAB('c','p','b','r')     ///< Corner blend radius of multi-waypoint MOVL [m]
+#define VOCAB_CC_CONFIG_GCMP_TOLERANCE ROBOTICSLAB_VOCAB('c','p','g','t')   ///< Joint deviation that invalidates cached GCMP torques [deg], 0 disables
+#define VOCAB_CC_CONFIG_GCMP_HIT_RATE ROBOTICSLAB_VOCAB('c','p','g','h')    ///< Ratio of GCMP cycles served from cache (read-only)
 
 /** @} */
 
 namespace roboticslab
 {
 
+/**
+ * @brief Abstract base class for a listener of cartesian controller state updates.
+ *
+ * @see ICartesianControl::setStateObserver
+ */
+class ICartesianStateObserver
+{
+    public:
+
+        //! Destructor
+        virtual ~ICartesianStateObserver() {}
+
+        /**
+         * @brief Receive current state and position
+         *
+         * Invoked from the control thread, keep it short and non-blocking.
+         *
+         * @param x 6-element vector describing current position in cartesian space; first
+         * three elements denote translation (meters), last three denote rotation in scaled
+         * axis-angle representation (radians).
+         * @param state Identifier for a cartesian control vocab.
+         * @param timestamp Remote encoder acquisition time.
+         */
+        virtual void onStat(const std::vector<double> &x, int state, double timestamp) = 0;
+
+        /**
+         * @brief Check whether state updates are wanted right now
+         *
+         * Queried from the control thread on each cycle, before computing forward kinematics
+         * for this observer; keep it short and non-blocking.
+         *
+         * @return true if @ref onStat should be invoked during this cycle.
+         */
+        virtual bool isObserving()
+        { return true; }
+};
+
 /**
  * @brief Abstract base class for a cartesian controller.
  */
@@ -186,6 +246,23 @@ class ICartesianControl
          */
         virtual bool inv(const std::vector<double> &xd, std::vector<double> &q) = 0;
 
+        /**
+         * @brief Inverse kinematics (batch)
+         *
+         * Perform inverse kinematics on a set of poses (using robot position as initial guess
+         * for each of them), but do not move. Saves round trips when many candidate poses are
+         * tested at once.
+         *
+         * @param xds Vector of 6-element vectors describing desired positions in cartesian space;
+         * first three elements denote translation (meters), last three denote rotation in scaled
+         * axis-angle representation (radians).
+         * @param qs Vector of results in joint space (meters or degrees), one per pose; an empty
+         * vector is stored for each pose that could not be solved.
+         *
+         * @return true if all poses were solved, false otherwise
+         */
+        virtual bool inv(const std::vector< std::vector<double> > &xds, std::vector< std::vector<double> > &qs) = 0;
+
         /**
          * @brief Move in joint space, absolute coordinates
          *
@@ -202,6 +279,20 @@ class ICartesianControl
          */
         virtual bool movj(const std::vector<double> &xd) = 0;
 
+        /**
+         * @brief Move in joint space through several waypoints
+         *
+         * Perform inverse kinematics on each waypoint and move through all resulting joint
+         * positions, without stopping at intermediate ones if supported by the implementation.
+         *
+         * @param xds Vector of 6-element vectors describing waypoints in cartesian space; first
+         * three elements denote translation (meters), last three denote rotation in scaled
+         * axis-angle representation (radians).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool movj(const std::vector< std::vector<double> > &xds) = 0;
+
         /**
          * @brief Move in joint space, relative coordinates
          *
@@ -231,6 +322,43 @@ class ICartesianControl
          */
         virtual bool movl(const std::vector<double> &xd) = 0;
 
+        /**
+         * @brief Linear move through several waypoints
+         *
+         * Move along a path of straight segments that joins all waypoints, corners
+         * are blended so that the robot does not stop until the last one is reached.
+         * Repeated waypoints are skipped. Via points that need a stop are rejected:
+         * a pure reorientation, or a path reversing onto itself.
+         *
+         * @param xds Vector of 6-element vectors describing waypoints in cartesian space; first
+         * three elements denote translation (meters), last three denote rotation in scaled
+         * axis-angle representation (radians).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool movl(const std::vector< std::vector<double> > &xds) = 0;
+
+        /**
+         * @brief Check a linear move without executing it
+         *
+         * Plan the same trajectory as @ref movl would, sample it at control rate and solve
+         * inverse kinematics (position and differential) on each sample, assuming perfect
+         * tracking. Stops at the first violation of joint position or velocity limits.
+         * Samples are solved in order, each one seeded with the solution of the previous one.
+         *
+         * @param xds Vector of 6-element vectors describing waypoints in cartesian space, as
+         * in @ref movl.
+         * @param qdotPeaks Peak absolute joint velocities found up to the first violation, if
+         * any (meters/second or degrees/second).
+         * @param failTime Time since start of first violation (seconds), negative if none.
+         * @param failReason Vocab describing first violation (see @ref VOCAB_CC_PREVIEW_UNREACHABLE
+         * and following), @ref VOCAB_CC_NOT_SET if none.
+         *
+         * @return true if the move is feasible, false otherwise
+         */
+        virtual bool preview(const std::vector< std::vector<double> > &xds, std::vector<double> &qdotPeaks,
+                             double * failTime = 0, int * failReason = 0) = 0;
+
         /**
          * @brief Linear move with given velocity
          *
@@ -266,6 +394,20 @@ class ICartesianControl
          */
         virtual bool forc(const std::vector<double> &td) = 0;
 
+        /**
+         * @brief Cartesian impedance control
+         *
+         * Hold the TCP at a pose through a virtual spring and damper in task space, the
+         * resulting wrench is mapped to joint torques on top of gravity compensation.
+         *
+         * @param xd 6-element vector describing the equilibrium pose in cartesian space; first
+         * three elements denote translation (meters), last three denote rotation in scaled
+         * axis-angle representation (radians).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool impd(const std::vector<double> &xd) = 0;
+
         /**
          * @brief Stop control
          *
@@ -420,6 +562,21 @@ class ICartesianControl
         virtual bool getParameters(std::map<int, double> & params) = 0;
 
         /** @} */
+
+        //--------------------- Local observers ---------------------
+
+        /**
+         * @brief Register a state observer
+         *
+         * Ask the controller to push its current state and forward kinematics once per
+         * control cycle, reusing the values it has already computed for its own purposes.
+         * Only one observer can be registered at a time.
+         *
+         * @param observer Instance to be notified, NULL to unregister the previous one.
+         *
+         * @return true on success, false if not supported
+         */
+        virtual bool setStateObserver(ICartesianStateObserver * observer) = 0;
 };
 
 }  // namespace roboticslab
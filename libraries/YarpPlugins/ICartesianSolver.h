@@ -175,6 +175,78 @@ class ICartesianSolver
          */
         virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot, const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t) = 0;
 
+        /**
+         * @brief Perform inverse dynamics on caller-owned storage
+         *
+         * Meant for periodic torque control: implementations should not allocate memory
+         * once configured, so that callers can reuse their own buffers every cycle.
+         *
+         * @param q Array of joint positions (meters or degrees), one per configured joint.
+         * @param qdot Array of joint velocities (meters/second or degrees/second), NULL for null velocities.
+         * @param qdotdot Array of joint accelerations (meters/second² or degrees/second²), NULL for null
+         * accelerations.
+         * @param fexts Flattened external forces, six consecutive elements per robot segment starting
+         * at the base (same layout as each element of the vector overload), NULL for no external forces.
+         * @param numFexts Number of six-element external forces stored in @p fexts.
+         * @param t Array of joint torques or forces, one per configured joint.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool invDyn(const double *q, const double *qdot, const double *qdotdot, const double *fexts, int numFexts, double *t) = 0;
+
+        /**
+         * @brief Compute the joint-space inertia matrix
+         *
+         * @param q Vector describing current position in joint space (meters or degrees).
+         * @param M Joint-space inertia matrix stored row by row, as many rows and columns as configured
+         * joints; maps joint accelerations in SI units (meters/second² or radians/second²) to joint
+         * torques or forces.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool massMatrix(const std::vector<double> &q, std::vector<double> &M) = 0;
+
+        /**
+         * @brief Compute pose and geometric Jacobian on caller-owned storage
+         *
+         * Meant for torque control loops that need both quantities on each cycle.
+         *
+         * @param q Array of joint positions (meters or degrees), one per configured joint.
+         * @param x 6-element array describing the same position in cartesian space (same layout
+         * as in @ref fwdKin), NULL if not needed.
+         * @param J Jacobian stored row by row, six rows and as many columns as configured joints;
+         * maps joint velocities in SI units (meters/second or radians/second) to the twist of the
+         * TCP, expressed in the base frame (translational velocity first).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool jacobian(const double *q, double *x, double *J) = 0;
+
+        /**
+         * @brief Compute Coriolis and centrifugal joint torques
+         *
+         * @param q Vector describing current position in joint space (meters or degrees).
+         * @param qdot Vector describing current velocity in joint space (meters/second or degrees/second).
+         * @param c Vector of joint torques or forces induced by Coriolis and centrifugal effects.
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool coriolisTorques(const std::vector<double> &q, const std::vector<double> &qdot, std::vector<double> &c) = 0;
+
+        /**
+         * @brief Perform forward dynamics
+         *
+         * Assumes no external forces.
+         *
+         * @param q Vector describing current position in joint space (meters or degrees).
+         * @param qdot Vector describing current velocity in joint space (meters/second or degrees/second).
+         * @param t Vector of applied joint torques or forces.
+         * @param qdotdot Vector describing resulting acceleration in joint space (meters/second² or degrees/second²).
+         *
+         * @return true on success, false otherwise
+         */
+        virtual bool fwdDyn(const std::vector<double> &q, const std::vector<double> &qdot, const std::vector<double> &t, std::vector<double> &qdotdot) = 0;
+
 };
 
 }  // namespace roboticslab
@@ -0,0 +1,118 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ChainIdSolver_ST.hpp"
+
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+ChainIdSolver_ST::ChainIdSolver_ST(const KDL::Chain & _chain, const KDL::Vector & _gravity)
+    : chain(_chain),
+      gravity(_gravity),
+      dynamics(PoeExpression::fromChain(_chain), _gravity)
+{
+    mapSegments();
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIdSolver_ST::mapSegments()
+{
+    segmentLinks.resize(chain.getNrOfSegments());
+    segmentFrames.resize(chain.getNrOfSegments());
+    jointInertias.resize(chain.getNrOfJoints());
+    linkFexts.resize(chain.getNrOfJoints());
+
+    KDL::Frame H_S_prev;
+    int link = -1;
+
+    for (int i = 0; i < chain.getNrOfSegments(); i++)
+    {
+        const KDL::Segment & segment = chain.getSegment(i);
+
+        if (segment.getJoint().getType() != KDL::Joint::None)
+        {
+            link++;
+            jointInertias[link] = segment.getJoint().getInertia();
+        }
+
+        H_S_prev = H_S_prev * segment.pose(0);
+
+        segmentLinks[i] = link;
+        segmentFrames[i] = H_S_prev;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int ChainIdSolver_ST::CartToJnt(const KDL::JntArray & q, const KDL::JntArray & q_dot, const KDL::JntArray & q_dotdot,
+        const KDL::Wrenches & f_ext, KDL::JntArray & torques)
+{
+    if (segmentLinks.size() != chain.getNrOfSegments() || dynamics.size() != chain.getNrOfJoints())
+    {
+        return (error = E_NOT_UP_TO_DATE);
+    }
+
+    if (q.rows() != chain.getNrOfJoints() || q_dot.rows() != chain.getNrOfJoints()
+            || q_dotdot.rows() != chain.getNrOfJoints() || torques.rows() != chain.getNrOfJoints()
+            || f_ext.size() != chain.getNrOfSegments())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    bool moving = false;
+    bool pushed = false;
+
+    for (int i = 0; i < chain.getNrOfJoints(); i++)
+    {
+        linkFexts[i] = KDL::Wrench::Zero();
+        moving = moving || q_dot(i) != 0.0 || q_dotdot(i) != 0.0;
+    }
+
+    for (int i = 0; i < chain.getNrOfSegments(); i++)
+    {
+        // wrenches on static segments do not reach any joint
+        if (segmentLinks[i] >= 0 && f_ext[i] != KDL::Wrench::Zero())
+        {
+            linkFexts[segmentLinks[i]] += segmentFrames[i] * f_ext[i];
+            pushed = true;
+        }
+    }
+
+    if (!moving && !pushed)
+    {
+        return (error = dynamics.gravityTorques(q, torques) ? E_NOERROR : E_SIZE_MISMATCH);
+    }
+
+    if (!dynamics.inverseDynamics(q, q_dot, q_dotdot, linkFexts, torques))
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    for (int i = 0; i < chain.getNrOfJoints(); i++)
+    {
+        torques(i) += jointInertias[i] * q_dotdot(i);
+    }
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIdSolver_ST::updateInternalDataStructures()
+{
+    dynamics = ScrewTheoryDynamics(PoeExpression::fromChain(chain), gravity);
+    mapSegments();
+}
+
+// -----------------------------------------------------------------------------
+
+KDL::ChainIdSolver * ChainIdSolver_ST::create(const KDL::Chain & chain, const KDL::Vector & gravity)
+{
+    return new ChainIdSolver_ST(chain, gravity);
+}
+
+// -----------------------------------------------------------------------------
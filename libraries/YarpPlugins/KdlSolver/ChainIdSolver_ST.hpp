@@ -0,0 +1,87 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __CHAIN_ID_SOLVER_ST_HPP__
+#define __CHAIN_ID_SOLVER_ST_HPP__
+
+#include <vector>
+
+#include <kdl/chainidsolver.hpp>
+
+#include "ScrewTheoryDynamics.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief ID solver using Screw Theory.
+ *
+ * Implementation of a recursive Newton-Euler inverse dynamics algorithm. This is a thin
+ * wrapper around \ref ScrewTheoryDynamics, a drop-in replacement for KDL::ChainIdSolver_RNE.
+ * External wrenches are expressed in the frame of each segment, as in KDL. Pure gravity
+ * compensation requests (null velocities and accelerations, no external wrenches) take
+ * a faster path that only involves link masses and centers of mass.
+ */
+class ChainIdSolver_ST : public KDL::ChainIdSolver
+{
+public:
+
+    /**
+     * @brief Calculate inverse dynamics.
+     *
+     * @param q Input joint positions.
+     * @param q_dot Input joint velocities.
+     * @param q_dotdot Input joint accelerations.
+     * @param f_ext External wrenches applied on each segment, expressed in segment frames.
+     * @param torques Output joint torques or forces.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    virtual int CartToJnt(const KDL::JntArray & q, const KDL::JntArray & q_dot, const KDL::JntArray & q_dotdot,
+                          const KDL::Wrenches & f_ext, KDL::JntArray & torques);
+
+    /**
+     * @brief Update the internal data structures.
+     *
+     * Update the internal data structures. This is required if the number of segments
+     * or number of joints of a chain has changed. This provides a single point of contact
+     * for solver memory allocations.
+     */
+    virtual void updateInternalDataStructures();
+
+    /**
+     * @brief Create an instance of \ref ChainIdSolver_ST.
+     *
+     * @param chain Input kinematic chain.
+     * @param gravity Gravity vector expressed in the base frame.
+     *
+     * @return Solver instance.
+     */
+    static KDL::ChainIdSolver * create(const KDL::Chain & chain, const KDL::Vector & gravity);
+
+private:
+
+    ChainIdSolver_ST(const KDL::Chain & chain, const KDL::Vector & gravity);
+
+    void mapSegments();
+
+    const KDL::Chain & chain;
+
+    KDL::Vector gravity;
+
+    ScrewTheoryDynamics dynamics;
+
+    //! Per segment: index of the link it belongs to (-1 if static) and tip frame at zero position.
+    std::vector<int> segmentLinks;
+    std::vector<KDL::Frame> segmentFrames;
+
+    //! Per joint: rotor inertia as configured in KDL::Joint.
+    std::vector<double> jointInertias;
+
+    //! Per link: external wrenches referred to the base frame at zero position.
+    std::vector<KDL::Wrench> linkFexts;
+};
+
+}  // namespace roboticslab
+
+#endif  // __CHAIN_ID_SOLVER_ST_HPP__
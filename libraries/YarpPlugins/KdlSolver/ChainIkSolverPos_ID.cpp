@@ -2,15 +2,36 @@
 
 #include "ChainIkSolverPos_ID.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
-#include <vector>
 
 #include <kdl/frames.hpp>
 
-#include <Eigen/Core>
-
 using namespace roboticslab;
 
+namespace
+{
+    //-- Distance to the joint limit in the direction of the step, zero if already beyond.
+    inline double roomToLimit(double q, double step, double qMin, double qMax)
+    {
+        return std::max(step > 0.0 ? qMax - q : q - qMin, 0.0);
+    }
+
+    //-- Smooth saturation: untouched in the first half of the room, then approaches the limit exponentially.
+    inline double shortenStep(double step, double room)
+    {
+        double half = room / 2;
+
+        if (std::abs(step) <= half)
+        {
+            return step;
+        }
+
+        return std::copysign(half - half * std::expm1(-(std::abs(step) - half) / half), step);
+    }
+}
+
 // -----------------------------------------------------------------------------
 
 ChainIkSolverPos_ID::ChainIkSolverPos_ID(const KDL::Chain & _chain, const KDL::JntArray & _q_min,
@@ -21,11 +42,35 @@ ChainIkSolverPos_ID::ChainIkSolverPos_ID(const KDL::Chain & _chain, const KDL::J
       qMax(_q_max),
       fkSolverPos(fksolver),
       jacSolver(chain),
-      jacobian(nj)
+      jacobian(nj),
+      damped(false),
+      lambdaMax(0.0),
+      w0(0.0),
+      jacobianBuffer(6, nj),
+      svd(6, nj, Eigen::ComputeThinU | Eigen::ComputeThinV),
+      tmp(std::min<int>(6, nj)),
+      delta(nj),
+      deltaLocked(nj),
+      locked(nj)
 {}
 
 // -----------------------------------------------------------------------------
 
+bool ChainIkSolverPos_ID::setAdaptiveDamping(double _lambdaMax, double _w0)
+{
+    if (_lambdaMax < 0.0 || _w0 < 0.0)
+    {
+        return false;
+    }
+
+    damped = true;
+    lambdaMax = _lambdaMax;
+    w0 = _w0;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
 int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out)
 {
     if (nj != chain.getNrOfJoints())
@@ -52,9 +97,22 @@ int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
         return (error = E_JACSOLVER_FAILED);
     }
 
-    KDL::JntArray delta_q = computeDiffInvKin(delta_twist);
+    for (int i = 0; i < 6; i++)
+    {
+        e(i) = delta_twist[i];
+    }
 
-    KDL::Add(q_init, delta_q, q_out);
+    if (damped)
+    {
+        computeDampedDiffInvKin();
+        limitStep(q_init);
+        KDL::Add(q_init, delta, q_out);
+        return (error = E_NOERROR);
+    }
+
+    computeDiffInvKin();
+
+    KDL::Add(q_init, delta, q_out);
 
     for (unsigned int j = 0; j < qMin.rows(); j++)
     {
@@ -77,29 +135,88 @@ int ChainIkSolverPos_ID::CartToJnt(const KDL::JntArray & q_init, const KDL::Fram
 
 // -----------------------------------------------------------------------------
 
-KDL::JntArray ChainIkSolverPos_ID::computeDiffInvKin(const KDL::Twist & delta_twist)
+void ChainIkSolverPos_ID::computeDiffInvKin()
 {
     // Samuel R. Buss, "Introduction to Inverse Kinematics with Jacobian Transpose,
     // Pseudoinverse and Damped Least Squares methods", Department of Mathematics,
     // University of California, San Diego [unpublished].
 
-    KDL::JntArray q(nj);
+    delta.data.noalias() = jacobian.data.transpose() * e;
+    JJTe.noalias() = jacobian.data * delta.data;
 
-    Eigen::Matrix<double, 6, 1> e;
+    double alpha = e.dot(JJTe) / JJTe.dot(JJTe);
 
-    e[0] = delta_twist.vel.x();
-    e[1] = delta_twist.vel.y();
-    e[2] = delta_twist.vel.z();
-    e[3] = delta_twist.rot.x();
-    e[4] = delta_twist.rot.y();
-    e[5] = delta_twist.rot.z();
+    delta.data *= alpha;
+}
 
-    Eigen::Matrix<double, 6, 1> JJTe = jacobian.data * jacobian.data.transpose() * e;
-    double alpha = e.dot(JJTe) / JJTe.dot(JJTe);
+// -----------------------------------------------------------------------------
 
-    q.data = alpha * jacobian.data.transpose() * e;
+void ChainIkSolverPos_ID::computeDampedDiffInvKin()
+{
+    // Y. Nakamura, H. Hanafusa, "Inverse Kinematic Solutions With Singularity Robustness
+    // for Robot Manipulator Control", J. Dyn. Sys., Meas., Control 108(3), 1986.
+
+    jacobianBuffer = jacobian.data;
+    svd.compute(jacobianBuffer);
+
+    const Eigen::VectorXd & sigma = svd.singularValues();
+    double w = sigma.prod();
+    double lambda = 0.0;
+
+    if (w < w0)
+    {
+        lambda = lambdaMax * (1.0 - w / w0) * (1.0 - w / w0);
+    }
+
+    tmp.noalias() = svd.matrixU().transpose() * e;
+
+    for (int i = 0; i < sigma.size(); i++)
+    {
+        double den = sigma(i) * sigma(i) + lambda * lambda;
+        tmp(i) = den > std::numeric_limits<double>::epsilon() ? tmp(i) * sigma(i) / den : 0.0;
+    }
+
+    delta.data.noalias() = svd.matrixV() * tmp;
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverPos_ID::limitStep(const KDL::JntArray & q)
+{
+    bool anyLocked = false;
 
-    return q;
+    //-- Lock joints whose full step would cross the limit they are heading to.
+    for (unsigned int j = 0; j < nj; j++)
+    {
+        double room = roomToLimit(q(j), delta(j), qMin(j), qMax(j));
+        locked[j] = std::abs(delta(j)) > room;
+
+        if (locked[j])
+        {
+            deltaLocked(j) = shortenStep(delta(j), room);
+            e -= jacobian.data.col(j) * deltaLocked(j);
+            jacobian.data.col(j).setZero();
+            anyLocked = true;
+        }
+    }
+
+    //-- Let the remaining joints take over the rest of the task.
+    if (anyLocked)
+    {
+        computeDampedDiffInvKin();
+    }
+
+    for (unsigned int j = 0; j < nj; j++)
+    {
+        if (locked[j])
+        {
+            delta(j) = deltaLocked(j);
+        }
+        else
+        {
+            delta(j) = shortenStep(delta(j), roomToLimit(q(j), delta(j), qMin(j), qMax(j)));
+        }
+    }
 }
 
 // -----------------------------------------------------------------------------
@@ -112,6 +229,12 @@ void ChainIkSolverPos_ID::updateInternalDataStructures()
     fkSolverPos.updateInternalDataStructures();
     jacSolver.updateInternalDataStructures();
     jacobian.resize(nj);
+    jacobianBuffer.resize(6, nj);
+    svd = Eigen::JacobiSVD<Eigen::MatrixXd>(6, nj, Eigen::ComputeThinU | Eigen::ComputeThinV);
+    tmp.resize(std::min<int>(6, nj));
+    delta.resize(nj);
+    deltaLocked.resize(nj);
+    locked.resize(nj);
 }
 
 // -----------------------------------------------------------------------------
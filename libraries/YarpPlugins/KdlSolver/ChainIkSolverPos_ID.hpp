@@ -3,6 +3,8 @@
 #ifndef __CHAIN_IK_SOLVER_POS_ID_HPP__
 #define __CHAIN_IK_SOLVER_POS_ID_HPP__
 
+#include <vector>
+
 #include <kdl/chain.hpp>
 #include <kdl/chainfksolver.hpp>
 #include <kdl/chainiksolver.hpp>
@@ -10,6 +12,9 @@
 #include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
 
+#include <Eigen/Core>
+#include <Eigen/SVD>
+
 namespace roboticslab
 {
 
@@ -20,6 +25,11 @@ namespace roboticslab
  * Re-implementation of KDL::ChainIkSolverPos_NR_JL in which only one iteration step
  * is performed. Aimed to provide a quick means of obtaining IK whenever the displacements
  * are small enough.
+ *
+ * By default, the step follows the Jacobian transpose with an optimal step length and the
+ * result is clamped to the joint limits. Alternatively, see @ref setAdaptiveDamping, a damped
+ * least-squares step is computed from a singular value decomposition of the Jacobian, with
+ * damping that grows as manipulability drops, and the joint limits are approached smoothly.
  */
 class ChainIkSolverPos_ID : public KDL::ChainIkSolverPos
 {
@@ -48,6 +58,22 @@ public:
      */
     virtual int CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out);
 
+    /**
+     * @brief Switch to damped least-squares steps with manipulability-adaptive damping.
+     *
+     * Nakamura and Hanafusa's damping @f$ \lambda = \lambda_{max} (1 - w / w_0)^2 @f$ is
+     * applied whenever manipulability @f$ w @f$ (product of the singular values of the
+     * Jacobian) drops below @f$ w_0 @f$. Joints whose full step would cross the limit they
+     * are heading to are locked at a smoothly shortened step and the step is recomputed
+     * with the remaining ones, which are in turn shortened as they approach their limits.
+     *
+     * @param lambdaMax Damping factor at a singularity.
+     * @param w0 Manipulability threshold, zero disables damping.
+     *
+     * @return False on illegal values.
+     */
+    bool setAdaptiveDamping(double lambdaMax, double w0);
+
     /**
     * @brief Update the internal data structures.
     *
@@ -75,7 +101,9 @@ public:
 
 private:
 
-    KDL::JntArray computeDiffInvKin(const KDL::Twist & delta_twist);
+    void computeDiffInvKin();
+    void computeDampedDiffInvKin();
+    void limitStep(const KDL::JntArray & q);
 
     const KDL::Chain & chain;
     unsigned int nj;
@@ -87,6 +115,20 @@ private:
     KDL::ChainJntToJacSolver jacSolver;
 
     KDL::Jacobian jacobian;
+
+    bool damped;
+    double lambdaMax;
+    double w0;
+
+    // workspace
+    Eigen::Matrix<double, 6, 1> e;
+    Eigen::Matrix<double, 6, 1> JJTe;
+    Eigen::MatrixXd jacobianBuffer; // JacobiSVD<MatrixXd> would copy a 6xN matrix into a temporary
+    Eigen::JacobiSVD<Eigen::MatrixXd> svd;
+    Eigen::VectorXd tmp;
+    KDL::JntArray delta;
+    KDL::JntArray deltaLocked;
+    std::vector<bool> locked;
 };
 
 }  // namespace roboticslab
@@ -0,0 +1,272 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ChainIkSolverPos_MultiStart.hpp"
+
+#include <limits>
+
+#include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainiksolverpos_lma.hpp>
+#include <kdl/chainiksolverpos_nr_jl.hpp>
+#include <kdl/chainiksolvervel_pinv.hpp>
+
+#include "ChainIkSolverVel_DLS.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_MultiStart::ChainIkSolverPos_MultiStart(const KDL::Chain & _chain, const KDL::JntArray & _qMin,
+        const KDL::JntArray & _qMax, int numSeeds, int _maxIter, WorkerPool & _workerPool)
+    : chain(_chain),
+      nj(chain.getNrOfJoints()),
+      qMin(_qMin),
+      qMax(_qMax),
+      maxIter(_maxIter),
+      workerPool(_workerPool),
+      seeds(numSeeds),
+      solved(false),
+      qLast(nj),
+      hasLast(false)
+{
+    for (auto & seed : seeds)
+    {
+        seed.qStart.resize(nj);
+        seed.qOut.resize(nj);
+        seed.qNext.resize(nj);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_MultiStart::~ChainIkSolverPos_MultiStart()
+{
+    for (auto & seed : seeds)
+    {
+        delete seed.ikSolver;
+        seed.ikSolver = NULL;
+
+        delete seed.ikVelSolver;
+        seed.ikVelSolver = NULL;
+
+        delete seed.fkSolver;
+        seed.fkSolver = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+bool ChainIkSolverPos_MultiStart::withinLimits(const KDL::JntArray & q) const
+{
+    for (unsigned int j = 0; j < nj; j++)
+    {
+        if (q(j) < qMin(j) || q(j) > qMax(j))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverPos_MultiStart::runSeed(Seed & seed, const KDL::Frame & p_in)
+{
+    seed.converged = false;
+    seed.qOut = seed.qStart;
+
+    for (int iter = 0; iter < maxIter && !solved; iter += SLICE)
+    {
+        int ret = seed.ikSolver->CartToJnt(seed.qOut, p_in, seed.qNext);
+        seed.qOut = seed.qNext;
+
+        if (ret == E_NOERROR)
+        {
+            seed.converged = withinLimits(seed.qOut);
+
+            if (seed.converged)
+            {
+                solved = true;
+            }
+
+            return;
+        }
+
+        if (ret != E_MAX_ITERATIONS_EXCEEDED)
+        {
+            return; // stuck, e.g. LMA's increment too small
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+int ChainIkSolverPos_MultiStart::CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out)
+{
+    if (nj != chain.getNrOfJoints())
+    {
+        return (error = E_NOT_UP_TO_DATE);
+    }
+
+    if (nj != q_init.rows() || nj != q_out.rows() || nj != qMin.rows() || nj != qMax.rows())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    //-- Caller's guess, last solution, then random joint values within limits.
+    for (int i = 0; i < seeds.size(); i++)
+    {
+        KDL::JntArray & qStart = seeds[i].qStart;
+
+        if (i == 0)
+        {
+            qStart = q_init;
+        }
+        else if (i == 1 && hasLast)
+        {
+            qStart = qLast;
+        }
+        else
+        {
+            for (unsigned int j = 0; j < nj; j++)
+            {
+                qStart(j) = std::uniform_real_distribution<double>(qMin(j), qMax(j))(randomEngine);
+            }
+        }
+    }
+
+    solved = false;
+
+    auto task = [this, &p_in](int i)
+    {
+        runSeed(seeds[i], p_in);
+    };
+
+    workerPool.run(seeds.size(), task);
+
+    //-- Several seeds may have converged before the rest noticed, pick the closest one.
+    int best = -1;
+    double bestDistance = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < seeds.size(); i++)
+    {
+        if (seeds[i].converged)
+        {
+            double distance = (seeds[i].qOut.data - q_init.data).squaredNorm();
+
+            if (distance < bestDistance)
+            {
+                best = i;
+                bestDistance = distance;
+            }
+        }
+    }
+
+    if (best < 0)
+    {
+        q_out = seeds[0].qOut;
+        return (error = E_NO_CONVERGENCE);
+    }
+
+    q_out = seeds[best].qOut;
+    qLast = q_out;
+    hasLast = true;
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverPos_MultiStart::updateInternalDataStructures()
+{
+    nj = chain.getNrOfJoints();
+    qMin.data.conservativeResizeLike(Eigen::VectorXd::Constant(nj, std::numeric_limits<double>::lowest()));
+    qMax.data.conservativeResizeLike(Eigen::VectorXd::Constant(nj, std::numeric_limits<double>::max()));
+    qLast.resize(nj);
+    hasLast = false;
+
+    for (auto & seed : seeds)
+    {
+        if (seed.fkSolver)
+        {
+            seed.fkSolver->updateInternalDataStructures();
+        }
+
+        if (seed.ikVelSolver)
+        {
+            seed.ikVelSolver->updateInternalDataStructures();
+        }
+
+        seed.ikSolver->updateInternalDataStructures();
+        seed.qStart.resize(nj);
+        seed.qOut.resize(nj);
+        seed.qNext.resize(nj);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+const char * ChainIkSolverPos_MultiStart::strError(const int error) const
+{
+    switch (error)
+    {
+    case E_NO_CONVERGENCE:
+        return "No seed converged within joint limits";
+    default:
+        return KDL::SolverI::strError(error);
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_MultiStart * ChainIkSolverPos_MultiStart::createNRJL(const KDL::Chain & chain, const KDL::JntArray & qMin,
+        const KDL::JntArray & qMax, int numSeeds, int maxIter, double eps, WorkerPool & workerPool,
+        const DampedLeastSquares * dls)
+{
+    if (numSeeds < 1 || maxIter < 1)
+    {
+        return NULL;
+    }
+
+    ChainIkSolverPos_MultiStart * solver = new ChainIkSolverPos_MultiStart(chain, qMin, qMax, numSeeds, maxIter, workerPool);
+
+    for (auto & seed : solver->seeds)
+    {
+        seed.fkSolver = new KDL::ChainFkSolverPos_recursive(chain);
+        if (dls)
+        {
+            seed.ikVelSolver = new ChainIkSolverVel_DLS(chain, *dls);
+        }
+        else
+        {
+            seed.ikVelSolver = new KDL::ChainIkSolverVel_pinv(chain);
+        }
+
+        seed.ikSolver = new KDL::ChainIkSolverPos_NR_JL(chain, qMin, qMax, *seed.fkSolver, *seed.ikVelSolver, SLICE, eps);
+    }
+
+    return solver;
+}
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverPos_MultiStart * ChainIkSolverPos_MultiStart::createLMA(const KDL::Chain & chain, const KDL::JntArray & qMin,
+        const KDL::JntArray & qMax, const Eigen::Matrix<double, 6, 1> & L, int numSeeds, int maxIter, double eps,
+        WorkerPool & workerPool)
+{
+    if (numSeeds < 1 || maxIter < 1)
+    {
+        return NULL;
+    }
+
+    ChainIkSolverPos_MultiStart * solver = new ChainIkSolverPos_MultiStart(chain, qMin, qMax, numSeeds, maxIter, workerPool);
+
+    for (auto & seed : solver->seeds)
+    {
+        seed.ikSolver = new KDL::ChainIkSolverPos_LMA(chain, L, eps, SLICE);
+    }
+
+    return solver;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,156 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __CHAIN_IK_SOLVER_POS_MULTI_START_HPP__
+#define __CHAIN_IK_SOLVER_POS_MULTI_START_HPP__
+
+#include <atomic>
+#include <random>
+#include <vector>
+
+#include <kdl/chain.hpp>
+#include <kdl/chainfksolver.hpp>
+#include <kdl/chainiksolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+
+#include <Eigen/Core>
+
+#include "DampedLeastSquares.hpp"
+#include "WorkerPool.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Numerical IK solver that runs several seeds in parallel.
+ *
+ * Each seed owns a numerical solver (KDL::ChainIkSolverPos_NR_JL or KDL::ChainIkSolverPos_LMA),
+ * along with its own differential IK solver if needed, started from a different initial guess: the one given by the caller, the last solution
+ * found and uniformly random joint values within limits. Seeds are dispatched over a
+ * \ref WorkerPool and iterate in short slices; once any of them converges within joint
+ * limits, the others stop at the end of their current slice. Among the seeds that converged,
+ * the one closest to the caller's guess is returned.
+ */
+class ChainIkSolverPos_MultiStart : public KDL::ChainIkSolverPos
+{
+public:
+
+    /** @brief Destructor. */
+    virtual ~ChainIkSolverPos_MultiStart();
+
+    /**
+     * @brief Calculate inverse position kinematics.
+     *
+     * @param q_init Initial guess of the joint coordinates.
+     * @param p_in Input cartesian coordinates.
+     * @param q_out Output joint coordinates.
+     *
+     * @return Return code, \ref E_NO_CONVERGENCE if no seed converged within joint limits,
+     * in which case \p q_out holds the last iterate of the caller's guess.
+     */
+    virtual int CartToJnt(const KDL::JntArray & q_init, const KDL::Frame & p_in, KDL::JntArray & q_out);
+
+    /**
+    * @brief Update the internal data structures.
+    *
+    * Update the internal data structures. This is required if the number of segments
+    * or number of joints of a chain has changed. This provides a single point of contact
+    * for solver memory allocations.
+    */
+    virtual void updateInternalDataStructures();
+
+    /**
+     * @brief Return a description of the last error
+     *
+     * @param error Error code.
+     *
+     * @return If \p error is known then a description of \p error, otherwise
+     * "UNKNOWN ERROR".
+     */
+    virtual const char * strError(const int error) const;
+
+    /**
+     * @brief Create an instance of \ref ChainIkSolverPos_MultiStart with Newton-Raphson seeds.
+     *
+     * @param chain Input kinematic chain, must outlive this solver.
+     * @param qMin Joint array of minimum joint limits.
+     * @param qMax Joint array of maximum joint limits.
+     * @param numSeeds Number of seeds, at least one.
+     * @param maxIter Maximum number of iterations per seed.
+     * @param eps Precision of each seed.
+     * @param workerPool Threads that run seeds in parallel.
+     * @param dls Configured least-squares solver copied into a \ref ChainIkSolverVel_DLS per seed,
+     * NULL to use KDL::ChainIkSolverVel_pinv instead.
+     *
+     * @return Solver instance or NULL on illegal arguments.
+     */
+    static ChainIkSolverPos_MultiStart * createNRJL(const KDL::Chain & chain, const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+                                                    int numSeeds, int maxIter, double eps, WorkerPool & workerPool,
+                                                    const DampedLeastSquares * dls);
+
+    /**
+     * @brief Create an instance of \ref ChainIkSolverPos_MultiStart with Levenberg-Marquardt seeds.
+     *
+     * @param chain Input kinematic chain, must outlive this solver.
+     * @param qMin Joint array of minimum joint limits, solutions beyond them are discarded.
+     * @param qMax Joint array of maximum joint limits, solutions beyond them are discarded.
+     * @param L Task-space weights of the LMA algorithm.
+     * @param numSeeds Number of seeds, at least one.
+     * @param maxIter Maximum number of iterations per seed.
+     * @param eps Precision of each seed.
+     * @param workerPool Threads that run seeds in parallel.
+     *
+     * @return Solver instance or NULL on illegal arguments.
+     */
+    static ChainIkSolverPos_MultiStart * createLMA(const KDL::Chain & chain, const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+                                                   const Eigen::Matrix<double, 6, 1> & L, int numSeeds, int maxIter, double eps,
+                                                   WorkerPool & workerPool);
+
+    /** @brief Return code, no seed converged within joint limits. */
+    static const int E_NO_CONVERGENCE = -100;
+
+    /** @brief Number of iterations of each seed between checks for early exit. */
+    static const int SLICE = 10;
+
+private:
+
+    //! One initial guess and the solver that refines it.
+    struct Seed
+    {
+        Seed() : fkSolver(NULL), ikVelSolver(NULL), ikSolver(NULL), converged(false) {}
+
+        KDL::ChainFkSolverPos * fkSolver;
+        KDL::ChainIkSolverVel * ikVelSolver; // NULL unless needed by ikSolver
+        KDL::ChainIkSolverPos * ikSolver; // runs SLICE iterations per call
+        KDL::JntArray qStart;
+        KDL::JntArray qOut;
+        KDL::JntArray qNext;
+        bool converged;
+    };
+
+    ChainIkSolverPos_MultiStart(const KDL::Chain & chain, const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+                                int numSeeds, int maxIter, WorkerPool & workerPool);
+
+    void runSeed(Seed & seed, const KDL::Frame & p_in);
+    bool withinLimits(const KDL::JntArray & q) const;
+
+    const KDL::Chain & chain;
+    unsigned int nj;
+
+    KDL::JntArray qMin, qMax;
+    int maxIter;
+    WorkerPool & workerPool;
+
+    std::vector<Seed> seeds;
+    std::atomic<bool> solved;
+
+    KDL::JntArray qLast;
+    bool hasLast;
+
+    std::mt19937 randomEngine;
+};
+
+}  // namespace roboticslab
+
+#endif  // __CHAIN_IK_SOLVER_POS_MULTI_START_HPP__
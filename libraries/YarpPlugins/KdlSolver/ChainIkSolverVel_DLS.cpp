@@ -0,0 +1,74 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "ChainIkSolverVel_DLS.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+ChainIkSolverVel_DLS::ChainIkSolverVel_DLS(const KDL::Chain & _chain, const DampedLeastSquares & _dls)
+    : chain(_chain),
+      nj(chain.getNrOfJoints()),
+      jacSolver(chain),
+      jacobian(nj),
+      dls(_dls),
+      xdot(6)
+{}
+
+// -----------------------------------------------------------------------------
+
+int ChainIkSolverVel_DLS::CartToJnt(const KDL::JntArray & q_in, const KDL::Twist & v_in, KDL::JntArray & qdot_out)
+{
+    if (nj != chain.getNrOfJoints())
+    {
+        return (error = E_NOT_UP_TO_DATE);
+    }
+
+    if (nj != q_in.rows() || nj != qdot_out.rows() || nj != dls.getNumJoints())
+    {
+        return (error = E_SIZE_MISMATCH);
+    }
+
+    if (jacSolver.JntToJac(q_in, jacobian) < 0)
+    {
+        return (error = E_JACSOLVER_FAILED);
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        xdot(i) = v_in[i];
+    }
+
+    if (!dls.solve(jacobian.data, xdot, q_in.data, qdot_out.data))
+    {
+        return (error = E_DLS_FAILED);
+    }
+
+    return (error = E_NOERROR);
+}
+
+// -----------------------------------------------------------------------------
+
+void ChainIkSolverVel_DLS::updateInternalDataStructures()
+{
+    nj = chain.getNrOfJoints();
+    jacSolver.updateInternalDataStructures();
+    jacobian.resize(nj);
+}
+
+// -----------------------------------------------------------------------------
+
+const char * ChainIkSolverVel_DLS::strError(const int error) const
+{
+    switch (error)
+    {
+    case E_JACSOLVER_FAILED:
+        return "Internal Jacobian solver failed";
+    case E_DLS_FAILED:
+        return "Damped least-squares solver failed";
+    default:
+        return KDL::SolverI::strError(error);
+    }
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,99 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __CHAIN_IK_SOLVER_VEL_DLS_HPP__
+#define __CHAIN_IK_SOLVER_VEL_DLS_HPP__
+
+#include <kdl/chain.hpp>
+#include <kdl/chainiksolver.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+
+#include <Eigen/Core>
+
+#include "DampedLeastSquares.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlSolver
+ * @brief Differential IK solver using weighted damped least squares.
+ *
+ * Thin KDL::ChainIkSolverVel adapter around \ref DampedLeastSquares, which holds
+ * weights, damping and secondary objectives. The number of joints of the chain
+ * must not change during the lifetime of this solver.
+ */
+class ChainIkSolverVel_DLS : public KDL::ChainIkSolverVel
+{
+public:
+
+    /**
+     * @brief Constructor
+     *
+     * @param chain The chain to calculate the inverse velocity for.
+     * @param dls A configured least-squares solver for one task and as many joints
+     * as the chain, copied.
+     */
+    ChainIkSolverVel_DLS(const KDL::Chain & chain, const DampedLeastSquares & dls);
+
+    /**
+     * @brief Calculate inverse velocity kinematics.
+     *
+     * @param q_in Current joint coordinates.
+     * @param v_in Desired cartesian velocity of the end effector, expressed in the base frame.
+     * @param qdot_out Output joint velocities.
+     *
+     * @return Return code, < 0 on failure.
+     */
+    virtual int CartToJnt(const KDL::JntArray & q_in, const KDL::Twist & v_in, KDL::JntArray & qdot_out);
+
+    /**
+     * @brief Not implemented.
+     *
+     * @return \ref E_NOT_IMPLEMENTED
+     */
+    virtual int CartToJnt(const KDL::JntArray & q_init, const KDL::FrameVel & v_in, KDL::JntArrayVel & q_out)
+    { return (error = E_NOT_IMPLEMENTED); }
+
+    /**
+    * @brief Update the internal data structures.
+    *
+    * Update the internal data structures. This is required if the number of segments
+    * or number of joints of a chain has changed. This provides a single point of contact
+    * for solver memory allocations.
+    */
+    virtual void updateInternalDataStructures();
+
+    /**
+     * @brief Return a description of the last error
+     *
+     * @param error Error code.
+     *
+     * @return If \p error is known then a description of \p error, otherwise
+     * "UNKNOWN ERROR".
+     */
+    virtual const char * strError(const int error) const;
+
+    /** @brief Return code, internal Jacobian solver failed. */
+    static const int E_JACSOLVER_FAILED = -100;
+
+    /** @brief Return code, least-squares solver failed. */
+    static const int E_DLS_FAILED = -101;
+
+private:
+
+    const KDL::Chain & chain;
+    unsigned int nj;
+
+    KDL::ChainJntToJacSolver jacSolver;
+    KDL::Jacobian jacobian;
+
+    DampedLeastSquares dls;
+    Eigen::VectorXd xdot;
+};
+
+}  // namespace roboticslab
+
+#endif  // __CHAIN_IK_SOLVER_VEL_DLS_HPP__
@@ -2,7 +2,9 @@
 
 #include "KdlSolver.hpp"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/LogStream.h>
@@ -30,8 +32,12 @@
 #include "KinematicRepresentation.hpp"
 #include "ConfigurationSelector.hpp"
 
+#include "ChainIdSolver_ST.hpp"
 #include "ChainIkSolverPos_ST.hpp"
 #include "ChainIkSolverPos_ID.hpp"
+#include "ChainIkSolverPos_MultiStart.hpp"
+#include "ChainIkSolverVel_DLS.hpp"
+#include "DampedLeastSquares.hpp"
 
 // ------------------- DeviceDriver Related ------------------------------------
 
@@ -282,8 +288,109 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
     yInfo() << "Chain number of joints (post- H0 and HN):" << chain.getNrOfJoints();
 
     fkSolverPos = new KDL::ChainFkSolverPos_recursive(chain);
-    ikSolverVel = new KDL::ChainIkSolverVel_pinv(chain);
-    idSolver = new KDL::ChainIdSolver_RNE(chain, gravity);
+
+    //-- Differential IK solver algorithm.
+    std::string ikVel = fullConfig.check("ikVel", yarp::os::Value(DEFAULT_IK_VEL_SOLVER), "differential IK solver algorithm (pinv, dls)").asString();
+    DampedLeastSquares dls(1, chain.getNrOfJoints()); // also copied into each nrjl seed
+
+    if (ikVel == "pinv")
+    {
+        ikSolverVel = new KDL::ChainIkSolverVel_pinv(chain);
+    }
+    else if (ikVel == "dls")
+    {
+        //-- Joint limits are only required by the joint limit avoidance term (dlsLimitGain).
+        KDL::JntArray qMax(chain.getNrOfJoints());
+        KDL::JntArray qMin(chain.getNrOfJoints());
+
+        if (fullConfig.check("mins") && fullConfig.check("maxs") && !retrieveJointLimits(fullConfig, qMin, qMax))
+        {
+            return false;
+        }
+
+        if (!configureDampedLeastSquares(fullConfig, qMin.data, qMax.data, dls))
+        {
+            return false;
+        }
+
+        ikSolverVel = new ChainIkSolverVel_DLS(chain, dls);
+    }
+    else
+    {
+        yError() << "Unsupported differential IK solver algorithm:" << ikVel.c_str();
+        return false;
+    }
+
+    //-- ID solver algorithm.
+    std::string id = fullConfig.check("invDyn", yarp::os::Value(DEFAULT_ID_SOLVER), "ID solver algorithm (kdl, st)").asString();
+
+    if (id == "kdl")
+    {
+        idSolver = new KDL::ChainIdSolver_RNE(chain, gravity);
+    }
+    else if (id == "st")
+    {
+        idSolver = ChainIdSolver_ST::create(chain, gravity);
+    }
+    else
+    {
+        yError() << "Unsupported ID solver algorithm:" << id.c_str();
+        return false;
+    }
+
+    qIdBuffer.resize(chain.getNrOfJoints());
+    qdotIdBuffer.resize(chain.getNrOfJoints());
+    qdotdotIdBuffer.resize(chain.getNrOfJoints());
+    tIdBuffer.resize(chain.getNrOfJoints());
+    fextsIdBuffer.resize(chain.getNrOfSegments());
+
+    dynParamSolver = new KDL::ChainDynParam(chain, gravity);
+    massBuffer.resize(chain.getNrOfJoints());
+    massDecomposition = Eigen::LDLT<Eigen::MatrixXd>(chain.getNrOfJoints());
+
+    jacSolver = new KDL::ChainJntToJacSolver(chain);
+    jacBuffer.resize(chain.getNrOfJoints());
+
+    //-- Parallel seeds for numerical IK.
+    int seeds = fullConfig.check("seeds", yarp::os::Value(DEFAULT_SEEDS), "number of initial guesses for numerical IK (lma, nrjl)").asInt32();
+
+    if (seeds < 1)
+    {
+        yError() << "Illegal number of seeds:" << seeds;
+        return false;
+    }
+
+    if (seeds > 1)
+    {
+        int workers = fullConfig.check("workers", yarp::os::Value(DEFAULT_WORKERS),
+            "threads for IK seeds besides the caller's (0: serial)").asInt32();
+
+        if (workers < 0)
+        {
+            yError() << "Illegal number of workers:" << workers;
+            return false;
+        }
+
+        workerPool = new WorkerPool(std::min(workers, seeds - 1));
+
+        if (fullConfig.check("workerCpus", "list of CPUs to pin workers to"))
+        {
+            yarp::os::Bottle * workerCpus = fullConfig.find("workerCpus").asList();
+            std::vector<int> cpus;
+
+            for (int i = 0; workerCpus && i < workerCpus->size(); i++)
+            {
+                cpus.push_back(workerCpus->get(i).asInt32());
+            }
+
+            if (!workerPool->setAffinity(cpus))
+            {
+                yWarning() << "Unable to pin workers to CPUs:" << cpus;
+            }
+        }
+
+        yInfo() << "IK seeds:" << seeds << "worker threads:" << workerPool->getNumWorkers();
+    }
 
     //-- IK solver algorithm.
     std::string ik = fullConfig.check("ik", yarp::os::Value(DEFAULT_IK_SOLVER), "IK solver algorithm (lma, nrjl, st, id)").asString();
@@ -300,7 +407,24 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
             return false;
         }
 
-        ikSolverPos = new KDL::ChainIkSolverPos_LMA(chain, L);
+        if (seeds > 1)
+        {
+            KDL::JntArray qMax(chain.getNrOfJoints());
+            KDL::JntArray qMin(chain.getNrOfJoints());
+
+            //-- Joint limits, needed to draw seeds and discard solutions.
+            if (!retrieveJointLimits(fullConfig, qMin, qMax))
+            {
+                yError() << "Unable to retrieve joint limits";
+                return false;
+            }
+
+            ikSolverPos = ChainIkSolverPos_MultiStart::createLMA(chain, qMin, qMax, L, seeds, DEFAULT_LMA_MAXITER, DEFAULT_LMA_EPS, *workerPool);
+        }
+        else
+        {
+            ikSolverPos = new KDL::ChainIkSolverPos_LMA(chain, L);
+        }
     }
     else if (ik == "nrjl")
     {
@@ -318,7 +442,15 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
         double eps = fullConfig.check("eps", yarp::os::Value(DEFAULT_EPS), "IK solver precision (meters)").asFloat64();
         double maxIter = fullConfig.check("maxIter", yarp::os::Value(DEFAULT_MAXITER), "maximum number of iterations").asInt32();
 
-        ikSolverPos = new KDL::ChainIkSolverPos_NR_JL(chain, qMin, qMax, *fkSolverPos, *ikSolverVel, maxIter, eps);
+        if (seeds > 1)
+        {
+            ikSolverPos = ChainIkSolverPos_MultiStart::createNRJL(chain, qMin, qMax, seeds, maxIter, eps, *workerPool,
+                                                                  ikVel == "dls" ? &dls : NULL);
+        }
+        else
+        {
+            ikSolverPos = new KDL::ChainIkSolverPos_NR_JL(chain, qMin, qMax, *fkSolverPos, *ikSolverVel, maxIter, eps);
+        }
     }
     else if (ik == "st")
     {
@@ -369,7 +501,28 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
             return false;
         }
 
-        ikSolverPos = new ChainIkSolverPos_ID(chain, qMin, qMax, *fkSolverPos);
+        ChainIkSolverPos_ID * idIkSolver = new ChainIkSolverPos_ID(chain, qMin, qMax, *fkSolverPos);
+        ikSolverPos = idIkSolver;
+
+        //-- Step computation.
+        std::string step = fullConfig.check("idStep", yarp::os::Value(DEFAULT_ID_STEP), "ID step (transpose, dls)").asString();
+
+        if (step == "dls")
+        {
+            double lambda = fullConfig.check("idLambda", yarp::os::Value(DEFAULT_ID_LAMBDA), "ID maximum damping factor").asFloat64();
+            double w0 = fullConfig.check("idManipulability", yarp::os::Value(DEFAULT_ID_MANIPULABILITY), "ID manipulability threshold for damping").asFloat64();
+
+            if (!idIkSolver->setAdaptiveDamping(lambda, w0))
+            {
+                yError("Illegal ID damping (lambda: %f, manipulability: %f)", lambda, w0);
+                return false;
+            }
+        }
+        else if (step != "transpose")
+        {
+            yError() << "Unsupported ID step:" << step;
+            return false;
+        }
     }
     else
     {
@@ -377,6 +530,12 @@ bool roboticslab::KdlSolver::open(yarp::os::Searchable& config)
         return false;
     }
 
+    if (ikSolverPos == NULL)
+    {
+        yError() << "Unable to create IK solver";
+        return false;
+    }
+
     originalChain = chain;
 
     return true;
@@ -388,8 +547,11 @@ bool roboticslab::KdlSolver::close()
 {
     delete fkSolverPos;
     delete ikSolverPos;
+    delete workerPool;
     delete ikSolverVel;
     delete idSolver;
+    delete dynParamSolver;
+    delete jacSolver;
 
     return true;
 }
@@ -34,6 +34,10 @@ bool roboticslab::KdlSolver::appendLink(const std::vector<double>& x)
     ikSolverPos->updateInternalDataStructures();
     ikSolverVel->updateInternalDataStructures();
     idSolver->updateInternalDataStructures();
+    dynParamSolver->updateInternalDataStructures();
+    jacSolver->updateInternalDataStructures();
+
+    fextsIdBuffer.resize(chain.getNrOfSegments());
 
     return true;
 }
@@ -50,6 +54,10 @@ bool roboticslab::KdlSolver::restoreOriginalChain()
     ikSolverPos->updateInternalDataStructures();
     ikSolverVel->updateInternalDataStructures();
     idSolver->updateInternalDataStructures();
+    dynParamSolver->updateInternalDataStructures();
+    jacSolver->updateInternalDataStructures();
+
+    fextsIdBuffer.resize(chain.getNrOfSegments());
 
     return true;
 }
@@ -219,25 +227,60 @@ bool roboticslab::KdlSolver::diffInvKin(const std::vector<double> &q, const std:
 
 bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,std::vector<double> &t)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
+    t.resize(chain.getNrOfJoints());
+    return invDyn(q.data(), NULL, NULL, NULL, 0, t.data());
+}
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t)
+{
+    std::vector<double> flatFexts;
+    flatFexts.reserve(6 * fexts.size());
+
+    for (int i = 0; i < fexts.size(); i++)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        flatFexts.insert(flatFexts.end(), fexts[i].begin(), fexts[i].begin() + 6);
     }
 
-    KDL::JntArray qdotInRad(chain.getNrOfJoints());
-    KDL::JntArray qdotdotInRad(chain.getNrOfJoints());
-    KDL::JntArray kdlt(chain.getNrOfJoints());
-    KDL::Wrenches wrenches(chain.getNrOfSegments(), KDL::Wrench::Zero());
+    t.resize(chain.getNrOfJoints());
+    return invDyn(q.data(), qdot.data(), qdotdot.data(), flatFexts.data(), fexts.size(), t.data());
+}
 
-    int ret;
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::invDyn(const double *q, const double *qdot, const double *qdotdot, const double *fexts, int numFexts, double *t)
+{
+    std::lock_guard<std::mutex> lock(mtx);
 
+    if (numFexts > static_cast<int>(fextsIdBuffer.size()))
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        ret = idSolver->CartToJnt(qInRad, qdotInRad, qdotdotInRad, wrenches, kdlt);
+        yError("invDyn(): got %d external forces, but chain has only %zu segments", numFexts, fextsIdBuffer.size());
+        return false;
+    }
+
+    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    {
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+        qdotIdBuffer(motor) = qdot ? KinRepresentation::degToRad(qdot[motor]) : 0.0;
+        qdotdotIdBuffer(motor) = qdotdot ? KinRepresentation::degToRad(qdotdot[motor]) : 0.0;
+    }
+
+    for (int i = 0; i < fextsIdBuffer.size(); i++)
+    {
+        if (fexts && i < numFexts)
+        {
+            const double * fext = fexts + 6 * i;
+            fextsIdBuffer[i] = KDL::Wrench(KDL::Vector(fext[0], fext[1], fext[2]), KDL::Vector(fext[3], fext[4], fext[5]));
+        }
+        else
+        {
+            fextsIdBuffer[i] = KDL::Wrench::Zero();
+        }
     }
 
+    int ret = idSolver->CartToJnt(qIdBuffer, qdotIdBuffer, qdotdotIdBuffer, fextsIdBuffer, tIdBuffer);
+
     if (ret < 0)
     {
         yError("invDyn(): %s", idSolver->strError(ret));
@@ -248,11 +291,9 @@ bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,std::vector<dou
         yWarning("invDyn(): %s", idSolver->strError(ret));
     }
 
-    t.resize(chain.getNrOfJoints());
-
     for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        t[motor] = kdlt(motor);
+        t[motor] = tIdBuffer(motor);
     }
 
     return true;
@@ -260,62 +301,177 @@ bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,std::vector<dou
 
 // -----------------------------------------------------------------------------
 
-bool roboticslab::KdlSolver::invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t)
+bool roboticslab::KdlSolver::massMatrix(const std::vector<double> &q, std::vector<double> &M)
 {
-    KDL::JntArray qInRad(chain.getNrOfJoints());
+    std::lock_guard<std::mutex> lock(mtx);
 
-    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
+    const int numJoints = chain.getNrOfJoints();
+
+    for (int motor = 0; motor < numJoints; motor++)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+    }
+
+    int ret = dynParamSolver->JntToMass(qIdBuffer, massBuffer);
+
+    if (ret < 0)
+    {
+        yError("massMatrix(): %s", dynParamSolver->strError(ret));
+        return false;
+    }
+
+    M.resize(numJoints * numJoints);
+
+    for (int i = 0; i < numJoints; i++)
+    {
+        for (int j = 0; j < numJoints; j++)
+        {
+            M[i * numJoints + j] = massBuffer(i, j);
+        }
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::jacobian(const double *q, double *x, double *J)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    const int numJoints = chain.getNrOfJoints();
+
+    for (int motor = 0; motor < numJoints; motor++)
+    {
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+    }
+
+    if (x)
+    {
+        KDL::Frame H;
+        int ret = fkSolverPos->JntToCart(qIdBuffer, H);
+
+        if (ret < 0)
+        {
+            yError("jacobian(): %s", fkSolverPos->strError(ret));
+            return false;
+        }
+
+        KDL::Vector rot = H.M.GetRot();
+
+        x[0] = H.p.x();
+        x[1] = H.p.y();
+        x[2] = H.p.z();
+        x[3] = rot.x();
+        x[4] = rot.y();
+        x[5] = rot.z();
+    }
+
+    //-- Base frame orientation, reference point at the TCP.
+    int ret = jacSolver->JntToJac(qIdBuffer, jacBuffer);
+
+    if (ret < 0)
+    {
+        yError("jacobian(): %s", jacSolver->strError(ret));
+        return false;
+    }
+
+    for (int i = 0; i < 6; i++)
+    {
+        for (int j = 0; j < numJoints; j++)
+        {
+            J[i * numJoints + j] = jacBuffer(i, j);
+        }
     }
 
-    KDL::JntArray qdotInRad(chain.getNrOfJoints());
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool roboticslab::KdlSolver::coriolisTorques(const std::vector<double> &q, const std::vector<double> &qdot, std::vector<double> &c)
+{
+    std::lock_guard<std::mutex> lock(mtx);
 
     for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        qdotInRad(motor) = KinRepresentation::degToRad(qdot[motor]);
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+        qdotIdBuffer(motor) = KinRepresentation::degToRad(qdot[motor]);
+    }
+
+    int ret = dynParamSolver->JntToCoriolis(qIdBuffer, qdotIdBuffer, tIdBuffer);
+
+    if (ret < 0)
+    {
+        yError("coriolisTorques(): %s", dynParamSolver->strError(ret));
+        return false;
     }
 
-    KDL::JntArray qdotdotInRad(chain.getNrOfJoints());
+    c.resize(chain.getNrOfJoints());
 
     for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        qdotdotInRad(motor) = KinRepresentation::degToRad(qdotdot[motor]);
+        c[motor] = tIdBuffer(motor);
     }
 
-    KDL::Wrenches wrenches(chain.getNrOfSegments(), KDL::Wrench::Zero());
+    return true;
+}
+
+// -----------------------------------------------------------------------------
 
-    for (int i = 0; i < fexts.size(); i++)
+bool roboticslab::KdlSolver::fwdDyn(const std::vector<double> &q, const std::vector<double> &qdot, const std::vector<double> &t, std::vector<double> &qdotdot)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        wrenches[i] = KDL::Wrench(
-            KDL::Vector(fexts[i][0], fexts[i][1], fexts[i][2]),
-            KDL::Vector(fexts[i][3], fexts[i][4], fexts[i][5])
-        );
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+        qdotIdBuffer(motor) = KinRepresentation::degToRad(qdot[motor]);
+        qdotdotIdBuffer(motor) = 0.0;
     }
 
-    KDL::JntArray kdlt(chain.getNrOfJoints());
-    int ret;
+    for (int i = 0; i < fextsIdBuffer.size(); i++)
+    {
+        fextsIdBuffer[i] = KDL::Wrench::Zero();
+    }
+
+    //-- Bias torques (gravity, Coriolis and centrifugal) via the configured ID solver, then M*qdotdot = t - bias.
+    int ret = idSolver->CartToJnt(qIdBuffer, qdotIdBuffer, qdotdotIdBuffer, fextsIdBuffer, tIdBuffer);
 
+    if (ret < 0)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        ret = idSolver->CartToJnt(qInRad, qdotInRad, qdotdotInRad, wrenches, kdlt);
+        yError("fwdDyn(): %s", idSolver->strError(ret));
+        return false;
     }
 
+    ret = dynParamSolver->JntToMass(qIdBuffer, massBuffer);
+
     if (ret < 0)
     {
-        yError("invDyn(): %s", idSolver->strError(ret));
+        yError("fwdDyn(): %s", dynParamSolver->strError(ret));
         return false;
     }
-    else if (ret > 0)
+
+    for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        yWarning("invDyn(): %s", idSolver->strError(ret));
+        tIdBuffer(motor) = t[motor] - tIdBuffer(motor);
     }
 
-    t.resize(chain.getNrOfJoints());
+    massDecomposition.compute(massBuffer.data);
+
+    if (massDecomposition.info() != Eigen::Success)
+    {
+        yError("fwdDyn(): singular mass matrix");
+        return false;
+    }
+
+    qdotdotIdBuffer.data = massDecomposition.solve(tIdBuffer.data);
+
+    qdotdot.resize(chain.getNrOfJoints());
 
     for (int motor = 0; motor < chain.getNrOfJoints(); motor++)
     {
-        t[motor] = kdlt(motor);
+        qdotdot[motor] = KinRepresentation::radToDeg(qdotdotIdBuffer(motor));
     }
 
     return true;
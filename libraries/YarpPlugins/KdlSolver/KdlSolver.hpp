@@ -8,13 +8,21 @@
 #include <yarp/dev/DeviceDriver.h>
 
 #include <kdl/chain.hpp>
+#include <kdl/chaindynparam.hpp>
 #include <kdl/chainfksolver.hpp>
 #include <kdl/chainiksolver.hpp>
 #include <kdl/chainidsolver.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/jntspaceinertiamatrix.hpp>
+
+#include <Eigen/Cholesky>
 
 #include <iostream> // only windows
 
 #include "ICartesianSolver.h"
+#include "WorkerPool.hpp"
 
 #define DEFAULT_KINEMATICS "none.ini"  // string
 #define DEFAULT_NUM_LINKS 1  // int
@@ -29,6 +37,15 @@
 #define DEFAULT_IK_SOLVER "lma"
 #define DEFAULT_LMA_WEIGHTS "1 1 1 0.1 0.1 0.1"
 #define DEFAULT_STRATEGY "leastOverallAngularDisplacement"
+#define DEFAULT_ID_SOLVER "kdl"
+#define DEFAULT_ID_STEP "transpose"
+#define DEFAULT_ID_LAMBDA 0.1
+#define DEFAULT_ID_MANIPULABILITY 0.001
+#define DEFAULT_SEEDS 1
+#define DEFAULT_WORKERS 0
+#define DEFAULT_LMA_EPS 1e-5
+#define DEFAULT_LMA_MAXITER 500
+#define DEFAULT_IK_VEL_SOLVER "pinv"
 
 namespace roboticslab
 {
@@ -53,7 +70,10 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
             : fkSolverPos(NULL),
               ikSolverPos(NULL),
               ikSolverVel(NULL),
-              idSolver(NULL)
+              idSolver(NULL),
+              dynParamSolver(NULL),
+              jacSolver(NULL),
+              workerPool(NULL)
         {}
 
         // -- ICartesianSolver declarations. Implementation in ICartesianSolverImpl.cpp--
@@ -90,6 +110,21 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
         // Perform inverse dynamics.
         virtual bool invDyn(const std::vector<double> &q,const std::vector<double> &qdot,const std::vector<double> &qdotdot, const std::vector< std::vector<double> > &fexts, std::vector<double> &t);
 
+        // Perform inverse dynamics on caller-owned storage.
+        virtual bool invDyn(const double *q, const double *qdot, const double *qdotdot, const double *fexts, int numFexts, double *t);
+
+        // Compute the joint-space inertia matrix.
+        virtual bool massMatrix(const std::vector<double> &q, std::vector<double> &M);
+
+        // Compute pose and geometric Jacobian on caller-owned storage.
+        virtual bool jacobian(const double *q, double *x, double *J);
+
+        // Compute Coriolis and centrifugal joint torques.
+        virtual bool coriolisTorques(const std::vector<double> &q, const std::vector<double> &qdot, std::vector<double> &c);
+
+        // Perform forward dynamics.
+        virtual bool fwdDyn(const std::vector<double> &q, const std::vector<double> &qdot, const std::vector<double> &t, std::vector<double> &qdotdot);
+
         // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
         /**
@@ -127,6 +162,22 @@ class KdlSolver : public yarp::dev::DeviceDriver, public ICartesianSolver
         KDL::ChainIkSolverPos * ikSolverPos;
         KDL::ChainIkSolverVel * ikSolverVel;
         KDL::ChainIdSolver * idSolver;
+        KDL::ChainDynParam * dynParamSolver;
+        KDL::ChainJntToJacSolver * jacSolver;
+
+        /** Threads for multi-start numerical IK, NULL if disabled. **/
+        WorkerPool * workerPool;
+
+        /** Inverse dynamics input and output buffers, sized on chain changes and guarded by mtx. **/
+        KDL::JntArray qIdBuffer, qdotIdBuffer, qdotdotIdBuffer, tIdBuffer;
+        KDL::Wrenches fextsIdBuffer;
+
+        /** Mass matrix and its factorization for forward dynamics, sized once and guarded by mtx. **/
+        KDL::JntSpaceInertiaMatrix massBuffer;
+        Eigen::LDLT<Eigen::MatrixXd> massDecomposition;
+
+        /** Jacobian output buffer, sized once and guarded by mtx. **/
+        KDL::Jacobian jacBuffer;
 };
 
 }  // namespace roboticslab
@@ -2,7 +2,9 @@
 
 #include "KdlTreeSolver.hpp"
 
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include <yarp/os/Bottle.h>
 #include <yarp/os/LogStream.h>
@@ -19,13 +21,15 @@
 #include <kdl/rotationalinertia.hpp>
 #include <kdl/segment.hpp>
 
-#include <kdl/treefksolverpos_recursive.hpp>
 #include <kdl/treeidsolver_recursive_newton_euler.hpp>
 #include <kdl/treeiksolverpos_nr_jl.hpp>
 #include <kdl/treeiksolverpos_online.hpp>
 #include <kdl/treeiksolvervel_wdls.hpp>
 
 #include "KinematicRepresentation.hpp"
+#include "DampedLeastSquares.hpp"
+#include "TreeIkSolverPos_ST.hpp"
+#include "TreeIkSolverVel_DLS.hpp"
 
 using namespace roboticslab;
 
@@ -332,15 +336,55 @@ bool KdlTreeSolver::open(yarp::os::Searchable & config)
     yInfo() << "Tree number of joints:" << tree.getNrOfJoints();
     yInfo() << "Tree endpoints:" << endpoints;
 
-    fkSolverPos = new KDL::TreeFkSolverPos_recursive(tree);
-    ikSolverVel = new KDL::TreeIkSolverVel_wdls(tree, endpoints);
+    fkSolverPos = new TreeFkSolverPos_Endpoints(tree, endpoints);
+
+    //-- Endpoint containers, filled in place on each call.
+    endpointFrames.resize(endpoints.size());
+    targetFrameSlots.clear();
+    targetTwistSlots.clear();
+
+    for (const auto & endpoint : endpoints)
+    {
+        targetFrameSlots.push_back(&targetFrames[endpoint]);
+        targetTwistSlots.push_back(&targetTwists[endpoint]);
+    }
+
+    qInBuffer.resize(tree.getNrOfJoints());
+    qOutBuffer.resize(tree.getNrOfJoints());
+
+    qIdBuffer.resize(tree.getNrOfJoints());
+    qdotIdBuffer.resize(tree.getNrOfJoints());
+    qdotdotIdBuffer.resize(tree.getNrOfJoints());
+    tIdBuffer.resize(tree.getNrOfJoints());
+    fextsIdBuffer.clear();
+
+    for (const auto & endpoint : endpoints)
+    {
+        fextsIdBuffer.insert(std::make_pair(endpoint, KDL::Wrench::Zero()));
+    }
+
     idSolver = new KDL::TreeIdSolver_RNE(tree, gravity);
 
+    KDL::JntArray qMax(tree.getNrOfJoints());
+    KDL::JntArray qMin(tree.getNrOfJoints());
+    KDL::JntArray qMaxVels(tree.getNrOfJoints());
+
+    //-- Joint limits.
+    if (!retrieveJointLimits(fullConfig, qMin, qMax, qMaxVels))
     {
-        auto * temp = dynamic_cast<KDL::TreeIkSolverVel_wdls *>(ikSolverVel);
+        yError() << "Unable to retrieve joint limits";
+        return false;
+    }
+
+    //-- Differential IK solver algorithm.
+    std::string ikVel = fullConfig.check("ikVel", yarp::os::Value(DEFAULT_IK_VEL_SOLVER), "differential IK solver algorithm (wdls, dls)").asString();
+
+    if (ikVel == "wdls")
+    {
+        auto * wdls = new KDL::TreeIkSolverVel_wdls(tree, endpoints);
 
         auto lambda = fullConfig.check("lambda", yarp::os::Value(DEFAULT_LAMBDA), "lambda parameter for diff IK").asFloat64();
-        temp->setLambda(lambda); // disclaimer: never set this to zero (which is the default)
+        wdls->setLambda(lambda); // disclaimer: never set this to zero (which is the default)
 
         yarp::sig::Matrix wJS(tree.getNrOfJoints(), tree.getNrOfJoints());
 
@@ -359,7 +403,7 @@ bool KdlTreeSolver::open(yarp::os::Searchable & config)
             }
         }
 
-        temp->setWeightJS(_wJS);
+        wdls->setWeightJS(_wJS);
 
         yarp::sig::Matrix wTS(6 * endpoints.size(), 6 * endpoints.size());
 
@@ -378,22 +422,29 @@ bool KdlTreeSolver::open(yarp::os::Searchable & config)
             }
         }
 
-        temp->setWeightTS(_wTS);
+        wdls->setWeightTS(_wTS);
+
+        ikSolverVel = wdls;
     }
+    else if (ikVel == "dls")
+    {
+        DampedLeastSquares dls(endpoints.size(), tree.getNrOfJoints());
 
-    KDL::JntArray qMax(tree.getNrOfJoints());
-    KDL::JntArray qMin(tree.getNrOfJoints());
-    KDL::JntArray qMaxVels(tree.getNrOfJoints());
+        if (!configureDampedLeastSquares(fullConfig, qMin.data, qMax.data, dls))
+        {
+            return false;
+        }
 
-    //-- Joint limits.
-    if (!retrieveJointLimits(fullConfig, qMin, qMax, qMaxVels))
+        ikSolverVel = new TreeIkSolverVel_DLS(endpoints, *fkSolverPos, dls);
+    }
+    else
     {
-        yError() << "Unable to retrieve joint limits";
+        yError() << "Unsupported differential IK solver algorithm:" << ikVel.c_str();
         return false;
     }
 
     //-- IK solver algorithm.
-    std::string ik = fullConfig.check("ik", yarp::os::Value(DEFAULT_IK_SOLVER), "IK solver algorithm (nrjl, online)").asString();
+    std::string ik = fullConfig.check("ik", yarp::os::Value(DEFAULT_IK_SOLVER), "IK solver algorithm (nrjl, online, st)").asString();
 
     if (ik == "nrjl")
     {
@@ -412,6 +463,60 @@ bool KdlTreeSolver::open(yarp::os::Searchable & config)
         vRotMax = KinRepresentation::degToRad(vRotMax);
         ikSolverPos = new KDL::TreeIkSolverPos_Online(tree.getNrOfJoints(), endpoints, qMin, qMax, qMaxVels, vTranslMax, vRotMax, *fkSolverPos, *ikSolverVel);
     }
+    else if (ik == "st")
+    {
+        //-- Precision and max iterations of the torso refinement.
+        double eps = fullConfig.check("eps", yarp::os::Value(DEFAULT_EPS), "IK solver precision (meters)").asFloat64();
+        int maxIter = fullConfig.check("maxIter", yarp::os::Value(DEFAULT_MAXITER), "maximum number of iterations").asInt32();
+        double lambda = fullConfig.check("lambda", yarp::os::Value(DEFAULT_LAMBDA), "lambda parameter for diff IK").asFloat64();
+
+        //-- IK configuration selection strategy.
+        std::string strategy = fullConfig.check("invKinStrategy", yarp::os::Value(DEFAULT_STRATEGY), "IK configuration strategy").asString();
+
+        if (strategy != "leastOverallAngularDisplacement" && strategy != "humanoidGait")
+        {
+            yError() << "Unsupported IK strategy:" << strategy;
+            return false;
+        }
+
+        //-- Worker threads for per-branch computations.
+        int workers = fullConfig.check("workers", yarp::os::Value(DEFAULT_WORKERS),
+            "threads for per-branch IK besides the caller's (0: serial)").asInt32();
+
+        if (workers < 0)
+        {
+            yError() << "Illegal number of workers:" << workers;
+            return false;
+        }
+
+        workerPool = new WorkerPool(std::min<int>(workers, endpoints.size() - 1));
+
+        if (fullConfig.check("workerCpus", "list of CPUs to pin workers to"))
+        {
+            yarp::os::Bottle * workerCpus = fullConfig.find("workerCpus").asList();
+            std::vector<int> cpus;
+
+            for (int i = 0; workerCpus && i < workerCpus->size(); i++)
+            {
+                cpus.push_back(workerCpus->get(i).asInt32());
+            }
+
+            if (!workerPool->setAffinity(cpus))
+            {
+                yWarning() << "Unable to pin workers to CPUs:" << cpus;
+            }
+        }
+
+        yInfo() << "Worker threads:" << workerPool->getNumWorkers();
+
+        ikSolverPos = TreeIkSolverPos_ST::create(tree, endpoints, qMin, qMax, strategy, *fkSolverPos, *workerPool, maxIter, eps, lambda);
+
+        if (ikSolverPos == nullptr)
+        {
+            yError() << "Unable to solve IK";
+            return false;
+        }
+    }
     else
     {
         yError() << "Unsupported IK solver algorithm:" << ik.c_str();
@@ -431,6 +536,9 @@ bool KdlTreeSolver::close()
     delete ikSolverPos;
     ikSolverPos = nullptr;
 
+    delete workerPool;
+    workerPool = nullptr;
+
     delete ikSolverVel;
     ikSolverVel = nullptr;
 
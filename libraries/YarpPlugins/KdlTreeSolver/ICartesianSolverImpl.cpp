@@ -18,6 +18,8 @@ using namespace roboticslab;
 
 bool KdlTreeSolver::getNumJoints(int * numJoints)
 {
+    std::lock_guard<std::mutex> lock(mtx);
+
     *numJoints = tree.getNrOfJoints();
     return true;
 }
@@ -42,20 +44,17 @@ bool KdlTreeSolver::restoreOriginalChain()
 
 bool KdlTreeSolver::changeOrigin(const std::vector<double> & x_old_obj, const std::vector<double> & x_new_old, std::vector<double> & x_new_obj)
 {
-    x_new_obj.clear();
-    x_new_obj.reserve(endpoints.size() * 6);
+    std::lock_guard<std::mutex> lock(mtx);
+
+    x_new_obj.resize(endpoints.size() * 6);
 
     for (auto i = 0; i < endpoints.size(); i++)
     {
-        std::vector<double> temp_old_obj(x_old_obj.cbegin() + i * 6, x_old_obj.cbegin() + (i + 1) * 6);
-        std::vector<double> temp_new_old(x_new_old.cbegin() + i * 6, x_new_old.cbegin() + (i + 1) * 6);
-
-        KDL::Frame H_old_obj = KdlVectorConverter::vectorToFrame(temp_old_obj);
-        KDL::Frame H_new_old = KdlVectorConverter::vectorToFrame(temp_new_old);
+        KDL::Frame H_old_obj = KdlVectorConverter::arrayToFrame(x_old_obj.data() + i * 6);
+        KDL::Frame H_new_old = KdlVectorConverter::arrayToFrame(x_new_old.data() + i * 6);
         KDL::Frame H_new_obj = H_new_old * H_old_obj;
 
-        std::vector<double> temp_new_obj = KdlVectorConverter::frameToVector(H_new_obj);
-        x_new_obj.insert(x_new_obj.end(), temp_new_obj.cbegin(), temp_new_obj.cend());
+        KdlVectorConverter::frameToArray(H_new_obj, x_new_obj.data() + i * 6);
     }
 
     return true;
@@ -65,27 +64,23 @@ bool KdlTreeSolver::changeOrigin(const std::vector<double> & x_old_obj, const st
 
 bool KdlTreeSolver::fwdKin(const std::vector<double> & q, std::vector<double> & x)
 {
-    KDL::JntArray qInRad(tree.getNrOfJoints());
+    std::lock_guard<std::mutex> lock(mtx);
 
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        qInBuffer(motor) = KinRepresentation::degToRad(q[motor]);
     }
 
-    x.clear();
-    x.reserve(endpoints.size() * 6);
-
-    for (const auto & endpoint : endpoints)
+    if (fkSolverPos->JntToCart(qInBuffer, endpointFrames) < 0)
     {
-        KDL::Frame fOutCart;
+        return false;
+    }
 
-        if (fkSolverPos->JntToCart(qInRad, fOutCart, endpoint) < 0)
-        {
-            return false;
-        }
+    x.resize(endpoints.size() * 6);
 
-        auto temp = KdlVectorConverter::frameToVector(fOutCart);
-        x.insert(x.end(), temp.cbegin(), temp.cend());
+    for (auto i = 0; i < endpoints.size(); i++)
+    {
+        KdlVectorConverter::frameToArray(endpointFrames[i], x.data() + i * 6);
     }
 
     return true;
@@ -95,21 +90,17 @@ bool KdlTreeSolver::fwdKin(const std::vector<double> & q, std::vector<double> &
 
 bool KdlTreeSolver::poseDiff(const std::vector<double> & xLhs, const std::vector<double> & xRhs, std::vector<double> & xOut)
 {
-    xOut.clear();
-    xOut.reserve(endpoints.size() * 6);
+    std::lock_guard<std::mutex> lock(mtx);
+
+    xOut.resize(endpoints.size() * 6);
 
     for (auto i = 0; i < endpoints.size(); i++)
     {
-        std::vector<double> temp_xLhs(xLhs.cbegin() + i * 6, xLhs.cbegin() + (i + 1) * 6);
-        std::vector<double> temp_xRhs(xRhs.cbegin() + i * 6, xRhs.cbegin() + (i + 1) * 6);
-
-        KDL::Frame fLhs = KdlVectorConverter::vectorToFrame(temp_xLhs);
-        KDL::Frame fRhs = KdlVectorConverter::vectorToFrame(temp_xRhs);
+        KDL::Frame fLhs = KdlVectorConverter::arrayToFrame(xLhs.data() + i * 6);
+        KDL::Frame fRhs = KdlVectorConverter::arrayToFrame(xRhs.data() + i * 6);
 
         KDL::Twist diff = KDL::diff(fRhs, fLhs); // [fLhs - fRhs] for translation
-        std::vector<double> temp_xOut = KdlVectorConverter::twistToVector(diff);
-
-        xOut.insert(xOut.end(), temp_xOut.cbegin(), temp_xOut.cend());
+        KdlVectorConverter::twistToArray(diff, xOut.data() + i * 6);
     }
 
     return true;
@@ -119,34 +110,28 @@ bool KdlTreeSolver::poseDiff(const std::vector<double> & xLhs, const std::vector
 
 bool KdlTreeSolver::invKin(const std::vector<double> & xd, const std::vector<double> & qGuess, std::vector<double> & q, const reference_frame frame)
 {
-    KDL::Frames frames;
+    std::lock_guard<std::mutex> lock(mtx);
 
     for (auto i = 0; i < endpoints.size(); i++)
     {
-        std::vector<double> sub(xd.cbegin() + i * 6, xd.cbegin() + (i + 1) * 6);
-        frames.insert(std::make_pair(endpoints[i], KdlVectorConverter::vectorToFrame(sub)));
+        *targetFrameSlots[i] = KdlVectorConverter::arrayToFrame(xd.data() + i * 6);
     }
 
-    KDL::JntArray qGuessInRad(tree.getNrOfJoints());
-
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
     {
-        qGuessInRad(motor) = KinRepresentation::degToRad(qGuess[motor]);
+        qInBuffer(motor) = KinRepresentation::degToRad(qGuess[motor]);
     }
 
     if (frame == TCP_FRAME)
     {
-        for (const auto & endpoint : endpoints)
+        if (fkSolverPos->JntToCart(qInBuffer, endpointFrames) < 0)
         {
-            KDL::Frame fOutCart;
-
-            if (fkSolverPos->JntToCart(qGuessInRad, fOutCart, endpoint) < 0)
-            {
-                return false;
-            }
+            return false;
+        }
 
-            auto it = frames.find(endpoint);
-            it->second = fOutCart * it->second;
+        for (auto i = 0; i < endpoints.size(); i++)
+        {
+            *targetFrameSlots[i] = endpointFrames[i] * *targetFrameSlots[i];
         }
     }
     else if (frame != BASE_FRAME)
@@ -155,9 +140,7 @@ bool KdlTreeSolver::invKin(const std::vector<double> & xd, const std::vector<dou
         return false;
     }
 
-    KDL::JntArray kdlq(tree.getNrOfJoints());
-
-    if (ikSolverPos->CartToJnt(qGuessInRad, frames, kdlq) < 0)
+    if (ikSolverPos->CartToJnt(qInBuffer, targetFrames, qOutBuffer) < 0)
     {
         return false;
     }
@@ -166,7 +149,7 @@ bool KdlTreeSolver::invKin(const std::vector<double> & xd, const std::vector<dou
 
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
     {
-        q[motor] = KinRepresentation::radToDeg(kdlq(motor));
+        q[motor] = KinRepresentation::radToDeg(qOutBuffer(motor));
     }
 
     return true;
@@ -176,37 +159,30 @@ bool KdlTreeSolver::invKin(const std::vector<double> & xd, const std::vector<dou
 
 bool KdlTreeSolver::diffInvKin(const std::vector<double> & q, const std::vector<double> & xdot, std::vector<double> & qdot, const reference_frame frame)
 {
-    KDL::Twists twists;
+    std::lock_guard<std::mutex> lock(mtx);
 
     for (auto i = 0; i < endpoints.size(); i++)
     {
-        std::vector<double> sub(xdot.cbegin() + i * 6, xdot.cbegin() + (i + 1) * 6);
-        twists.insert(std::make_pair(endpoints[i], KdlVectorConverter::vectorToTwist(sub)));
+        *targetTwistSlots[i] = KdlVectorConverter::arrayToTwist(xdot.data() + i * 6);
     }
 
-    KDL::JntArray qInRad(tree.getNrOfJoints());
-
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
     {
-        qInRad(motor) = KinRepresentation::degToRad(q[motor]);
+        qInBuffer(motor) = KinRepresentation::degToRad(q[motor]);
     }
 
     if (frame == TCP_FRAME)
     {
-        for (const auto & endpoint : endpoints)
+        if (fkSolverPos->JntToCart(qInBuffer, endpointFrames) < 0)
         {
-            KDL::Frame fOutCart;
-
-            if (fkSolverPos->JntToCart(qInRad, fOutCart, endpoint) < 0)
-            {
-                return false;
-            }
-
-            auto it = twists.find(endpoint);
+            return false;
+        }
 
+        for (auto i = 0; i < endpoints.size(); i++)
+        {
             //-- Transform the basis to which the twist is expressed, but leave the reference point intact
             //-- "Twist and Wrench transformations" @ http://docs.ros.org/latest/api/orocos_kdl/html/geomprim.html
-            it->second = fOutCart.M * it->second;
+            *targetTwistSlots[i] = endpointFrames[i].M * *targetTwistSlots[i];
         }
     }
     else if (frame != BASE_FRAME)
@@ -215,9 +191,7 @@ bool KdlTreeSolver::diffInvKin(const std::vector<double> & q, const std::vector<
         return false;
     }
 
-    KDL::JntArray qDotOutRadS(tree.getNrOfJoints());
-
-    if (ikSolverVel->CartToJnt(qInRad, twists, qDotOutRadS) < 0)
+    if (ikSolverVel->CartToJnt(qInBuffer, targetTwists, qOutBuffer) < 0)
     {
         return false;
     }
@@ -226,7 +200,7 @@ bool KdlTreeSolver::diffInvKin(const std::vector<double> & q, const std::vector<
 
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
     {
-        qdot[motor] = KinRepresentation::radToDeg(qDotOutRadS(motor));
+        qdot[motor] = KinRepresentation::radToDeg(qOutBuffer(motor));
     }
 
     return true;
@@ -236,6 +210,8 @@ bool KdlTreeSolver::diffInvKin(const std::vector<double> & q, const std::vector<
 
 bool KdlTreeSolver::invDyn(const std::vector<double> & q, std::vector<double> & t)
 {
+    std::lock_guard<std::mutex> lock(mtx);
+
     KDL::JntArray qInRad(tree.getNrOfJoints());
 
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
@@ -272,6 +248,8 @@ bool KdlTreeSolver::invDyn(const std::vector<double> & q, std::vector<double> &
 
 bool KdlTreeSolver::invDyn(const std::vector<double> & q, const std::vector<double> & qdot, const std::vector<double> & qdotdot, const std::vector<std::vector<double>> & fexts, std::vector<double> & t)
 {
+    std::lock_guard<std::mutex> lock(mtx);
+
     KDL::JntArray qInRad(tree.getNrOfJoints());
 
     for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
@@ -319,3 +297,68 @@ bool KdlTreeSolver::invDyn(const std::vector<double> & q, const std::vector<doub
 }
 
 // -----------------------------------------------------------------------------
+
+bool KdlTreeSolver::invDyn(const double * q, const double * qdot, const double * qdotdot, const double * fexts, int numFexts, double * t)
+{
+    std::lock_guard<std::mutex> lock(mtx);
+
+    if (fexts && numFexts > 0)
+    {
+        // FIXME: not trivial, see https://github.com/roboticslab-uc3m/kinematics-dynamics/issues/162
+        yError() << "invDyn(): external forces not supported";
+        return false;
+    }
+
+    for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
+    {
+        qIdBuffer(motor) = KinRepresentation::degToRad(q[motor]);
+        qdotIdBuffer(motor) = qdot ? KinRepresentation::degToRad(qdot[motor]) : 0.0;
+        qdotdotIdBuffer(motor) = qdotdot ? KinRepresentation::degToRad(qdotdot[motor]) : 0.0;
+    }
+
+    if (idSolver->CartToJnt(qIdBuffer, qdotIdBuffer, qdotdotIdBuffer, fextsIdBuffer, tIdBuffer) < 0)
+    {
+        return false;
+    }
+
+    for (int motor = 0; motor < tree.getNrOfJoints(); motor++)
+    {
+        t[motor] = tIdBuffer(motor);
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool KdlTreeSolver::massMatrix(const std::vector<double> & q, std::vector<double> & M)
+{
+    yWarning() << "massMatrix() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool KdlTreeSolver::jacobian(const double * q, double * x, double * J)
+{
+    yWarning() << "jacobian() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool KdlTreeSolver::coriolisTorques(const std::vector<double> & q, const std::vector<double> & qdot, std::vector<double> & c)
+{
+    yWarning() << "coriolisTorques() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+
+bool KdlTreeSolver::fwdDyn(const std::vector<double> & q, const std::vector<double> & qdot, const std::vector<double> & t, std::vector<double> & qdotdot)
+{
+    yWarning() << "fwdDyn() not implemented";
+    return false;
+}
+
+// -----------------------------------------------------------------------------
@@ -3,17 +3,21 @@
 #ifndef __KDL_TREE_SOLVER_HPP__
 #define __KDL_TREE_SOLVER_HPP__
 
+#include <mutex>
 #include <string>
 #include <vector>
 
 #include <yarp/dev/DeviceDriver.h>
 
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
 #include <kdl/tree.hpp>
-#include <kdl/treefksolver.hpp>
 #include <kdl/treeiksolver.hpp>
 #include <kdl/treeidsolver.hpp>
 
 #include "ICartesianSolver.h"
+#include "TreeFkSolverPos_Endpoints.hpp"
+#include "WorkerPool.hpp"
 
 #define DEFAULT_KINEMATICS "none.ini"
 #define DEFAULT_LAMBDA 0.01
@@ -22,6 +26,9 @@
 #define DEFAULT_V_TRANSL_MAX 1.0 // meters/s
 #define DEFAULT_V_ROT_MAX 50.0 // degrees/s
 #define DEFAULT_IK_SOLVER "nrjl"
+#define DEFAULT_STRATEGY "leastOverallAngularDisplacement"
+#define DEFAULT_WORKERS 0
+#define DEFAULT_IK_VEL_SOLVER "wdls"
 
 namespace roboticslab
 {
@@ -44,7 +51,8 @@ public:
     KdlTreeSolver() : fkSolverPos(nullptr),
                       ikSolverPos(nullptr),
                       ikSolverVel(nullptr),
-                      idSolver(nullptr)
+                      idSolver(nullptr),
+                      workerPool(nullptr)
     {}
 
     // -- ICartesianSolver declarations. Implementation in ICartesianSolverImpl.cpp --
@@ -79,6 +87,21 @@ public:
     // Perform inverse dynamics.
     bool invDyn(const std::vector<double> & q, const std::vector<double> & qdot, const std::vector<double> & qdotdot, const std::vector<std::vector<double>> & fexts, std::vector<double> & t) override;
 
+    // Perform inverse dynamics on caller-owned storage.
+    bool invDyn(const double * q, const double * qdot, const double * qdotdot, const double * fexts, int numFexts, double * t) override;
+
+    // Compute the joint-space inertia matrix.
+    bool massMatrix(const std::vector<double> & q, std::vector<double> & M) override;
+
+    // Compute pose and geometric Jacobian on caller-owned storage.
+    bool jacobian(const double * q, double * x, double * J) override;
+
+    // Compute Coriolis and centrifugal joint torques.
+    bool coriolisTorques(const std::vector<double> & q, const std::vector<double> & qdot, std::vector<double> & c) override;
+
+    // Perform forward dynamics.
+    bool fwdDyn(const std::vector<double> & q, const std::vector<double> & qdot, const std::vector<double> & t, std::vector<double> & qdotdot) override;
+
     // -------- DeviceDriver declarations. Implementation in IDeviceImpl.cpp --------
 
     bool open(yarp::os::Searchable & config) override;
@@ -86,12 +109,32 @@ public:
     bool close() override;
 
 protected:
+    // Guards the solvers and the preallocated storage below.
+    mutable std::mutex mtx;
+
     std::vector<std::string> endpoints;
     KDL::Tree tree;
-    KDL::TreeFkSolverPos * fkSolverPos;
+    TreeFkSolverPos_Endpoints * fkSolverPos;
     KDL::TreeIkSolverPos * ikSolverPos;
     KDL::TreeIkSolverVel * ikSolverVel;
     KDL::TreeIdSolver * idSolver;
+
+    // Solves the branches of the tree in parallel (screw theory IK only).
+    WorkerPool * workerPool;
+
+    // Preallocated per-call storage, indexed like endpoints. The slots point
+    // into the maps expected by KDL's tree IK solvers, whose keys never change.
+    std::vector<KDL::Frame> endpointFrames;
+    KDL::Frames targetFrames;
+    std::vector<KDL::Frame *> targetFrameSlots;
+    KDL::Twists targetTwists;
+    std::vector<KDL::Twist *> targetTwistSlots;
+    KDL::JntArray qInBuffer;
+    KDL::JntArray qOutBuffer;
+
+    // Preallocated inverse dynamics storage, zero wrenches on every endpoint.
+    KDL::JntArray qIdBuffer, qdotIdBuffer, qdotdotIdBuffer, tIdBuffer;
+    KDL::WrenchMap fextsIdBuffer;
 };
 
 } // namespace roboticslab
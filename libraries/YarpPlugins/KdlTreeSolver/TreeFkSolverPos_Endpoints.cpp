@@ -0,0 +1,227 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "TreeFkSolverPos_Endpoints.hpp"
+
+#include <set>
+#include <utility>
+
+#include <kdl/joint.hpp>
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+TreeFkSolverPos_Endpoints::TreeFkSolverPos_Endpoints(const KDL::Tree & _tree, const std::vector<std::string> & endpoints)
+    : tree(_tree),
+      endpointNodes(endpoints.size(), -1),
+      endpointNames(endpoints),
+      qCached(_tree.getNrOfJoints()),
+      cacheValid(false)
+{
+    const KDL::SegmentMap & segments = tree.getSegments();
+    const KDL::SegmentMap::const_iterator root = tree.getRootSegment();
+
+    //-- Mark every segment on a root-to-endpoint path.
+    std::set<std::string> used;
+
+    for (const auto & endpoint : endpoints)
+    {
+        KDL::SegmentMap::const_iterator it = segments.find(endpoint);
+
+        while (it != segments.end() && it != root && used.insert(it->first).second)
+        {
+            it = KDL::GetTreeElementParent(it->second);
+        }
+    }
+
+    //-- Depth-first preorder, so that parents always precede their children.
+    std::vector<std::pair<KDL::SegmentMap::const_iterator, int>> pending;
+    pending.emplace_back(root, -1);
+
+    while (!pending.empty())
+    {
+        KDL::SegmentMap::const_iterator it = pending.back().first;
+        int parent = pending.back().second;
+        pending.pop_back();
+
+        if (it != root)
+        {
+            const KDL::Segment & segment = KDL::GetTreeElementSegment(it->second);
+            bool fixed = segment.getJoint().getType() == KDL::Joint::None;
+
+            Node node;
+            node.parent = parent;
+            node.segment = &segment;
+            node.qNr = fixed ? -1 : static_cast<int>(KDL::GetTreeElementQNr(it->second));
+
+            parent = nodes.size();
+            nodes.push_back(node);
+
+            for (int i = 0; i < endpoints.size(); i++)
+            {
+                if (endpoints[i] == it->first)
+                {
+                    endpointNodes[i] = parent;
+                }
+            }
+        }
+
+        for (const auto & child : KDL::GetTreeElementChildren(it->second))
+        {
+            if (used.count(child->first) != 0)
+            {
+                pending.emplace_back(child, parent);
+            }
+        }
+    }
+
+    nodeFrames.resize(nodes.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void TreeFkSolverPos_Endpoints::sweep(const KDL::JntArray & q)
+{
+    if (cacheValid)
+    {
+        bool same = true;
+
+        for (int i = 0; i < q.rows() && same; i++)
+        {
+            same = q(i) == qCached(i);
+        }
+
+        if (same)
+        {
+            return;
+        }
+    }
+
+    for (int i = 0; i < nodes.size(); i++)
+    {
+        const Node & node = nodes[i];
+        KDL::Frame H = node.segment->pose(node.qNr >= 0 ? q(node.qNr) : 0.0);
+        nodeFrames[i] = node.parent >= 0 ? nodeFrames[node.parent] * H : H;
+    }
+
+    qCached = q;
+    cacheValid = true;
+}
+
+// -----------------------------------------------------------------------------
+
+int TreeFkSolverPos_Endpoints::JntToCart(const KDL::JntArray & q_in, std::vector<KDL::Frame> & p_out)
+{
+    if (q_in.rows() != tree.getNrOfJoints() || p_out.size() != endpointNodes.size())
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < endpointNodes.size(); i++)
+    {
+        if (endpointNodes[i] < 0)
+        {
+            return -2;
+        }
+    }
+
+    sweep(q_in);
+
+    for (int i = 0; i < endpointNodes.size(); i++)
+    {
+        p_out[i] = nodeFrames[endpointNodes[i]];
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int TreeFkSolverPos_Endpoints::JntToJac(const KDL::JntArray & q_in, Eigen::MatrixXd & J)
+{
+    if (q_in.rows() != tree.getNrOfJoints() || J.rows() != 6 * endpointNodes.size() || J.cols() != q_in.rows())
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < endpointNodes.size(); i++)
+    {
+        if (endpointNodes[i] < 0)
+        {
+            return -2;
+        }
+    }
+
+    sweep(q_in);
+    J.setZero();
+
+    for (int i = 0; i < endpointNodes.size(); i++)
+    {
+        const KDL::Vector & p_e = nodeFrames[endpointNodes[i]].p;
+
+        for (int k = endpointNodes[i]; k >= 0; k = nodes[k].parent)
+        {
+            const Node & node = nodes[k];
+
+            if (node.qNr < 0)
+            {
+                continue;
+            }
+
+            const KDL::Joint & joint = node.segment->getJoint();
+            const KDL::Frame & H_parent = node.parent >= 0 ? nodeFrames[node.parent] : KDL::Frame::Identity();
+            KDL::Twist column = (H_parent.M * joint.twist(1.0)).RefPoint(p_e - H_parent * joint.JointOrigin());
+
+            for (int r = 0; r < 6; r++)
+            {
+                J(6 * i + r, node.qNr) = column[r];
+            }
+        }
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int TreeFkSolverPos_Endpoints::JntToCart(const KDL::JntArray & q_in, KDL::Frame & p_out, const std::string & segmentName)
+{
+    if (q_in.rows() != tree.getNrOfJoints())
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < endpointNames.size(); i++)
+    {
+        if (endpointNames[i] == segmentName && endpointNodes[i] >= 0)
+        {
+            sweep(q_in);
+            p_out = nodeFrames[endpointNodes[i]];
+            return 0;
+        }
+    }
+
+    //-- Not an endpoint, same as KDL::TreeFkSolverPos_recursive.
+    const KDL::SegmentMap & segments = tree.getSegments();
+    const KDL::SegmentMap::const_iterator root = tree.getRootSegment();
+    KDL::SegmentMap::const_iterator it = segments.find(segmentName);
+
+    if (it == segments.end())
+    {
+        return -2;
+    }
+
+    p_out = KDL::Frame::Identity();
+
+    while (it != root)
+    {
+        const KDL::Segment & segment = KDL::GetTreeElementSegment(it->second);
+        bool fixed = segment.getJoint().getType() == KDL::Joint::None;
+        p_out = segment.pose(fixed ? 0.0 : q_in(KDL::GetTreeElementQNr(it->second))) * p_out;
+        it = KDL::GetTreeElementParent(it->second);
+    }
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,105 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __TREE_FK_SOLVER_POS_ENDPOINTS_HPP__
+#define __TREE_FK_SOLVER_POS_ENDPOINTS_HPP__
+
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/segment.hpp>
+#include <kdl/tree.hpp>
+#include <kdl/treefksolver.hpp>
+
+#include <Eigen/Core>
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlTreeSolver
+ * @brief FK solver for a fixed set of tree endpoints.
+ *
+ * Computes the frames of all endpoints in a single topological sweep from the root,
+ * so that segments shared by several branches (e.g. a torso) are evaluated only once.
+ * Segments that do not lead to any endpoint are skipped. The result of the last sweep
+ * is cached, hence consecutive single-endpoint queries on the same joint values (as issued
+ * by KDL's tree IK solvers) cost one sweep in total. Not thread-safe.
+ */
+class TreeFkSolverPos_Endpoints : public KDL::TreeFkSolverPos
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param tree Input kinematic tree, must outlive this solver.
+     * @param endpoints Names of the tip segments, in output order.
+     */
+    TreeFkSolverPos_Endpoints(const KDL::Tree & tree, const std::vector<std::string> & endpoints);
+
+    /**
+     * @brief Calculate forward position kinematics of all endpoints.
+     *
+     * @param q_in Input joint positions.
+     * @param p_out Output endpoint frames, in the order given at construction. Not resized.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    int JntToCart(const KDL::JntArray & q_in, std::vector<KDL::Frame> & p_out);
+
+    /**
+     * @brief Calculate forward position kinematics of a single segment.
+     *
+     * Endpoints are served from the sweep cache, other segments are computed
+     * by walking up to the root.
+     *
+     * @param q_in Input joint positions.
+     * @param p_out Output frame.
+     * @param segmentName Name of the segment.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    virtual int JntToCart(const KDL::JntArray & q_in, KDL::Frame & p_out, const std::string & segmentName);
+
+    /**
+     * @brief Calculate the stacked geometric Jacobian of all endpoints.
+     *
+     * Shares the sweep cache with @ref JntToCart.
+     *
+     * @param q_in Input joint positions.
+     * @param J Output Jacobian (6 * number of endpoints x number of joints), each
+     * block expressed in the base frame with its reference point at the endpoint.
+     * Not resized.
+     *
+     * @return Return code, < 0 if something went wrong.
+     */
+    int JntToJac(const KDL::JntArray & q_in, Eigen::MatrixXd & J);
+
+private:
+
+    //! Segment on a root-to-endpoint path, stored after its parent.
+    struct Node
+    {
+        int parent; // -1 if attached to the root segment
+        const KDL::Segment * segment;
+        int qNr; // -1 if fixed
+    };
+
+    void sweep(const KDL::JntArray & q);
+
+    const KDL::Tree & tree;
+
+    std::vector<Node> nodes;
+    std::vector<KDL::Frame> nodeFrames;
+    std::vector<int> endpointNodes;
+    std::vector<std::string> endpointNames;
+
+    KDL::JntArray qCached;
+    bool cacheValid;
+};
+
+} // namespace roboticslab
+
+#endif // __TREE_FK_SOLVER_POS_ENDPOINTS_HPP__
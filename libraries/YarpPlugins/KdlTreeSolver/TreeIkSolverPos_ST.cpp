@@ -0,0 +1,348 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "TreeIkSolverPos_ST.hpp"
+
+#include <algorithm>
+#include <map>
+
+#include <kdl/chain.hpp>
+#include <kdl/joint.hpp>
+
+#include "ProductOfExponentials.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+TreeIkSolverPos_ST::TreeIkSolverPos_ST(const KDL::JntArray & _qMin, const KDL::JntArray & _qMax,
+        TreeFkSolverPos_Endpoints & _fkSolver, WorkerPool & _workerPool, int _maxIter, double _eps, double _lambda)
+    : qMin(_qMin),
+      qMax(_qMax),
+      fkSolver(_fkSolver),
+      workerPool(_workerPool),
+      maxIter(_maxIter),
+      eps(_eps),
+      lambda(_lambda)
+{}
+
+// -----------------------------------------------------------------------------
+
+TreeIkSolverPos_ST::~TreeIkSolverPos_ST()
+{
+    for (auto & branch : branches)
+    {
+        delete branch.problem;
+        branch.problem = NULL;
+
+        delete branch.config;
+        branch.config = NULL;
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+void TreeIkSolverPos_ST::solveBranch(Branch & branch, KDL::JntArray & q_out)
+{
+    if (branch.problem == NULL)
+    {
+        branch.status = 0; // nothing to solve, fully determined by the torso
+        return;
+    }
+
+    bool ret = branch.problem->solve(branch.H_base.Inverse() * *branch.target, branch.solutions);
+
+    if (!branch.config->configure(branch.solutions) || !branch.config->findOptimalConfiguration(branch.qGuess))
+    {
+        branch.status = E_OUT_OF_LIMITS;
+        return;
+    }
+
+    branch.config->retrievePose(branch.qOut);
+
+    for (int i = 0; i < branch.joints.size(); i++)
+    {
+        q_out(branch.joints[i]) = branch.qOut(i);
+    }
+
+    branch.status = ret ? 0 : E_NOT_REACHABLE;
+}
+
+// -----------------------------------------------------------------------------
+
+double TreeIkSolverPos_ST::CartToJnt(const KDL::JntArray & q_init, const KDL::Frames & p_in, KDL::JntArray & q_out)
+{
+    if (q_init.rows() != qMin.rows() || q_out.rows() != qMin.rows())
+    {
+        return E_INVALID_INPUT;
+    }
+
+    for (auto & branch : branches)
+    {
+        auto it = p_in.find(branch.endpoint);
+
+        if (it == p_in.end())
+        {
+            return E_INVALID_INPUT;
+        }
+
+        branch.target = &it->second;
+
+        for (int i = 0; i < branch.joints.size(); i++)
+        {
+            branch.qGuess(i) = q_init(branch.joints[i]);
+        }
+    }
+
+    q_out = q_init;
+
+    for (const auto & joint : torso)
+    {
+        q_out(joint.qNr) = std::min(std::max(q_out(joint.qNr), qMin(joint.qNr)), qMax(joint.qNr));
+    }
+
+    // each task only writes its own branch and the joints it owns
+    auto task = [this, &q_out](int i)
+    {
+        solveBranch(branches[i], q_out);
+    };
+
+    for (int iter = 0; ; iter++)
+    {
+        //-- Base frames only depend on torso joints; the FK solver is not thread-safe, hence not in the tasks.
+        for (auto & branch : branches)
+        {
+            if (fkSolver.JntToCart(q_out, branch.H_base, branch.baseSegment) < 0)
+            {
+                return E_SOLUTION_NOT_FOUND;
+            }
+        }
+
+        workerPool.run(branches.size(), task);
+
+        bool reachable = true;
+
+        for (const auto & branch : branches)
+        {
+            if (branch.status < 0)
+            {
+                return branch.status;
+            }
+
+            reachable = reachable && branch.status == 0;
+        }
+
+        if (torso.empty())
+        {
+            return reachable ? 0 : E_NOT_REACHABLE;
+        }
+
+        //-- Remaining pose error, as seen by the torso.
+        if (fkSolver.JntToCart(q_out, endpointFrames) < 0)
+        {
+            return E_SOLUTION_NOT_FOUND;
+        }
+
+        for (int i = 0; i < branches.size(); i++)
+        {
+            KDL::Twist error = KDL::diff(endpointFrames[i], *branches[i].target);
+
+            for (int k = 0; k < 6; k++)
+            {
+                e(6 * i + k) = error[k];
+            }
+        }
+
+        if (e.norm() <= eps)
+        {
+            return 0;
+        }
+
+        if (iter >= maxIter)
+        {
+            return E_NOT_REACHABLE;
+        }
+
+        //-- Torso columns of the Jacobian of each endpoint, branch joints kept still.
+        for (int j = 0; j < torso.size(); j++)
+        {
+            KDL::Frame H_parent;
+
+            if (fkSolver.JntToCart(q_out, H_parent, torso[j].parentSegment) < 0)
+            {
+                return E_SOLUTION_NOT_FOUND;
+            }
+
+            const KDL::Joint & joint = torso[j].segment->getJoint();
+            KDL::Twist unitTwist = H_parent.M * joint.twist(1.0);
+            KDL::Vector origin = H_parent * joint.JointOrigin();
+
+            for (int i = 0; i < branches.size(); i++)
+            {
+                KDL::Twist column = unitTwist.RefPoint(endpointFrames[i].p - origin);
+
+                for (int k = 0; k < 6; k++)
+                {
+                    J(6 * i + k, j) = column[k];
+                }
+            }
+        }
+
+        A.noalias() = J.transpose() * J;
+        A.diagonal().array() += lambda * lambda;
+        b.noalias() = J.transpose() * e;
+
+        decomposition.compute(A);
+
+        if (decomposition.info() != Eigen::Success)
+        {
+            return E_SOLUTION_NOT_FOUND;
+        }
+
+        delta = decomposition.solve(b);
+
+        for (int j = 0; j < torso.size(); j++)
+        {
+            int qNr = torso[j].qNr;
+            q_out(qNr) = std::min(std::max(q_out(qNr) + delta(j), qMin(qNr)), qMax(qNr));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+
+TreeIkSolverPos_ST * TreeIkSolverPos_ST::create(const KDL::Tree & tree, const std::vector<std::string> & endpoints,
+        const KDL::JntArray & qMin, const KDL::JntArray & qMax, const std::string & strategy,
+        TreeFkSolverPos_Endpoints & fkSolver, WorkerPool & workerPool, int maxIter, double eps, double lambda)
+{
+    if (strategy != "leastOverallAngularDisplacement" && strategy != "humanoidGait")
+    {
+        return NULL;
+    }
+
+    const KDL::SegmentMap & segments = tree.getSegments();
+    const KDL::SegmentMap::const_iterator root = tree.getRootSegment();
+
+    //-- Number of root-to-endpoint paths each segment lies on.
+    std::map<std::string, int> pathCounts;
+
+    for (const auto & endpoint : endpoints)
+    {
+        KDL::SegmentMap::const_iterator it = segments.find(endpoint);
+
+        if (it == segments.end())
+        {
+            return NULL;
+        }
+
+        while (it != root)
+        {
+            pathCounts[it->first]++;
+            it = KDL::GetTreeElementParent(it->second);
+        }
+    }
+
+    TreeIkSolverPos_ST * solver = new TreeIkSolverPos_ST(qMin, qMax, fkSolver, workerPool, maxIter, eps, lambda);
+    solver->branches.resize(endpoints.size());
+
+    for (int i = 0; i < endpoints.size(); i++)
+    {
+        Branch & branch = solver->branches[i];
+        branch.endpoint = endpoints[i];
+
+        //-- Walk up until the first segment shared with another endpoint (or the root).
+        KDL::SegmentMap::const_iterator it = segments.find(endpoints[i]);
+
+        while (it != root && pathCounts[it->first] == 1)
+        {
+            const KDL::Segment & segment = KDL::GetTreeElementSegment(it->second);
+
+            if (segment.getJoint().getType() != KDL::Joint::None)
+            {
+                branch.joints.insert(branch.joints.begin(), KDL::GetTreeElementQNr(it->second));
+            }
+
+            it = KDL::GetTreeElementParent(it->second);
+        }
+
+        branch.baseSegment = it->first;
+
+        if (branch.joints.empty())
+        {
+            continue;
+        }
+
+        KDL::Chain chain;
+
+        if (!tree.getChain(branch.baseSegment, branch.endpoint, chain))
+        {
+            delete solver;
+            return NULL;
+        }
+
+        ScrewTheoryIkProblemBuilder builder(PoeExpression::fromChain(chain));
+        branch.problem = builder.build();
+
+        if (branch.problem == NULL)
+        {
+            delete solver;
+            return NULL;
+        }
+
+        KDL::JntArray branchMin(branch.joints.size());
+        KDL::JntArray branchMax(branch.joints.size());
+
+        for (int j = 0; j < branch.joints.size(); j++)
+        {
+            branchMin(j) = qMin(branch.joints[j]);
+            branchMax(j) = qMax(branch.joints[j]);
+        }
+
+        if (strategy == "humanoidGait")
+        {
+            branch.config = new ConfigurationSelectorHumanoidGait(branchMin, branchMax);
+        }
+        else
+        {
+            branch.config = new ConfigurationSelectorLeastOverallAngularDisplacement(branchMin, branchMax);
+        }
+
+        branch.qGuess.resize(branch.joints.size());
+        branch.qOut.resize(branch.joints.size());
+    }
+
+    //-- Torso joints, sorted by joint index.
+    for (const auto & pathCount : pathCounts)
+    {
+        KDL::SegmentMap::const_iterator it = segments.find(pathCount.first);
+        const KDL::Segment & segment = KDL::GetTreeElementSegment(it->second);
+
+        if (pathCount.second > 1 && segment.getJoint().getType() != KDL::Joint::None)
+        {
+            TorsoJoint joint;
+            joint.qNr = KDL::GetTreeElementQNr(it->second);
+            joint.segment = &segment;
+            joint.parentSegment = KDL::GetTreeElementParent(it->second)->first;
+            solver->torso.push_back(joint);
+        }
+    }
+
+    std::sort(solver->torso.begin(), solver->torso.end(), [](const TorsoJoint & lhs, const TorsoJoint & rhs)
+    {
+        return lhs.qNr < rhs.qNr;
+    });
+
+    const int rows = 6 * endpoints.size();
+    const int cols = solver->torso.size();
+
+    solver->endpointFrames.resize(endpoints.size());
+    solver->J.resize(rows, cols);
+    solver->e.resize(rows);
+    solver->A.resize(cols, cols);
+    solver->b.resize(cols);
+    solver->delta.resize(cols);
+    solver->decomposition = Eigen::LDLT<Eigen::MatrixXd>(cols);
+
+    return solver;
+}
+
+// -----------------------------------------------------------------------------
@@ -0,0 +1,147 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __TREE_IK_SOLVER_POS_ST_HPP__
+#define __TREE_IK_SOLVER_POS_ST_HPP__
+
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/segment.hpp>
+#include <kdl/tree.hpp>
+#include <kdl/treeiksolver.hpp>
+
+#include <Eigen/Core>
+#include <Eigen/Cholesky>
+
+#include "ScrewTheoryIkProblem.hpp"
+#include "ConfigurationSelector.hpp"
+#include "TreeFkSolverPos_Endpoints.hpp"
+#include "WorkerPool.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlTreeSolver
+ * @brief IK solver using Screw Theory on each branch of a tree.
+ *
+ * The tree is split into torso joints, shared by the paths to two or more endpoints,
+ * and one branch per endpoint with the remaining joints. Each branch is solved in closed
+ * form by its own \ref ScrewTheoryIkProblem relative to the frame it hangs from, and
+ * branches are dispatched in parallel over a \ref WorkerPool. Since every joint belongs
+ * either to the torso or to a single branch, shared joints are never written by two
+ * branches. Torso joints start at the initial guess and are only moved if some endpoint
+ * cannot be reached that way, by damped least-squares steps on the remaining pose error
+ * after each closed-form pass.
+ */
+class TreeIkSolverPos_ST : public KDL::TreeIkSolverPos
+{
+public:
+
+    /** @brief Destructor. */
+    virtual ~TreeIkSolverPos_ST();
+
+    /**
+     * @brief Calculate inverse position kinematics.
+     *
+     * @param q_init Initial guess of the joint coordinates.
+     * @param p_in Input cartesian coordinates of each endpoint.
+     * @param q_out Output joint coordinates.
+     *
+     * @return Return code, < 0 if there is no solution or \ref E_NOT_REACHABLE if
+     * the closest one was returned instead.
+     */
+    virtual double CartToJnt(const KDL::JntArray & q_init, const KDL::Frames & p_in, KDL::JntArray & q_out);
+
+    /**
+     * @brief Create an instance of \ref TreeIkSolverPos_ST.
+     *
+     * @param tree Input kinematic tree, must outlive this solver.
+     * @param endpoints Names of the tip segments.
+     * @param qMin Joint array of minimum joint limits.
+     * @param qMax Joint array of maximum joint limits.
+     * @param strategy Configuration selection strategy of each branch, see \ref ConfigurationSelector.
+     * @param fkSolver FK solver for the same tree and endpoints.
+     * @param workerPool Threads that solve branches in parallel.
+     * @param maxIter Maximum number of torso refinement steps.
+     * @param eps Precision of the torso refinement (norm of the stacked pose error).
+     * @param lambda Damping factor of the torso refinement.
+     *
+     * @return Solver instance or NULL if the tree could not be decomposed or any
+     * branch lacks a closed-form solution.
+     */
+    static TreeIkSolverPos_ST * create(const KDL::Tree & tree, const std::vector<std::string> & endpoints,
+                                       const KDL::JntArray & qMin, const KDL::JntArray & qMax,
+                                       const std::string & strategy, TreeFkSolverPos_Endpoints & fkSolver,
+                                       WorkerPool & workerPool, int maxIter, double eps, double lambda);
+
+    /** @brief Return code, IK solution not found. */
+    static const int E_SOLUTION_NOT_FOUND = -100;
+
+    /** @brief Return code, target pose out of robot limits. */
+    static const int E_OUT_OF_LIMITS = -101;
+
+    /** @brief Return code, missing endpoint target or wrong joint array size. */
+    static const int E_INVALID_INPUT = -102;
+
+    /** @brief Return code, solution out of reach. */
+    static const int E_NOT_REACHABLE = 100;
+
+private:
+
+    //! Joints owned by a single endpoint, solved in closed form.
+    struct Branch
+    {
+        Branch() : problem(NULL), config(NULL), target(NULL), status(0) {}
+
+        std::string endpoint;
+        std::string baseSegment; // last segment shared with other endpoints
+        std::vector<int> joints; // tree joint index of each branch joint, from base to tip
+        ScrewTheoryIkProblem * problem; // NULL if the endpoint has no joints of its own
+        ConfigurationSelector * config;
+        ScrewTheoryIkProblem::Solutions solutions;
+        KDL::JntArray qGuess;
+        KDL::JntArray qOut;
+        KDL::Frame H_base;
+        const KDL::Frame * target;
+        int status;
+    };
+
+    //! Joint shared by the paths to several endpoints.
+    struct TorsoJoint
+    {
+        int qNr;
+        const KDL::Segment * segment;
+        std::string parentSegment;
+    };
+
+    TreeIkSolverPos_ST(const KDL::JntArray & qMin, const KDL::JntArray & qMax, TreeFkSolverPos_Endpoints & fkSolver,
+                       WorkerPool & workerPool, int maxIter, double eps, double lambda);
+
+    void solveBranch(Branch & branch, KDL::JntArray & q_out);
+
+    KDL::JntArray qMin, qMax;
+    TreeFkSolverPos_Endpoints & fkSolver;
+    WorkerPool & workerPool;
+    int maxIter;
+    double eps;
+    double lambda;
+
+    std::vector<Branch> branches;
+    std::vector<TorsoJoint> torso;
+
+    // torso refinement workspace
+    std::vector<KDL::Frame> endpointFrames;
+    Eigen::MatrixXd J;
+    Eigen::VectorXd e;
+    Eigen::MatrixXd A;
+    Eigen::VectorXd b;
+    Eigen::VectorXd delta;
+    Eigen::LDLT<Eigen::MatrixXd> decomposition;
+};
+
+}  // namespace roboticslab
+
+#endif  // __TREE_IK_SOLVER_POS_ST_HPP__
@@ -0,0 +1,55 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#include "TreeIkSolverVel_DLS.hpp"
+
+using namespace roboticslab;
+
+// -----------------------------------------------------------------------------
+
+TreeIkSolverVel_DLS::TreeIkSolverVel_DLS(const std::vector<std::string> & _endpoints, TreeFkSolverPos_Endpoints & _fkSolver,
+        const DampedLeastSquares & _dls)
+    : endpoints(_endpoints),
+      fkSolver(_fkSolver),
+      dls(_dls),
+      J(6 * _dls.getNumTasks(), _dls.getNumJoints()),
+      xdot(6 * _dls.getNumTasks())
+{}
+
+// -----------------------------------------------------------------------------
+
+double TreeIkSolverVel_DLS::CartToJnt(const KDL::JntArray & q_in, const KDL::Twists & v_in, KDL::JntArray & qdot_out)
+{
+    if (endpoints.size() != dls.getNumTasks() || q_in.rows() != dls.getNumJoints() || qdot_out.rows() != dls.getNumJoints())
+    {
+        return E_INVALID_INPUT;
+    }
+
+    for (int i = 0; i < endpoints.size(); i++)
+    {
+        auto it = v_in.find(endpoints[i]);
+
+        if (it == v_in.end())
+        {
+            return E_INVALID_INPUT;
+        }
+
+        for (int k = 0; k < 6; k++)
+        {
+            xdot(6 * i + k) = it->second[k];
+        }
+    }
+
+    if (fkSolver.JntToJac(q_in, J) < 0)
+    {
+        return E_JACSOLVER_FAILED;
+    }
+
+    if (!dls.solve(J, xdot, q_in.data, qdot_out.data))
+    {
+        return E_DLS_FAILED;
+    }
+
+    return dls.getDamping();
+}
+
+// -----------------------------------------------------------------------------
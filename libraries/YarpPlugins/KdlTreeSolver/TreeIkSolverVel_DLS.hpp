@@ -0,0 +1,75 @@
+// -*- mode:C++; tab-width:4; c-basic-offset:4; indent-tabs-mode:nil -*-
+
+#ifndef __TREE_IK_SOLVER_VEL_DLS_HPP__
+#define __TREE_IK_SOLVER_VEL_DLS_HPP__
+
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/treeiksolver.hpp>
+
+#include <Eigen/Core>
+
+#include "DampedLeastSquares.hpp"
+#include "TreeFkSolverPos_Endpoints.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup KdlTreeSolver
+ * @brief Differential IK solver using weighted damped least squares.
+ *
+ * Each endpoint is one task of a \ref DampedLeastSquares solver, the stacked
+ * Jacobian is obtained from the same sweep as the endpoint frames.
+ */
+class TreeIkSolverVel_DLS : public KDL::TreeIkSolverVel
+{
+public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param endpoints Names of the tip segments.
+     * @param fkSolver FK solver for the same tree and endpoints.
+     * @param dls A configured least-squares solver for as many tasks as endpoints
+     * and as many joints as the tree, copied.
+     */
+    TreeIkSolverVel_DLS(const std::vector<std::string> & endpoints, TreeFkSolverPos_Endpoints & fkSolver,
+                        const DampedLeastSquares & dls);
+
+    /**
+     * @brief Calculate inverse velocity kinematics.
+     *
+     * @param q_in Current joint coordinates.
+     * @param v_in Desired cartesian velocity of each endpoint, expressed in the base frame.
+     * @param qdot_out Output joint velocities.
+     *
+     * @return Return code, < 0 on failure, otherwise the damping factor used.
+     */
+    virtual double CartToJnt(const KDL::JntArray & q_in, const KDL::Twists & v_in, KDL::JntArray & qdot_out);
+
+    /** @brief Return code, missing endpoint twist or wrong joint array size. */
+    static const int E_INVALID_INPUT = -100;
+
+    /** @brief Return code, internal Jacobian computation failed. */
+    static const int E_JACSOLVER_FAILED = -101;
+
+    /** @brief Return code, least-squares solver failed. */
+    static const int E_DLS_FAILED = -102;
+
+private:
+
+    std::vector<std::string> endpoints;
+    TreeFkSolverPos_Endpoints & fkSolver;
+    DampedLeastSquares dls;
+
+    Eigen::MatrixXd J;
+    Eigen::VectorXd xdot;
+};
+
+}  // namespace roboticslab
+
+#endif  // __TREE_IK_SOLVER_VEL_DLS_HPP__
@@ -61,6 +61,134 @@ class BasicCartesianControlTest : public testing::Test
         roboticslab::ICartesianControl *iCartesianControl;
 };
 
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref BasicCartesianControl impedance control at 1 kHz on a simulated
+ * torque-controlled mechanism.
+ */
+class BasicCartesianControlImpdTest : public testing::Test
+{
+
+    public:
+        virtual void SetUp() {
+            yarp::os::Property cartesianControlOptions {
+                {"device", yarp::os::Value("BasicCartesianControl")},
+                {"robot", yarp::os::Value("fakeMotionControl")},
+                {"solver", yarp::os::Value("KdlSolver")},
+                {"numLinks", yarp::os::Value(1)},
+                {"cmcPeriodMs", yarp::os::Value(1)}
+            };
+
+            cartesianControlOptions.addGroup("link_0").put("A", yarp::os::Value(1));
+            cartesianControlOptions.put("mins", yarp::os::Value::makeList("-100.0"));
+            cartesianControlOptions.put("maxs", yarp::os::Value::makeList("100.0"));
+            cartesianControlOptions.put("maxvels", yarp::os::Value::makeList("100.0"));
+
+            cartesianControlDevice.open(cartesianControlOptions);
+
+            if (!cartesianControlDevice.isValid())
+            {
+                yError() << "CartesianControl device not valid:" << cartesianControlOptions.find("device").asString();
+                return;
+            }
+
+            if (!cartesianControlDevice.view(iCartesianControl))
+            {
+                yError() << "Could not view iCartesianControl in:" << cartesianControlOptions.find("device").asString();
+                return;
+            }
+
+            yarp::os::Time::delay(1);
+        }
+
+        virtual void TearDown()
+        {
+            cartesianControlDevice.close();
+        }
+
+    protected:
+        yarp::dev::PolyDriver cartesianControlDevice;
+        roboticslab::ICartesianControl *iCartesianControl;
+};
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref BasicCartesianControl gravity compensation torque cache at 1 kHz
+ * on a simulated torque-controlled mechanism.
+ */
+class BasicCartesianControlGcmpTest : public testing::Test
+{
+
+    public:
+        virtual void SetUp() {
+            yarp::os::Property cartesianControlOptions {
+                {"device", yarp::os::Value("BasicCartesianControl")},
+                {"robot", yarp::os::Value("fakeMotionControl")},
+                {"solver", yarp::os::Value("KdlSolver")},
+                {"numLinks", yarp::os::Value(1)},
+                {"cmcPeriodMs", yarp::os::Value(1)},
+                {"gcmpCacheTolerance", yarp::os::Value(1.0)},
+                {"gcmpCacheTaylor", yarp::os::Value(true)}
+            };
+
+            cartesianControlOptions.addGroup("link_0").put("A", yarp::os::Value(1));
+            cartesianControlOptions.put("mins", yarp::os::Value::makeList("-100.0"));
+            cartesianControlOptions.put("maxs", yarp::os::Value::makeList("100.0"));
+            cartesianControlOptions.put("maxvels", yarp::os::Value::makeList("100.0"));
+
+            cartesianControlDevice.open(cartesianControlOptions);
+
+            if (!cartesianControlDevice.isValid())
+            {
+                yError() << "CartesianControl device not valid:" << cartesianControlOptions.find("device").asString();
+                return;
+            }
+
+            if (!cartesianControlDevice.view(iCartesianControl))
+            {
+                yError() << "Could not view iCartesianControl in:" << cartesianControlOptions.find("device").asString();
+                return;
+            }
+
+            yarp::os::Time::delay(1);
+        }
+
+        virtual void TearDown()
+        {
+            cartesianControlDevice.close();
+        }
+
+    protected:
+        // joint-space move of the single joint, in degrees, then back to no control
+        void moveJoint(double q)
+        {
+            std::vector<double> xd(6), x;
+            xd[0] = std::cos(q * M_PI / 180);  // x
+            xd[1] = std::sin(q * M_PI / 180);  // y
+            xd[5] = q * M_PI / 180;  // o(z)
+            ASSERT_TRUE(iCartesianControl->stopControl());
+            ASSERT_TRUE(iCartesianControl->movj(xd));
+            ASSERT_TRUE(iCartesianControl->wait(5.0));
+            ASSERT_TRUE(iCartesianControl->stat(x));
+            ASSERT_NEAR(x[5], q * M_PI / 180, 1e-3);
+        }
+
+        // GCMP run of 0.1 seconds at the current posture
+        void runGcmp(double * hitRate)
+        {
+            int state;
+            std::vector<double> x;
+            ASSERT_TRUE(iCartesianControl->gcmp());
+            yarp::os::Time::delay(0.1);
+            ASSERT_TRUE(iCartesianControl->stat(x, &state));
+            ASSERT_EQ(state, VOCAB_CC_GCMP_CONTROLLING);
+            ASSERT_TRUE(iCartesianControl->getParameter(VOCAB_CC_CONFIG_GCMP_HIT_RATE, hitRate));
+        }
+
+        yarp::dev::PolyDriver cartesianControlDevice;
+        roboticslab::ICartesianControl *iCartesianControl;
+};
+
 TEST_F( BasicCartesianControlTest, BasicCartesianControlStat)
 {
     std::vector<double> x;
@@ -100,6 +228,20 @@ TEST_F( BasicCartesianControlTest, BasicCartesianControlInv2)
     ASSERT_NEAR(q[0], 90, 1e-3);
 }
 
+TEST_F( BasicCartesianControlTest, BasicCartesianControlInvBatch)
+{
+    std::vector< std::vector<double> > xds(2, std::vector<double>(6)), qs;
+    xds[0][0] = 1;  // x
+    xds[1][1] = 1;  // y
+    xds[1][5] = M_PI / 2;  // o(z)
+    ASSERT_TRUE(iCartesianControl->inv(xds,qs));
+    ASSERT_EQ(qs.size(), 2 );
+    ASSERT_EQ(qs[0].size(), 1 );
+    ASSERT_NEAR(qs[0][0], 0, 1e-3);
+    ASSERT_EQ(qs[1].size(), 1 );
+    ASSERT_NEAR(qs[1][0], 90, 1e-3);
+}
+
 TEST_F( BasicCartesianControlTest, BasicCartesianControlTool)
 {
     std::vector<double> x(6),xToolA,xToolB,xNoTool;
@@ -145,4 +287,110 @@ TEST_F( BasicCartesianControlTest, BasicCartesianControlTool)
     ASSERT_NEAR(xNoTool[5], 0, 1e-9);
 }
 
+TEST( BasicCartesianControlOptionsTest, BasicCartesianControlTimeOptimalSamples)
+{
+    // time-optimal profiles start and end at rest, an interior sample is required
+    for (int samples = 2; samples <= 3; samples++)
+    {
+        yarp::os::Property cartesianControlOptions {
+            {"device", yarp::os::Value("BasicCartesianControl")},
+            {"robot", yarp::os::Value("fakeMotionControl")},
+            {"solver", yarp::os::Value("KdlSolver")},
+            {"numLinks", yarp::os::Value(1)},
+            {"timeOptimalMovl", yarp::os::Value(true)},
+            {"timeOptimalSamples", yarp::os::Value(samples)}
+        };
+
+        cartesianControlOptions.addGroup("link_0").put("A", yarp::os::Value(1));
+        cartesianControlOptions.put("mins", yarp::os::Value::makeList("-100.0"));
+        cartesianControlOptions.put("maxs", yarp::os::Value::makeList("100.0"));
+        cartesianControlOptions.put("maxvels", yarp::os::Value::makeList("100.0"));
+
+        yarp::dev::PolyDriver cartesianControlDevice(cartesianControlOptions);
+        ASSERT_EQ(cartesianControlDevice.isValid(), samples == 3);
+    }
+}
+
+TEST_F( BasicCartesianControlImpdTest, BasicCartesianControlImpd)
+{
+    double period;
+    ASSERT_TRUE(iCartesianControl->getParameter(VOCAB_CC_CONFIG_CMC_PERIOD, &period));
+    ASSERT_EQ(period, 1);
+
+    std::vector<double> x;
+    int state;
+    ASSERT_TRUE(iCartesianControl->stat(x, &state));
+    ASSERT_EQ(state, VOCAB_CC_NOT_CONTROLLING);
+
+    // equilibrium pose away from the current one, the loop must keep controlling
+    std::vector<double> xd(x);
+    xd[1] = 0.1;
+    ASSERT_TRUE(iCartesianControl->impd(xd));
+
+    // new equilibrium poses while the control loop runs
+    for (int i = 0; i < 100; i++)
+    {
+        xd[1] = 0.1 * (i % 2);
+        ASSERT_TRUE(iCartesianControl->impd(xd));
+        yarp::os::Time::delay(0.01);
+        ASSERT_TRUE(iCartesianControl->stat(x, &state));
+        ASSERT_EQ(state, VOCAB_CC_IMPD_CONTROLLING);
+    }
+
+    ASSERT_TRUE(iCartesianControl->stopControl());
+    ASSERT_TRUE(iCartesianControl->stat(x, &state));
+    ASSERT_EQ(state, VOCAB_CC_NOT_CONTROLLING);
+}
+
+TEST_F( BasicCartesianControlGcmpTest, BasicCartesianControlGcmpCache)
+{
+    double tolerance, hitRate;
+    ASSERT_TRUE(iCartesianControl->getParameter(VOCAB_CC_CONFIG_GCMP_TOLERANCE, &tolerance));
+    ASSERT_EQ(tolerance, 1);
+
+    // the hit rate is read-only
+    ASSERT_FALSE(iCartesianControl->setParameter(VOCAB_CC_CONFIG_GCMP_HIT_RATE, 1.0));
+
+    // cold cache, only the first cycle misses on a still mechanism
+    runGcmp(&hitRate);
+    ASSERT_LT(hitRate, 1.0);
+    ASSERT_GT(hitRate, 0.9);
+
+    // within tolerance of the cached posture, every cycle is extrapolated from the cache
+    moveJoint(0.5);
+    runGcmp(&hitRate);
+    ASSERT_EQ(hitRate, 1.0);
+
+    // beyond tolerance of the cached posture, refreshed once
+    moveJoint(2.0);
+    runGcmp(&hitRate);
+    ASSERT_LT(hitRate, 1.0);
+    ASSERT_GT(hitRate, 0.9);
+
+    ASSERT_TRUE(iCartesianControl->stopControl());
+    runGcmp(&hitRate);
+    ASSERT_EQ(hitRate, 1.0);
+
+    // a new tool invalidates cached torques while the control loop runs
+    std::vector<double> xTool(6);
+    xTool[0] = 1;
+    ASSERT_TRUE(iCartesianControl->tool(xTool));
+    yarp::os::Time::delay(0.1);
+    ASSERT_TRUE(iCartesianControl->getParameter(VOCAB_CC_CONFIG_GCMP_HIT_RATE, &hitRate));
+    ASSERT_LT(hitRate, 1.0);
+    ASSERT_GT(hitRate, 0.9);
+
+    // a null tolerance disables the cache
+    ASSERT_TRUE(iCartesianControl->stopControl());
+    ASSERT_TRUE(iCartesianControl->setParameter(VOCAB_CC_CONFIG_GCMP_TOLERANCE, 0.0));
+    runGcmp(&hitRate);
+    ASSERT_EQ(hitRate, 0.0);
+
+    std::vector<double> x;
+    int state;
+    ASSERT_TRUE(iCartesianControl->stopControl());
+    ASSERT_TRUE(iCartesianControl->stat(x, &state));
+    ASSERT_EQ(state, VOCAB_CC_NOT_CONTROLLING);
+}
+
 }  // namespace roboticslab
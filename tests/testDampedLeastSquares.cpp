@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+
+#include <Eigen/Core>
+
+#include "DampedLeastSquares.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref DampedLeastSquares.
+ */
+class DampedLeastSquaresTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {}
+
+    virtual void TearDown()
+    {}
+
+protected:
+    static Eigen::MatrixXd makeJacobian(int rows, int cols)
+    {
+        Eigen::MatrixXd J(rows, cols);
+
+        for (int i = 0; i < rows; i++)
+        {
+            for (int j = 0; j < cols; j++)
+            {
+                J(i, j) = std::sin(1.3 * i + 0.7 * j + 0.1 * i * j);
+            }
+        }
+
+        return J;
+    }
+
+    static const double EPS;
+};
+
+const double DampedLeastSquaresTest::EPS = 1e-9;
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresSquare)
+{
+    DampedLeastSquares dls(1, 6);
+    ASSERT_TRUE(dls.setDamping(0.1, 1e-3));
+
+    Eigen::MatrixXd J = makeJacobian(6, 6);
+    Eigen::VectorXd xdot = Eigen::VectorXd::LinSpaced(6, -1.0, 1.0);
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(6), qdot(6);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_EQ(dls.getDamping(), 0.0);
+    ASSERT_TRUE((J * qdot).isApprox(xdot, EPS));
+}
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresNullSpace)
+{
+    DampedLeastSquares dls(1, 9);
+
+    Eigen::MatrixXd J = makeJacobian(6, 9);
+    Eigen::VectorXd xdot = Eigen::VectorXd::LinSpaced(6, -1.0, 1.0);
+    Eigen::VectorXd q = Eigen::VectorXd::Constant(9, 0.5), qdot(9), qdotPrimary(9);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdotPrimary));
+
+    //-- Secondary objectives must not disturb the primary task.
+    ASSERT_TRUE(dls.setJointLimitAvoidance(Eigen::VectorXd::Constant(9, -1.0), Eigen::VectorXd::Constant(9, 1.0), 1.0));
+    ASSERT_TRUE(dls.setPosture(Eigen::VectorXd::Zero(9), 2.0));
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+
+    ASSERT_TRUE((J * qdot).isApprox(xdot, EPS));
+    ASSERT_FALSE(qdot.isApprox(qdotPrimary, EPS));
+
+    //-- ...but should pull towards the middle of the range and the rest posture.
+    ASSERT_LT((q + 1e-3 * qdot).squaredNorm(), (q + 1e-3 * qdotPrimary).squaredNorm());
+}
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresSingular)
+{
+    DampedLeastSquares dls(1, 6);
+    ASSERT_TRUE(dls.setDamping(0.1, 0.05));
+
+    //-- Rank 5: last two columns are equal.
+    Eigen::MatrixXd J = makeJacobian(6, 6);
+    J.col(5) = J.col(4);
+
+    Eigen::VectorXd xdot = Eigen::VectorXd::LinSpaced(6, -1.0, 1.0);
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(6), qdot(6);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_NEAR(dls.getDamping(), 0.1, EPS);
+    ASSERT_TRUE(qdot.allFinite());
+    ASSERT_LT(qdot.norm(), 100.0);
+}
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresZeroTaskWeights)
+{
+    DampedLeastSquares dls(1, 6);
+    ASSERT_TRUE(dls.setDamping(0.1, 0.05));
+
+    //-- Position only, orientation rows drop out of the weighted Jacobian.
+    Eigen::VectorXd weights(6);
+    weights << 1, 1, 1, 0, 0, 0;
+    ASSERT_TRUE(dls.setTaskWeights(weights));
+
+    Eigen::MatrixXd J = makeJacobian(6, 6);
+    Eigen::VectorXd xdot = Eigen::VectorXd::LinSpaced(6, -1.0, 1.0);
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(6), qdot(6);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_EQ(dls.getDamping(), 0.0);
+    ASSERT_TRUE((J.topRows(3) * qdot).isApprox(xdot.head(3), EPS));
+
+    //-- Nothing left to track.
+    ASSERT_TRUE(dls.setTaskWeights(Eigen::VectorXd::Zero(6)));
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_EQ(dls.getDamping(), 0.0);
+    ASSERT_TRUE(qdot.isZero());
+}
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresFixedRows)
+{
+    DampedLeastSquares dls(1, 4);
+
+    //-- Same layout as KDL::Jacobian, bound without a copy.
+    Eigen::Matrix<double, 6, Eigen::Dynamic> J = makeJacobian(6, 4);
+    Eigen::VectorXd xdot = Eigen::VectorXd::LinSpaced(6, -1.0, 1.0);
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(4), qdot(4), qdotExpected(4);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_TRUE(dls.solve(Eigen::MatrixXd(J), xdot, q, qdotExpected));
+    ASSERT_TRUE(qdot.isApprox(qdotExpected, EPS));
+}
+
+TEST_F(DampedLeastSquaresTest, DampedLeastSquaresWeights)
+{
+    //-- Two tasks compete for a single joint.
+    DampedLeastSquares dls(2, 1);
+    Eigen::MatrixXd J = Eigen::MatrixXd::Zero(12, 1);
+    J(0, 0) = J(6, 0) = 1.0;
+
+    Eigen::VectorXd xdot = Eigen::VectorXd::Zero(12);
+    xdot(0) = 1.0;
+    xdot(6) = -1.0;
+
+    Eigen::VectorXd q = Eigen::VectorXd::Zero(1), qdot(1);
+
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_NEAR(qdot(0), 0.0, EPS);
+
+    Eigen::VectorXd weights = Eigen::VectorXd::Ones(12);
+    weights(0) = 3.0;
+
+    ASSERT_TRUE(dls.setTaskWeights(weights));
+    ASSERT_TRUE(dls.solve(J, xdot, q, qdot));
+    ASSERT_NEAR(qdot(0), 0.5, EPS);
+
+    ASSERT_FALSE(dls.setTaskWeights(Eigen::VectorXd::Ones(7)));
+    ASSERT_FALSE(dls.setJointWeights(Eigen::VectorXd::Zero(1)));
+}
+
+}  // namespace roboticslab
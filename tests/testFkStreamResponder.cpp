@@ -0,0 +1,165 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <yarp/os/Bottle.h>
+
+#include "CartesianControlClient.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref FkStreamResponder.
+ */
+class FkStreamResponderTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+protected:
+    FkStreamResponder responder;
+
+    static yarp::os::Bottle makeMessage(int state, double value, int size = DEFAULT_FK_STREAM_POSE_SIZE)
+    {
+        yarp::os::Bottle b;
+        b.addVocab(state);
+
+        for (int i = 0; i < size; i++)
+        {
+            b.addFloat64(value);
+        }
+
+        b.addFloat64(value); // timestamp
+        return b;
+    }
+
+    static const int ITERATIONS;
+    static const int READERS;
+};
+
+const int FkStreamResponderTest::ITERATIONS = 200000;
+const int FkStreamResponderTest::READERS = 4;
+
+TEST_F(FkStreamResponderTest, FkStreamResponderReadWrite)
+{
+    std::vector<double> x;
+    int state;
+    double timestamp;
+
+    yarp::os::Bottle b = makeMessage(VOCAB_CC_MOVL_CONTROLLING, 1.5);
+    responder.onRead(b);
+
+    ASSERT_TRUE(responder.getLastStatData(x, &state, &timestamp, 10.0));
+    ASSERT_EQ(x.size(), DEFAULT_FK_STREAM_POSE_SIZE);
+    ASSERT_EQ(x[0], 1.5);
+    ASSERT_EQ(state, VOCAB_CC_MOVL_CONTROLLING);
+    ASSERT_EQ(timestamp, 1.5);
+
+    //-- Oversized messages are discarded, last valid data is kept
+    yarp::os::Bottle big = makeMessage(VOCAB_CC_NOT_CONTROLLING, 2.5);
+    big.addFloat64(2.5);
+    responder.onRead(big);
+
+    ASSERT_TRUE(responder.getLastStatData(x, &state, &timestamp, 10.0));
+    ASSERT_EQ(x[0], 1.5);
+    ASSERT_EQ(state, VOCAB_CC_MOVL_CONTROLLING);
+}
+
+TEST_F(FkStreamResponderTest, FkStreamResponderTreePose)
+{
+    //-- Two endpoints of a tree, six values each
+    const int treePoseSize = 2 * DEFAULT_FK_STREAM_POSE_SIZE;
+    responder.setPoseSize(treePoseSize);
+
+    std::vector<double> x;
+    int state;
+    double timestamp;
+
+    yarp::os::Bottle b = makeMessage(VOCAB_CC_MOVL_CONTROLLING, 1.5, treePoseSize);
+    responder.onRead(b);
+
+    ASSERT_TRUE(responder.getLastStatData(x, &state, &timestamp, 10.0));
+    ASSERT_EQ(x.size(), treePoseSize);
+    ASSERT_EQ(x[treePoseSize - 1], 1.5);
+    ASSERT_EQ(state, VOCAB_CC_MOVL_CONTROLLING);
+    ASSERT_EQ(timestamp, 1.5);
+
+    //-- Smaller poses still fit
+    yarp::os::Bottle small = makeMessage(VOCAB_CC_NOT_CONTROLLING, 2.5);
+    responder.onRead(small);
+
+    ASSERT_TRUE(responder.getLastStatData(x, &state, &timestamp, 10.0));
+    ASSERT_EQ(x.size(), DEFAULT_FK_STREAM_POSE_SIZE);
+    ASSERT_EQ(x[0], 2.5);
+    ASSERT_EQ(state, VOCAB_CC_NOT_CONTROLLING);
+
+    //-- Beyond the configured size, discarded
+    yarp::os::Bottle big = makeMessage(VOCAB_CC_MOVL_CONTROLLING, 3.5, treePoseSize + 1);
+    responder.onRead(big);
+
+    ASSERT_TRUE(responder.getLastStatData(x, &state, &timestamp, 10.0));
+    ASSERT_EQ(x.size(), DEFAULT_FK_STREAM_POSE_SIZE);
+    ASSERT_EQ(x[0], 2.5);
+}
+
+TEST_F(FkStreamResponderTest, FkStreamResponderNoTornReads)
+{
+    std::atomic<bool> done(false);
+    std::atomic<int> torn(0);
+    std::vector<std::thread> readers;
+
+    yarp::os::Bottle b = makeMessage(VOCAB_CC_NOT_CONTROLLING, 0.0);
+    responder.onRead(b);
+
+    for (int r = 0; r < READERS; r++)
+    {
+        readers.emplace_back([this, &done, &torn]
+        {
+            std::vector<double> x;
+            int state;
+            double timestamp;
+
+            while (!done)
+            {
+                responder.getLastStatData(x, &state, &timestamp, 10.0);
+
+                //-- Every message carries the same value in all fields
+                for (size_t i = 0; i < x.size(); i++)
+                {
+                    if (x[i] != timestamp || state != (static_cast<int>(timestamp) % 2 == 0 ? VOCAB_CC_NOT_CONTROLLING : VOCAB_CC_MOVL_CONTROLLING))
+                    {
+                        torn++;
+                        break;
+                    }
+                }
+            }
+        });
+    }
+
+    for (int i = 1; i <= ITERATIONS; i++)
+    {
+        yarp::os::Bottle b = makeMessage(i % 2 == 0 ? VOCAB_CC_NOT_CONTROLLING : VOCAB_CC_MOVL_CONTROLLING, i);
+        responder.onRead(b);
+    }
+
+    done = true;
+
+    for (size_t r = 0; r < readers.size(); r++)
+    {
+        readers[r].join();
+    }
+
+    ASSERT_EQ(torn, 0);
+}
+
+}  // namespace roboticslab
@@ -1,6 +1,11 @@
 #include "gtest/gtest.h"
 
+#include <cerrno>
 #include <cmath>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <string>
 #include <vector>
 
 #include <yarp/os/all.h>
@@ -9,6 +14,117 @@
 
 #include "ICartesianSolver.h"
 
+namespace
+{
+    std::atomic<bool> countAllocations(false);
+    std::atomic<int> allocations(0);
+}
+
+#if defined(__GLIBC__)
+
+//-- Count heap allocations performed while enabled. The C allocator is interposed since it sits
+//-- below operator new, Eigen's aligned_malloc and the KdlSolver plugin itself.
+extern "C"
+{
+    void * __libc_malloc(std::size_t size);
+    void * __libc_calloc(std::size_t n, std::size_t size);
+    void * __libc_realloc(void * ptr, std::size_t size);
+    void * __libc_memalign(std::size_t alignment, std::size_t size);
+
+    void * malloc(std::size_t size)
+    {
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        return __libc_malloc(size);
+    }
+
+    void * calloc(std::size_t n, std::size_t size)
+    {
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        return __libc_calloc(n, size);
+    }
+
+    void * realloc(void * ptr, std::size_t size)
+    {
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        return __libc_realloc(ptr, size);
+    }
+
+    void * memalign(std::size_t alignment, std::size_t size)
+    {
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        return __libc_memalign(alignment, size);
+    }
+
+    void * aligned_alloc(std::size_t alignment, std::size_t size)
+    {
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void ** ptr, std::size_t alignment, std::size_t size)
+    {
+        if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+        {
+            return EINVAL;
+        }
+
+        if (countAllocations)
+        {
+            allocations++;
+        }
+
+        *ptr = __libc_memalign(alignment, size);
+        return *ptr != NULL ? 0 : ENOMEM;
+    }
+}
+
+#else
+
+//-- Count heap allocations performed while enabled, the array forms forward here.
+void * operator new(std::size_t size)
+{
+    if (countAllocations)
+    {
+        allocations++;
+    }
+
+    void * ptr = std::malloc(size != 0 ? size : 1);
+
+    if (ptr == NULL)
+    {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+#endif
+
 namespace roboticslab
 {
 
@@ -98,6 +214,103 @@ TEST_F( KdlSolverTest, KdlSolverInvKin2)
     ASSERT_NEAR(q[0], 90, 1e-3);
 }
 
+TEST_F( KdlSolverTest, KdlSolverInvKinIdDls)
+{
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (25)) (ik id) (idStep dls)");
+    yarp::dev::PolyDriver idSolverDevice(solverOptions);
+    ICartesianSolver * idCartesianSolver;
+
+    ASSERT_TRUE(idSolverDevice.isValid());
+    ASSERT_TRUE(idSolverDevice.view(idCartesianSolver));
+
+    std::vector<double> xd, q(1), qGuess(1);
+    q[0] = 20;
+    ASSERT_TRUE(idCartesianSolver->fwdKin(q, xd));
+
+    //-- Reachable target, repeated single steps converge.
+    qGuess[0] = 10;
+
+    for (int i = 0; i < 20; i++)
+    {
+        ASSERT_TRUE(idCartesianSolver->invKin(xd, qGuess, q));
+        qGuess = q;
+    }
+
+    ASSERT_NEAR(q[0], 20, 1e-3);
+
+    //-- Target beyond the upper limit, approached but never crossed.
+    q[0] = 30;
+    ASSERT_TRUE(idCartesianSolver->fwdKin(q, xd));
+
+    for (int i = 0; i < 20; i++)
+    {
+        ASSERT_TRUE(idCartesianSolver->invKin(xd, qGuess, q));
+        ASSERT_LE(q[0], 25 + 1e-9);
+        qGuess = q;
+    }
+
+    ASSERT_NEAR(q[0], 25, 1e-3);
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinMultiStart)
+{
+    yarp::os::Property solverOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ik nrjl) (seeds 4) (workers 3)");
+    yarp::dev::PolyDriver multiStartSolverDevice(solverOptions);
+    ICartesianSolver * multiStartCartesianSolver;
+
+    ASSERT_TRUE(multiStartSolverDevice.isValid());
+    ASSERT_TRUE(multiStartSolverDevice.view(multiStartCartesianSolver));
+
+    std::vector<double> xd, q(1), qGuess(1);
+
+    for (int i = 0; i < 10; i++)
+    {
+        q[0] = -150 + 30 * i;
+        qGuess[0] = 170 - 35 * i;
+        ASSERT_TRUE(multiStartCartesianSolver->fwdKin(q, xd));
+        ASSERT_TRUE(multiStartCartesianSolver->invKin(xd, qGuess, q));
+        ASSERT_EQ(q.size(), 1);
+        ASSERT_NEAR(q[0], -150 + 30 * i, 1e-3);
+    }
+}
+
+TEST_F( KdlSolverTest, KdlSolverInvKinMultiStartFallback)
+{
+    //-- From 170 degrees, the shortest way to -170 degrees runs into the upper limit; the caller's guess
+    //-- alone never converges, other seeds must take over. Repeated with per-seed DLS velocity solvers.
+    const std::string ikVels[] = {"pinv", "dls"};
+
+    for (const auto & ikVel : ikVels)
+    {
+        yarp::os::Property singleOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ik nrjl)");
+        singleOptions.put("ikVel", ikVel);
+        yarp::dev::PolyDriver singleSolverDevice(singleOptions);
+        ICartesianSolver * singleCartesianSolver;
+
+        ASSERT_TRUE(singleSolverDevice.isValid());
+        ASSERT_TRUE(singleSolverDevice.view(singleCartesianSolver));
+
+        yarp::os::Property multiStartOptions("(device KdlSolver) (numLinks 1) (link_0 (A 1)) (mins (-180)) (maxs (180)) (ik nrjl) (seeds 8) (workers 2)");
+        multiStartOptions.put("ikVel", ikVel);
+        yarp::dev::PolyDriver multiStartSolverDevice(multiStartOptions);
+        ICartesianSolver * multiStartCartesianSolver;
+
+        ASSERT_TRUE(multiStartSolverDevice.isValid());
+        ASSERT_TRUE(multiStartSolverDevice.view(multiStartCartesianSolver));
+
+        std::vector<double> xd, q(1), qGuess(1);
+        q[0] = -170;
+        qGuess[0] = 170;
+        ASSERT_TRUE(singleCartesianSolver->fwdKin(q, xd));
+
+        ASSERT_FALSE(singleCartesianSolver->invKin(xd, qGuess, q));
+
+        ASSERT_TRUE(multiStartCartesianSolver->invKin(xd, qGuess, q));
+        ASSERT_EQ(q.size(), 1);
+        ASSERT_NEAR(q[0], -170, 1e-3);
+    }
+}
+
 TEST_F( KdlSolverTest, KdlSolverInvDyn1)
 {
     std::vector<double> q(1),t;
@@ -127,5 +340,73 @@ TEST_F( KdlSolverTest, KdlSolverInvDyn3)
     ASSERT_NEAR(t[0], 5, 1e-9);  //-- T = F*d = 1kg * 10m/s^2 * 0.5m = 5 N*m
 }
 
+TEST_F( KdlSolverTest, KdlSolverInvDynBuffers)
+{
+    double q[1] = {0.0}, qdot[1] = {0.0}, qdotdot[1] = {0.0}, t[1] = {0.0};
+    double fexts[6] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+
+    ASSERT_TRUE(iCartesianSolver->invDyn(q, qdot, qdotdot, fexts, 1, t));  //-- warm up
+
+    allocations = 0;
+    countAllocations = true;
+
+    bool ok1 = iCartesianSolver->invDyn(q, NULL, NULL, NULL, 0, t);
+    double t1 = t[0];
+    bool ok2 = iCartesianSolver->invDyn(q, qdot, qdotdot, fexts, 1, t);
+
+    countAllocations = false;
+
+    ASSERT_TRUE(ok1);
+    ASSERT_TRUE(ok2);
+    ASSERT_EQ(allocations, 0);
+    ASSERT_NEAR(t1, 5, 1e-9);  //-- T = F*d = 1kg * 10m/s^2 * 0.5m = 5 N*m
+    ASSERT_NEAR(t[0], 5, 1e-9);
+}
+
+TEST_F( KdlSolverTest, KdlSolverMassMatrix)
+{
+    std::vector<double> q(1),M;
+    q[0] = 30.0;
+    ASSERT_TRUE(iCartesianSolver->massMatrix(q,M));
+    ASSERT_EQ(M.size(), 1 );
+    ASSERT_NEAR(M[0], 1.25, 1e-9);  //-- I = Izz + m*d^2 = 1 + 1kg * (0.5m)^2 = 1.25 kg*m^2
+}
+
+TEST_F( KdlSolverTest, KdlSolverJacobian)
+{
+    double q[1] = {90.0}, x[6], J[6];
+    ASSERT_TRUE(iCartesianSolver->jacobian(q,x,J));
+    ASSERT_NEAR(x[0], 0, 1e-9);
+    ASSERT_NEAR(x[1], 1, 1e-9);
+    ASSERT_NEAR(x[5], M_PI / 2, 1e-9);
+    ASSERT_NEAR(J[0], -1, 1e-9);  //-- v = w x r = (0 0 1) x (0 1 0)
+    ASSERT_NEAR(J[1], 0, 1e-9);
+    ASSERT_NEAR(J[2], 0, 1e-9);
+    ASSERT_NEAR(J[3], 0, 1e-9);
+    ASSERT_NEAR(J[4], 0, 1e-9);
+    ASSERT_NEAR(J[5], 1, 1e-9);
+}
+
+TEST_F( KdlSolverTest, KdlSolverCoriolisTorques)
+{
+    std::vector<double> q(1),qdot(1),c;
+    q[0] = 30.0;
+    qdot[0] = 90.0;
+    ASSERT_TRUE(iCartesianSolver->coriolisTorques(q,qdot,c));
+    ASSERT_EQ(c.size(), 1 );
+    ASSERT_NEAR(c[0], 0, 1e-9);  //-- no Coriolis nor centrifugal effects on a single revolute joint
+}
+
+TEST_F( KdlSolverTest, KdlSolverFwdDyn)
+{
+    std::vector<double> q(1),qdot(1),t(1),qdotdot;
+    q[0] = 0.0;
+    qdot[0] = 90.0;
+    t[0] = 7.5;
+    ASSERT_TRUE(iCartesianSolver->fwdDyn(q,qdot,t,qdotdot));
+    ASSERT_EQ(qdotdot.size(), 1 );
+    ASSERT_NEAR(qdotdot[0], 2 * 180 / M_PI, 1e-6);  //-- qdotdot = (T - m*g*d) / I = (7.5 - 5) / 1.25 = 2 rad/s^2
+}
+
 }  // namespace roboticslab
 
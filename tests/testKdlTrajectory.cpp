@@ -194,6 +194,414 @@ TEST_F(KdlTrajectoryTest, KdlTrajectoryLineRectNoDuration)
     ASSERT_TRUE(iCartesianTrajectory->destroy());
 }
 
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTrapSampled)
+{
+    const double period = 0.05;
+
+    //-- Create reference and pre-sampled line trajectories
+    KdlTrajectory sampled;
+    ASSERT_TRUE(sampled.setSamplingPeriod(period));
+
+    ICartesianTrajectory * trajectories[] = {iCartesianTrajectory, &sampled};
+
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(trajectories[i]->setMaxVelocity(MAX_VEL));
+        ASSERT_TRUE(trajectories[i]->setMaxAcceleration(MAX_ACC));
+        ASSERT_TRUE(trajectories[i]->addWaypoint(x1));
+        ASSERT_TRUE(trajectories[i]->addWaypoint(x2));
+        ASSERT_TRUE(trajectories[i]->configurePath(ICartesianTrajectory::LINE));
+        ASSERT_TRUE(trajectories[i]->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL));
+        ASSERT_TRUE(trajectories[i]->create());
+    }
+
+    double duration;
+    ASSERT_TRUE(sampled.getDuration(&duration));
+
+    //-- Compare off-grid, interpolation error is bounded by acc*period^2/8
+    std::vector<double> expected, actual;
+
+    for (double t = -0.1; t < duration + 0.1; t += 0.0137)
+    {
+        ASSERT_TRUE(iCartesianTrajectory->getPosition(t, expected));
+        ASSERT_TRUE(sampled.getPosition(t, actual));
+        ASSERT_NEAR(actual[0], expected[0], MAX_ACC * period * period / 8 + EPS);
+
+        ASSERT_TRUE(iCartesianTrajectory->getVelocity(t, expected));
+        ASSERT_TRUE(sampled.getVelocity(t, actual));
+        ASSERT_NEAR(actual[0], expected[0], MAX_ACC * period + EPS);
+
+        ASSERT_TRUE(sampled.getAcceleration(t, actual));
+    }
+
+    //-- Destroy lines
+    ASSERT_TRUE(sampled.destroy());
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTrapSampledAcrossPi)
+{
+    const double period = 0.05;
+
+    //-- Rotate 20 degrees about z through pi, scaled axis-angle flips sign halfway
+    std::vector<double> xPi1(x1), xPi2(x2);
+    xPi1[5] = 170 * M_PI / 180;
+    xPi2[5] = -170 * M_PI / 180;
+
+    KdlTrajectory sampled;
+    ASSERT_TRUE(sampled.setSamplingPeriod(period));
+
+    ICartesianTrajectory * trajectories[] = {iCartesianTrajectory, &sampled};
+
+    for (int i = 0; i < 2; i++)
+    {
+        ASSERT_TRUE(trajectories[i]->setMaxVelocity(MAX_VEL));
+        ASSERT_TRUE(trajectories[i]->setMaxAcceleration(MAX_ACC));
+        ASSERT_TRUE(trajectories[i]->addWaypoint(xPi1));
+        ASSERT_TRUE(trajectories[i]->addWaypoint(xPi2));
+        ASSERT_TRUE(trajectories[i]->configurePath(ICartesianTrajectory::LINE));
+        ASSERT_TRUE(trajectories[i]->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL));
+        ASSERT_TRUE(trajectories[i]->create());
+    }
+
+    double duration;
+    ASSERT_TRUE(sampled.getDuration(&duration));
+    ASSERT_EQ(sampled.getSampleTableBytes(), (std::ceil(duration / period) + 1) * 19 * sizeof(double));
+
+    //-- Orientation must stay close to the reference, modulo the 2*pi wrap at the boundary
+    std::vector<double> expected, actual;
+
+    for (double t = -0.1; t < duration + 0.1; t += 0.0137)
+    {
+        ASSERT_TRUE(iCartesianTrajectory->getPosition(t, expected));
+        ASSERT_TRUE(sampled.getPosition(t, actual));
+        ASSERT_NEAR(actual[0], expected[0], MAX_ACC * period * period / 8 + EPS);
+        ASSERT_NEAR(actual[3], 0.0, EPS);
+        ASSERT_NEAR(actual[4], 0.0, EPS);
+        ASSERT_NEAR(std::remainder(actual[5] - expected[5], 2 * M_PI), 0.0, 1e-3);
+    }
+
+    //-- Destroy lines
+    ASSERT_TRUE(sampled.destroy());
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTrapState)
+{
+    //-- Create line trajectory
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+
+    //-- Joint evaluation matches separate queries
+    double state[ICartesianTrajectory::STATE_SIZE];
+    std::vector<double> position, velocity, acceleration;
+
+    for (double t = -0.1; t < duration + 0.1; t += 0.0137)
+    {
+        ASSERT_TRUE(iCartesianTrajectory->getState(t, state));
+        ASSERT_TRUE(iCartesianTrajectory->getPosition(t, position));
+        ASSERT_TRUE(iCartesianTrajectory->getVelocity(t, velocity));
+        ASSERT_TRUE(iCartesianTrajectory->getAcceleration(t, acceleration));
+
+        for (int i = 0; i < 6; i++)
+        {
+            ASSERT_NEAR(state[i], position[i], EPS);
+            ASSERT_NEAR(state[6 + i], velocity[i], EPS);
+            ASSERT_NEAR(state[12 + i], acceleration[i], EPS);
+        }
+    }
+
+    //-- Destroy line
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineRectState)
+{
+    //-- Create line trajectory, rectangular profile lacks acceleration
+    ASSERT_TRUE(iCartesianTrajectory->setDuration(DURATION));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::RECTANGULAR));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    double state[ICartesianTrajectory::STATE_SIZE];
+    ASSERT_TRUE(iCartesianTrajectory->getState(DURATION / 2, state));
+    ASSERT_NEAR(state[0], 1.5, EPS);
+    ASSERT_NEAR(state[6], 1.0 / DURATION, EPS);
+    ASSERT_NEAR(state[12], 0.0, EPS);
+
+    //-- Destroy line
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTimeOptimal)
+{
+    const int samples = 101;
+
+    //-- Create line trajectory, path speed limits are not active
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE));
+
+    KdlTrajectory * kdlTrajectory = static_cast<KdlTrajectory *>(iCartesianTrajectory);
+
+    std::vector< std::vector<double> > positions, tangents;
+    ASSERT_TRUE(kdlTrajectory->getPathSamples(samples, positions, tangents));
+    ASSERT_EQ(static_cast<int>(positions.size()), samples);
+    ASSERT_NEAR(positions[50][0], 1.5, EPS);
+    ASSERT_NEAR(tangents[50][0], 1.0, EPS);
+
+    ASSERT_TRUE(kdlTrajectory->setPathSpeedLimits(std::vector<double>(samples, 1.0)));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TIME_OPTIMAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    //-- Same as the trapezoidal profile
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, 9.0, EPS);
+
+    std::vector<double> position, velocity;
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(4.0, position));
+    ASSERT_NEAR(position[0], 1.4, EPS);
+    ASSERT_TRUE(iCartesianTrajectory->getVelocity(4.5, velocity));
+    ASSERT_NEAR(velocity[0], MAX_VEL, EPS);
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x2[0], EPS);
+
+    //-- Destroy line
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTimeOptimalMinSamples)
+{
+    //-- Two grid points leave no room to move, both ends are at rest
+    KdlTrajectory * kdlTrajectory = static_cast<KdlTrajectory *>(iCartesianTrajectory);
+    ASSERT_FALSE(kdlTrajectory->setPathSpeedLimits(std::vector<double>(2, 1.0)));
+    ASSERT_TRUE(kdlTrajectory->setPathSpeedLimits(std::vector<double>(3, 1.0)));
+
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TIME_OPTIMAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    //-- Coarse, yet the target is reached in finite time
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_GT(duration, 0.0);
+
+    std::vector<double> position;
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x2[0], EPS);
+
+    //-- Destroy line
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryLineTimeOptimalSlowdown)
+{
+    const int samples = 101;
+    const double slow = 0.1;
+
+    std::vector<double> limits(samples, 1.0);
+    limits[samples / 2] = slow;
+
+    //-- Create line trajectory, slow down halfway
+    KdlTrajectory * kdlTrajectory = static_cast<KdlTrajectory *>(iCartesianTrajectory);
+    ASSERT_FALSE(kdlTrajectory->setPathSpeedLimits(std::vector<double>(samples, 0.0)));
+    ASSERT_TRUE(kdlTrajectory->setPathSpeedLimits(limits));
+
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::LINE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TIME_OPTIMAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    //-- Slower than the trapezoidal profile
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_GT(duration, 9.0);
+
+    //-- Speed never exceeds what allows braking down to the limit halfway
+    std::vector<double> position, velocity, acceleration;
+
+    for (double t = 0.0; t <= duration; t += 0.01)
+    {
+        ASSERT_TRUE(iCartesianTrajectory->getPosition(t, position));
+        ASSERT_TRUE(iCartesianTrajectory->getVelocity(t, velocity));
+        ASSERT_TRUE(iCartesianTrajectory->getAcceleration(t, acceleration));
+        double reach = slow * slow + 2 * MAX_ACC * std::abs(position[0] - 1.5);
+        ASSERT_LE(velocity[0] * velocity[0], reach + EPS);
+        ASSERT_LE(std::abs(acceleration[0]), MAX_ACC + EPS);
+    }
+
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x2[0], EPS);
+
+    //-- Destroy line
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryRoundedCompositeRect)
+{
+    const double radius = 0.1;
+
+    std::vector<double> x3(x2);
+    x3[1] = 1.0;
+
+    //-- Create rounded composite trajectory, 90 degree corner at x2
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->setBlendRadius(radius));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x3));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::RECTANGULAR));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    //-- Query duration: two shortened segments plus a quarter circle
+    const double length = 2 * (1.0 - radius) + radius * M_PI / 2;
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, length / MAX_VEL, EPS);
+
+    //-- Use path
+    double movementTime;
+    std::vector<double> position, velocity;
+
+    // middle of the blend, speed is kept
+    movementTime = (1.0 - radius + radius * M_PI / 4) / MAX_VEL;
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(movementTime, position));
+    ASSERT_NEAR(position[0], x2[0] - radius + radius * std::cos(M_PI / 4), 1e-6);
+    ASSERT_NEAR(position[1], radius - radius * std::sin(M_PI / 4), 1e-6);
+    ASSERT_TRUE(iCartesianTrajectory->getVelocity(movementTime, velocity));
+    ASSERT_NEAR(std::sqrt(velocity[0] * velocity[0] + velocity[1] * velocity[1]), MAX_VEL, 1e-6);
+
+    // end
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x3[0], EPS);
+    ASSERT_NEAR(position[1], x3[1], EPS);
+
+    //-- Destroy path
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryRoundedCompositeStationary)
+{
+    //-- Repeated waypoints at both ends, zero-length segments are holds
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::RECTANGULAR));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, (x2[0] - x1[0]) / MAX_VEL, EPS);
+
+    std::vector<double> position;
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x2[0], EPS);
+
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+
+    //-- Every waypoint coincides, hold the pose
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, 0.0, EPS);
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(0.0, position));
+    ASSERT_NEAR(position[0], x1[0], EPS);
+
+    //-- Destroy path
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryRoundedCompositeReorientation)
+{
+    std::vector<double> x2Rotated(x2), x3(x2);
+    x2Rotated[5] = M_PI / 2;
+    x3[1] = 1.0;
+
+    //-- Pure reorientation at a via point, would need to stop there
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2Rotated));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x3));
+    ASSERT_FALSE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+
+    //-- Reorientation alone is a plain segment
+    ASSERT_TRUE(iCartesianTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2Rotated));
+    ASSERT_TRUE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+    ASSERT_TRUE(iCartesianTrajectory->configureVelocityProfile(ICartesianTrajectory::TRAPEZOIDAL));
+    ASSERT_TRUE(iCartesianTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iCartesianTrajectory->getDuration(&duration));
+
+    std::vector<double> position;
+    ASSERT_TRUE(iCartesianTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], x2[0], EPS);
+    ASSERT_NEAR(position[5], M_PI / 2, EPS);
+
+    //-- Destroy path
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryRoundedCompositeReversal)
+{
+    //-- Back to the start through x2, would need to stop there
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_FALSE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+
+    //-- Destroy path
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
+TEST_F(KdlTrajectoryTest, KdlTrajectoryRoundedCompositeRadiusTooBig)
+{
+    std::vector<double> x3(x2);
+    x3[1] = 1.0;
+
+    //-- Blend would not fit into the first segment
+    ASSERT_TRUE(iCartesianTrajectory->setBlendRadius(2.0));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x1));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x2));
+    ASSERT_TRUE(iCartesianTrajectory->addWaypoint(x3));
+    ASSERT_FALSE(iCartesianTrajectory->configurePath(ICartesianTrajectory::ROUNDED_COMPOSITE));
+
+    //-- Destroy path
+    ASSERT_TRUE(iCartesianTrajectory->destroy());
+}
+
 TEST_F(KdlTrajectoryTest, KdlTrajectoryLineRectInitialTwist)
 {
     //-- Create line trajectory
@@ -0,0 +1,134 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "OnlineTrajectoryGenerator.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref OnlineTrajectoryGenerator.
+ */
+class OnlineTrajectoryGeneratorTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        std::vector<double> maxVelocity(2, MAX_VEL);
+        ASSERT_TRUE(generator.configure(PERIOD, maxVelocity, MAX_ACC, MAX_JERK));
+        generator.reset(std::vector<double>(2, 0.0));
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+protected:
+    OnlineTrajectoryGenerator generator;
+
+    //-- Run until done, check limits on every cycle
+    int run(int maxSteps, const std::vector<double>& initialVelocity = std::vector<double>(2, 0.0))
+    {
+        std::vector<double> position, velocity;
+        std::vector<double> prevVelocity(initialVelocity), prevAcceleration(2, 0.0);
+
+        for (int k = 0; k < maxSteps; k++)
+        {
+            generator.step(position, velocity);
+
+            for (int i = 0; i < 2; i++)
+            {
+                double acceleration = (velocity[i] - prevVelocity[i]) / PERIOD;
+                double jerk = (acceleration - prevAcceleration[i]) / PERIOD;
+
+                EXPECT_LE(std::abs(velocity[i]), MAX_VEL + EPS);
+                EXPECT_LE(std::abs(acceleration), MAX_ACC + EPS);
+                EXPECT_LE(std::abs(jerk), MAX_JERK + EPS);
+
+                prevVelocity[i] = velocity[i];
+                prevAcceleration[i] = acceleration;
+            }
+
+            if (generator.isDone())
+            {
+                return k + 1;
+            }
+        }
+
+        return -1;
+    }
+
+    static const double PERIOD;
+    static const double MAX_VEL;
+    static const double MAX_ACC;
+    static const double MAX_JERK;
+
+    static const double EPS;
+};
+
+const double OnlineTrajectoryGeneratorTest::PERIOD = 0.05;
+const double OnlineTrajectoryGeneratorTest::MAX_VEL = 30.0;
+const double OnlineTrajectoryGeneratorTest::MAX_ACC = 100.0;
+const double OnlineTrajectoryGeneratorTest::MAX_JERK = 1000.0;
+
+const double OnlineTrajectoryGeneratorTest::EPS = 1e-6;
+
+TEST_F(OnlineTrajectoryGeneratorTest, OnlineTrajectoryGeneratorReachTarget)
+{
+    std::vector<double> target(2);
+    target[0] = 90.0;
+    target[1] = -1.0;
+
+    ASSERT_TRUE(generator.setTarget(target));
+    ASSERT_GT(run(1000), 0);
+
+    std::vector<double> position, velocity;
+    generator.step(position, velocity);
+    ASSERT_EQ(position, target);
+    ASSERT_EQ(velocity, std::vector<double>(2, 0.0));
+}
+
+TEST_F(OnlineTrajectoryGeneratorTest, OnlineTrajectoryGeneratorNoOvershoot)
+{
+    std::vector<double> target(2, 10.0), position, velocity;
+    ASSERT_TRUE(generator.setTarget(target));
+
+    for (int k = 0; k < 1000 && !generator.isDone(); k++)
+    {
+        generator.step(position, velocity);
+        ASSERT_LE(position[0], target[0] + EPS);
+        ASSERT_GE(velocity[0], -EPS);
+    }
+
+    ASSERT_TRUE(generator.isDone());
+}
+
+TEST_F(OnlineTrajectoryGeneratorTest, OnlineTrajectoryGeneratorChangeTarget)
+{
+    std::vector<double> target(2, 90.0), position, velocity;
+    ASSERT_TRUE(generator.setTarget(target));
+
+    for (int k = 0; k < 20; k++)
+    {
+        generator.step(position, velocity);
+    }
+
+    //-- Reverse while moving at full speed
+    ASSERT_NEAR(velocity[0], MAX_VEL, EPS);
+    target[0] = target[1] = -10.0;
+    ASSERT_TRUE(generator.setTarget(target));
+    ASSERT_GT(run(1000, velocity), 0);
+
+    generator.step(position, velocity);
+    ASSERT_EQ(position, target);
+}
+
+TEST_F(OnlineTrajectoryGeneratorTest, OnlineTrajectoryGeneratorSizeMismatch)
+{
+    ASSERT_FALSE(generator.setTarget(std::vector<double>(3, 0.0)));
+}
+
+}  // namespace roboticslab
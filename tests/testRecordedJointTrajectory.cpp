@@ -0,0 +1,140 @@
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "RecordedJointTrajectory.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref RecordedJointTrajectory.
+ */
+class RecordedJointTrajectoryTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        recordedTrajectory = new RecordedJointTrajectory();
+
+        start.resize(2);
+        start[0] = 1.0;
+        start[1] = -1.0;
+
+        goal.resize(7, 0.0);
+        goal[0] = 0.5;
+
+        tool.resize(6, 0.0);
+        tool[2] = 0.1;
+    }
+
+    virtual void TearDown()
+    {
+        delete recordedTrajectory;
+        recordedTrajectory = 0;
+    }
+
+protected:
+    void record(RecordedJointTrajectory * trajectory)
+    {
+        //-- Joint 0 goes 1 -> 3 at 1 unit/s, joint 1 stays
+        ASSERT_TRUE(trajectory->setPeriod(PERIOD));
+
+        for (int i = 0; i <= 4; i++)
+        {
+            std::vector<double> sample(2);
+            sample[0] = start[0] + i * PERIOD;
+            sample[1] = start[1];
+            ASSERT_TRUE(trajectory->addWaypoint(sample));
+        }
+
+        trajectory->setKey(COMMAND, FRAME, start, goal, tool);
+        ASSERT_TRUE(trajectory->create());
+    }
+
+    RecordedJointTrajectory* recordedTrajectory;
+
+    std::vector<double> start, goal, tool;
+
+    static const int COMMAND;
+    static const int FRAME;
+    static const double PERIOD;
+    static const double EPS;
+};
+
+const int RecordedJointTrajectoryTest::COMMAND = 42;
+const int RecordedJointTrajectoryTest::FRAME = 1;
+const double RecordedJointTrajectoryTest::PERIOD = 0.5;
+const double RecordedJointTrajectoryTest::EPS = 1e-9;
+
+TEST_F(RecordedJointTrajectoryTest, RecordedJointTrajectoryReplay)
+{
+    record(recordedTrajectory);
+
+    double duration;
+    ASSERT_TRUE(recordedTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, 2.0, EPS);
+
+    double q[2], qdot[2], qdotdot[2];
+
+    //-- Interpolate between samples
+    ASSERT_TRUE(recordedTrajectory->getState(0.75, q, qdot, qdotdot));
+    ASSERT_NEAR(q[0], 1.75, EPS);
+    ASSERT_NEAR(q[1], -1.0, EPS);
+    ASSERT_NEAR(qdot[0], 1.0, EPS);
+    ASSERT_NEAR(qdot[1], 0.0, EPS);
+    ASSERT_NEAR(qdotdot[0], 0.0, EPS);
+
+    //-- Hold last sample at rest after the end
+    ASSERT_TRUE(recordedTrajectory->getState(5.0, q, qdot, NULL));
+    ASSERT_NEAR(q[0], 3.0, EPS);
+    ASSERT_NEAR(qdot[0], 0.0, EPS);
+
+    //-- Recordings are fixed
+    ASSERT_FALSE(recordedTrajectory->setDuration(1.0));
+    ASSERT_FALSE(recordedTrajectory->addWaypoint(start));
+}
+
+TEST_F(RecordedJointTrajectoryTest, RecordedJointTrajectorySaveLoad)
+{
+    record(recordedTrajectory);
+
+    std::string filename = testing::TempDir() + "testRecordedJointTrajectory.traj";
+    ASSERT_TRUE(recordedTrajectory->save(filename));
+
+    RecordedJointTrajectory loaded;
+    ASSERT_TRUE(loaded.load(filename));
+    std::remove(filename.c_str());
+
+    //-- Key survives, matching within tolerance
+    std::vector<double> nearStart(start);
+    nearStart[0] += 0.05;
+
+    ASSERT_TRUE(loaded.matches(COMMAND, FRAME, nearStart, goal, tool, 0.1, 1e-3));
+    ASSERT_FALSE(loaded.matches(COMMAND, FRAME, nearStart, goal, tool, 0.01, 1e-3));
+    ASSERT_FALSE(loaded.matches(COMMAND + 1, FRAME, start, goal, tool, 0.1, 1e-3));
+    ASSERT_FALSE(loaded.matches(COMMAND, FRAME, start, std::vector<double>(7, 0.0), tool, 0.1, 1e-3));
+
+    //-- Same numbers in another reference frame are another motion
+    ASSERT_FALSE(loaded.matches(COMMAND, FRAME + 1, start, goal, tool, 0.1, 1e-3));
+
+    //-- Same motion with another tool or none
+    ASSERT_FALSE(loaded.matches(COMMAND, FRAME, start, goal, std::vector<double>(6, 0.0), 0.1, 1e-3));
+    ASSERT_FALSE(loaded.matches(COMMAND, FRAME, start, goal, std::vector<double>(), 0.1, 1e-3));
+
+    //-- Samples survive in single precision
+    double duration;
+    ASSERT_TRUE(loaded.getDuration(&duration));
+    ASSERT_NEAR(duration, 2.0, EPS);
+
+    std::vector<double> q;
+    ASSERT_TRUE(loaded.getPosition(1.25, q));
+    ASSERT_EQ(q.size(), 2);
+    ASSERT_NEAR(q[0], 2.25, 1e-6);
+    ASSERT_NEAR(q[1], -1.0, 1e-6);
+}
+
+}  // namespace roboticslab
@@ -7,14 +7,21 @@
 
 #include <kdl/chain.hpp>
 #include <kdl/chainfksolverpos_recursive.hpp>
+#include <kdl/chainidsolver_recursive_newton_euler.hpp>
+#include <kdl/chainjnttojacsolver.hpp>
 #include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
 #include <kdl/jntarray.hpp>
 #include <kdl/joint.hpp>
+#include <kdl/rigidbodyinertia.hpp>
+#include <kdl/rotationalinertia.hpp>
+#include <kdl/segment.hpp>
 #include <kdl/utilities/utility.h>
 
 #include "ConfigurationSelector.hpp"
 #include "MatrixExponential.hpp"
 #include "ProductOfExponentials.hpp"
+#include "ScrewTheoryDynamics.hpp"
 #include "ScrewTheoryIkProblem.hpp"
 #include "ScrewTheoryIkSubproblems.hpp"
 
@@ -347,6 +354,78 @@ public:
         }
     }
 
+    static KDL::Chain addLinkInertias(const KDL::Chain & chain)
+    {
+        KDL::Chain chainWithInertias;
+
+        for (int i = 0; i < chain.getNrOfSegments(); i++)
+        {
+            const KDL::Segment & segment = chain.getSegment(i);
+            KDL::RotationalInertia I_c(0.1 + 0.01 * i, 0.2, 0.15, 0.001 * i, -0.002, 0.003);
+            KDL::RigidBodyInertia inertia(1.0 + 0.25 * i, KDL::Vector(0.01 * i, -0.02 * i, 0.05), I_c);
+            chainWithInertias.addSegment(KDL::Segment(segment.getJoint(), segment.getFrameToTip(), inertia));
+        }
+
+        return chainWithInertias;
+    }
+
+    static void checkRobotDynamics(const KDL::Chain & chain)
+    {
+        const KDL::Vector gravity(0, 0, -9.81);
+        const int n = chain.getNrOfJoints();
+
+        PoeExpression poe = PoeExpression::fromChain(chain);
+        ScrewTheoryDynamics dynamics(poe, gravity);
+        ASSERT_EQ(dynamics.size(), n);
+
+        KDL::ChainFkSolverPos_recursive fkSolver(chain);
+        KDL::ChainJntToJacSolver jacSolver(chain);
+        KDL::ChainIdSolver_RNE idSolver(chain, gravity);
+
+        KDL::JntArray q(n), qdot(n), qdotdot(n), t_DH(n), t_ST(n);
+
+        for (int i = 0; i < n; i++)
+        {
+            q(i) = 0.3 * (i + 1) - 1.0;
+            qdot(i) = 0.5 - 0.2 * i;
+            qdotdot(i) = 0.1 * i - 0.4;
+        }
+
+        KDL::Wrenches fexts_DH(chain.getNrOfSegments(), KDL::Wrench::Zero());
+        KDL::Frame H_S_T_q_DH, H_S_T_q_ST;
+        KDL::Jacobian J_DH(n), J_ST(n);
+
+        ASSERT_EQ(idSolver.CartToJnt(q, KDL::JntArray(n), KDL::JntArray(n), fexts_DH, t_DH), KDL::SolverI::E_NOERROR);
+        ASSERT_EQ(fkSolver.JntToCart(q, H_S_T_q_DH), KDL::SolverI::E_NOERROR);
+        ASSERT_EQ(jacSolver.JntToJac(q, J_DH), KDL::SolverI::E_NOERROR);
+        ASSERT_TRUE(dynamics.gravityTorques(q, t_ST, &H_S_T_q_ST, &J_ST));
+
+        ASSERT_EQ(H_S_T_q_ST, H_S_T_q_DH);
+
+        J_ST.changeRefPoint(H_S_T_q_ST.p);  //-- spatial Jacobian to KDL's reference point (tool origin)
+        ASSERT_TRUE(KDL::Equal(J_ST, J_DH, 1e-9));
+
+        for (int i = 0; i < n; i++)
+        {
+            ASSERT_NEAR(t_ST(i), t_DH(i), 1e-9);
+        }
+
+        //-- external wrench on the last segment, referred to the base frame at zero position
+        KDL::Wrench fext(KDL::Vector(1, -2, 3), KDL::Vector(0.1, 0.2, -0.3));
+        fexts_DH.back() = fext;
+
+        std::vector<KDL::Wrench> fexts_ST(n, KDL::Wrench::Zero());
+        fexts_ST.back() = poe.getTransform() * fext;
+
+        ASSERT_EQ(idSolver.CartToJnt(q, qdot, qdotdot, fexts_DH, t_DH), KDL::SolverI::E_NOERROR);
+        ASSERT_TRUE(dynamics.inverseDynamics(q, qdot, qdotdot, fexts_ST, t_ST));
+
+        for (int i = 0; i < n; i++)
+        {
+            ASSERT_NEAR(t_ST(i), t_DH(i), 1e-9);
+        }
+    }
+
     static int findTargetConfiguration(const ScrewTheoryIkProblem::Solutions & solutions, const KDL::JntArray & target)
     {
         for (int i = 0; i < solutions.size(); i++)
@@ -560,6 +639,33 @@ TEST_F(ScrewTheoryTest, ProductOfExponentialsReverse)
     ASSERT_EQ(H_S_T_q_reversed, H_S_T_q.Inverse());
 }
 
+TEST_F(ScrewTheoryTest, ProductOfExponentialsInertia)
+{
+    const KDL::Vector gravity(0, 0, -9.81);
+
+    KDL::Chain chain = addLinkInertias(makeStanfordKinematicsFromDH());
+    KDL::Chain chainFromPoe = PoeExpression::fromChain(chain).toChain();
+
+    KDL::ChainIdSolver_RNE idSolver(chain, gravity);
+    KDL::ChainIdSolver_RNE idSolverFromPoe(chainFromPoe, gravity);
+
+    KDL::JntArray q = fillJointValues(chain.getNrOfJoints(), KDL::PI / 4);
+    KDL::JntArray qdot = fillJointValues(chain.getNrOfJoints(), 0.5);
+    KDL::JntArray qdotdot = fillJointValues(chain.getNrOfJoints(), -0.25);
+    KDL::JntArray t(chain.getNrOfJoints()), tFromPoe(chain.getNrOfJoints());
+
+    KDL::Wrenches fexts(chain.getNrOfSegments(), KDL::Wrench::Zero());
+    KDL::Wrenches fextsFromPoe(chainFromPoe.getNrOfSegments(), KDL::Wrench::Zero());
+
+    ASSERT_EQ(idSolver.CartToJnt(q, qdot, qdotdot, fexts, t), KDL::SolverI::E_NOERROR);
+    ASSERT_EQ(idSolverFromPoe.CartToJnt(q, qdot, qdotdot, fextsFromPoe, tFromPoe), KDL::SolverI::E_NOERROR);
+
+    for (int i = 0; i < chain.getNrOfJoints(); i++)
+    {
+        ASSERT_NEAR(tFromPoe(i), t(i), 1e-9);
+    }
+}
+
 TEST_F(ScrewTheoryTest, PadenKahanOne)
 {
     KDL::Vector p(0, 1, 0);
@@ -905,6 +1011,18 @@ TEST_F(ScrewTheoryTest, TeoRightLegKinematics)
     checkRobotKinematics(chain, poe, 8);
 }
 
+TEST_F(ScrewTheoryTest, TeoRightArmDynamics)
+{
+    KDL::Chain chain = addLinkInertias(makeTeoRightArmKinematicsFromDH());
+    checkRobotDynamics(chain);
+}
+
+TEST_F(ScrewTheoryTest, StanfordDynamics)
+{
+    KDL::Chain chain = addLinkInertias(makeStanfordKinematicsFromDH());
+    checkRobotDynamics(chain);
+}
+
 TEST_F(ScrewTheoryTest, ConfigurationSelector)
 {
     PoeExpression poe = makeTeoRightArmKinematicsFromPoE();
@@ -0,0 +1,234 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+#include "SplineJointTrajectory.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref SplineJointTrajectory.
+ */
+class SplineJointTrajectoryTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {
+        iJointTrajectory = new SplineJointTrajectory();
+
+        q1.resize(2);
+        q2.resize(2);
+        q3.resize(2);
+
+        q2[0] = 10.0;
+        q2[1] = -5.0;
+        q3[0] = 20.0;
+        q3[1] = -10.0;
+    }
+
+    virtual void TearDown()
+    {
+        delete iJointTrajectory;
+        iJointTrajectory = 0;
+    }
+
+protected:
+    IJointTrajectory* iJointTrajectory;
+
+    std::vector<double> q1, q2, q3;
+
+    static const double MAX_VEL;
+    static const double MAX_ACC;
+
+    static const double EPS;
+};
+
+const double SplineJointTrajectoryTest::MAX_VEL = 10.0;
+const double SplineJointTrajectoryTest::MAX_ACC = 10.0;
+
+const double SplineJointTrajectoryTest::EPS = 1e-9;
+
+TEST_F(SplineJointTrajectoryTest, SplineJointTrajectoryCubic)
+{
+    //-- Create single segment, acceleration-limited
+    ASSERT_TRUE(iJointTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iJointTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q2));
+    ASSERT_TRUE(iJointTrajectory->configurePath(IJointTrajectory::CUBIC_SPLINE));
+    ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+    ASSERT_TRUE(iJointTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iJointTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, std::sqrt(6.0 * q2[0] / MAX_ACC), EPS);
+
+    //-- Both joints start and end together, at rest
+    std::vector<double> position, velocity, acceleration;
+
+    ASSERT_TRUE(iJointTrajectory->getPosition(duration / 2, position));
+    ASSERT_NEAR(position[0], q2[0] / 2, EPS);
+    ASSERT_NEAR(position[1], q2[1] / 2, EPS);
+
+    ASSERT_TRUE(iJointTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], q2[0], EPS);
+    ASSERT_NEAR(position[1], q2[1], EPS);
+
+    ASSERT_TRUE(iJointTrajectory->getVelocity(duration, velocity));
+    ASSERT_NEAR(velocity[0], 0.0, EPS);
+    ASSERT_NEAR(velocity[1], 0.0, EPS);
+
+    ASSERT_TRUE(iJointTrajectory->getAcceleration(0.0, acceleration));
+    ASSERT_NEAR(acceleration[0], MAX_ACC, EPS);
+
+    for (double t = 0.0; t <= duration; t += 0.01)
+    {
+        ASSERT_TRUE(iJointTrajectory->getVelocity(t, velocity));
+        ASSERT_LE(std::abs(velocity[0]), MAX_VEL + EPS);
+    }
+
+    //-- Destroy trajectory
+    ASSERT_TRUE(iJointTrajectory->destroy());
+}
+
+TEST_F(SplineJointTrajectoryTest, SplineJointTrajectoryQuinticViaPoint)
+{
+    //-- Create two segments, joints keep moving through the via point
+    ASSERT_TRUE(iJointTrajectory->setMaxVelocity(MAX_VEL));
+    ASSERT_TRUE(iJointTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q2));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q3));
+    ASSERT_TRUE(iJointTrajectory->configurePath(IJointTrajectory::QUINTIC_SPLINE));
+    ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+    ASSERT_TRUE(iJointTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iJointTrajectory->getDuration(&duration));
+
+    //-- Continuous up to acceleration at the via point
+    const double dt = 1e-7;
+    double before[3][2], after[3][2];
+
+    ASSERT_TRUE(iJointTrajectory->getState(duration / 2 - dt, before[0], before[1], before[2]));
+    ASSERT_TRUE(iJointTrajectory->getState(duration / 2 + dt, after[0], after[1], after[2]));
+
+    for (int joint = 0; joint < 2; joint++)
+    {
+        ASSERT_NEAR(before[0][joint], q2[joint], 1e-5);
+        ASSERT_NEAR(after[0][joint], q2[joint], 1e-5);
+        ASSERT_NEAR(before[1][joint], after[1][joint], 1e-5);
+        ASSERT_NEAR(before[2][joint], after[2][joint], 1e-5);
+    }
+
+    ASSERT_GT(std::abs(before[1][0]), 0.0);
+
+    //-- Ends at rest on last waypoint
+    double position[2], velocity[2], acceleration[2];
+    ASSERT_TRUE(iJointTrajectory->getState(duration + 1.0, position, velocity, acceleration));
+    ASSERT_NEAR(position[0], q3[0], EPS);
+    ASSERT_NEAR(position[1], q3[1], EPS);
+    ASSERT_NEAR(velocity[0], 0.0, EPS);
+    ASSERT_NEAR(acceleration[0], 0.0, EPS);
+
+    //-- Destroy trajectory
+    ASSERT_TRUE(iJointTrajectory->destroy());
+}
+
+TEST_F(SplineJointTrajectoryTest, SplineJointTrajectoryViaPointShortSegment)
+{
+    //-- Arrive at the via point at speed, then stop shortly after
+    std::vector<double> qShort(q2);
+    qShort[0] += 0.1;
+    qShort[1] -= 0.05;
+
+    const int types[] = {IJointTrajectory::CUBIC_SPLINE, IJointTrajectory::QUINTIC_SPLINE};
+
+    for (int type : types)
+    {
+        ASSERT_TRUE(iJointTrajectory->setMaxVelocity(MAX_VEL));
+        ASSERT_TRUE(iJointTrajectory->setMaxAcceleration(MAX_ACC));
+        ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+        ASSERT_TRUE(iJointTrajectory->addWaypoint(q2));
+        ASSERT_TRUE(iJointTrajectory->addWaypoint(qShort));
+        ASSERT_TRUE(iJointTrajectory->configurePath(type));
+        ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+        ASSERT_TRUE(iJointTrajectory->create());
+
+        double duration;
+        ASSERT_TRUE(iJointTrajectory->getDuration(&duration));
+
+        //-- Acceleration limit holds everywhere, velocity is continuous at the via point
+        std::vector<double> acceleration;
+
+        for (double t = 0.0; t <= duration; t += 1e-3)
+        {
+            ASSERT_TRUE(iJointTrajectory->getAcceleration(t, acceleration));
+            ASSERT_LE(std::abs(acceleration[0]), MAX_ACC + 1e-6);
+            ASSERT_LE(std::abs(acceleration[1]), MAX_ACC + 1e-6);
+        }
+
+        std::vector<double> position;
+        ASSERT_TRUE(iJointTrajectory->getPosition(duration, position));
+        ASSERT_NEAR(position[0], qShort[0], EPS);
+        ASSERT_NEAR(position[1], qShort[1], EPS);
+
+        //-- Destroy trajectory
+        ASSERT_TRUE(iJointTrajectory->destroy());
+    }
+}
+
+TEST_F(SplineJointTrajectoryTest, SplineJointTrajectoryDuration)
+{
+    std::vector<double> maxVelocities(2, MAX_VEL);
+    maxVelocities[1] = 1.0; // second joint is the slowest one
+
+    //-- Limits dictate a longer duration than requested
+    ASSERT_TRUE(iJointTrajectory->setDuration(0.1));
+    ASSERT_TRUE(iJointTrajectory->setMaxJointVelocities(maxVelocities));
+    ASSERT_TRUE(iJointTrajectory->setMaxAcceleration(MAX_ACC));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q2));
+    ASSERT_TRUE(iJointTrajectory->configurePath(IJointTrajectory::CUBIC_SPLINE));
+    ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+    ASSERT_TRUE(iJointTrajectory->create());
+
+    double duration;
+    ASSERT_TRUE(iJointTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, 1.5 * std::abs(q2[1]) / maxVelocities[1], EPS);
+    ASSERT_TRUE(iJointTrajectory->destroy());
+
+    //-- Stretched to a longer duration
+    ASSERT_TRUE(iJointTrajectory->setDuration(20.0));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q2));
+    ASSERT_TRUE(iJointTrajectory->configurePath(IJointTrajectory::CUBIC_SPLINE));
+    ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+    ASSERT_TRUE(iJointTrajectory->create());
+
+    ASSERT_TRUE(iJointTrajectory->getDuration(&duration));
+    ASSERT_NEAR(duration, 20.0, EPS);
+
+    std::vector<double> position;
+    ASSERT_TRUE(iJointTrajectory->getPosition(duration, position));
+    ASSERT_NEAR(position[0], q2[0], EPS);
+
+    //-- Destroy trajectory
+    ASSERT_TRUE(iJointTrajectory->destroy());
+}
+
+TEST_F(SplineJointTrajectoryTest, SplineJointTrajectoryWaypointSizeMismatch)
+{
+    ASSERT_TRUE(iJointTrajectory->addWaypoint(q1));
+    ASSERT_FALSE(iJointTrajectory->addWaypoint(std::vector<double>(3, 0.0)));
+    ASSERT_FALSE(iJointTrajectory->addWaypoint(q2, std::vector<double>(1, 0.0)));
+    ASSERT_TRUE(iJointTrajectory->configurePath(IJointTrajectory::CUBIC_SPLINE));
+    ASSERT_TRUE(iJointTrajectory->configureVelocityProfile(IJointTrajectory::SYNCHRONIZED));
+    ASSERT_FALSE(iJointTrajectory->create()); // single waypoint
+    ASSERT_TRUE(iJointTrajectory->destroy());
+}
+
+}  // namespace roboticslab
@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <yarp/os/Stamp.h>
+
+#include "CartesianControlServer.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref StreamResponder drop policies.
+ */
+class StreamResponderTest : public testing::Test
+{
+public:
+    StreamResponderTest()
+        : responder(NULL)
+    {}
+
+    virtual void SetUp()
+    {
+    }
+
+    virtual void TearDown()
+    {
+    }
+
+protected:
+    void assertStats(unsigned int received, unsigned int applied, unsigned int dropped, unsigned int late)
+    {
+        unsigned int _received, _applied, _dropped, _late;
+        responder.getStats(&_received, &_applied, &_dropped, &_late);
+
+        ASSERT_EQ(_received, received);
+        ASSERT_EQ(_applied, applied);
+        ASSERT_EQ(_dropped, dropped);
+        ASSERT_EQ(_late, late);
+    }
+
+    StreamResponder responder;
+
+    //-- Sender clock runs far ahead of the local one.
+    static const double OFFSET;
+};
+
+const double StreamResponderTest::OFFSET = 1000.0;
+
+TEST_F(StreamResponderTest, StreamResponderLegacySender)
+{
+    responder.setLatestOnly(true);
+    responder.setMaxAge(0.1);
+
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(), 10.0, 0));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(), 20.0, 5));
+    assertStats(2, 2, 0, 0);
+}
+
+TEST_F(StreamResponderTest, StreamResponderMaxAge)
+{
+    responder.setMaxAge(0.1);
+
+    //-- Steady link with some jitter, the clock offset alone must not render commands late.
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(0, OFFSET + 0.00), 0.02, 0));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(1, OFFSET + 0.02), 0.03, 0));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(2, OFFSET + 0.04), 0.09, 0));
+
+    //-- Network hiccup: a burst of commands received at once.
+    ASSERT_FALSE(responder.acceptCommand(yarp::os::Stamp(3, OFFSET + 0.06), 0.30, 2));
+    ASSERT_FALSE(responder.acceptCommand(yarp::os::Stamp(4, OFFSET + 0.08), 0.30, 1));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(5, OFFSET + 0.25), 0.30, 0));
+
+    assertStats(6, 4, 0, 2);
+}
+
+TEST_F(StreamResponderTest, StreamResponderLatestOnly)
+{
+    responder.setLatestOnly(true);
+
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(0, OFFSET + 0.0), 0.1, 0));
+
+    //-- Superseded by a pending command.
+    ASSERT_FALSE(responder.acceptCommand(yarp::os::Stamp(1, OFFSET + 0.1), 0.2, 1));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(2, OFFSET + 0.2), 0.2, 0));
+
+    //-- Out of order.
+    ASSERT_FALSE(responder.acceptCommand(yarp::os::Stamp(1, OFFSET + 0.1), 0.3, 0));
+
+    //-- Sender restarted, sequence numbers start over.
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(0, OFFSET + 5.0), 5.1, 0));
+    ASSERT_TRUE(responder.acceptCommand(yarp::os::Stamp(1, OFFSET + 5.1), 5.2, 0));
+
+    assertStats(6, 4, 2, 0);
+}
+
+}  // namespace roboticslab
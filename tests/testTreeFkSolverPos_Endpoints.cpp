@@ -0,0 +1,192 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jacobian.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+#include <kdl/tree.hpp>
+#include <kdl/treefksolverpos_recursive.hpp>
+#include <kdl/treejnttojacsolver.hpp>
+
+#include <Eigen/Core>
+
+#include "TreeFkSolverPos_Endpoints.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref TreeFkSolverPos_Endpoints against KDL's recursive tree solvers on a
+ * torso with two arms and a head that does not lead to any endpoint.
+ */
+class TreeFkSolverPos_EndpointsTest : public testing::Test
+{
+public:
+    TreeFkSolverPos_EndpointsTest()
+        : tree("base")
+    {
+        const KDL::Joint rotX(KDL::Joint::RotX), rotY(KDL::Joint::RotY), rotZ(KDL::Joint::RotZ);
+        const KDL::Joint fixed(KDL::Joint::None);
+
+        tree.addSegment(KDL::Segment("torso_1", rotZ, KDL::Frame(KDL::Vector(0.0, 0.0, 0.2))), "base");
+        tree.addSegment(KDL::Segment("torso_2", rotY, KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))), "torso_1");
+        tree.addSegment(KDL::Segment("head", rotZ, KDL::Frame(KDL::Vector(0.0, 0.0, 0.15))), "torso_2");
+
+        tree.addSegment(KDL::Segment("left_shoulder", fixed, KDL::Frame(KDL::Rotation::RotX(-M_PI / 2), KDL::Vector(0.0, 0.25, 0.0))), "torso_2");
+        tree.addSegment(KDL::Segment("left_1", rotZ, KDL::Frame(KDL::Vector(0.0, 0.0, 0.1))), "left_shoulder");
+        tree.addSegment(KDL::Segment("left_2", rotX, KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))), "left_1");
+        tree.addSegment(KDL::Segment("left_3", rotY, KDL::Frame(KDL::Vector(0.05, 0.0, 0.2))), "left_2");
+
+        tree.addSegment(KDL::Segment("right_shoulder", fixed, KDL::Frame(KDL::Rotation::RotX(M_PI / 2), KDL::Vector(0.0, -0.25, 0.0))), "torso_2");
+        tree.addSegment(KDL::Segment("right_1", rotZ, KDL::Frame(KDL::Vector(0.0, 0.0, 0.1))), "right_shoulder");
+        tree.addSegment(KDL::Segment("right_2", rotX, KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))), "right_1");
+        tree.addSegment(KDL::Segment("right_3", rotY, KDL::Frame(KDL::Vector(-0.05, 0.0, 0.2))), "right_2");
+
+        endpoints.push_back("left_3");
+        endpoints.push_back("right_3");
+    }
+
+    virtual void SetUp()
+    {}
+
+    virtual void TearDown()
+    {}
+
+protected:
+    //-- Deterministic joint values spread over the whole range.
+    KDL::JntArray makeJoints(int k) const
+    {
+        KDL::JntArray q(tree.getNrOfJoints());
+
+        for (int i = 0; i < q.rows(); i++)
+        {
+            q(i) = std::sin(0.37 * k + 1.3 * i) * M_PI;
+        }
+
+        return q;
+    }
+
+    static const double EPS;
+    static const int CONFIGURATIONS;
+
+    KDL::Tree tree;
+    std::vector<std::string> endpoints;
+};
+
+const double TreeFkSolverPos_EndpointsTest::EPS = 1e-9;
+const int TreeFkSolverPos_EndpointsTest::CONFIGURATIONS = 50;
+
+TEST_F(TreeFkSolverPos_EndpointsTest, TreeFkSolverPos_EndpointsJntToCart)
+{
+    TreeFkSolverPos_Endpoints fkSolver(tree, endpoints);
+    KDL::TreeFkSolverPos_recursive fkSolverKdl(tree);
+
+    std::vector<KDL::Frame> frames(endpoints.size());
+    KDL::Frame expected;
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+        ASSERT_EQ(fkSolver.JntToCart(q, frames), 0);
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ASSERT_GE(fkSolverKdl.JntToCart(q, expected, endpoints[i]), 0);
+            ASSERT_TRUE(KDL::Equal(frames[i], expected, EPS));
+        }
+    }
+}
+
+TEST_F(TreeFkSolverPos_EndpointsTest, TreeFkSolverPos_EndpointsSegment)
+{
+    TreeFkSolverPos_Endpoints fkSolver(tree, endpoints);
+    KDL::TreeFkSolverPos_recursive fkSolverKdl(tree);
+
+    //-- Endpoints come from the sweep cache, the rest (incl. segments off any endpoint path) are walked.
+    const char * segments[] = {"left_3", "right_3", "torso_1", "torso_2", "head", "left_shoulder", "right_2"};
+    KDL::Frame actual, expected;
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+
+        for (const char * segment : segments)
+        {
+            ASSERT_EQ(fkSolver.JntToCart(q, actual, segment), 0);
+            ASSERT_GE(fkSolverKdl.JntToCart(q, expected, segment), 0);
+            ASSERT_TRUE(KDL::Equal(actual, expected, EPS));
+        }
+    }
+}
+
+TEST_F(TreeFkSolverPos_EndpointsTest, TreeFkSolverPos_EndpointsCache)
+{
+    TreeFkSolverPos_Endpoints fkSolver(tree, endpoints);
+    KDL::TreeFkSolverPos_recursive fkSolverKdl(tree);
+
+    KDL::JntArray q = makeJoints(0);
+    KDL::Frame actual, expected;
+
+    //-- Change one joint at a time right after a cached sweep, results must follow.
+    for (int i = 0; i < q.rows(); i++)
+    {
+        ASSERT_EQ(fkSolver.JntToCart(q, actual, "left_3"), 0);
+        q(i) += 0.1;
+
+        for (const auto & endpoint : endpoints)
+        {
+            ASSERT_EQ(fkSolver.JntToCart(q, actual, endpoint), 0);
+            ASSERT_GE(fkSolverKdl.JntToCart(q, expected, endpoint), 0);
+            ASSERT_TRUE(KDL::Equal(actual, expected, EPS));
+        }
+    }
+}
+
+TEST_F(TreeFkSolverPos_EndpointsTest, TreeFkSolverPos_EndpointsJntToJac)
+{
+    TreeFkSolverPos_Endpoints fkSolver(tree, endpoints);
+    KDL::TreeJntToJacSolver jacSolverKdl(tree);
+
+    const int numJoints = tree.getNrOfJoints();
+    Eigen::MatrixXd J(6 * endpoints.size(), numJoints);
+    KDL::Jacobian expected(numJoints);
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+        ASSERT_EQ(fkSolver.JntToJac(q, J), 0);
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ASSERT_GE(jacSolverKdl.JntToJac(q, expected, endpoints[i]), 0);
+            ASSERT_TRUE(J.block(6 * i, 0, 6, numJoints).isApprox(expected.data, EPS));
+        }
+    }
+}
+
+TEST_F(TreeFkSolverPos_EndpointsTest, TreeFkSolverPos_EndpointsErrors)
+{
+    KDL::JntArray q(tree.getNrOfJoints());
+    KDL::JntArray qShort(tree.getNrOfJoints() - 1);
+    std::vector<KDL::Frame> frames(endpoints.size());
+    KDL::Frame frame;
+
+    TreeFkSolverPos_Endpoints fkSolver(tree, endpoints);
+    ASSERT_LT(fkSolver.JntToCart(qShort, frames), 0);
+    ASSERT_LT(fkSolver.JntToCart(q, frame, "unknown"), 0);
+
+    std::vector<KDL::Frame> tooFew(1);
+    ASSERT_LT(fkSolver.JntToCart(q, tooFew), 0);
+
+    std::vector<std::string> unknown(1, "unknown");
+    TreeFkSolverPos_Endpoints fkSolverUnknown(tree, unknown);
+    ASSERT_LT(fkSolverUnknown.JntToCart(q, tooFew), 0);
+}
+
+}  // namespace roboticslab
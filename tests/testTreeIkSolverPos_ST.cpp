@@ -0,0 +1,270 @@
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <kdl/frames.hpp>
+#include <kdl/jntarray.hpp>
+#include <kdl/joint.hpp>
+#include <kdl/segment.hpp>
+#include <kdl/tree.hpp>
+
+#include "TreeFkSolverPos_Endpoints.hpp"
+#include "TreeIkSolverPos_ST.hpp"
+#include "WorkerPool.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref TreeIkSolverPos_ST on a two-joint torso carrying two copies of
+ * TEO's (UC3M) right arm.
+ */
+class TreeIkSolverPos_STTest : public testing::Test
+{
+public:
+    TreeIkSolverPos_STTest()
+        : tree("base")
+    {
+        const KDL::Joint rotY(KDL::Joint::RotY), rotZ(KDL::Joint::RotZ);
+
+        tree.addSegment(KDL::Segment("torso_1", rotZ, KDL::Frame(KDL::Vector(0.0, 0.0, 0.2))), "base");
+        tree.addSegment(KDL::Segment("torso_2", rotY, KDL::Frame(KDL::Vector(0.0, 0.0, 0.3))), "torso_1");
+
+        addArm("left", KDL::Vector(0.0, 0.35, 0.0));
+        addArm("right", KDL::Vector(0.0, -0.35, 0.0));
+
+        endpoints.push_back("left_6");
+        endpoints.push_back("right_6");
+
+        qMin.resize(tree.getNrOfJoints());
+        qMax.resize(tree.getNrOfJoints());
+
+        for (int i = 0; i < tree.getNrOfJoints(); i++)
+        {
+            qMin(i) = -KDL::PI;
+            qMax(i) = KDL::PI;
+        }
+    }
+
+    virtual void SetUp()
+    {
+        fkSolver.reset(new TreeFkSolverPos_Endpoints(tree, endpoints));
+    }
+
+    virtual void TearDown()
+    {}
+
+protected:
+    void addArm(const std::string & name, const KDL::Vector & shoulder)
+    {
+        const KDL::Joint rotZ(KDL::Joint::RotZ);
+        const double dh[][4] = {
+            {    0, -KDL::PI / 2,        0,            0},
+            {    0, -KDL::PI / 2,        0, -KDL::PI / 2},
+            {    0, -KDL::PI / 2, -0.32901, -KDL::PI / 2},
+            {    0,  KDL::PI / 2,        0,            0},
+            {    0, -KDL::PI / 2,   -0.215,            0},
+            {-0.09,            0,        0, -KDL::PI / 2}
+        };
+
+        std::string parent = name + "_shoulder";
+        tree.addSegment(KDL::Segment(parent, KDL::Joint(KDL::Joint::None), KDL::Frame(shoulder)), "torso_2");
+
+        for (int i = 0; i < 6; i++)
+        {
+            std::string segment = name + "_" + std::to_string(i + 1);
+            tree.addSegment(KDL::Segment(segment, rotZ, KDL::Frame::DH(dh[i][0], dh[i][1], dh[i][2], dh[i][3])), parent);
+            parent = segment;
+        }
+    }
+
+    //-- Deterministic joint values, elbows bent to stay away from the workspace boundary.
+    KDL::JntArray makeJoints(int k) const
+    {
+        KDL::JntArray q(tree.getNrOfJoints());
+
+        for (int i = 0; i < q.rows(); i++)
+        {
+            q(i) = 0.5 * std::sin(0.37 * k + 1.3 * i);
+        }
+
+        q(5) += KDL::PI / 2; // left elbow
+        q(11) += KDL::PI / 2; // right elbow
+        return q;
+    }
+
+    KDL::Frames makeTargets(const KDL::JntArray & q)
+    {
+        std::vector<KDL::Frame> frames(endpoints.size());
+        fkSolver->JntToCart(q, frames);
+
+        KDL::Frames targets;
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            targets[endpoints[i]] = frames[i];
+        }
+
+        return targets;
+    }
+
+    void assertReached(const KDL::JntArray & q, const KDL::Frames & targets)
+    {
+        std::vector<KDL::Frame> frames(endpoints.size());
+        ASSERT_EQ(fkSolver->JntToCart(q, frames), 0);
+
+        for (int i = 0; i < endpoints.size(); i++)
+        {
+            ASSERT_TRUE(KDL::Equal(frames[i], targets.at(endpoints[i]), EPS));
+        }
+    }
+
+    TreeIkSolverPos_ST * create(WorkerPool & workerPool)
+    {
+        return TreeIkSolverPos_ST::create(tree, endpoints, qMin, qMax, "leastOverallAngularDisplacement",
+                                          *fkSolver, workerPool, MAX_ITER, EPS, LAMBDA);
+    }
+
+    static const double EPS;
+    static const double LAMBDA;
+    static const int MAX_ITER;
+    static const int CONFIGURATIONS;
+
+    KDL::Tree tree;
+    std::vector<std::string> endpoints;
+    KDL::JntArray qMin, qMax;
+    std::unique_ptr<TreeFkSolverPos_Endpoints> fkSolver;
+};
+
+const double TreeIkSolverPos_STTest::EPS = 1e-6;
+const double TreeIkSolverPos_STTest::LAMBDA = 0.01;
+const int TreeIkSolverPos_STTest::MAX_ITER = 100;
+const int TreeIkSolverPos_STTest::CONFIGURATIONS = 20;
+
+TEST_F(TreeIkSolverPos_STTest, TreeIkSolverPos_STCreate)
+{
+    WorkerPool workerPool;
+
+    std::unique_ptr<TreeIkSolverPos_ST> ikSolver(create(workerPool));
+    ASSERT_TRUE(ikSolver);
+
+    std::unique_ptr<TreeIkSolverPos_ST> badStrategy(TreeIkSolverPos_ST::create(tree, endpoints, qMin, qMax, "unknown",
+                                                                               *fkSolver, workerPool, MAX_ITER, EPS, LAMBDA));
+    ASSERT_FALSE(badStrategy);
+
+    std::vector<std::string> unknown(1, "unknown");
+    std::unique_ptr<TreeIkSolverPos_ST> badEndpoint(TreeIkSolverPos_ST::create(tree, unknown, qMin, qMax, "leastOverallAngularDisplacement",
+                                                                               *fkSolver, workerPool, MAX_ITER, EPS, LAMBDA));
+    ASSERT_FALSE(badEndpoint);
+}
+
+TEST_F(TreeIkSolverPos_STTest, TreeIkSolverPos_STArms)
+{
+    WorkerPool workerPool;
+    std::unique_ptr<TreeIkSolverPos_ST> ikSolver(create(workerPool));
+    ASSERT_TRUE(ikSolver);
+
+    KDL::JntArray qOut(tree.getNrOfJoints());
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+        KDL::Frames targets = makeTargets(q);
+
+        //-- Torso guess is exact, arms start away from the solution.
+        KDL::JntArray qInit = q;
+
+        for (int i = 2; i < qInit.rows(); i++)
+        {
+            qInit(i) += 0.2;
+        }
+
+        ASSERT_EQ(ikSolver->CartToJnt(qInit, targets, qOut), 0);
+        assertReached(qOut, targets);
+
+        //-- Torso joints are left untouched if arms can reach their targets in closed form.
+        ASSERT_EQ(qOut(0), q(0));
+        ASSERT_EQ(qOut(1), q(1));
+    }
+}
+
+TEST_F(TreeIkSolverPos_STTest, TreeIkSolverPos_STTorso)
+{
+    WorkerPool workerPool;
+    std::unique_ptr<TreeIkSolverPos_ST> ikSolver(create(workerPool));
+    ASSERT_TRUE(ikSolver);
+
+    KDL::JntArray qOut(tree.getNrOfJoints());
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+        KDL::Frames targets = makeTargets(q);
+
+        //-- Both the torso and the arms start away from the solution.
+        KDL::JntArray qInit = q;
+
+        for (int i = 0; i < qInit.rows(); i++)
+        {
+            qInit(i) += 0.1;
+        }
+
+        ASSERT_GE(ikSolver->CartToJnt(qInit, targets, qOut), 0);
+        assertReached(qOut, targets);
+    }
+}
+
+TEST_F(TreeIkSolverPos_STTest, TreeIkSolverPos_STParallel)
+{
+    WorkerPool serialPool(0);
+    WorkerPool parallelPool(1);
+
+    std::unique_ptr<TreeIkSolverPos_ST> serialSolver(create(serialPool));
+    std::unique_ptr<TreeIkSolverPos_ST> parallelSolver(create(parallelPool));
+    ASSERT_TRUE(serialSolver);
+    ASSERT_TRUE(parallelSolver);
+
+    KDL::JntArray qSerial(tree.getNrOfJoints()), qParallel(tree.getNrOfJoints());
+
+    for (int k = 0; k < CONFIGURATIONS; k++)
+    {
+        KDL::JntArray q = makeJoints(k);
+        KDL::Frames targets = makeTargets(q);
+        KDL::JntArray qInit = makeJoints(k + CONFIGURATIONS);
+
+        //-- Same branches solved on different threads must give the very same result.
+        double serialRet = serialSolver->CartToJnt(qInit, targets, qSerial);
+        double parallelRet = parallelSolver->CartToJnt(qInit, targets, qParallel);
+
+        ASSERT_EQ(serialRet, parallelRet);
+        ASSERT_TRUE(qSerial == qParallel);
+    }
+}
+
+TEST_F(TreeIkSolverPos_STTest, TreeIkSolverPos_STErrors)
+{
+    WorkerPool workerPool;
+    std::unique_ptr<TreeIkSolverPos_ST> ikSolver(create(workerPool));
+    ASSERT_TRUE(ikSolver);
+
+    KDL::JntArray q = makeJoints(0);
+    KDL::JntArray qOut(tree.getNrOfJoints());
+    KDL::JntArray qShort(tree.getNrOfJoints() - 1);
+    KDL::Frames targets = makeTargets(q);
+
+    ASSERT_EQ(ikSolver->CartToJnt(qShort, targets, qOut), TreeIkSolverPos_ST::E_INVALID_INPUT);
+
+    KDL::Frames missing;
+    missing[endpoints[0]] = targets[endpoints[0]];
+    ASSERT_EQ(ikSolver->CartToJnt(q, missing, qOut), TreeIkSolverPos_ST::E_INVALID_INPUT);
+
+    //-- Far beyond the reach of the left arm, whatever the torso does.
+    targets[endpoints[0]].p += KDL::Vector(5.0, 0.0, 0.0);
+    ASSERT_NE(ikSolver->CartToJnt(q, targets, qOut), 0);
+}
+
+}  // namespace roboticslab
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "WorkerPool.hpp"
+
+namespace roboticslab
+{
+
+/**
+ * @ingroup kinematics-dynamics-tests
+ * @brief Tests \ref WorkerPool.
+ */
+class WorkerPoolTest : public testing::Test
+{
+public:
+    virtual void SetUp()
+    {}
+
+    virtual void TearDown()
+    {}
+
+protected:
+    static const int NUM_TASKS;
+    static const int NUM_CYCLES;
+};
+
+const int WorkerPoolTest::NUM_TASKS = 7;
+const int WorkerPoolTest::NUM_CYCLES = 1000;
+
+TEST_F(WorkerPoolTest, WorkerPoolSerial)
+{
+    WorkerPool pool;
+    ASSERT_EQ(pool.getNumWorkers(), 0);
+
+    std::vector<int> out(NUM_TASKS, 0);
+    auto task = [&out](int i) { out[i] = i * i; };
+    pool.run(NUM_TASKS, task);
+
+    for (int i = 0; i < NUM_TASKS; i++)
+    {
+        ASSERT_EQ(out[i], i * i);
+    }
+}
+
+TEST_F(WorkerPoolTest, WorkerPoolBarrier)
+{
+    WorkerPool pool(3);
+    ASSERT_EQ(pool.getNumWorkers(), 3);
+
+    std::vector<int> out(NUM_TASKS, 0);
+
+    //-- Each cycle must see all results of the previous one
+    for (int cycle = 1; cycle <= NUM_CYCLES; cycle++)
+    {
+        auto task = [&out](int i) { out[i] += 1; };
+        pool.run(NUM_TASKS, task);
+
+        for (int i = 0; i < NUM_TASKS; i++)
+        {
+            ASSERT_EQ(out[i], cycle);
+        }
+    }
+}
+
+}  // namespace roboticslab